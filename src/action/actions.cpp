@@ -54,6 +54,7 @@
 #include "action/action_unload.h"
 #include "action/action_upgradeto.h"
 #include "action/action_use.h"
+#include "action/order_pool.h"
 
 #include "animation/animation_die.h"
 #include "commands.h"
@@ -79,6 +80,16 @@
 
 unsigned SyncHash; /// Hash calculated to find sync failures
 
+void *COrder::operator new(const size_t size)
+{
+	return wyrmgus::order_pool::allocate(size);
+}
+
+void COrder::operator delete(void *ptr, const size_t size)
+{
+	wyrmgus::order_pool::deallocate(ptr, size);
+}
+
 CUnit *COrder::get_goal() const
 {
 	if (this->goal == nullptr) {
@@ -306,6 +317,16 @@ static inline void IncreaseVariable(CUnit &unit, int index)
 	//Wyrmgus end
 }
 
+/**
+**  Variables which are spell effect timers, decreased by one each cycle
+*/
+static const int SpellEffects[] = {BLOODLUST_INDEX, HASTE_INDEX, SLOW_INDEX, INVISIBLE_INDEX, UNHOLYARMOR_INDEX, POISON_INDEX, STUN_INDEX, BLEEDING_INDEX, LEADERSHIP_INDEX, BLESSING_INDEX, INSPIRE_INDEX, PRECISION_INDEX, REGENERATION_INDEX, BARKSKIN_INDEX, INFUSION_INDEX, TERROR_INDEX, WITHER_INDEX, DEHYDRATION_INDEX, HYDRATING_INDEX};
+
+static bool IsSpellEffectVariable(const unsigned int index)
+{
+	return std::find(std::begin(SpellEffects), std::end(SpellEffects), static_cast<int>(index)) != std::end(SpellEffects);
+}
+
 /**
 **  Handle things about the unit that decay over time each cycle
 **
@@ -358,13 +379,7 @@ static void HandleBuffsEachCycle(CUnit &unit)
 		}
 	}
 	
-	const int SpellEffects[] = {BLOODLUST_INDEX, HASTE_INDEX, SLOW_INDEX, INVISIBLE_INDEX, UNHOLYARMOR_INDEX, POISON_INDEX, STUN_INDEX, BLEEDING_INDEX, LEADERSHIP_INDEX, BLESSING_INDEX, INSPIRE_INDEX, PRECISION_INDEX, REGENERATION_INDEX, BARKSKIN_INDEX, INFUSION_INDEX, TERROR_INDEX, WITHER_INDEX, DEHYDRATION_INDEX, HYDRATING_INDEX};
-	//  decrease spells effects time.
-	for (unsigned int i = 0; i < sizeof(SpellEffects) / sizeof(int); ++i) {
-		unit.Variable[SpellEffects[i]].Increase = -1;
-		IncreaseVariable(unit, SpellEffects[i]);
-	}
-	
+	//the spell effect timers have been decreased for all units by DecreaseSpellEffectTimers
 	const bool lastStatusIsHidden = unit.Variable[INVISIBLE_INDEX].Value > 0;
 	if (lastStatusIsHidden && unit.Variable[INVISIBLE_INDEX].Value == 0) {
 		UnHideUnit(unit);
@@ -424,25 +439,23 @@ static void HandleBuffsEachSecond(CUnit &unit)
 	}
 	//Wyrmgus end
 	
-	// User defined variables
-	for (unsigned int i = 0; i < UnitTypeVar.GetNumberVariable(); i++) {
-		if (i == BLOODLUST_INDEX || i == HASTE_INDEX || i == SLOW_INDEX
-			|| i == INVISIBLE_INDEX || i == UNHOLYARMOR_INDEX || i == POISON_INDEX || i == STUN_INDEX || i == BLEEDING_INDEX || i == LEADERSHIP_INDEX || i == BLESSING_INDEX || i == INSPIRE_INDEX || i == PRECISION_INDEX || i == REGENERATION_INDEX || i == BARKSKIN_INDEX || i == INFUSION_INDEX || i == TERROR_INDEX || i == WITHER_INDEX || i == DEHYDRATION_INDEX || i == HYDRATING_INDEX) {
-			continue;
-		}
-		if (i == HP_INDEX && HandleBurnAndPoison(unit)) {
-			continue;
-		}
+	// User defined variables; those without side effects have been increased for all units by IncreaseVariablesEachSecond
+	if (!HandleBurnAndPoison(unit)) {
 		//Wyrmgus start
-		if (i == HP_INDEX && unit.Variable[REGENERATION_INDEX].Value > 0) {
-			unit.Variable[i].Value += 1;
-			clamp(&unit.Variable[i].Value, 0, unit.GetModifiedVariable(i, VariableAttribute::Max));
+		if (unit.Variable[REGENERATION_INDEX].Value > 0) {
+			unit.Variable[HP_INDEX].Value += 1;
+			clamp(&unit.Variable[HP_INDEX].Value, 0, unit.GetModifiedVariable(HP_INDEX, VariableAttribute::Max));
 		}
 		//Wyrmgus end
-		if (unit.Variable[i].Enable && unit.Variable[i].Increase) {
-			IncreaseVariable(unit, i);
+
+		if (unit.Variable[HP_INDEX].Increase && unit.Variable[HP_INDEX].Enable) {
+			IncreaseVariable(unit, HP_INDEX);
 		}
 	}
+
+	if (unit.Variable[GIVERESOURCE_INDEX].Increase && unit.Variable[GIVERESOURCE_INDEX].Enable) {
+		IncreaseVariable(unit, GIVERESOURCE_INDEX);
+	}
 	
 	//Wyrmgus start
 	if (unit.IsAlive() && unit.CurrentAction() != UnitAction::Built) {
@@ -552,9 +565,42 @@ static void HandleUnitAction(CUnit &unit)
 	unit.Orders[0]->Execute(unit);
 }
 
+/**
+**  Increase the user defined variables without side effects of all units, one variable column at a time
+*/
+template <typename UNITP_ITERATOR>
+static void IncreaseVariablesEachSecond(UNITP_ITERATOR begin, UNITP_ITERATOR end)
+{
+	std::vector<size_t> slots;
+	for (UNITP_ITERATOR it = begin; it != end; ++it) {
+		const CUnit &unit = **it;
+
+		if (unit.Destroyed || unit.Type->BoolFlag[DECORATION_INDEX].value) {
+			continue;
+		}
+
+		slots.push_back(unit.UnitManagerData.GetUnitId());
+	}
+
+	//hit points and resources held have side effects when they change, and spell effect timers are decreased each cycle instead
+	std::vector<int> variable_indexes;
+	const unsigned int variable_count = UnitTypeVar.GetNumberVariable();
+	for (unsigned int i = 0; i < variable_count; i++) {
+		if (i == HP_INDEX || i == GIVERESOURCE_INDEX || IsSpellEffectVariable(i)) {
+			continue;
+		}
+
+		variable_indexes.push_back(i);
+	}
+
+	wyrmgus::unit_manager::get()->get_variable_table().apply_increases(slots, variable_indexes);
+}
+
 template <typename UNITP_ITERATOR>
 static void UnitActionsEachSecond(UNITP_ITERATOR begin, UNITP_ITERATOR end)
 {
+	IncreaseVariablesEachSecond(begin, end);
+
 	for (UNITP_ITERATOR it = begin; it != end; ++it) {
 		CUnit &unit = **it;
 
@@ -628,9 +674,31 @@ static void DumpUnitInfo(CUnit &unit)
 	fflush(nullptr);
 }
 
+/**
+**  Decrease the spell effect timers of all units, one variable column at a time
+*/
+template <typename UNITP_ITERATOR>
+static void DecreaseSpellEffectTimers(UNITP_ITERATOR begin, UNITP_ITERATOR end)
+{
+	std::vector<size_t> slots;
+	for (UNITP_ITERATOR it = begin; it != end; ++it) {
+		const CUnit &unit = **it;
+
+		if (unit.Destroyed) {
+			continue;
+		}
+
+		slots.push_back(unit.UnitManagerData.GetUnitId());
+	}
+
+	wyrmgus::unit_manager::get()->get_variable_table().decrease_timers(slots, SpellEffects, sizeof(SpellEffects) / sizeof(int));
+}
+
 template <typename UNITP_ITERATOR>
 static void UnitActionsEachCycle(UNITP_ITERATOR begin, UNITP_ITERATOR end)
 {
+	DecreaseSpellEffectTimers(begin, end);
+
 	for (UNITP_ITERATOR it = begin; it != end; ++it) {
 		CUnit &unit = **it;
 
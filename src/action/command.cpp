@@ -45,6 +45,7 @@
 #include "script.h"
 #include "spell/spell.h"
 #include "translate.h"
+#include "ui/button.h"
 #include "ui/ui.h"
 #include "unit/unit.h"
 //Wyrmgus start
@@ -78,6 +79,7 @@ static void ReleaseOrders(CUnit &unit)
 		}
 	}
 	unit.Orders.resize(1);
+	InvalidateButtonAllowedCache();
 	//Wyrmgus start
 //	unit.Orders[0]->Finished = true;
 	if (unit.Variable[STUN_INDEX].Value == 0 || unit.Orders[0]->Action != UnitAction::Still) { //if the unit is stunned, don't end its current "still" order
@@ -111,6 +113,7 @@ static std::unique_ptr<COrder> *GetNextOrder(CUnit &unit, int flush)
 		return nullptr;
 	}
 	unit.Orders.push_back(nullptr);
+	InvalidateButtonAllowedCache();
 	return &unit.Orders.back();
 }
 
@@ -125,6 +128,7 @@ static void RemoveOrder(CUnit &unit, unsigned int order)
 	Assert(order < unit.Orders.size());
 
 	unit.Orders.erase(unit.Orders.begin() + order);
+	InvalidateButtonAllowedCache();
 	if (unit.Orders.empty()) {
 		unit.Orders.push_back(COrder::NewActionStill());
 	}
@@ -1414,14 +1418,14 @@ void CommandSharedVision(int player, bool state, int opponent)
 				wyrmgus::tile &mf = *CMap::Map.Field(i, z);
 				const std::unique_ptr<wyrmgus::tile_player_info> &mfp = mf.player_info;
 
-				if (mfp->Visible[player] && !mfp->Visible[opponent] && !CPlayer::Players[player]->is_revealed()) {
-					mfp->Visible[opponent] = 1;
+				if (mfp->get_visible(player) && !mfp->get_visible(opponent) && !CPlayer::Players[player]->is_revealed()) {
+					mfp->get_visible_ref(opponent) = 1;
 					if (opponent == CPlayer::GetThisPlayer()->Index) {
 						CMap::Map.MarkSeenTile(mf);
 					}
 				}
-				if (mfp->Visible[opponent] && !mfp->Visible[player] && !CPlayer::Players[opponent]->is_revealed()) {
-					mfp->Visible[player] = 1;
+				if (mfp->get_visible(opponent) && !mfp->get_visible(player) && !CPlayer::Players[opponent]->is_revealed()) {
+					mfp->get_visible_ref(player) = 1;
 					if (player == CPlayer::GetThisPlayer()->Index) {
 						CMap::Map.MarkSeenTile(mf);
 					}
@@ -0,0 +1,126 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "stratagus.h"
+
+#include "action/order_pool.h"
+
+namespace wyrmgus {
+
+void *order_pool::allocate(const size_t size)
+{
+	if (size == 0 || size > order_pool::max_pooled_size) {
+		++order_pool::large_order_statistics.allocations;
+		++order_pool::large_order_statistics.live_blocks;
+		return ::operator new(size);
+	}
+
+	const size_t size_class = order_pool::get_size_class(size);
+	statistics &class_statistics = order_pool::size_class_statistics[size_class];
+
+	++class_statistics.allocations;
+	++class_statistics.live_blocks;
+
+	if (order_pool::free_lists[size_class] == nullptr) {
+		order_pool::allocate_chunk(size_class);
+	} else {
+		++class_statistics.reused_allocations;
+	}
+
+	free_block *block = order_pool::free_lists[size_class];
+	order_pool::free_lists[size_class] = block->next;
+	return block;
+}
+
+void order_pool::deallocate(void *ptr, const size_t size)
+{
+	if (ptr == nullptr) {
+		return;
+	}
+
+	if (size == 0 || size > order_pool::max_pooled_size) {
+		--order_pool::large_order_statistics.live_blocks;
+		::operator delete(ptr);
+		return;
+	}
+
+	const size_t size_class = order_pool::get_size_class(size);
+	--order_pool::size_class_statistics[size_class].live_blocks;
+
+	free_block *block = new (ptr) free_block;
+	block->next = order_pool::free_lists[size_class];
+	order_pool::free_lists[size_class] = block;
+}
+
+order_pool::statistics order_pool::get_total_statistics()
+{
+	statistics total_statistics = order_pool::large_order_statistics;
+
+	for (const statistics &class_statistics : order_pool::size_class_statistics) {
+		total_statistics.allocations += class_statistics.allocations;
+		total_statistics.reused_allocations += class_statistics.reused_allocations;
+		total_statistics.live_blocks += class_statistics.live_blocks;
+		total_statistics.reserved_blocks += class_statistics.reserved_blocks;
+	}
+
+	return total_statistics;
+}
+
+size_t order_pool::get_reserved_bytes()
+{
+	size_t reserved_bytes = 0;
+
+	for (size_t i = 0; i < order_pool::size_class_count; ++i) {
+		reserved_bytes += order_pool::size_class_statistics[i].reserved_blocks * order_pool::get_block_size(i);
+	}
+
+	return reserved_bytes;
+}
+
+/**
+**	@brief	Allocate a chunk of blocks for a size class, and add them to its free list
+*/
+void order_pool::allocate_chunk(const size_t size_class)
+{
+	const size_t block_size = order_pool::get_block_size(size_class);
+	unsigned char *chunk = static_cast<unsigned char *>(::operator new(block_size * order_pool::blocks_per_chunk));
+
+	//add the blocks in reverse order, so that they are handed out in address order
+	for (size_t i = order_pool::blocks_per_chunk; i > 0; --i) {
+		free_block *block = new (chunk + (i - 1) * block_size) free_block;
+		block->next = order_pool::free_lists[size_class];
+		order_pool::free_lists[size_class] = block;
+	}
+
+	order_pool::size_class_statistics[size_class].reserved_blocks += order_pool::blocks_per_chunk;
+}
+
+}
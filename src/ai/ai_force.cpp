@@ -867,6 +867,41 @@ bool AiForce::IsHeroOnlyForce() const
 	return true;
 }
 
+/**
+**  Calculate the paths of units which have just been sent to a goal together.
+**
+**  The paths are calculated as a batch, in parallel, and each unit follows its path
+**  when it starts moving, unless its goal has changed in the meantime.
+**
+**  @param units  The units which have been given a move or attack order.
+*/
+static void AiCalculateSentUnitPaths(const std::vector<CUnit *> &units)
+{
+	std::vector<PathFinderData *> batch;
+
+	for (CUnit *unit : units) {
+		if (unit->pathFinderData == nullptr || !unit->IsAliveOnMap() || !unit->CanMove()) {
+			continue;
+		}
+
+		//the order which has just been given is the last one, since the current order is only removed in the action loop
+		COrder *order = unit->Orders.back().get();
+		if (order->Finished || (order->Action != UnitAction::Move && order->Action != UnitAction::Attack)) {
+			continue;
+		}
+
+		PathFinderData &data = *unit->pathFinderData;
+		order->UpdatePathFinderData(data.input);
+		if (data.output.Length <= 0 || data.input.IsRecalculateNeeded()) {
+			batch.push_back(&data);
+		}
+	}
+
+	if (!batch.empty()) {
+		NewPathBatch(batch);
+	}
+}
+
 //Wyrmgus start
 //void AiForce::Attack(const Vec2i &pos)
 void AiForce::Attack(const Vec2i &pos, int z)
@@ -1032,6 +1067,8 @@ void AiForce::Attack(const Vec2i &pos, int z)
 		}
 	}
 
+	std::vector<CUnit *> sent_units;
+
 	for (size_t i = 0; i != this->get_units().size(); ++i) {
 		CUnit *unit = *this->get_units()[i];
 		
@@ -1056,6 +1093,7 @@ void AiForce::Attack(const Vec2i &pos, int z)
 //				CommandAttack(*unit, this->GoalPos,  nullptr, FlushCommands);
 				CommandAttack(*unit, this->GoalPos,  nullptr, FlushCommands, this->GoalMapLayer);
 				//Wyrmgus end
+				sent_units.push_back(unit);
 			} else {
 				if (leader) {
 					CommandDefend(*unit, *leader, FlushCommands);
@@ -1064,10 +1102,13 @@ void AiForce::Attack(const Vec2i &pos, int z)
 //					CommandMove(*unit, this->GoalPos, FlushCommands);
 					CommandMove(*unit, this->GoalPos, FlushCommands, this->GoalMapLayer);
 					//Wyrmgus end
+					sent_units.push_back(unit);
 				}
 			}
 		}
 	}
+
+	AiCalculateSentUnitPaths(sent_units);
 }
 
 void AiForce::ReturnToHome()
@@ -1747,6 +1788,7 @@ void AiForce::Update()
 			}
 			
 			State = AiForceAttackingState::Attacking;
+			std::vector<CUnit *> sent_units;
 			for (size_t i = 0; i != this->get_units().size(); ++i) {
 				CUnit *ai_unit = *this->get_units()[i];
 				
@@ -1768,6 +1810,7 @@ void AiForce::Update()
 
 				if (ai_unit->IsAgressive()) {
 					CommandAttack(*ai_unit, this->GoalPos, nullptr, FlushCommands, this->GoalMapLayer);
+					sent_units.push_back(ai_unit);
 				} else {
 					if (leader) {
 						CommandDefend(*ai_unit, *leader, FlushCommands);
@@ -1776,9 +1819,11 @@ void AiForce::Update()
 //						CommandMove(*ai_unit, this->GoalPos, FlushCommands);
 						CommandMove(*ai_unit, this->GoalPos, FlushCommands, this->GoalMapLayer);
 						//Wyrmgus end
+						sent_units.push_back(ai_unit);
 					}
 				}
 			}
+			AiCalculateSentUnitPaths(sent_units);
 		}
 	}
 
@@ -2118,6 +2163,7 @@ void AiForceManager::Update()
 							}
 						}
 					}
+					AiCalculateSentUnitPaths(idleUnits);
 				}
 			}
 		} else if (force.Attacking) {
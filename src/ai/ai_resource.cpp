@@ -2436,7 +2436,9 @@ void AiCheckDockConstruction()
 		return;
 	}
 
-	const wyrmgus::unit_type *dock_type = AiPlayer->Player->get_faction()->get_class_unit_type(wyrmgus::unit_class::get("dock"));
+	static const wyrmgus::data_handle<wyrmgus::unit_class> dock_class = wyrmgus::unit_class::get_handle("dock");
+
+	const wyrmgus::unit_type *dock_type = AiPlayer->Player->get_faction()->get_class_unit_type(dock_class.get());
 	if (dock_type == nullptr) {
 		return;
 	}
@@ -2619,9 +2621,12 @@ void AiCheckBuildings()
 	}
 }
 
+/// Handle to the minecart unit class, which the minecart checks need each time they are run
+static const wyrmgus::data_handle<wyrmgus::unit_class> minecart_class = wyrmgus::unit_class::get_handle("minecart");
+
 static void AiCheckMinecartConstruction()
 {
-	const wyrmgus::unit_type *minecart_type = AiPlayer->Player->get_faction()->get_class_unit_type(wyrmgus::unit_class::get("minecart"));
+	const wyrmgus::unit_type *minecart_type = AiPlayer->Player->get_faction()->get_class_unit_type(minecart_class.get());
 	if (minecart_type == nullptr) {
 		return;
 	}
@@ -2692,7 +2697,7 @@ static void AiCheckMinecartConstruction()
 
 static void AiCheckMinecartSalvaging()
 {
-	const wyrmgus::unit_type *minecart_type = AiPlayer->Player->get_faction()->get_class_unit_type(wyrmgus::unit_class::get("minecart"));
+	const wyrmgus::unit_type *minecart_type = AiPlayer->Player->get_faction()->get_class_unit_type(minecart_class.get());
 	if (minecart_type == nullptr) {
 		return;
 	}
@@ -54,12 +54,14 @@
 
 #include "actions.h"
 #include "config.h"
+#include "database/database.h"
 #include "iolib.h"
 #include "player.h"
 #include "script.h"
 #include "spell/spell.h"
 #include "unit/unit.h"
 #include "unit/unit_type.h"
+#include "util/string_util.h"
 
 struct LabelsStruct {
 	CAnimation *Anim;
@@ -91,197 +93,289 @@ int UnitShowAnimation(CUnit &unit, const CAnimation *anim)
 }
 
 /**
-**  Parse player number in animation frame
+**  Get the variable field with the given name.
 **
-**  @param unit      Unit of the animation.
-**  @param parseint  Integer to parse.
+**  @param name  Name of the field, e.g. "Value".
 **
-**  @return  The parsed value.
+**  @return  The variable field, or None if the name isn't that of a field.
 */
-
-static int ParseAnimPlayer(const CUnit &unit, char *parseint)
+CAnimationOperand::VariableField CAnimationOperand::GetVariableField(const std::string &name)
 {
-	if (!strcmp(parseint, "this")) {
-		return unit.Player->Index;
+	if (name == "Value") {
+		return VariableField::Value;
+	} else if (name == "Max") {
+		return VariableField::Max;
+	} else if (name == "Increase") {
+		return VariableField::Increase;
+	} else if (name == "Enable") {
+		return VariableField::Enable;
+	} else if (name == "Percent") {
+		return VariableField::Percent;
 	}
-	return ParseAnimInt(unit, parseint);
+
+	return VariableField::None;
 }
 
+/**
+**  Resolve the operand from its text form.
+*/
+void CAnimationOperand::Resolve()
+{
+	this->Type = OperandType::Unresolved;
+	this->OfGoal = false;
+	this->Resolve(this->Str);
+}
 
 /**
-**  Parse integer in animation frame.
-**
-**  @param unit      Unit of the animation.
-**  @param parseint  Integer to parse.
+**  Resolve the operand from a text form.
 **
-**  @return  The parsed value.
+**  @param str  Text to resolve, in the format which used to be parsed by ParseAnimInt each time the operand was evaluated.
 */
-
-int ParseAnimInt(const CUnit &unit, const char *parseint)
+void CAnimationOperand::Resolve(const std::string &str)
 {
-	char s[100];
-	const CUnit *goal = &unit;
-
-	if (!strlen(parseint)) {
-		return 0;
+	if (str.empty()) {
+		this->Type = OperandType::Constant;
+		this->Value = 0;
+		return;
 	}
 
-	strcpy(s, parseint);
-	char *cur = &s[2];
-	if (s[0] == 'v' || s[0] == 't') { //unit variable detected
-		if (s[0] == 't') {
-			if (unit.CurrentOrder()->has_goal()) {
-				goal = unit.CurrentOrder()->get_goal();
-			} else {
-				return 0;
+	const std::string cur = str.size() > 2 ? str.substr(2) : std::string();
+
+	switch (str[0]) {
+		case 'v':
+		case 't': { //unit variable detected
+			this->OfGoal = str[0] == 't';
+
+			const size_t separator_pos = cur.find('.');
+			if (separator_pos == std::string::npos) {
+				throw std::runtime_error("Need also specify the variable \"" + cur + "\" tag.");
 			}
-		}
-		char *next = strchr(cur, '.');
-		if (next == nullptr) {
-			throw std::runtime_error("Need also specify the variable \"" + std::string(cur) + "\" tag.");
-		} else {
-			*next = '\0';
-		}
-		const int index = UnitTypeVar.VariableNameLookup[cur];// User variables
-		if (index == -1) {
-			if (!strcmp(cur, "ResourcesHeld")) {
-				return goal->ResourcesHeld;
-			} else if (!strcmp(cur, "ResourceActive")) {
-				return goal->Resource.Active;
-			} else if (!strcmp(cur, "InsideCount")) {
-				return goal->InsideCount;
-			} else if (!strcmp(cur, "_Distance")) {
-				return unit.MapDistanceTo(*goal);
+
+			const std::string variable_name = cur.substr(0, separator_pos);
+			const std::string field_name = cur.substr(separator_pos + 1);
+
+			this->Index = UnitTypeVar.VariableNameLookup[variable_name.c_str()];// User variables
+			if (this->Index == -1) {
+				if (variable_name == "ResourcesHeld") {
+					this->Type = OperandType::ResourcesHeld;
+				} else if (variable_name == "ResourceActive") {
+					this->Type = OperandType::ResourceActive;
+				} else if (variable_name == "InsideCount") {
+					this->Type = OperandType::InsideCount;
+				} else if (variable_name == "_Distance") {
+					this->Type = OperandType::Distance;
+				} else {
+					throw std::runtime_error("Bad variable name \"" + variable_name + "\".");
+				}
+				return;
 			}
-			throw std::runtime_error("Bad variable name \"" + std::string(cur) + "\".");
-		}
-		if (!strcmp(next + 1, "Value")) {
-			//Wyrmgus start
-//			return goal->Variable[index].Value;
-			return goal->GetModifiedVariable(index, VariableAttribute::Value);
-			//Wyrmgus end
-		} else if (!strcmp(next + 1, "Max")) {
-			//Wyrmgus start
-//			return goal->Variable[index].Max;
-			return goal->GetModifiedVariable(index, VariableAttribute::Max);
-			//Wyrmgus end
-		} else if (!strcmp(next + 1, "Increase")) {
-			//Wyrmgus start
-//			return goal->Variable[index].Increase;
-			return goal->GetModifiedVariable(index, VariableAttribute::Increase);
-			//Wyrmgus end
-		} else if (!strcmp(next + 1, "Enable")) {
-			return goal->Variable[index].Enable;
-		} else if (!strcmp(next + 1, "Percent")) {
-			//Wyrmgus start
-//			return goal->Variable[index].Value * 100 / goal->Variable[index].Max;
-			return goal->GetModifiedVariable(index, VariableAttribute::Value) * 100 / goal->GetModifiedVariable(index, VariableAttribute::Max);
-			//Wyrmgus end
+
+			this->Type = OperandType::Variable;
+			this->Field = CAnimationOperand::GetVariableField(field_name);
+			return;
 		}
-		return 0;
-	} else if (s[0] == 'b' || s[0] == 'g') { //unit bool flag detected
-		if (s[0] == 'g') {
-			if (unit.CurrentOrder()->has_goal()) {
-				goal = unit.CurrentOrder()->get_goal();
+		case 'b':
+		case 'g': //unit bool flag detected
+			this->OfGoal = str[0] == 'g';
+			this->Index = UnitTypeVar.BoolFlagNameLookup[cur.c_str()];// User bool flags
+			if (this->Index == -1) {
+				throw std::runtime_error("Bad bool-flag name \"" + cur + "\".");
+			}
+			this->Type = OperandType::BoolFlag;
+			return;
+		case 's': //spell type detected
+			this->Type = OperandType::CurrentSpell;
+			this->Spell = wyrmgus::spell::try_get(cur);
+			return;
+		case 'S': // check if autocast for this spell available
+			this->Type = OperandType::AutocastSpell;
+			this->Spell = wyrmgus::spell::get(cur);
+			return;
+		case 'r': { //random value
+			this->Type = OperandType::Random;
+			const size_t separator_pos = cur.find('.');
+			if (separator_pos == std::string::npos) {
+				this->Value = 0;
+				this->MaxValue = atoi(cur.c_str());
 			} else {
-				return 0;
+				this->Value = atoi(cur.substr(0, separator_pos).c_str());
+				this->MaxValue = atoi(cur.substr(separator_pos + 1).c_str());
 			}
+			return;
 		}
-		const int index = UnitTypeVar.BoolFlagNameLookup[cur];// User bool flags
-		if (index == -1) {
-			throw std::runtime_error("Bad bool-flag name \"" + std::string(cur) + "\".");
-		}
-		return goal->Type->BoolFlag[index].value;
-	} else if (s[0] == 's') { //spell type detected
-		Assert(goal->CurrentAction() == UnitAction::SpellCast);
-		const COrder_SpellCast &order = *static_cast<COrder_SpellCast *>(goal->CurrentOrder());
-		const wyrmgus::spell &spell = order.GetSpell();
-		if (!strcmp(spell.get_identifier().c_str(), cur)) {
-			return 1;
-		}
-		return 0;
-	} else if (s[0] == 'S') { // check if autocast for this spell available
-		const wyrmgus::spell *spell = wyrmgus::spell::get(cur);
-		if (unit.is_autocast_spell(spell)) {
-			return 1;
-		}
-		return 0;
-	} else if (s[0] == 'r') { //random value
-		char *next = strchr(cur, '.');
-		if (next == nullptr) {
-			return SyncRand(atoi(cur) + 1);
+		case 'l': //player number
+			if (cur == "this") {
+				this->Type = OperandType::PlayerIndex;
+				return;
+			}
+			this->Resolve(cur);
+			return;
+		default:
+			break;
+	}
+
+	// Check if we trying to parse a number
+	if (!isdigit(str[0]) && str[0] != '-') {
+		throw std::runtime_error("Invalid animation operand: \"" + str + "\".");
+	}
+	this->Type = OperandType::Constant;
+	this->Value = atoi(str.c_str());
+}
+
+/**
+**  Evaluate the operand for a unit.
+**
+**  @param unit  Unit of the animation.
+**
+**  @return  The value of the operand.
+*/
+int CAnimationOperand::Evaluate(const CUnit &unit) const
+{
+	const CUnit *goal = &unit;
+
+	if (this->OfGoal) {
+		if (unit.CurrentOrder()->has_goal()) {
+			goal = unit.CurrentOrder()->get_goal();
 		} else {
-			*next = '\0';
-			const int min = atoi(cur);
-			return min + SyncRand(atoi(next + 1) - min + 1);
+			return 0;
 		}
-	} else if (s[0] == 'l') { //player number
-		return ParseAnimPlayer(unit, cur);
+	}
 
+	switch (this->Type) {
+		case OperandType::Constant:
+			return this->Value;
+		case OperandType::Variable:
+			switch (this->Field) {
+				case VariableField::Value:
+					return goal->GetModifiedVariable(this->Index, VariableAttribute::Value);
+				case VariableField::Max:
+					return goal->GetModifiedVariable(this->Index, VariableAttribute::Max);
+				case VariableField::Increase:
+					return goal->GetModifiedVariable(this->Index, VariableAttribute::Increase);
+				case VariableField::Enable:
+					return goal->Variable[this->Index].Enable;
+				case VariableField::Percent:
+					return goal->GetModifiedVariable(this->Index, VariableAttribute::Value) * 100 / goal->GetModifiedVariable(this->Index, VariableAttribute::Max);
+				default:
+					return 0;
+			}
+		case OperandType::ResourcesHeld:
+			return goal->ResourcesHeld;
+		case OperandType::ResourceActive:
+			return goal->Resource.Active;
+		case OperandType::InsideCount:
+			return goal->InsideCount;
+		case OperandType::Distance:
+			return unit.MapDistanceTo(*goal);
+		case OperandType::BoolFlag:
+			return goal->Type->BoolFlag[this->Index].value;
+		case OperandType::CurrentSpell: {
+			Assert(goal->CurrentAction() == UnitAction::SpellCast);
+			const COrder_SpellCast &order = *static_cast<COrder_SpellCast *>(goal->CurrentOrder());
+			return &order.GetSpell() == this->Spell ? 1 : 0;
+		}
+		case OperandType::AutocastSpell:
+			return unit.is_autocast_spell(this->Spell) ? 1 : 0;
+		case OperandType::Random:
+			return this->Value + SyncRand(this->MaxValue - this->Value + 1);
+		case OperandType::PlayerIndex:
+			return unit.Player->Index;
+		default:
+			throw std::runtime_error("The animation operand \"" + this->Str + "\" has not been resolved.");
 	}
-	// Check if we trying to parse a number
-	Assert(isdigit(s[0]) || s[0] == '-');
-	return atoi(parseint);
+}
+
+/**
+**  Parse integer in animation frame.
+**
+**  Animations resolve their operands when initialized, this is for parsing and evaluating one at once.
+**
+**  @param unit      Unit of the animation.
+**  @param parseint  Integer to parse.
+**
+**  @return  The parsed value.
+*/
+int ParseAnimInt(const CUnit &unit, const char *parseint)
+{
+	CAnimationOperand operand(parseint);
+	operand.Resolve();
+	return operand.Evaluate(unit);
 }
 
 /**
 **  Parse flags list in animation frame.
 **
-**  @param unit       Unit of the animation.
+**  @param type       Type of the animation.
 **  @param parseflag  Flag list to parse.
 **
 **  @return The parsed value.
 */
-int ParseAnimFlags(const CUnit &unit, const char *parseflag)
+int ParseAnimFlags(const AnimationType type, const std::string &parseflag)
 {
-	char s[100];
 	int flags = 0;
 
-	strcpy(s, parseflag);
-	char *cur = s;
-	char *next = s;
-	while (next && *next) {
-		next = strchr(cur, '.');
-		if (next) {
-			*next = '\0';
-			++next;
+	if (parseflag.empty()) {
+		return flags;
+	}
+
+	for (const std::string &cur : string::split(parseflag, '.')) {
+		if (cur.empty()) {
+			continue;
 		}
-		if (unit.Anim.Anim->Type == AnimationSpawnMissile) {
-			if (!strcmp(cur, "none")) {
+
+		if (type == AnimationSpawnMissile) {
+			if (cur == "none") {
 				flags = SM_None;
 				return flags;
-			} else if (!strcmp(cur, "damage")) {
+			} else if (cur == "damage") {
 				flags |= SM_Damage;
-			} else if (!strcmp(cur, "totarget")) {
+			} else if (cur == "totarget") {
 				flags |= SM_ToTarget;
-			} else if (!strcmp(cur, "pixel")) {
+			} else if (cur == "pixel") {
 				flags |= SM_Pixel;
-			} else if (!strcmp(cur, "reltarget")) {
+			} else if (cur == "reltarget") {
 				flags |= SM_RelTarget;
-			} else if (!strcmp(cur, "ranged")) {
+			} else if (cur == "ranged") {
 				flags |= SM_Ranged;
-			}  else if (!strcmp(cur, "setdirection")) {
+			}  else if (cur == "setdirection") {
 				flags |= SM_SetDirection;
 			} else {
-				throw std::runtime_error("Unknown animation flag: \"" + std::string(cur) + "\".");
+				throw std::runtime_error("Unknown animation flag: \"" + cur + "\".");
 			}
-		} else if (unit.Anim.Anim->Type == AnimationSpawnUnit) {
-			if (!strcmp(cur, "none")) {
+		} else if (type == AnimationSpawnUnit) {
+			if (cur == "none") {
 				flags = SU_None;
 				return flags;
-			} else if (!strcmp(cur, "summoned")) {
+			} else if (cur == "summoned") {
 				flags |= SU_Summoned;
-			} else if (!strcmp(cur, "jointoai")) {
+			} else if (cur == "jointoai") {
 				flags |= SU_JoinToAIForce;
 			} else {
-				throw std::runtime_error("Unknown animation flag: \"" + std::string(cur) + "\".");
+				throw std::runtime_error("Unknown animation flag: \"" + cur + "\".");
 			}
 		}
-		cur = next;
 	}
 	return flags;
 }
 
+/**
+**  Initialize the animations of a script, resolving their operands.
+**
+**  @param first_anim  First animation of the script.
+*/
+static void InitializeAnimations(CAnimation *first_anim)
+{
+	CAnimation *anim = first_anim;
+	while (anim != nullptr) {
+		anim->initialize();
+
+		anim = anim->get_next();
+		if (anim == first_anim) {
+			break;
+		}
+	}
+}
+
 
 /**
 **  Show unit animation.
@@ -577,6 +671,16 @@ void animation_set::process_sml_scope(const sml_data &scope)
 
 void animation_set::initialize()
 {
+	for (CAnimation *first_anim : {this->Start.get(), this->Still.get(), this->Attack.get(), this->RangedAttack.get(), this->Build.get(), this->Move.get(), this->Repair.get(), this->Research.get(), this->SpellCast.get(), this->Train.get(), this->Upgrade.get()}) {
+		InitializeAnimations(first_anim);
+	}
+	for (int i = 0; i != ANIMATIONS_DEATHTYPES + 1; ++i) {
+		InitializeAnimations(this->Death[i].get());
+	}
+	for (int i = 0; i != MaxCosts; ++i) {
+		InitializeAnimations(this->Harvest[i].get());
+	}
+
 	// Must add to array in a fixed order for save games
 	animation_set::AddAnimationToArray(this->Start.get());
 	animation_set::AddAnimationToArray(this->Still.get());
@@ -737,6 +841,12 @@ static std::unique_ptr<CAnimation> ParseAnimation(lua_State *l, int idx)
 	}
 	prev->set_next(firstAnim.get());
 	FixLabels(l);
+
+	//animations defined after the database has been initialized have their operands resolved right away
+	if (wyrmgus::database::get()->is_initialized()) {
+		InitializeAnimations(firstAnim.get());
+	}
+
 	return firstAnim;
 }
 
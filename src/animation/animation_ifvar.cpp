@@ -71,8 +71,8 @@ void CAnimation_IfVar::Action(CUnit &unit, int &/*move*/, int /*scale*/) const
 {
 	Assert(unit.Anim.Anim == this);
 
-	const int lop = ParseAnimInt(unit, this->leftVar.c_str());
-	const int rop = ParseAnimInt(unit, this->rightVar.c_str());
+	const int lop = this->leftVar.Evaluate(unit);
+	const int rop = this->rightVar.Evaluate(unit);
 	const bool cond = this->binOpFunc(lop, rop);
 
 	if (cond) {
@@ -87,7 +87,7 @@ void CAnimation_IfVar::Init(const char *s, lua_State *)
 {
 	const std::vector<std::string> str_list = string::split(s, ' ');
 
-	this->leftVar = str_list.at(0);
+	this->leftVar = CAnimationOperand(str_list.at(0));
 
 	const std::string op = str_list.at(1);
 
@@ -129,9 +129,15 @@ void CAnimation_IfVar::Init(const char *s, lua_State *)
 		}
 	}
 
-	this->rightVar = str_list.at(2);
+	this->rightVar = CAnimationOperand(str_list.at(2));
 
 	const std::string label = str_list.at(3);
 
 	FindLabelLater(&this->gotoLabel, label);
 }
+
+void CAnimation_IfVar::initialize()
+{
+	this->leftVar.Resolve();
+	this->rightVar.Resolve();
+}
@@ -44,9 +44,7 @@
 {
 	Assert(unit.Anim.Anim == this);
 
-	char arg1[128];
 	CUnit *goal = &unit;
-	strcpy(arg1, this->varStr.c_str());
 
 	if (this->unitSlotStr.empty() == false) {
 		switch (this->unitSlotStr[0]) {
@@ -65,38 +63,37 @@
 		return;
 	}
 
-	char *next = strchr(arg1, '.');
-	if (next == nullptr) {
-		// Special case for non-unit_variable variables
-		if (!strcmp(arg1, "DamageType")) {
-			int death = ExtraDeathIndex(this->valueStr.c_str());
-			if (death == ANIMATIONS_DEATHTYPES) {
-				throw std::runtime_error("Incorrect death type: " + this->valueStr + ".");
-			}
-			goal->Type->DamageType = this->valueStr;
-			return;
+	// Special case for non-unit_variable variables
+	if (this->damageType) {
+		int death = ExtraDeathIndex(this->valueStr.c_str());
+		if (death == ANIMATIONS_DEATHTYPES) {
+			throw std::runtime_error("Incorrect death type: " + this->valueStr + ".");
 		}
-		throw std::runtime_error("Need also specify the variable \"" + std::string(arg1) + "\" tag.");
-	} else {
-		*next = '\0';
-	}
-	const int index = UnitTypeVar.VariableNameLookup[arg1];// User variables
-	if (index == -1) {
-		throw std::runtime_error("Bad variable name \"" + std::string(arg1) + "\".");
+		goal->Type->DamageType = this->valueStr;
+		return;
 	}
 
-	const int rop = ParseAnimInt(unit, this->valueStr.c_str());
+	const int index = this->varIndex;
+	const int rop = this->valueOperand.Evaluate(unit);
 	int value = 0;
-	if (!strcmp(next + 1, "Value")) {
-		value = goal->Variable[index].Value;
-	} else if (!strcmp(next + 1, "Max")) {
-		value = goal->Variable[index].Max;
-	} else if (!strcmp(next + 1, "Increase")) {
-		value = goal->Variable[index].Increase;
-	} else if (!strcmp(next + 1, "Enable")) {
-		value = goal->Variable[index].Enable;
-	} else if (!strcmp(next + 1, "Percent")) {
-		value = goal->Variable[index].Value * 100 / goal->Variable[index].Max;
+	switch (this->varField) {
+		case CAnimationOperand::VariableField::Value:
+			value = goal->Variable[index].Value;
+			break;
+		case CAnimationOperand::VariableField::Max:
+			value = goal->Variable[index].Max;
+			break;
+		case CAnimationOperand::VariableField::Increase:
+			value = goal->Variable[index].Increase;
+			break;
+		case CAnimationOperand::VariableField::Enable:
+			value = goal->Variable[index].Enable;
+			break;
+		case CAnimationOperand::VariableField::Percent:
+			value = goal->Variable[index].Value * 100 / goal->Variable[index].Max;
+			break;
+		default:
+			break;
 	}
 	switch (this->mod) {
 		case modAdd:
@@ -135,16 +132,24 @@
 		default:
 			value = rop;
 	}
-	if (!strcmp(next + 1, "Value")) {
-		goal->Variable[index].Value = value;
-	} else if (!strcmp(next + 1, "Max")) {
-		goal->Variable[index].Max = value;
-	} else if (!strcmp(next + 1, "Increase")) {
-		goal->Variable[index].Increase = value;
-	} else if (!strcmp(next + 1, "Enable")) {
-		goal->Variable[index].Enable = value;
-	} else if (!strcmp(next + 1, "Percent")) {
-		goal->Variable[index].Value = goal->Variable[index].Max * value / 100;
+	switch (this->varField) {
+		case CAnimationOperand::VariableField::Value:
+			goal->Variable[index].Value = value;
+			break;
+		case CAnimationOperand::VariableField::Max:
+			goal->Variable[index].Max = value;
+			break;
+		case CAnimationOperand::VariableField::Increase:
+			goal->Variable[index].Increase = value;
+			break;
+		case CAnimationOperand::VariableField::Enable:
+			goal->Variable[index].Enable = value;
+			break;
+		case CAnimationOperand::VariableField::Percent:
+			goal->Variable[index].Value = goal->Variable[index].Max * value / 100;
+			break;
+		default:
+			break;
 	}
 	//Wyrmgus start
 //	clamp(&goal->Variable[index].Value, 0, goal->Variable[index].Max);
@@ -213,3 +218,29 @@
 	end = std::min(len, str.find(' ', begin));
 	this->unitSlotStr.assign(str, begin, end - begin);
 }
+
+/**
+**  Resolve the variable to set and the value operand.
+*/
+void CAnimation_SetVar::initialize()
+{
+	const size_t separator_pos = this->varStr.find('.');
+	if (separator_pos == std::string::npos) {
+		// Special case for non-unit_variable variables
+		if (this->varStr == "DamageType") {
+			this->damageType = true;
+			return;
+		}
+		throw std::runtime_error("Need also specify the variable \"" + this->varStr + "\" tag.");
+	}
+
+	const std::string variable_name = this->varStr.substr(0, separator_pos);
+	this->varIndex = UnitTypeVar.VariableNameLookup[variable_name.c_str()];// User variables
+	if (this->varIndex == -1) {
+		throw std::runtime_error("Bad variable name \"" + variable_name + "\".");
+	}
+	this->varField = CAnimationOperand::GetVariableField(this->varStr.substr(separator_pos + 1));
+
+	this->valueOperand = CAnimationOperand(this->valueStr);
+	this->valueOperand.Resolve();
+}
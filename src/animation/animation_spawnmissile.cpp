@@ -46,18 +46,18 @@ void CAnimation_SpawnMissile::Action(CUnit &unit, int &/*move*/, int /*scale*/)
 {
 	Assert(unit.Anim.Anim == this);
 
-	const int startx = ParseAnimInt(unit, this->startXStr.c_str());
-	const int starty = ParseAnimInt(unit, this->startYStr.c_str());
-	const int destx = ParseAnimInt(unit, this->destXStr.c_str());
-	const int desty = ParseAnimInt(unit, this->destYStr.c_str());
-	const SpawnMissile_Flags flags = (SpawnMissile_Flags)(ParseAnimFlags(unit, this->flagsStr.c_str()));
-	const int offsetnum = ParseAnimInt(unit, this->offsetNumStr.c_str());
+	const int startx = this->startXOperand.Evaluate(unit);
+	const int starty = this->startYOperand.Evaluate(unit);
+	const int destx = this->destXOperand.Evaluate(unit);
+	const int desty = this->destYOperand.Evaluate(unit);
+	const SpawnMissile_Flags flags = (SpawnMissile_Flags)(this->flags);
+	const int offsetnum = this->offsetNumOperand.Evaluate(unit);
 	const CUnit *goal = flags & SM_RelTarget ? unit.CurrentOrder()->get_goal() : &unit;
 	const int dir = ((goal->Direction + NextDirection / 2) & 0xFF) / NextDirection;
 	const PixelPos moff = goal->Type->MissileOffsets[dir][!offsetnum ? 0 : offsetnum - 1];
 	PixelPos start;
 	PixelPos dest;
-	wyrmgus::missile_type *mtype = wyrmgus::missile_type::try_get(this->missileTypeStr);
+	wyrmgus::missile_type *mtype = this->missileType != nullptr ? this->missileType : wyrmgus::missile_type::try_get(this->missileTypeStr);
 	if (mtype == nullptr) {
 		return;
 	}
@@ -152,19 +152,19 @@ void CAnimation_SpawnMissile::Action(CUnit &unit, int &/*move*/, int /*scale*/)
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->startXStr.assign(str, begin, end - begin);
+	this->startXOperand = CAnimationOperand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->startYStr.assign(str, begin, end - begin);
+	this->startYOperand = CAnimationOperand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->destXStr.assign(str, begin, end - begin);
+	this->destXOperand = CAnimationOperand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->destYStr.assign(str, begin, end - begin);
+	this->destYOperand = CAnimationOperand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
@@ -172,5 +172,16 @@ void CAnimation_SpawnMissile::Action(CUnit &unit, int &/*move*/, int /*scale*/)
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->offsetNumStr.assign(str, begin, end - begin);
+	this->offsetNumOperand = CAnimationOperand(str.substr(begin, end - begin));
+}
+
+void CAnimation_SpawnMissile::initialize()
+{
+	this->missileType = wyrmgus::missile_type::try_get(this->missileTypeStr);
+	this->startXOperand.Resolve();
+	this->startYOperand.Resolve();
+	this->destXOperand.Resolve();
+	this->destYOperand.Resolve();
+	this->flags = ParseAnimFlags(this->Type, this->flagsStr);
+	this->offsetNumOperand.Resolve();
 }
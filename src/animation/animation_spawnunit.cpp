@@ -41,15 +41,15 @@ void CAnimation_SpawnUnit::Action(CUnit &unit, int &/*move*/, int /*scale*/) con
 {
 	Assert(unit.Anim.Anim == this);
 
-	const int offX = ParseAnimInt(unit, this->offXStr.c_str());
-	const int offY = ParseAnimInt(unit, this->offYStr.c_str());
-	const int range = ParseAnimInt(unit, this->rangeStr.c_str());
-	const int playerId = ParseAnimInt(unit, this->playerStr.c_str());
-	const SpawnUnit_Flags flags = (SpawnUnit_Flags)(ParseAnimFlags(unit, this->flagsStr.c_str()));
+	const int offX = this->offXOperand.Evaluate(unit);
+	const int offY = this->offYOperand.Evaluate(unit);
+	const int range = this->rangeOperand.Evaluate(unit);
+	const int playerId = this->playerOperand.Evaluate(unit);
+	const SpawnUnit_Flags flags = (SpawnUnit_Flags)(this->flags);
 
 	CPlayer &player = *CPlayer::Players[playerId];
 	const Vec2i pos(unit.tilePos.x + offX, unit.tilePos.y + offY);
-	wyrmgus::unit_type *type = wyrmgus::unit_type::get(this->unitTypeStr.c_str());
+	wyrmgus::unit_type *type = this->unitType != nullptr ? this->unitType : wyrmgus::unit_type::get(this->unitTypeStr);
 	Vec2i resPos;
 	DebugPrint("Creating a %s\n" _C_ type->get_name().c_str());
 	FindNearestDrop(*type, pos, resPos, LookingW, unit.MapLayer->ID);
@@ -90,19 +90,19 @@ void CAnimation_SpawnUnit::Init(const char *s, lua_State *)
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->offXStr.assign(str, begin, end - begin);
+	this->offXOperand = CAnimationOperand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->offYStr.assign(str, begin, end - begin);
+	this->offYOperand = CAnimationOperand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->rangeStr.assign(str, begin, end - begin);
+	this->rangeOperand = CAnimationOperand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
-	this->playerStr.assign(str, begin, end - begin);
+	this->playerOperand = CAnimationOperand(str.substr(begin, end - begin));
 
 	begin = std::min(len, str.find_first_not_of(' ', end));
 	end = std::min(len, str.find(' ', begin));
@@ -110,3 +110,13 @@ void CAnimation_SpawnUnit::Init(const char *s, lua_State *)
 		this->flagsStr.assign(str, begin, end - begin);
 	}
 }
+
+void CAnimation_SpawnUnit::initialize()
+{
+	this->unitType = wyrmgus::unit_type::try_get(this->unitTypeStr);
+	this->offXOperand.Resolve();
+	this->offYOperand.Resolve();
+	this->rangeOperand.Resolve();
+	this->playerOperand.Resolve();
+	this->flags = ParseAnimFlags(this->Type, this->flagsStr);
+}
@@ -0,0 +1,82 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "util/interned_string.h"
+
+namespace wyrmgus {
+
+//a handle to a data entry, which resolves its identifier only once, so that code looking up the same entry often doesn't need to go through the identifier lookup each time; it is resolved again if the entries of the data type have been removed or cleared since
+template <typename T>
+class data_handle final
+{
+public:
+	explicit data_handle(const std::string_view &identifier) : identifier(identifier)
+	{
+	}
+
+	explicit data_handle(const interned_string &identifier) : identifier(identifier)
+	{
+	}
+
+	const interned_string &get_identifier() const
+	{
+		return this->identifier;
+	}
+
+	T *get() const
+	{
+		if (this->generation != T::get_generation()) {
+			this->instance = T::get(this->identifier);
+			this->generation = T::get_generation();
+		}
+
+		return this->instance;
+	}
+
+	T *operator ->() const
+	{
+		return this->get();
+	}
+
+	operator T *() const
+	{
+		return this->get();
+	}
+
+private:
+	interned_string identifier;
+	mutable T *instance = nullptr;
+	mutable uint64_t generation = 0; //the generation of the data type's entries for which the instance was resolved
+};
+
+}
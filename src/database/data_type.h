@@ -31,12 +31,15 @@
 
 #pragma once
 
+#include "database/data_handle.h"
 #include "database/data_module_container.h"
 #include "database/data_type_metadata.h"
 #include "database/database.h"
 #include "database/sml_data.h"
 #include "database/sml_operator.h"
+#include "util/interned_string.h"
 #include "util/qunique_ptr.h"
+#include "util/string_hash_map.h"
 
 namespace wyrmgus {
 
@@ -67,23 +70,38 @@ public:
 		return instance;
 	}
 
-	static T *try_get(const std::string &identifier)
+	static T *get(const interned_string &identifier)
 	{
-		if (identifier == "none") {
-			return nullptr;
-		}
+		T *instance = T::try_get(identifier);
 
-		auto find_iterator = data_type::instances_by_identifier.find(identifier);
-		if (find_iterator != data_type::instances_by_identifier.end()) {
-			return find_iterator->second.get();
+		if (instance == nullptr && identifier.str() != "none") {
+			throw std::runtime_error("Invalid " + std::string(T::class_identifier) + " instance: \"" + identifier.str() + "\".");
 		}
 
-		auto alias_find_iterator = data_type::instances_by_alias.find(identifier);
-		if (alias_find_iterator != data_type::instances_by_alias.end()) {
-			return alias_find_iterator->second;
-		}
+		return instance;
+	}
 
-		return nullptr;
+	static T *try_get(const std::string &identifier)
+	{
+		return data_type::try_get(identifier, string_hash_map<T *>::hash_key(identifier));
+	}
+
+	//look up an interned identifier, using its precomputed hash
+	static T *try_get(const interned_string &identifier)
+	{
+		return data_type::try_get(identifier.str(), identifier.get_hash());
+	}
+
+	//get a handle for the instance with the given identifier, which resolves the identifier only once
+	static data_handle<T> get_handle(const std::string &identifier)
+	{
+		return data_handle<T>(identifier);
+	}
+
+	//the generation of the instances, which changes whenever instances are removed, so that handles know when to resolve their identifier again
+	static uint64_t get_generation()
+	{
+		return data_type::generation;
 	}
 
 	static T *get_or_add(const std::string &identifier, const data_module *data_module)
@@ -103,7 +121,8 @@ public:
 
 	static bool exists(const std::string &identifier)
 	{
-		return data_type::instances_by_identifier.contains(identifier) || data_type::instances_by_alias.contains(identifier);
+		const size_t hash = string_hash_map<T *>::hash_key(identifier);
+		return data_type::instances_by_identifier.find(identifier, hash) != nullptr || data_type::instances_by_alias.find(identifier, hash) != nullptr;
 	}
 
 	static T *add(const std::string &identifier, const data_module *data_module)
@@ -116,9 +135,10 @@ public:
 			throw std::runtime_error("Tried to add a " + std::string(T::class_identifier) + " instance with the already-used \"" + identifier + "\" string identifier.");
 		}
 
-		data_type::instances_by_identifier[identifier] = make_qunique<T>(identifier);
+		qunique_ptr<T> &instance_ptr = data_type::instances_by_identifier[identifier];
+		instance_ptr = make_qunique<T>(identifier);
 
-		T *instance = data_type::instances_by_identifier.find(identifier)->second.get();
+		T *instance = instance_ptr.get();
 		data_type::instances.push_back(instance);
 		instance->moveToThread(QApplication::instance()->thread());
 		instance->set_module(data_module);
@@ -156,6 +176,7 @@ public:
 		data_type::instances.erase(std::remove(data_type::instances.begin(), data_type::instances.end(), instance), data_type::instances.end());
 
 		data_type::instances_by_identifier.erase(instance->get_identifier());
+		++data_type::generation;
 	}
 
 	static void remove(const std::string &identifier)
@@ -168,6 +189,7 @@ public:
 		data_type::instances.clear();
 		data_type::instances_by_alias.clear();
 		data_type::instances_by_identifier.clear();
+		++data_type::generation;
 	}
 
 	template <typename function_type>
@@ -294,19 +316,107 @@ public:
 		}
 	}
 
+	//benchmark looking up each identifier and alias of the data type with each lookup method
+	static void benchmark_identifier_lookups(identifier_lookup_benchmark &benchmark)
+	{
+		std::vector<std::string> identifiers;
+		for (const T *instance : T::get_all()) {
+			identifiers.push_back(instance->get_identifier());
+
+			for (const std::string &alias : instance->get_aliases()) {
+				identifiers.push_back(alias);
+			}
+		}
+
+		std::map<std::string, T *> ordered_map;
+		std::vector<interned_string> interned_identifiers;
+		std::vector<data_handle<T>> handles;
+		for (const std::string &identifier : identifiers) {
+			ordered_map[identifier] = T::try_get(identifier);
+			interned_identifiers.emplace_back(identifier);
+			handles.emplace_back(identifier);
+		}
+
+		std::vector<T *> ordered_map_results(identifiers.size());
+		std::vector<T *> string_results(identifiers.size());
+		std::vector<T *> interned_string_results(identifiers.size());
+		std::vector<T *> handle_results(identifiers.size());
+
+		for (size_t round = 0; round < benchmark.rounds; ++round) {
+			const auto start_time = std::chrono::steady_clock::now();
+
+			for (size_t i = 0; i < identifiers.size(); ++i) {
+				ordered_map_results[i] = ordered_map.find(identifiers[i])->second;
+			}
+
+			const auto ordered_map_end_time = std::chrono::steady_clock::now();
+
+			for (size_t i = 0; i < identifiers.size(); ++i) {
+				string_results[i] = T::try_get(identifiers[i]);
+			}
+
+			const auto string_end_time = std::chrono::steady_clock::now();
+
+			for (size_t i = 0; i < interned_identifiers.size(); ++i) {
+				interned_string_results[i] = T::try_get(interned_identifiers[i]);
+			}
+
+			const auto interned_string_end_time = std::chrono::steady_clock::now();
+
+			for (size_t i = 0; i < handles.size(); ++i) {
+				handle_results[i] = handles[i].get();
+			}
+
+			const auto handle_end_time = std::chrono::steady_clock::now();
+
+			benchmark.ordered_map_time += ordered_map_end_time - start_time;
+			benchmark.string_time += string_end_time - ordered_map_end_time;
+			benchmark.interned_string_time += interned_string_end_time - string_end_time;
+			benchmark.handle_time += handle_end_time - interned_string_end_time;
+		}
+
+		for (size_t i = 0; i < identifiers.size(); ++i) {
+			if (string_results[i] != ordered_map_results[i] || interned_string_results[i] != ordered_map_results[i] || handle_results[i] != ordered_map_results[i]) {
+				++benchmark.mismatch_count;
+			}
+		}
+
+		benchmark.lookup_count += identifiers.size() * benchmark.rounds;
+	}
+
 private:
+	static T *try_get(const std::string_view &identifier, const size_t hash)
+	{
+		if (identifier == "none") {
+			return nullptr;
+		}
+
+		const qunique_ptr<T> *instance = data_type::instances_by_identifier.find(identifier, hash);
+		if (instance != nullptr) {
+			return instance->get();
+		}
+
+		T * const *alias_instance = data_type::instances_by_alias.find(identifier, hash);
+		if (alias_instance != nullptr) {
+			return *alias_instance;
+		}
+
+		return nullptr;
+	}
+
 	static inline bool initialize_class()
 	{
 		//initialize the metadata (including database parsing/processing functions) for this data type
-		auto metadata = std::make_unique<data_type_metadata>(T::class_identifier, T::database_dependencies, T::parse_database, T::process_database, T::initialize_all, T::process_all_text, T::check_all, T::clear);
+		auto metadata = std::make_unique<data_type_metadata>(T::class_identifier, T::database_dependencies, T::parse_database, T::process_database, T::initialize_all, T::process_all_text, T::check_all, T::clear, T::benchmark_identifier_lookups);
 		database::get()->register_metadata(std::move(metadata));
 
 		return true;
 	}
 
 	static inline std::vector<T *> instances;
-	static inline std::map<std::string, qunique_ptr<T>> instances_by_identifier;
-	static inline std::map<std::string, T *> instances_by_alias;
+	static inline string_hash_map<qunique_ptr<T>> instances_by_identifier;
+	static inline string_hash_map<T *> instances_by_alias;
+	static inline uint64_t generation = 1;
 	static inline data_module_map<std::vector<sml_data>> sml_data_to_process;
 #ifdef __GNUC__
 	//the "used" attribute is needed under GCC, or else this variable will be optimized away (even in debug builds)
@@ -31,16 +31,30 @@
 
 #pragma once
 
+#include <chrono>
+
 namespace wyrmgus {
 
 class data_module;
 
+//the results of benchmarking the identifier lookup for data types, accumulated over the data types
+struct identifier_lookup_benchmark final
+{
+	size_t rounds = 1; //how many times each identifier is looked up
+	size_t lookup_count = 0; //the lookups done with each method
+	size_t mismatch_count = 0; //lookups for which the methods gave different results
+	std::chrono::steady_clock::duration ordered_map_time = std::chrono::steady_clock::duration::zero(); //the time taken by an ordered map with string keys, as a baseline
+	std::chrono::steady_clock::duration string_time = std::chrono::steady_clock::duration::zero();
+	std::chrono::steady_clock::duration interned_string_time = std::chrono::steady_clock::duration::zero();
+	std::chrono::steady_clock::duration handle_time = std::chrono::steady_clock::duration::zero();
+};
+
 //the metadata for a data type, including e.g. its initialization function
 class data_type_metadata
 {
 public:
-	data_type_metadata(const std::string &class_identifier, const std::set<std::string> &database_dependencies, const std::function<void(const std::filesystem::path &, const data_module *)> &parsing_function, const std::function<void(bool)> &processing_function, const std::function<void()> &initialization_function, const std::function<void()> &text_processing_function, const std::function<void()> &checking_function, const std::function<void()> &clearing_function)
-		: class_identifier(class_identifier), database_dependencies(database_dependencies), parsing_function(parsing_function), processing_function(processing_function), initialization_function(initialization_function), text_processing_function(text_processing_function), checking_function(checking_function), clearing_function(clearing_function)
+	data_type_metadata(const std::string &class_identifier, const std::set<std::string> &database_dependencies, const std::function<void(const std::filesystem::path &, const data_module *)> &parsing_function, const std::function<void(bool)> &processing_function, const std::function<void()> &initialization_function, const std::function<void()> &text_processing_function, const std::function<void()> &checking_function, const std::function<void()> &clearing_function, const std::function<void(identifier_lookup_benchmark &)> &lookup_benchmark_function)
+		: class_identifier(class_identifier), database_dependencies(database_dependencies), parsing_function(parsing_function), processing_function(processing_function), initialization_function(initialization_function), text_processing_function(text_processing_function), checking_function(checking_function), clearing_function(clearing_function), lookup_benchmark_function(lookup_benchmark_function)
 	{
 	}
 
@@ -94,6 +108,11 @@ public:
 		return this->clearing_function;
 	}
 
+	const std::function<void(identifier_lookup_benchmark &)> &get_lookup_benchmark_function() const
+	{
+		return this->lookup_benchmark_function;
+	}
+
 private:
 	std::string class_identifier;
 	const std::set<std::string> &database_dependencies;
@@ -103,6 +122,7 @@ private:
 	std::function<void()> text_processing_function; //functions to process text for entries
 	std::function<void()> checking_function; //functions to check if data entries are valid
 	std::function<void()> clearing_function; //functions to clear the data entries
+	std::function<void(identifier_lookup_benchmark &)> lookup_benchmark_function; //functions to benchmark the lookup of the data entries by identifier
 };
 
 }
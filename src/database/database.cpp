@@ -98,14 +98,19 @@
 #include "unit/unit_type.h"
 #include "upgrade/upgrade_class.h"
 #include "upgrade/upgrade_structs.h"
+#include "util/hash_util.h"
 #include "util/qunique_ptr.h"
 #include "util/string_util.h"
+#include "util/thread_pool.h"
+#include "version.h"
 #include "video/font.h"
 #include "video/font_color.h"
 #include "world.h"
 
 namespace wyrmgus {
 
+static constexpr const char *database_cache_header = "WYRMGUS_DATABASE_CACHE\n";
+
 /**
 **	@brief	Process a SML property for an instance of a QObject-derived class
 **
@@ -551,10 +556,18 @@ void database::parse_folder(const std::filesystem::path &path, std::vector<sml_d
 		filepaths_by_depth[dir_iterator.depth()].push_back(dir_entry.path());
 	}
 
+	//reserve the place of each file in the list, so that the list's order does not depend on the order in which the files finish parsing; the files are then parsed concurrently by parse_queued_files()
+	std::vector<file_parsing_task> &file_parsing_tasks = database::get()->file_parsing_tasks;
+
 	for (const auto &kv_pair : filepaths_by_depth) {
 		for (const std::filesystem::path &filepath : kv_pair.second) {
-			sml_parser parser(filepath);
-			sml_data_list.push_back(parser.parse());
+			file_parsing_task task;
+			task.filepath = filepath;
+			task.sml_data_list = &sml_data_list;
+			task.index = sml_data_list.size();
+			file_parsing_tasks.push_back(std::move(task));
+
+			sml_data_list.emplace_back();
 		}
 	}
 }
@@ -574,11 +587,273 @@ void database::parse()
 		const std::filesystem::path &path = kv_pair.first;
 		const data_module *data_module = kv_pair.second;
 
-		//parse the files in each data type's folder
+		//queue the files in each data type's folder for parsing
 		for (const std::unique_ptr<data_type_metadata> &metadata : this->metadata) {
+			const size_t first_task_index = this->file_parsing_tasks.size();
+
 			metadata->get_parsing_function()(path, data_module);
+
+			for (size_t i = first_task_index; i < this->file_parsing_tasks.size(); ++i) {
+				this->file_parsing_tasks[i].metadata = metadata.get();
+			}
+
+			this->load_timings[metadata->get_class_identifier()].file_count += this->file_parsing_tasks.size() - first_task_index;
+		}
+	}
+
+	this->parse_queued_files();
+}
+
+/**
+**	@brief	Parse the queued data files concurrently
+**
+**	Each file's data is placed in the list element reserved for it when it was queued, so the resulting order is the same as if the files had been parsed one after another.
+*/
+void database::parse_queued_files()
+{
+	const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+	//use the cached result of parsing the files if none of them changed since it was written
+	const uint64_t files_hash = this->get_queued_files_hash();
+	bool loaded_from_cache = false;
+
+	try {
+		loaded_from_cache = this->load_cache(files_hash);
+	} catch (const std::exception &exception) {
+		fprintf(stderr, "Failed to load the database cache: %s\n", exception.what());
+	}
+
+	if (!loaded_from_cache) {
+		thread_pool::get()->parallel_for(this->file_parsing_tasks.size(), [this](const size_t i) {
+			file_parsing_task &task = this->file_parsing_tasks[i];
+			const std::chrono::steady_clock::time_point task_start_time = std::chrono::steady_clock::now();
+
+			try {
+				sml_parser parser(task.filepath);
+				(*task.sml_data_list)[task.index] = parser.parse();
+			} catch (...) {
+				task.exception = std::current_exception();
+			}
+
+			task.duration = std::chrono::steady_clock::now() - task_start_time;
+		});
+	}
+
+	const std::chrono::steady_clock::duration wall_time = std::chrono::steady_clock::now() - start_time;
+	this->parsing_wall_time += wall_time;
+
+	std::vector<file_parsing_task> file_parsing_tasks = std::move(this->file_parsing_tasks);
+	this->file_parsing_tasks.clear();
+
+	for (const file_parsing_task &task : file_parsing_tasks) {
+		this->load_timings[task.metadata->get_class_identifier()].parsing += task.duration;
+	}
+
+	//report the error of the first failing file in loading order, regardless of which thread finished first
+	for (const file_parsing_task &task : file_parsing_tasks) {
+		if (task.exception) {
+			std::rethrow_exception(task.exception);
+		}
+	}
+
+	const auto to_milliseconds = [](const std::chrono::steady_clock::duration &duration) {
+		return static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+	};
+
+	if (loaded_from_cache) {
+		if (EnableDebugPrint) {
+			fprintf(stdout, "Database cache: loaded %d files from the cache in %lld ms.\n", static_cast<int>(file_parsing_tasks.size()), to_milliseconds(wall_time));
+		}
+
+		return;
+	}
+
+	const std::chrono::steady_clock::time_point save_start_time = std::chrono::steady_clock::now();
+
+	try {
+		this->save_cache(files_hash, file_parsing_tasks);
+	} catch (const std::exception &exception) {
+		fprintf(stderr, "Failed to save the database cache: %s\n", exception.what());
+	}
+
+	if (EnableDebugPrint) {
+		fprintf(stdout, "Database cache: parsed %d files in %lld ms, and wrote the cache in %lld ms.\n", static_cast<int>(file_parsing_tasks.size()), to_milliseconds(wall_time), to_milliseconds(std::chrono::steady_clock::now() - save_start_time));
+	}
+}
+
+/**
+**	@brief	Get the hash of the paths and contents of the data files queued for parsing
+**
+**	@return	The hash, which changes if any of the files is added, removed, renamed or modified, or if their order changes
+*/
+uint64_t database::get_queued_files_hash() const
+{
+	std::vector<uint64_t> file_hashes(this->file_parsing_tasks.size(), 0);
+
+	thread_pool::get()->parallel_for(this->file_parsing_tasks.size(), [this, &file_hashes](const size_t i) {
+		const file_parsing_task &task = this->file_parsing_tasks[i];
+
+		const std::string path_str = task.filepath.string();
+		uint64_t file_hash = hash::fnv1a(path_str.data(), path_str.size());
+
+		std::ifstream ifstream(task.filepath, std::ios::binary);
+		std::vector<char> buffer(64 * 1024);
+		while (ifstream) {
+			ifstream.read(buffer.data(), buffer.size());
+			file_hash = hash::fnv1a(buffer.data(), static_cast<size_t>(ifstream.gcount()), file_hash);
 		}
+
+		file_hashes[i] = file_hash;
+	});
+
+	//the engine version is part of the hash, since the cached data has to be regenerated whenever the engine changes
+	uint64_t files_hash = hash::fnv1a(VERSION, std::string_view(VERSION).size());
+	for (const uint64_t file_hash : file_hashes) {
+		files_hash = hash::fnv1a(&file_hash, sizeof(file_hash), files_hash);
 	}
+
+	return files_hash;
+}
+
+/**
+**	@brief	Load the parsed data of the queued files from the database cache
+**
+**	@param	files_hash	The hash of the queued files
+**
+**	@return	True if the cache was loaded, or false if there is no cache, or it was written for different files or for a different engine version
+*/
+bool database::load_cache(const uint64_t files_hash)
+{
+	const std::filesystem::path cache_filepath = database::get_cache_path() / database::cache_filename;
+
+	if (!std::filesystem::exists(cache_filepath)) {
+		return false;
+	}
+
+	std::ifstream ifstream(cache_filepath, std::ios::binary);
+	if (!ifstream) {
+		return false;
+	}
+
+	const std::string cache_data((std::istreambuf_iterator<char>(ifstream)), std::istreambuf_iterator<char>());
+	std::string_view buffer(cache_data);
+
+	const auto read_uint64 = [&buffer]() {
+		uint64_t value = 0;
+		if (buffer.size() < sizeof(value)) {
+			throw std::runtime_error("Unexpected end of the database cache.");
+		}
+
+		memcpy(&value, buffer.data(), sizeof(value));
+		buffer.remove_prefix(sizeof(value));
+		return value;
+	};
+
+	const std::string_view cache_header = database_cache_header;
+	if (!buffer.starts_with(cache_header)) {
+		return false;
+	}
+	buffer.remove_prefix(cache_header.size());
+
+	if (read_uint64() != database::cache_format_version || read_uint64() != files_hash || read_uint64() != this->file_parsing_tasks.size()) {
+		return false;
+	}
+
+	//the sizes of the files' serialized data, so that they can be deserialized concurrently
+	std::vector<std::string_view> file_buffers;
+	file_buffers.reserve(this->file_parsing_tasks.size());
+
+	std::vector<uint64_t> file_sizes;
+	file_sizes.reserve(this->file_parsing_tasks.size());
+	for (size_t i = 0; i < this->file_parsing_tasks.size(); ++i) {
+		file_sizes.push_back(read_uint64());
+	}
+
+	for (const uint64_t file_size : file_sizes) {
+		if (buffer.size() < file_size) {
+			throw std::runtime_error("Unexpected end of the database cache.");
+		}
+
+		file_buffers.push_back(buffer.substr(0, file_size));
+		buffer.remove_prefix(file_size);
+	}
+
+	std::vector<std::exception_ptr> exceptions(this->file_parsing_tasks.size());
+
+	thread_pool::get()->parallel_for(this->file_parsing_tasks.size(), [this, &file_buffers, &exceptions](const size_t i) {
+		const file_parsing_task &task = this->file_parsing_tasks[i];
+
+		try {
+			std::string_view file_buffer = file_buffers[i];
+			(*task.sml_data_list)[task.index] = sml_data::deserialize(file_buffer);
+		} catch (...) {
+			exceptions[i] = std::current_exception();
+		}
+	});
+
+	for (const std::exception_ptr &exception : exceptions) {
+		if (exception) {
+			std::rethrow_exception(exception);
+		}
+	}
+
+	return true;
+}
+
+/**
+**	@brief	Save the parsed data of the files to the database cache
+**
+**	@param	files_hash			The hash of the files
+**	@param	file_parsing_tasks	The tasks of the parsed files
+*/
+void database::save_cache(const uint64_t files_hash, const std::vector<file_parsing_task> &file_parsing_tasks) const
+{
+	std::vector<std::string> file_buffers(file_parsing_tasks.size());
+
+	thread_pool::get()->parallel_for(file_parsing_tasks.size(), [&file_parsing_tasks, &file_buffers](const size_t i) {
+		const file_parsing_task &task = file_parsing_tasks[i];
+		(*task.sml_data_list)[task.index].serialize(file_buffers[i]);
+	});
+
+	const auto write_uint64 = [](std::ofstream &ofstream, const uint64_t value) {
+		ofstream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+	};
+
+	const std::filesystem::path cache_path = database::get_cache_path();
+	if (!std::filesystem::exists(cache_path)) {
+		std::filesystem::create_directories(cache_path);
+	}
+
+	//write to a temporary file first, so that an interrupted write cannot leave a truncated cache behind
+	const std::filesystem::path cache_filepath = cache_path / database::cache_filename;
+	std::filesystem::path temp_filepath = cache_filepath;
+	temp_filepath += ".tmp";
+
+	{
+		std::ofstream ofstream(temp_filepath, std::ios::binary | std::ios::trunc);
+		if (!ofstream) {
+			throw std::runtime_error("Failed to open file \"" + temp_filepath.string() + "\" for writing.");
+		}
+
+		ofstream.write(database_cache_header, std::string_view(database_cache_header).size());
+		write_uint64(ofstream, database::cache_format_version);
+		write_uint64(ofstream, files_hash);
+		write_uint64(ofstream, file_buffers.size());
+
+		for (const std::string &file_buffer : file_buffers) {
+			write_uint64(ofstream, file_buffer.size());
+		}
+
+		for (const std::string &file_buffer : file_buffers) {
+			ofstream.write(file_buffer.data(), file_buffer.size());
+		}
+
+		if (!ofstream) {
+			throw std::runtime_error("Failed to write file \"" + temp_filepath.string() + "\".");
+		}
+	}
+
+	std::filesystem::rename(temp_filepath, cache_filepath);
 }
 
 void database::load(const bool initial_definition)
@@ -607,7 +882,16 @@ void database::load(const bool initial_definition)
 	try {
 		//create or process data entries for each data type
 		for (const std::unique_ptr<data_type_metadata> &metadata : this->metadata) {
+			const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
 			metadata->get_processing_function()(initial_definition);
+
+			load_timing &timing = this->load_timings[metadata->get_class_identifier()];
+			if (initial_definition) {
+				timing.definition += std::chrono::steady_clock::now() - start_time;
+			} else {
+				timing.processing += std::chrono::steady_clock::now() - start_time;
+			}
 		}
 	} catch (...) {
 		std::throw_with_nested(std::runtime_error("Failed to process database."));
@@ -662,32 +946,112 @@ void database::initialize()
 
 	//initialize data entries for each data type
 	for (const std::unique_ptr<data_type_metadata> &metadata : this->metadata) {
+		const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
 		try {
 			metadata->get_initialization_function()();
 		} catch (...) {
 			std::throw_with_nested(std::runtime_error("Error initializing the instances of the " + metadata->get_class_identifier() + " class."));
 		}
+
+		this->load_timings[metadata->get_class_identifier()].initialization += std::chrono::steady_clock::now() - start_time;
 	}
 
 	//process text for data entries for each data type
 	for (const std::unique_ptr<data_type_metadata> &metadata : this->metadata) {
+		const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
 		try {
 			metadata->get_text_processing_function()();
 		} catch (...) {
 			std::throw_with_nested(std::runtime_error("Error processing text for the instances of the " + metadata->get_class_identifier() + " class."));
 		}
+
+		this->load_timings[metadata->get_class_identifier()].initialization += std::chrono::steady_clock::now() - start_time;
 	}
 
 	this->initialized = true;
 
 	//check if data entries are valid for each data type
 	for (const std::unique_ptr<data_type_metadata> &metadata : this->metadata) {
+		const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
 		try {
 			metadata->get_checking_function()();
 		} catch (...) {
 			std::throw_with_nested(std::runtime_error("Error when checking the instances of the " + metadata->get_class_identifier() + " class."));
 		}
+
+		this->load_timings[metadata->get_class_identifier()].checking += std::chrono::steady_clock::now() - start_time;
+	}
+
+	//the load timings are only reported when debug printing is enabled (with the -p command line option)
+	if (EnableDebugPrint) {
+		this->print_load_timings();
 	}
+
+	this->load_timings.clear();
+	this->parsing_wall_time = std::chrono::steady_clock::duration::zero();
+}
+
+/**
+**	@brief	Print the time spent loading each data type, from the slowest to the fastest
+*/
+void database::print_load_timings() const
+{
+	const auto to_milliseconds = [](const std::chrono::steady_clock::duration &duration) {
+		return static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+	};
+
+	std::vector<std::pair<std::string, std::chrono::steady_clock::duration>> total_durations;
+	std::chrono::steady_clock::duration parsing_thread_time = std::chrono::steady_clock::duration::zero();
+
+	for (const auto &kv_pair : this->load_timings) {
+		const load_timing &timing = kv_pair.second;
+		total_durations.emplace_back(kv_pair.first, timing.parsing + timing.definition + timing.processing + timing.initialization + timing.checking);
+		parsing_thread_time += timing.parsing;
+	}
+
+	std::stable_sort(total_durations.begin(), total_durations.end(), [](const auto &a, const auto &b) {
+		return a.second > b.second;
+	});
+
+	fprintf(stdout, "Database load timings: parsing took %lld ms (%lld ms of thread time on %d threads).\n", to_milliseconds(this->parsing_wall_time), to_milliseconds(parsing_thread_time), static_cast<int>(thread_pool::get()->get_thread_count()));
+
+	for (const auto &kv_pair : total_durations) {
+		const load_timing &timing = this->load_timings.find(kv_pair.first)->second;
+
+		if (to_milliseconds(kv_pair.second) == 0) {
+			continue;
+		}
+
+		fprintf(stdout, "    %s: %lld ms total, %d files, %lld ms parsing, %lld ms definition, %lld ms processing, %lld ms initialization, %lld ms checking\n", kv_pair.first.c_str(), to_milliseconds(kv_pair.second), static_cast<int>(timing.file_count), to_milliseconds(timing.parsing), to_milliseconds(timing.definition), to_milliseconds(timing.processing), to_milliseconds(timing.initialization), to_milliseconds(timing.checking));
+	}
+}
+
+/**
+**	@brief	Benchmark looking up every data entry by its identifiers with each lookup method, and print the results
+**
+**	@param	rounds	How many times each identifier is looked up with each method
+*/
+void database::benchmark_identifier_lookups(const size_t rounds) const
+{
+	const auto to_microseconds = [](const std::chrono::steady_clock::duration &duration) {
+		return static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+	};
+
+	identifier_lookup_benchmark benchmark;
+	benchmark.rounds = rounds;
+
+	for (const std::unique_ptr<data_type_metadata> &metadata : this->metadata) {
+		metadata->get_lookup_benchmark_function()(benchmark);
+	}
+
+	fprintf(stdout, "Identifier lookup benchmark: %lld lookups per method, %lld mismatches.\n", static_cast<long long>(benchmark.lookup_count), static_cast<long long>(benchmark.mismatch_count));
+	fprintf(stdout, "    Ordered map: %lld us\n", to_microseconds(benchmark.ordered_map_time));
+	fprintf(stdout, "    String: %lld us\n", to_microseconds(benchmark.string_time));
+	fprintf(stdout, "    Interned string: %lld us\n", to_microseconds(benchmark.interned_string_time));
+	fprintf(stdout, "    Handle: %lld us\n", to_microseconds(benchmark.handle_time));
 }
 
 void database::clear()
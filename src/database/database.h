@@ -32,6 +32,8 @@
 #include "util/singleton.h"
 #include "util/type_traits.h"
 
+#include <chrono>
+
 namespace wyrmgus {
 
 class data_entry;
@@ -46,6 +48,8 @@ public:
 	static constexpr const char *maps_folder = "maps";
 	static constexpr const char *music_folder = "music";
 	static constexpr const char *sounds_folder = "sounds";
+	static constexpr const char *cache_filename = "database.bin";
+	static constexpr uint64_t cache_format_version = 1; //the version of the database cache's binary format, to be increased whenever it changes
 
 	template <typename T>
 	static void process_sml_data(T *instance, const sml_data &data)
@@ -106,6 +110,11 @@ public:
 		return this->get_root_path() / "dlcs";
 	}
 
+	static std::filesystem::path get_cache_path()
+	{
+		return database::get_documents_path() / "cache";
+	}
+
 	static std::filesystem::path get_documents_modules_path()
 	{
 		return database::get_documents_path() / "modules";
@@ -146,11 +155,38 @@ public:
 
 	static void parse_folder(const std::filesystem::path &path, std::vector<sml_data> &sml_data_list);
 
+private:
+	//a data file queued for parsing, with the element of its data type's list which will receive the result
+	struct file_parsing_task
+	{
+		std::filesystem::path filepath;
+		std::vector<sml_data> *sml_data_list = nullptr;
+		size_t index = 0;
+		const data_type_metadata *metadata = nullptr; //the metadata of the data type which queued the file
+		std::chrono::steady_clock::duration duration = std::chrono::steady_clock::duration::zero();
+		std::exception_ptr exception;
+	};
+
+	//the time spent on each loading stage for a data type
+	struct load_timing
+	{
+		std::chrono::steady_clock::duration parsing = std::chrono::steady_clock::duration::zero(); //the summed time of the parsing threads
+		std::chrono::steady_clock::duration definition = std::chrono::steady_clock::duration::zero();
+		std::chrono::steady_clock::duration processing = std::chrono::steady_clock::duration::zero();
+		std::chrono::steady_clock::duration initialization = std::chrono::steady_clock::duration::zero();
+		std::chrono::steady_clock::duration checking = std::chrono::steady_clock::duration::zero();
+		size_t file_count = 0;
+	};
+
 public:
 	database();
 	~database();
 
 	void parse();
+	void parse_queued_files();
+	uint64_t get_queued_files_hash() const;
+	bool load_cache(const uint64_t files_hash);
+	void save_cache(const uint64_t files_hash, const std::vector<file_parsing_task> &file_parsing_tasks) const;
 	void load(const bool initial_definition);
 	void load_predefines();
 	void load_defines();
@@ -162,6 +198,8 @@ public:
 	}
 
 	void initialize();
+	void print_load_timings() const;
+	void benchmark_identifier_lookups(const size_t rounds) const;
 
 	void clear();
 	void register_metadata(std::unique_ptr<data_type_metadata> &&metadata);
@@ -258,6 +296,9 @@ private:
 	std::vector<std::unique_ptr<data_type_metadata>> metadata;
 	std::vector<qunique_ptr<data_module>> modules;
 	std::map<std::string, data_module *> modules_by_identifier;
+	std::vector<file_parsing_task> file_parsing_tasks;
+	std::map<std::string, load_timing> load_timings; //load timings per data type class identifier
+	std::chrono::steady_clock::duration parsing_wall_time = std::chrono::steady_clock::duration::zero();
 	bool initialized = false;
 };
 
@@ -36,6 +36,52 @@
 
 namespace wyrmgus {
 
+static void serialize_size(std::string &buffer, const size_t size)
+{
+	const uint32_t size_value = static_cast<uint32_t>(size);
+	buffer.append(reinterpret_cast<const char *>(&size_value), sizeof(size_value));
+}
+
+static void serialize_string(std::string &buffer, const std::string &str)
+{
+	serialize_size(buffer, str.size());
+	buffer.append(str);
+}
+
+static size_t deserialize_size(std::string_view &buffer)
+{
+	uint32_t size_value = 0;
+	if (buffer.size() < sizeof(size_value)) {
+		throw std::runtime_error("Unexpected end of serialized SML data.");
+	}
+
+	memcpy(&size_value, buffer.data(), sizeof(size_value));
+	buffer.remove_prefix(sizeof(size_value));
+	return size_value;
+}
+
+static std::string deserialize_string(std::string_view &buffer)
+{
+	const size_t size = deserialize_size(buffer);
+	if (buffer.size() < size) {
+		throw std::runtime_error("Unexpected end of serialized SML data.");
+	}
+
+	std::string str(buffer.substr(0, size));
+	buffer.remove_prefix(size);
+	return str;
+}
+
+static sml_operator deserialize_operator(std::string_view &buffer)
+{
+	const size_t operator_value = deserialize_size(buffer);
+	if (operator_value > static_cast<size_t>(sml_operator::greater_than_or_equality)) {
+		throw std::runtime_error("Invalid serialized SML operator: " + std::to_string(operator_value) + ".");
+	}
+
+	return static_cast<sml_operator>(operator_value);
+}
+
 sml_data::sml_data(std::string &&tag)
 	: tag(std::move(tag)), scope_operator(sml_operator::assignment)
 {
@@ -91,4 +137,78 @@ void sml_data::print(std::ofstream &ofstream, const size_t indentation, const bo
 	}
 }
 
+/**
+**	@brief	Append a binary representation of the SML data to a buffer
+**
+**	@param	buffer	The buffer
+*/
+void sml_data::serialize(std::string &buffer) const
+{
+	serialize_string(buffer, this->get_tag());
+	serialize_size(buffer, static_cast<size_t>(this->get_operator()));
+
+	serialize_size(buffer, this->get_values().size());
+	for (const std::string &value : this->get_values()) {
+		serialize_string(buffer, value);
+	}
+
+	serialize_size(buffer, this->get_elements().size());
+	for (const auto &element : this->get_elements()) {
+		if (std::holds_alternative<sml_property>(element)) {
+			const sml_property &property = std::get<sml_property>(element);
+			buffer.push_back(0);
+			serialize_string(buffer, property.get_key());
+			serialize_size(buffer, static_cast<size_t>(property.get_operator()));
+			serialize_string(buffer, property.get_value());
+		} else {
+			buffer.push_back(1);
+			std::get<sml_data>(element).serialize(buffer);
+		}
+	}
+}
+
+/**
+**	@brief	Create SML data from its binary representation, removing the latter from the buffer
+**
+**	@param	buffer	The buffer, starting with the serialized SML data
+**
+**	@return	The SML data
+*/
+sml_data sml_data::deserialize(std::string_view &buffer)
+{
+	std::string tag = deserialize_string(buffer);
+	const sml_operator scope_operator = deserialize_operator(buffer);
+	sml_data data(std::move(tag), scope_operator);
+
+	const size_t value_count = deserialize_size(buffer);
+	data.values.reserve(value_count);
+	for (size_t i = 0; i < value_count; ++i) {
+		data.values.push_back(deserialize_string(buffer));
+	}
+
+	const size_t element_count = deserialize_size(buffer);
+	data.elements.reserve(element_count);
+	for (size_t i = 0; i < element_count; ++i) {
+		if (buffer.empty()) {
+			throw std::runtime_error("Unexpected end of serialized SML data.");
+		}
+
+		const char element_type = buffer.front();
+		buffer.remove_prefix(1);
+
+		if (element_type == 0) {
+			std::string key = deserialize_string(buffer);
+			const sml_operator property_operator = deserialize_operator(buffer);
+			std::string value = deserialize_string(buffer);
+			data.elements.push_back(sml_property(std::move(key), property_operator, std::move(value)));
+		} else if (element_type == 1) {
+			data.elements.push_back(sml_data::deserialize(buffer));
+		} else {
+			throw std::runtime_error("Invalid serialized SML element type: " + std::to_string(element_type) + ".");
+		}
+	}
+
+	return data;
+}
+
 }
@@ -293,6 +293,9 @@ public:
 
 	void print(std::ofstream &ofstream, const size_t indentation, const bool new_line) const;
 
+	void serialize(std::string &buffer) const;
+	static sml_data deserialize(std::string_view &buffer);
+
 	void print_components(std::ofstream &ofstream, const size_t indentation = 0) const
 	{
 		if (!this->get_values().empty()) {
@@ -34,6 +34,8 @@
 #include "database/sml_data.h"
 #include "database/sml_operator.h"
 
+#include <QFile>
+
 namespace wyrmgus {
 
 sml_parser::sml_parser(const std::filesystem::path &filepath)
@@ -47,40 +49,93 @@ sml_data sml_parser::parse()
 		throw std::runtime_error("File \"" + this->filepath.string() + "\" not found.");
 	}
 
-	std::ifstream ifstream(this->filepath);
+	QFile file(QString::fromStdString(this->filepath.string()));
 
-	if (!ifstream) {
+	if (!file.open(QIODevice::ReadOnly)) {
 		throw std::runtime_error("Failed to open file: " + this->filepath.string());
 	}
 
 	sml_data file_sml_data(this->filepath.stem().string());
+	this->current_sml_data = &file_sml_data;
+
+	//map the file into memory, so that tokens can be views into it instead of being copied; if the file cannot be mapped (e.g. because it is empty), read it instead
+	const qint64 file_size = file.size();
+	uchar *mapped_data = file_size > 0 ? file.map(0, file_size) : nullptr;
 
-	std::string line;
+	if (mapped_data != nullptr) {
+		this->parse_buffer(std::string_view(reinterpret_cast<const char *>(mapped_data), static_cast<size_t>(file_size)));
+		file.unmap(mapped_data);
+	} else {
+		const QByteArray file_data = file.readAll();
+		this->parse_buffer(std::string_view(file_data.constData(), static_cast<size_t>(file_data.size())));
+	}
+
+	this->reset();
+
+	return file_sml_data;
+}
+
+void sml_parser::parse_buffer(const std::string_view &buffer)
+{
 	int line_index = 1;
-	this->current_sml_data = &file_sml_data;
 
 	try {
-		while (std::getline(ifstream, line)) {
-			this->parse_line(line);
+		size_t line_start = 0;
+
+		while (line_start < buffer.size()) {
+			size_t line_end = buffer.find('\n', line_start);
+			if (line_end == std::string_view::npos) {
+				line_end = buffer.size();
+			}
+
+			this->parse_line(buffer.substr(line_start, line_end - line_start));
 			this->parse_tokens();
 			++line_index;
+
+			line_start = line_end + 1;
 		}
 	} catch (std::exception &exception) {
 		throw std::runtime_error("Error parsing data file \"" + this->filepath.string() + "\", line " + std::to_string(line_index) + ": " + exception.what());
 	}
-
-	this->reset();
-
-	return file_sml_data;
 }
 
-void sml_parser::parse_line(const std::string &line)
+void sml_parser::parse_line(const std::string_view &line)
 {
 	bool opened_quotation_marks = false;
 	bool escaped = false;
-	std::string current_string;
 
-	for (const char c : line) {
+	//the current token is a view into the line for as long as its characters are contiguous in it, and is only copied into an owned string if it is not
+	size_t token_start = 0;
+	size_t token_size = 0;
+	std::string owned_string;
+	bool owned = false;
+
+	const auto finish_token = [&]() {
+		if (owned) {
+			if (!owned_string.empty()) {
+				this->owned_strings.push_back(std::move(owned_string));
+				this->tokens.push_back(this->owned_strings.back());
+			}
+
+			owned_string = std::string();
+			owned = false;
+		} else if (token_size > 0) {
+			this->tokens.push_back(line.substr(token_start, token_size));
+		}
+
+		token_size = 0;
+	};
+
+	const auto make_owned = [&]() {
+		if (!owned) {
+			owned_string = std::string(line.substr(token_start, token_size));
+			owned = true;
+		}
+	};
+
+	for (size_t i = 0; i < line.size(); ++i) {
+		const char c = line[i];
+
 		if (!escaped) {
 			if (c == '\"') {
 				opened_quotation_marks = !opened_quotation_marks;
@@ -98,11 +153,7 @@ void sml_parser::parse_line(const std::string &line)
 
 			//whitespace, carriage returns and etc. separate tokens, if they occur outside of quotes
 			if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
-				if (!current_string.empty()) {
-					this->tokens.push_back(std::move(current_string));
-					current_string = std::string();
-				}
-
+				finish_token();
 				continue;
 			}
 		}
@@ -110,17 +161,29 @@ void sml_parser::parse_line(const std::string &line)
 		if (escaped) {
 			escaped = false;
 
-			if (this->parse_escaped_character(current_string, c)) {
+			std::string escaped_string;
+			if (this->parse_escaped_character(escaped_string, c)) {
+				make_owned();
+				owned_string += escaped_string;
 				continue;
 			}
 		}
 
-		current_string += c;
+		if (owned) {
+			owned_string += c;
+		} else if (token_size == 0) {
+			token_start = i;
+			token_size = 1;
+		} else if (token_start + token_size == i) {
+			++token_size;
+		} else {
+			//the character is not contiguous with the rest of the token, e.g. because of a quotation mark or unknown escape sequence in between
+			make_owned();
+			owned_string += c;
+		}
 	}
 
-	if (!current_string.empty()) {
-		this->tokens.push_back(std::move(current_string));
-	}
+	finish_token();
 }
 
 /**
@@ -155,11 +218,11 @@ bool sml_parser::parse_escaped_character(std::string &current_string, const char
 */
 void sml_parser::parse_tokens()
 {
-	for (std::string &token : this->tokens) {
+	for (const std::string_view &token : this->tokens) {
 		if (!this->current_key.empty() && this->current_property_operator == sml_operator::none && token != "=" && token != "+=" && token != "-=" && token != "==" && token != "!=" && token != "<" && token != "<=" && token != ">" && token != ">=" && token != "{") {
 			//if the previously-given key isn't empty and no operator has been provided before or now, then the key was actually a value, part of a simple collection of values
-			this->current_sml_data->add_value(std::move(this->current_key));
-			this->current_key = std::string();
+			this->current_sml_data->add_value(std::string(this->current_key));
+			this->current_key = std::string_view();
 		}
 
 		if (this->current_key.empty()) {
@@ -178,7 +241,7 @@ void sml_parser::parse_tokens()
 
 				this->current_sml_data = this->current_sml_data->parent;
 			} else { //key
-				this->current_key = std::move(token);
+				this->current_key = token;
 			}
 
 			continue;
@@ -204,7 +267,7 @@ void sml_parser::parse_tokens()
 			} else if (token == ">=") {
 				this->current_property_operator = sml_operator::greater_than_or_equality;
 			} else {
-				throw std::runtime_error("Tried using operator \"" + token + "\" for key \"" + this->current_key + "\", but it is not a valid operator.");
+				throw std::runtime_error("Tried using operator \"" + std::string(token) + "\" for key \"" + std::string(this->current_key) + "\", but it is not a valid operator.");
 			}
 
 			continue;
@@ -216,15 +279,14 @@ void sml_parser::parse_tokens()
 				throw std::runtime_error("Only the assignment and addition operators are valid after a tag.");
 			}
 
-			std::string &tag_name = this->current_key;
-			sml_data &new_sml_data = this->current_sml_data->add_child(std::move(tag_name), this->current_property_operator);
+			sml_data &new_sml_data = this->current_sml_data->add_child(std::string(this->current_key), this->current_property_operator);
 			new_sml_data.parent = this->current_sml_data;
 			this->current_sml_data = &new_sml_data;
 		} else {
-			this->current_sml_data->add_property(std::move(this->current_key), this->current_property_operator, std::move(token));
+			this->current_sml_data->add_property(std::string(this->current_key), this->current_property_operator, std::string(token));
 		}
 
-		this->current_key = std::string();
+		this->current_key = std::string_view();
 		this->current_property_operator = sml_operator::none;
 	}
 
@@ -234,8 +296,9 @@ void sml_parser::parse_tokens()
 void sml_parser::reset()
 {
 	this->tokens.clear();
+	this->owned_strings.clear();
 	this->current_sml_data = nullptr;
-	this->current_key = std::string();
+	this->current_key = std::string_view();
 	this->current_property_operator = sml_operator::none;
 }
 
@@ -44,16 +44,18 @@ public:
 	sml_data parse();
 
 private:
-	void parse_line(const std::string &line);
+	void parse_buffer(const std::string_view &buffer);
+	void parse_line(const std::string_view &line);
 	bool parse_escaped_character(std::string &current_string, const char c);
 	void parse_tokens();
 	void reset();
 
 private:
 	std::filesystem::path filepath;
-	std::vector<std::string> tokens;
+	std::vector<std::string_view> tokens; //the tokens of the current line, which are views into the file buffer, or into the owned strings if they could not be taken verbatim from it
+	std::deque<std::string> owned_strings; //the strings of tokens which had escaped characters or quotes in their middle, and which thus differ from the text in the file buffer
 	sml_data *current_sml_data = nullptr;
-	std::string current_key;
+	std::string_view current_key;
 	sml_operator current_property_operator;
 };
 
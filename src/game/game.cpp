@@ -162,6 +162,7 @@ void game::do_cycle()
 {
 	if (GameCycle % CYCLES_PER_IN_GAME_HOUR == 0) {
 		CDate::CurrentTotalHours++;
+		trigger::on_condition_dependency_changed(condition_dependency_date);
 
 		this->current_date = this->current_date.addSecs(1 * 60 * 60 * DEFAULT_DAY_MULTIPLIER_PER_YEAR);
 
@@ -33,9 +33,11 @@
 #include "currency.h"
 #include "database/database.h"
 #include "dialogue.h"
+#include "game/snapshot.h"
 //Wyrmgus start
 #include "grand_strategy.h"
 //Wyrmgus end
+#include "iolib.h"
 #include "luacallback.h"
 #include "map/map.h"
 #include "map/map_layer.h"
@@ -248,6 +250,32 @@ static void PlaceUnits()
 	}
 }
 
+/**
+**  Load the map fields of the saved game being loaded from its binary snapshot.
+**
+**  @param save_directory     Directory of the saved game.
+**  @param snapshot_filename  Name of the snapshot file, which is in the same directory as the saved game.
+*/
+void LoadMapFieldsSnapshot(const std::string &save_directory, const std::string &snapshot_filename)
+{
+	const std::filesystem::path snapshot_path = std::filesystem::path(save_directory) / snapshot_filename;
+
+	CFile file;
+	if (file.open(snapshot_path.string().c_str(), CL_OPEN_READ) == -1) {
+		throw std::runtime_error("Failed to open savegame snapshot \"" + snapshot_path.string() + "\".");
+	}
+
+	wyrmgus::snapshot_reader reader(file);
+	file.close();
+
+	wyrmgus::read_snapshot_header(reader);
+	CMap::get()->load_fields_snapshot(reader);
+
+	if (reader.read_uint32() != static_cast<uint32_t>(wyrmgus::snapshot_section::end)) {
+		throw std::runtime_error("Savegame snapshot \"" + snapshot_path.string() + "\" has unexpected data after the map fields.");
+	}
+}
+
 /**
 **  Load a game to file.
 **
@@ -273,7 +301,8 @@ void LoadGame(const std::string &filename)
 	//Wyrmgus start
 	CalculateItemsToLoad();
 	//Wyrmgus end
-	LuaLoadFile(filename);
+	//the saved game's directory is passed to it, so that it can refer to its snapshot
+	LuaLoadFile(filename, std::filesystem::path(filename).parent_path().string());
 	LuaGarbageCollect();
 
 	//clear the base reference for destroyed units
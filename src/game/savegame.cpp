@@ -34,9 +34,11 @@
 #include "ai.h"
 #include "character.h"
 #include "database/database.h"
+#include "game/snapshot.h"
 #include "iocompat.h"
 #include "iolib.h"
 #include "map/map.h"
+#include "map/tile.h"
 #include "missile.h"
 #include "parameters.h"
 #include "player.h"
@@ -53,8 +55,40 @@
 #include "util/random.h"
 #include "version.h"
 
+#include <atomic>
+#include <chrono>
+
 extern void StartMap(const std::string &filename, bool clean);
 
+bool SaveGameBinarySnapshot = true;
+
+/**
+**  A file of a saved game, serialized in memory and waiting to be written to disk.
+*/
+struct SaveGameFile
+{
+	std::filesystem::path Path; /// Path of the file, without the compression extension
+	std::string Data;           /// Uncompressed contents of the file
+};
+
+/**
+**  The state of a saved game, copied or serialized between game cycles and waiting to be written to disk.
+*/
+struct SaveGameData
+{
+	std::string SnapshotPath;                               /// Path of the binary snapshot file, or an empty string if the game is saved as Lua only
+	std::vector<wyrmgus::map_layer_snapshot> MapLayers;     /// Copy of the map fields, to be serialized to the snapshot
+	SaveGameFile LuaFile;                                   /// The serialized Lua file of the saved game
+};
+
+static bool SaveGameInBackground = false;           /// Whether SaveGame should write the files on the background thread
+static std::jthread SaveGameThread;                 /// Thread writing the files of the last saved game to disk
+static std::atomic<size_t> SaveGameBytesWritten(0); /// Bytes of the files already written by the background thread
+static std::atomic<size_t> SaveGameBytesTotal(0);   /// Total bytes of the files being written by the background thread, or 0 while they are being serialized
+static std::atomic<bool> SaveGameFinished(true);    /// Whether the background thread has finished writing
+static std::atomic<bool> SaveGameFailed(false);     /// Whether writing on the background thread failed
+static int SaveGameLastProgress = -1;               /// Last progress percentage shown in the status line
+
 void ExpandPath(std::string &newpath, const std::string &path)
 {
 	if (path[0] == '~') {
@@ -87,26 +121,268 @@ static std::string GetSaveDir()
 	return dir;
 }
 
+/**
+**  Get the name of the binary snapshot file of a saved game.
+**
+**  Each save gets a snapshot of its own, named after the time it was made, so that the snapshot referred to by the previous save under the same name is kept until the new save has replaced it.
+**
+**  @param filename  File name of the saved game, without the compression extension.
+*/
+static std::string GetSnapshotFilename(const std::string &filename)
+{
+	const long long timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	return filename + "." + std::to_string(timestamp) + ".snapshot";
+}
+
+/**
+**  Remove the binary snapshot files of a saved game.
+**
+**  @param save_path          Path of the saved game, without the compression extension.
+**  @param snapshot_filename  Name of the snapshot file to be kept, without the compression extension, or an empty string to remove all of them.
+*/
+static void RemoveSnapshots(const std::filesystem::path &save_path, const std::string &snapshot_filename)
+{
+	static const std::string snapshot_extension = ".snapshot";
+
+	const std::string save_filename = save_path.filename().string();
+
+	std::error_code error_code;
+	std::vector<std::filesystem::path> snapshot_paths;
+	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(save_path.parent_path(), error_code)) {
+		std::string name = entry.path().filename().string();
+		if (name.ends_with(".gz")) {
+			name.resize(name.size() - 3);
+		}
+
+		if (!name.ends_with(snapshot_extension) || name == snapshot_filename) {
+			continue;
+		}
+
+		//only a timestamp may be between the saved game's name and the extension, so that the snapshots of other saved games whose names start with this one's are kept
+		const std::string stem = name.substr(0, name.size() - snapshot_extension.size());
+		if (stem != save_filename) {
+			if (!stem.starts_with(save_filename + ".")) {
+				continue;
+			}
+
+			const std::string timestamp = stem.substr(save_filename.size() + 1);
+			if (timestamp.empty() || !std::all_of(timestamp.begin(), timestamp.end(), [](const char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; })) {
+				continue;
+			}
+		}
+
+		snapshot_paths.push_back(entry.path());
+	}
+
+	for (const std::filesystem::path &snapshot_path : snapshot_paths) {
+		std::filesystem::remove(snapshot_path, error_code);
+	}
+}
+
+/**
+**  Save the bulk of the game state to a binary snapshot in memory.
+**
+**  This only reads the copied state, so that it can be done on the background thread.
+**
+**  @param filepath    Path of the snapshot file.
+**  @param map_layers  Copy of the map fields.
+**
+**  @return  The serialized snapshot file.
+*/
+static SaveGameFile SaveGameSnapshot(const std::string &filepath, const std::vector<wyrmgus::map_layer_snapshot> &map_layers)
+{
+	CFile file;
+	file.open(filepath.c_str(), CL_WRITE_MEMORY | CL_OPEN_WRITE);
+
+	{
+		wyrmgus::snapshot_writer writer(file);
+		wyrmgus::write_snapshot_header(writer);
+		CMap::save_fields_snapshot(writer, map_layers);
+		writer.write_uint32(static_cast<uint32_t>(wyrmgus::snapshot_section::end));
+	}
+
+	file.close();
+	return SaveGameFile{filepath, file.take_buffer()};
+}
+
+/**
+**  Compress and write a serialized file of a saved game to disk.
+**
+**  The data is written to a temporary file first, which then replaces the
+**  target file, so that an interrupted save never leaves a truncated file behind.
+**
+**  @param save_file  The serialized file.
+**
+**  @return  True if the file was written, or false otherwise.
+*/
+static bool WriteSaveGameFile(const SaveGameFile &save_file)
+{
+	static constexpr size_t chunk_size = 64 * 1024;
+
+	std::filesystem::path temp_path = save_file.Path;
+	temp_path += ".tmp";
+
+	CFile file;
+	if (file.open(temp_path.string().c_str(), CL_WRITE_GZ | CL_OPEN_WRITE) == -1) {
+		fprintf(stderr, "Can't save to '%s'\n", temp_path.string().c_str());
+		return false;
+	}
+
+	for (size_t offset = 0; offset < save_file.Data.size(); offset += chunk_size) {
+		const size_t size = std::min(chunk_size, save_file.Data.size() - offset);
+		if (file.write(save_file.Data.data() + offset, size) <= 0) {
+			fprintf(stderr, "Can't write to '%s'\n", temp_path.string().c_str());
+			file.close();
+			return false;
+		}
+		SaveGameBytesWritten += size;
+	}
+
+	file.close();
+
+	//the file is compressed if zlib is available, in which case the ".gz" extension has been appended to its name
+	std::filesystem::path final_path = save_file.Path;
+	std::filesystem::path temp_path_gz = temp_path;
+	temp_path_gz += ".gz";
+	if (std::filesystem::exists(temp_path_gz)) {
+		temp_path = temp_path_gz;
+		final_path += ".gz";
+	}
+
+	std::error_code error_code;
+	std::filesystem::rename(temp_path, final_path, error_code);
+	if (error_code) {
+		fprintf(stderr, "Can't replace '%s': %s\n", final_path.string().c_str(), error_code.message().c_str());
+		std::filesystem::remove(temp_path, error_code);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+**  Write the serialized files of a saved game to disk, in order.
+**
+**  The Lua file of the saved game comes last, and the snapshots of the previous save under the same name are only removed once it has been replaced, as that save's Lua file refers to them until then.
+**
+**  @return  True if all files were written, or false otherwise.
+*/
+static bool WriteSaveGameFiles(const std::vector<SaveGameFile> &save_files)
+{
+	for (const SaveGameFile &save_file : save_files) {
+		if (!WriteSaveGameFile(save_file)) {
+			return false;
+		}
+	}
+
+	const std::string snapshot_filename = save_files.size() > 1 ? save_files.front().Path.filename().string() : std::string();
+	RemoveSnapshots(save_files.back().Path, snapshot_filename);
+
+	return true;
+}
+
+/**
+**  Serialize the copied state of a saved game and write its files to disk.
+**
+**  @param save_data  The saved game.
+**
+**  @return  True if all files were written, or false otherwise.
+*/
+static bool WriteSaveGame(SaveGameData &save_data)
+{
+	const auto start_time = std::chrono::steady_clock::now();
+
+	std::vector<SaveGameFile> save_files;
+	if (!save_data.SnapshotPath.empty()) {
+		try {
+			save_files.push_back(SaveGameSnapshot(save_data.SnapshotPath, save_data.MapLayers));
+		} catch (const std::exception &exception) {
+			fprintf(stderr, "Can't save the snapshot '%s': %s\n", save_data.SnapshotPath.c_str(), exception.what());
+			return false;
+		}
+		save_data.MapLayers.clear();
+	}
+	save_files.push_back(std::move(save_data.LuaFile));
+
+	size_t bytes_total = 0;
+	for (const SaveGameFile &save_file : save_files) {
+		bytes_total += save_file.Data.size();
+	}
+	SaveGameBytesTotal = bytes_total;
+
+	const bool result = WriteSaveGameFiles(save_files);
+
+	DebugPrint("Saved game serialized and written in %lld ms\n" _C_ static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count()));
+
+	return result;
+}
+
+/**
+**  Wait for the background thread to finish writing the last saved game, if it is still running.
+*/
+static void WaitForSaveGame()
+{
+	if (SaveGameThread.joinable()) {
+		SaveGameThread.join();
+	}
+}
+
+/**
+**  Serialize the copied state of a saved game and write its files to disk on the background thread, while the game keeps running.
+**
+**  @param save_data  The saved game.
+*/
+static void WriteSaveGameInBackground(SaveGameData &&save_data)
+{
+	WaitForSaveGame();
+
+	SaveGameBytesTotal = 0;
+	SaveGameBytesWritten = 0;
+	SaveGameFailed = false;
+	SaveGameFinished = false;
+	SaveGameLastProgress = -1;
+
+	SaveGameThread = std::jthread([save_data = std::move(save_data)]() mutable {
+		SaveGameFailed = !WriteSaveGame(save_data);
+		SaveGameFinished = true;
+	});
+}
+
 /**
 **  Save a game to file.
 **
 **  @param filename  File name to be stored.
 **  @return  -1 if saving failed, 0 if all OK
 **
-**  @note  Later we want to store in a more compact binary format.
+**  @note  The map fields are stored in a binary snapshot next to the Lua file, unless SaveGameBinarySnapshot is false, in which case the whole game is saved as Lua.
+**  The map fields are only copied here, and serialized together with the compression and writing of the files, which may be deferred to the background thread.
+**  The rest of the game state is serialized to Lua here, as it is read through the Lua state, which may only be used by the game loop's thread.
 */
 int SaveGame(const std::string &filename)
 {
+	//a previous save may still be being written to the same files
+	WaitForSaveGame();
+
+	const auto start_time = std::chrono::steady_clock::now();
+
 	CFile file;
 	std::string fullpath(GetSaveDir());
 
 	fullpath += "/";
 	fullpath += filename;
-	if (file.open(fullpath.c_str(), CL_WRITE_GZ | CL_OPEN_WRITE) == -1) {
-		fprintf(stderr, "Can't save to '%s'\n", filename.c_str());
-		return -1;
+
+	SaveGameData save_data;
+
+	std::string snapshot_filename;
+	if (SaveGameBinarySnapshot) {
+		snapshot_filename = GetSnapshotFilename(filename);
+		save_data.SnapshotPath = GetSaveDir() + "/" + snapshot_filename;
+		save_data.MapLayers = CMap::get()->get_fields_snapshot();
 	}
 
+	//serialize the game in memory, so that the game state isn't read while the files are written
+	file.open(fullpath.c_str(), CL_WRITE_MEMORY | CL_OPEN_WRITE);
+
 	time_t now;
 	char dateStr[64];
 
@@ -114,6 +390,8 @@ int SaveGame(const std::string &filename)
 	const struct tm *timeinfo = localtime(&now);
 	strftime(dateStr, sizeof(dateStr), "%c", timeinfo);
 
+	file.printf("local save_directory = ...\n"); //passed by LoadGame, for the map to refer to the snapshot
+
 	// Load initial level // Without units
 	file.printf("local oldCreateUnit = CreateUnit\n");
 	file.printf("local oldSetResourcesHeld = SetResourcesHeld\n");
@@ -166,7 +444,7 @@ int SaveGame(const std::string &filename)
 	SaveUnitTypes(file);
 	SaveUpgrades(file);
 	SavePlayers(file);
-	CMap::get()->Save(file);
+	CMap::get()->Save(file, snapshot_filename);
 	wyrmgus::unit_manager::get()->Save(file);
 	SaveUserInterface(file);
 	SaveAi(file);
@@ -182,9 +460,57 @@ int SaveGame(const std::string &filename)
 	}
 	SaveTriggers(file); //Triggers are saved in SaveGlobal, so load it after Global
 	file.close();
+
+	save_data.LuaFile = SaveGameFile{fullpath, file.take_buffer()};
+
+	DebugPrint("Game state copied and serialized to Lua in %lld ms\n" _C_ static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count()));
+
+	if (SaveGameInBackground) {
+		WriteSaveGameInBackground(std::move(save_data));
+		return 0;
+	}
+
+	if (!WriteSaveGame(save_data)) {
+		return -1;
+	}
+
 	return 0;
 }
 
+/**
+**  Autosave the game.
+**
+**  The game state is copied and serialized to Lua between game cycles, while the map fields are serialized, and the files compressed and written to disk, on the background thread.
+*/
+void RunAutosave()
+{
+	SaveGameInBackground = true;
+	CclCommand("if (RunSaveGame ~= nil) then RunSaveGame(\"autosave.sav\") end;");
+	SaveGameInBackground = false;
+}
+
+/**
+**  Show the progress of the saved game being written on the background thread in the status line.
+*/
+void UpdateSaveGameProgress()
+{
+	if (!SaveGameThread.joinable()) {
+		return;
+	}
+
+	if (SaveGameFinished) {
+		SaveGameThread.join();
+		UI.StatusLine.Set(SaveGameFailed ? _("Autosave failed") : _("Autosave complete"));
+		return;
+	}
+
+	const int progress = SaveGameBytesTotal != 0 ? static_cast<int>(SaveGameBytesWritten * 100 / SaveGameBytesTotal) : 0;
+	if (progress != SaveGameLastProgress) {
+		SaveGameLastProgress = progress;
+		UI.StatusLine.Set(std::string(_("Autosave")) + " " + std::to_string(progress) + "%");
+	}
+}
+
 /**
 **  Delete save game
 **
@@ -197,10 +523,19 @@ void DeleteSaveGame(const std::string &filename)
 		return;
 	}
 
+	WaitForSaveGame();
+
 	std::string fullpath = GetSaveDir() + "/" + filename;
 	if (!std::filesystem::remove(fullpath)) {
 		fprintf(stderr, "delete failed for %s", fullpath.c_str());
 	}
+
+	//also delete the binary snapshot, if the saved game has one
+	std::filesystem::path save_path(fullpath);
+	if (save_path.extension() == ".gz") {
+		save_path.replace_extension();
+	}
+	RemoveSnapshots(save_path, std::string());
 }
 
 void StartSavedGame(const std::string &filename)
@@ -0,0 +1,124 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include "stratagus.h"
+
+#include "game/snapshot.h"
+
+#include "iolib.h"
+
+namespace wyrmgus {
+
+static constexpr char snapshot_magic[8] = {'W', 'Y', 'R', 'M', 'S', 'N', 'A', 'P'};
+
+/**
+**	@brief	The version of the snapshot format, to be increased whenever the layout of the data changes
+*/
+static constexpr uint32_t snapshot_version = 1;
+
+snapshot_writer::snapshot_writer(CFile &file) : file(file)
+{
+	this->buffer.reserve(snapshot_writer::flush_threshold);
+}
+
+snapshot_writer::~snapshot_writer()
+{
+	this->flush();
+}
+
+void snapshot_writer::write_string(const std::string &value)
+{
+	this->write_uint32(static_cast<uint32_t>(value.size()));
+	this->buffer.insert(this->buffer.end(), value.begin(), value.end());
+	this->check_flush();
+}
+
+void snapshot_writer::flush()
+{
+	if (this->buffer.empty()) {
+		return;
+	}
+
+	if (this->file.write(this->buffer.data(), this->buffer.size()) <= 0) {
+		throw std::runtime_error("Failed to write savegame snapshot data.");
+	}
+
+	this->buffer.clear();
+}
+
+snapshot_reader::snapshot_reader(CFile &file)
+{
+	static constexpr size_t read_size = 65536;
+
+	while (true) {
+		const size_t old_size = this->data.size();
+		this->data.resize(old_size + read_size);
+
+		const int read_count = file.read(this->data.data() + old_size, read_size);
+		if (read_count <= 0) {
+			this->data.resize(old_size);
+			break;
+		}
+
+		this->data.resize(old_size + read_count);
+	}
+}
+
+std::string snapshot_reader::read_string()
+{
+	const uint32_t size = this->read_uint32();
+	this->check_remaining(size);
+
+	std::string value(reinterpret_cast<const char *>(this->data.data() + this->position), size);
+	this->position += size;
+	return value;
+}
+
+void write_snapshot_header(snapshot_writer &writer)
+{
+	for (const char c : snapshot_magic) {
+		writer.write_uint8(static_cast<uint8_t>(c));
+	}
+
+	writer.write_uint32(snapshot_version);
+}
+
+void read_snapshot_header(snapshot_reader &reader)
+{
+	for (const char c : snapshot_magic) {
+		if (reader.read_uint8() != static_cast<uint8_t>(c)) {
+			throw std::runtime_error("The file is not a savegame snapshot.");
+		}
+	}
+
+	const uint32_t version = reader.read_uint32();
+	if (version != snapshot_version) {
+		throw std::runtime_error("Unsupported savegame snapshot version: " + std::to_string(version) + ".");
+	}
+}
+
+}
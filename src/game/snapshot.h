@@ -0,0 +1,248 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#pragma once
+
+class CFile;
+
+namespace wyrmgus {
+
+/**
+**	@brief	Writer for binary savegame snapshots
+**
+**	Values are stored in little-endian order, and are gathered in a buffer which is written to the file in bulk.
+*/
+class snapshot_writer final
+{
+public:
+	static constexpr size_t flush_threshold = 65536;
+
+	explicit snapshot_writer(CFile &file);
+	~snapshot_writer();
+
+	void write_uint8(const uint8_t value)
+	{
+		this->buffer.push_back(value);
+		this->check_flush();
+	}
+
+	void write_uint16(const uint16_t value)
+	{
+		this->write_uint8(static_cast<uint8_t>(value));
+		this->write_uint8(static_cast<uint8_t>(value >> 8));
+	}
+
+	void write_uint32(const uint32_t value)
+	{
+		this->write_uint16(static_cast<uint16_t>(value));
+		this->write_uint16(static_cast<uint16_t>(value >> 16));
+	}
+
+	void write_uint64(const uint64_t value)
+	{
+		this->write_uint32(static_cast<uint32_t>(value));
+		this->write_uint32(static_cast<uint32_t>(value >> 32));
+	}
+
+	void write_int16(const int16_t value)
+	{
+		this->write_uint16(static_cast<uint16_t>(value));
+	}
+
+	void write_int32(const int32_t value)
+	{
+		this->write_uint32(static_cast<uint32_t>(value));
+	}
+
+	void write_bool(const bool value)
+	{
+		this->write_uint8(value ? 1 : 0);
+	}
+
+	void write_string(const std::string &value);
+
+	void flush();
+
+private:
+	void check_flush()
+	{
+		if (this->buffer.size() >= snapshot_writer::flush_threshold) {
+			this->flush();
+		}
+	}
+
+	CFile &file;
+	std::vector<uint8_t> buffer;
+};
+
+/**
+**	@brief	Reader for binary savegame snapshots
+**
+**	The whole file is read into memory when the reader is created.
+*/
+class snapshot_reader final
+{
+public:
+	explicit snapshot_reader(CFile &file);
+
+	uint8_t read_uint8()
+	{
+		this->check_remaining(1);
+		return this->data[this->position++];
+	}
+
+	uint16_t read_uint16()
+	{
+		const uint16_t low = this->read_uint8();
+		const uint16_t high = this->read_uint8();
+		return static_cast<uint16_t>(low | (high << 8));
+	}
+
+	uint32_t read_uint32()
+	{
+		const uint32_t low = this->read_uint16();
+		const uint32_t high = this->read_uint16();
+		return low | (high << 16);
+	}
+
+	uint64_t read_uint64()
+	{
+		const uint64_t low = this->read_uint32();
+		const uint64_t high = this->read_uint32();
+		return low | (high << 32);
+	}
+
+	int16_t read_int16()
+	{
+		return static_cast<int16_t>(this->read_uint16());
+	}
+
+	int32_t read_int32()
+	{
+		return static_cast<int32_t>(this->read_uint32());
+	}
+
+	bool read_bool()
+	{
+		return this->read_uint8() != 0;
+	}
+
+	std::string read_string();
+
+	bool is_at_end() const
+	{
+		return this->position == this->data.size();
+	}
+
+private:
+	void check_remaining(const size_t size) const
+	{
+		if (this->data.size() - this->position < size) {
+			throw std::runtime_error("Unexpected end of savegame snapshot data.");
+		}
+	}
+
+	std::vector<uint8_t> data;
+	size_t position = 0;
+};
+
+/**
+**	@brief	Table of the data entries referred to by a savegame snapshot
+**
+**	Entries are referred to by their index in the table, with 0 standing for null, so that each identifier is only stored and looked up once.
+*/
+template <typename T>
+class snapshot_entry_table final
+{
+public:
+	void add_entry(const T *entry)
+	{
+		if (entry == nullptr || this->indexes.contains(entry)) {
+			return;
+		}
+
+		this->entries.push_back(entry);
+		this->indexes[entry] = static_cast<uint32_t>(this->entries.size());
+	}
+
+	uint32_t get_index(const T *entry) const
+	{
+		if (entry == nullptr) {
+			return 0;
+		}
+
+		return this->indexes.find(entry)->second;
+	}
+
+	const T *get_entry(const uint32_t index) const
+	{
+		if (index == 0) {
+			return nullptr;
+		}
+
+		if (index > this->entries.size()) {
+			throw std::runtime_error("Invalid savegame snapshot data entry index: " + std::to_string(index) + ".");
+		}
+
+		return this->entries[index - 1];
+	}
+
+	void write(snapshot_writer &writer) const
+	{
+		writer.write_uint32(static_cast<uint32_t>(this->entries.size()));
+		for (const T *entry : this->entries) {
+			writer.write_string(entry->get_identifier());
+		}
+	}
+
+	void read(snapshot_reader &reader)
+	{
+		const uint32_t count = reader.read_uint32();
+		for (uint32_t i = 0; i < count; ++i) {
+			this->add_entry(T::get(reader.read_string()));
+		}
+	}
+
+private:
+	std::vector<const T *> entries;
+	std::map<const T *, uint32_t> indexes;
+};
+
+/**
+**	@brief	The sections a savegame snapshot can contain, in the order in which they are written
+**
+**	The snapshot holds the map fields, which are the bulk of a late-game save; the rest of the game state is saved in the Lua savegame referring to the snapshot.
+*/
+enum class snapshot_section : uint32_t {
+	map_fields = 1,
+	end = 0xFFFFFFFF
+};
+
+extern void write_snapshot_header(snapshot_writer &writer);
+extern void read_snapshot_header(snapshot_reader &reader);
+
+}
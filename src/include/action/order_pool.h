@@ -0,0 +1,90 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+namespace wyrmgus {
+
+//a pool for the memory of unit orders, which are created and destroyed very frequently
+//blocks are grouped in size classes, each with its own free list, so that each order type effectively gets a free list of its own; the memory is reused but never returned to the system, so orders destroyed during static destruction at exit are still safe
+//the pool is only used by the game logic thread
+class order_pool final
+{
+public:
+	static constexpr size_t size_class_granularity = 16;
+	static constexpr size_t max_pooled_size = 512; //orders larger than this are allocated normally
+	static constexpr size_t size_class_count = max_pooled_size / size_class_granularity;
+	static constexpr size_t blocks_per_chunk = 64;
+
+	struct statistics final
+	{
+		unsigned long long allocations = 0;
+		unsigned long long reused_allocations = 0; //allocations served from the free list
+		size_t live_blocks = 0;
+		size_t reserved_blocks = 0;
+	};
+
+	static void *allocate(const size_t size);
+	static void deallocate(void *ptr, const size_t size);
+
+	static const statistics &get_size_class_statistics(const size_t size_class)
+	{
+		return order_pool::size_class_statistics[size_class];
+	}
+
+	static statistics get_total_statistics();
+	static size_t get_reserved_bytes();
+
+private:
+	static size_t get_size_class(const size_t size)
+	{
+		return (size + size_class_granularity - 1) / size_class_granularity - 1;
+	}
+
+	static size_t get_block_size(const size_t size_class)
+	{
+		return (size_class + 1) * size_class_granularity;
+	}
+
+	static void allocate_chunk(const size_t size_class);
+
+private:
+	struct free_block final
+	{
+		free_block *next = nullptr;
+	};
+
+	static inline free_block *free_lists[size_class_count] = {};
+	static inline statistics size_class_statistics[size_class_count];
+	static inline statistics large_order_statistics; //orders too large to be pooled
+};
+
+}
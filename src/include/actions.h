@@ -107,6 +107,10 @@ public:
 	{
 	}
 
+	//orders of all types are allocated from the order pool; as the destructor is virtual, the size passed to the deallocation function is that of the order's actual type
+	static void *operator new(const size_t size);
+	static void operator delete(void *ptr, const size_t size);
+
 	virtual std::unique_ptr<COrder> Clone() const = 0;
 	virtual void Execute(CUnit &unit) = 0;
 
@@ -42,6 +42,7 @@ struct lua_State;
 
 namespace wyrmgus {
 	class animation_set;
+	class spell;
 }
 
 /**
@@ -88,6 +89,71 @@ enum SetVar_ModifyTypes {
 	modNot,          /// Bitwise NOT
 };
 
+/**
+**  An integer operand of an animation.
+**
+**  The operand is written as text in the animation definition, and resolved into its type and indices
+**  when the animation set is initialized, so that evaluating it doesn't require parsing the text.
+*/
+class CAnimationOperand
+{
+public:
+	/// The field of a unit variable used by an animation
+	enum class VariableField {
+		None,
+		Value,
+		Max,
+		Increase,
+		Enable,
+		Percent
+	};
+
+	static VariableField GetVariableField(const std::string &name);
+
+	CAnimationOperand()
+	{
+	}
+
+	explicit CAnimationOperand(const std::string &str) : Str(str)
+	{
+	}
+
+	const std::string &GetString() const
+	{
+		return this->Str;
+	}
+
+	void Resolve();
+	int Evaluate(const CUnit &unit) const;
+
+private:
+	void Resolve(const std::string &str);
+
+	enum class OperandType {
+		Unresolved,
+		Constant,
+		Variable,       /// A unit variable
+		ResourcesHeld,  /// The resources held by the unit
+		ResourceActive, /// Whether the unit is actively gathering resources
+		InsideCount,    /// The number of units inside the unit
+		Distance,       /// The distance between the unit and the goal of its current order
+		BoolFlag,       /// A bool flag of the unit's type
+		CurrentSpell,   /// Whether the unit is casting the spell
+		AutocastSpell,  /// Whether the unit has the spell set to autocast
+		Random,         /// A random value between the minimum and maximum (inclusive)
+		PlayerIndex     /// The index of the unit's player
+	};
+
+	std::string Str;
+	OperandType Type = OperandType::Unresolved;
+	bool OfGoal = false;                  /// Whether the operand applies to the goal of the unit's current order instead of the unit itself
+	int Index = -1;                       /// The index of the variable or bool flag
+	VariableField Field = VariableField::None;
+	int Value = 0;                        /// The value of a constant, or the minimum of a random value
+	int MaxValue = 0;                     /// The maximum of a random value
+	const wyrmgus::spell *Spell = nullptr;
+};
+
 class CAnimation
 {
 public:
@@ -105,6 +171,11 @@ public:
 		Q_UNUSED(l)
 	}
 
+	/// Resolve the operands of the animation, called when its animation set is initialized
+	virtual void initialize()
+	{
+	}
+
 	CAnimation *get_next() const
 	{
 		return this->next_ptr;
@@ -193,6 +264,6 @@ extern int UnitShowAnimationScaled(CUnit &unit, const CAnimation *anim, int scal
 extern int UnitShowAnimation(CUnit &unit, const CAnimation *anim);
 
 extern int ParseAnimInt(const CUnit &unit, const char *parseint);
-extern int ParseAnimFlags(const CUnit &unit, const char *parseflag);
+extern int ParseAnimFlags(AnimationType type, const std::string &parseflag);
 
 extern void FindLabelLater(CAnimation **anim, const std::string &name);
@@ -38,13 +38,14 @@ public:
 
 	virtual void Action(CUnit &unit, int &move, int scale) const;
 	virtual void Init(const char *s, lua_State *l);
+	virtual void initialize();
 
 private:
 	typedef bool BinOpFunc(int lhs, int rhs);
 
 private:
-	std::string leftVar;
-	std::string rightVar;
+	CAnimationOperand leftVar;
+	CAnimationOperand rightVar;
 	BinOpFunc *binOpFunc;
 	CAnimation *gotoLabel;
 };
@@ -38,10 +38,15 @@ public:
 
 	virtual void Action(CUnit &unit, int &move, int scale) const;
 	virtual void Init(const char *s, lua_State *l);
+	virtual void initialize();
 
 private:
 	SetVar_ModifyTypes mod;
 	std::string varStr;
 	std::string valueStr;
 	std::string unitSlotStr;
+	bool damageType = false;  /// Whether the damage type of the unit's type is set, instead of a variable
+	int varIndex = -1;
+	CAnimationOperand::VariableField varField = CAnimationOperand::VariableField::None;
+	CAnimationOperand valueOperand;
 };
@@ -31,6 +31,10 @@
 
 #include "animation.h"
 
+namespace wyrmgus {
+	class missile_type;
+}
+
 //SpawnMissile flags
 enum SpawnMissile_Flags {
 	SM_None = 0,           /// Clears all flags
@@ -50,13 +54,16 @@ public:
 
 	virtual void Action(CUnit &unit, int &move, int scale) const override;
 	virtual void Init(const char *s, lua_State *l) override;
+	virtual void initialize() override;
 
 private:
 	std::string missileTypeStr;
-	std::string startXStr;
-	std::string startYStr;
-	std::string destXStr;
-	std::string destYStr;
+	wyrmgus::missile_type *missileType = nullptr;
+	CAnimationOperand startXOperand;
+	CAnimationOperand startYOperand;
+	CAnimationOperand destXOperand;
+	CAnimationOperand destYOperand;
 	std::string flagsStr;
-	std::string offsetNumStr;
+	int flags = SM_None;
+	CAnimationOperand offsetNumOperand;
 };
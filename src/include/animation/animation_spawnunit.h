@@ -31,6 +31,10 @@
 
 #include "animation.h"
 
+namespace wyrmgus {
+	class unit_type;
+}
+
 //SpawnUnit flags
 enum SpawnUnit_Flags {
 	SU_None = 0,           /// Clears all flags
@@ -45,12 +49,15 @@ public:
 
 	virtual void Action(CUnit &unit, int &move, int scale) const;
 	virtual void Init(const char *s, lua_State *l);
+	virtual void initialize();
 
 private:
 	std::string unitTypeStr;
-	std::string offXStr;
-	std::string offYStr;
-	std::string rangeStr;
-	std::string playerStr;
+	wyrmgus::unit_type *unitType = nullptr;
+	CAnimationOperand offXOperand;
+	CAnimationOperand offYOperand;
+	CAnimationOperand rangeOperand;
+	CAnimationOperand playerOperand;
 	std::string flagsStr;
+	int flags = SU_None;
 };
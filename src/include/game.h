@@ -85,7 +85,11 @@ class CGraphic;
 extern void LoadGame(const std::string &filename); /// Load saved game
 extern int SaveGame(const std::string &filename); /// Save game
 extern void DeleteSaveGame(const std::string &filename);
+extern void RunAutosave();                   /// Autosave the game, writing it to disk on a background thread
+extern void UpdateSaveGameProgress();        /// Show the progress of the background autosave in the status line
+extern void LoadMapFieldsSnapshot(const std::string &save_directory, const std::string &snapshot_filename); /// Load the map fields of the saved game being loaded from its snapshot
 extern bool SaveGameLoading;                 /// Save game is in progress of loading
+extern bool SaveGameBinarySnapshot;          /// Whether the bulk of saved games is stored in a binary snapshot, instead of only as Lua
 
 extern void InitModules();              /// Initialize all modules
 extern void LuaRegisterModules();       /// Register lua script of each modules
@@ -102,6 +102,10 @@ public:
 	int read(void *buf, size_t len);
 	int seek(long offset, int whence);
 	long tell();
+	int write(const void *buf, size_t len);
+	int write_int(const int64_t value);
+	int write_string(const std::string_view &str);
+	std::string take_buffer();
 
 	int printf(const char *format, ...) PRINTF_VAARG_ATTRIBUTE(2, 3); // Don't forget to count this
 private:
@@ -117,13 +121,15 @@ enum {
 	CLF_TYPE_PLAIN,    /// plain text file handle
 	CLF_TYPE_GZIP,     /// gzip file handle
 	CLF_TYPE_BZIP2,    /// bzip2 file handle
-	CLF_TYPE_PHYSFS    /// physfs file handle
+	CLF_TYPE_PHYSFS,   /// physfs file handle
+	CLF_TYPE_MEMORY    /// in-memory buffer handle
 };
 
 #define CL_OPEN_READ 0x1
 #define CL_OPEN_WRITE 0x2
 #define CL_WRITE_GZ 0x4
 #define CL_WRITE_BZ2 0x8
+#define CL_WRITE_MEMORY 0x10
 
 /// Build library path name
 extern std::string LibraryFileName(const char *file);
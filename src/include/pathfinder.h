@@ -234,6 +234,8 @@ extern void FreePathfinder();
 
 /// Returns the next element of the path
 extern int NextPathElement(CUnit &unit, short int *xdp, short int *ydp);
+/// Calculate new paths for a batch of path finder data in parallel
+extern std::vector<int> NewPathBatch(const std::vector<PathFinderData *> &batch);
 /// Return distance to unit.
 //Wyrmgus start
 //extern int UnitReachable(const CUnit &unit, const CUnit &dst, int range);
@@ -269,4 +271,11 @@ extern int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, in
 						 //Wyrmgus end
 //Wyrmgus end
 
+/// Start or stop recording the calls to AStarFindPath
+extern void SetAStarQueryRecording(bool recording);
+/// Replay the recorded calls to AStarFindPath, comparing the heap open set with the legacy sorted array one
+extern void BenchmarkAStarQueries(int iterations);
+/// Calculate the paths of the moving units one after another and as a batch, comparing the results
+extern void BenchmarkNewPathBatch(int iterations);
+
 extern void PathfinderCclRegister();
@@ -224,6 +224,127 @@ struct UnitDesc;
 */
 struct StringDesc;
 
+/**
+**  Player property of a PlayerData number description.
+*/
+enum class PlayerDataProperty {
+	None,
+	RaceName,
+	Resources,
+	StoredResources,
+	MaxResources,
+	Incomes,
+	//Wyrmgus start
+	Prices,
+	ResourceDemand,
+	StoredResourceDemand,
+	EffectiveResourceDemand,
+	EffectiveResourceBuyPrice,
+	EffectiveResourceSellPrice,
+	TradeCost,
+	//Wyrmgus end
+	UnitTypesCount,
+	UnitTypesUnderConstructionCount,
+	UnitTypesAiActiveCount,
+	AiEnabled,
+	TotalNumUnits,
+	NumBuildings,
+	//Wyrmgus start
+	NumBuildingsUnderConstruction,
+	//Wyrmgus end
+	Supply,
+	Demand,
+	UnitLimit,
+	BuildingLimit,
+	TotalUnitLimit,
+	Score,
+	TotalUnits,
+	TotalBuildings,
+	TotalResources,
+	TotalRazings,
+	TotalKills,
+	Population,
+	Overlord,
+	TopOverlord
+};
+
+/**
+**  Value outside of a description which the description's evaluation depends on.
+*/
+struct DescReference {
+	enum class Kind {
+		Unit,
+		UnitType,
+		Upgrade,
+		Faction,
+		Resource,
+		Player
+	};
+
+	const void *GetValue() const;
+
+	Kind kind = Kind::Unit;
+	const void *Address = nullptr; /// Address of the referenced pointer.
+};
+
+/**
+**  Parts of the game state which descriptions depend on.
+**
+**  Memoized description results are invalidated when a part of the game state they depend on changes.
+*/
+enum DescDependency : unsigned int {
+	DescDependency_None = 0,
+	DescDependency_Players = 1 << 0,  /// The civilization, faction and diplomacy of the players the description refers to, tracked per player.
+	DescDependency_Upgrades = 1 << 1, /// The upgrades of players, which modify unit type stats.
+	DescDependency_Other = 1 << 2,    /// State whose changes aren't tracked, so that the result is only reused within a draw pass.
+	DescDependency_All = DescDependency_Players | DescDependency_Upgrades | DescDependency_Other
+};
+
+/**
+**  Key of a memoized string description result.
+**
+**  The unit and player values a description reads are part of its key, so that the result is reused until one of them changes.
+*/
+struct StringDescMemoKey {
+	std::vector<const void *> References; /// Values of the references.
+	std::vector<int> Numbers;             /// Values of the unit stats and player data read by the description.
+	std::vector<std::string> Strings;     /// Values of the unit and player names read by the description.
+	std::vector<unsigned long> PlayerGenerations; /// Generations of the players the description refers to.
+
+	bool operator==(const StringDescMemoKey &other) const = default;
+};
+
+/**
+**  Memoized evaluation of a string description.
+**
+**  The result is reused across draw passes, until the values referenced by the description or the parts of the game state it depends on change.
+*/
+struct StringDescMemo {
+	bool Analyzed = false;     /// Whether the description tree has been analyzed.
+	bool Memoizable = false;   /// False if the description calls Lua or uses random numbers.
+	bool ReferencesUnit = false; /// Whether the description refers to units.
+	std::vector<DescReference> References; /// The values referenced by the description tree.
+	std::vector<const NumberDesc *> KeyNumbers; /// The unit stats and player data in the description tree.
+	std::vector<const StringDesc *> KeyStrings; /// The unit and player names in the description tree.
+	unsigned int Dependencies = DescDependency_None; /// The parts of the game state the description depends on.
+	bool HasResult = false;    /// Whether a result has been memoized.
+	unsigned long Generation = 0; /// Generation of the depended on game state when the result was evaluated.
+	StringDescMemoKey Key;     /// Key when the result was evaluated.
+	std::string Result;        /// The memoized result.
+};
+
+/**
+**  Scope during which string description evaluations are memoized.
+**
+**  Game state does not change while the display is drawn, so a description evaluated several times in one pass, e.g. to measure and then draw a popup, needs only be evaluated once. Descriptions depending only on tracked game state keep their results across passes.
+*/
+class DescMemoizationScope final
+{
+public:
+	DescMemoizationScope();
+	~DescMemoizationScope();
+};
+
 /// for Bin operand  a ?? b
 struct BinOp {
 	std::unique_ptr<NumberDesc> Left;           /// Left operand.
@@ -275,6 +396,11 @@ struct NumberDesc {
 			std::unique_ptr<NumberDesc> Player; /// Number of player
 			std::unique_ptr<StringDesc> DataType; /// Player's data
 			std::unique_ptr<StringDesc> ResType;  /// Resource type
+			//compiled form of constant data and resource types, resolved on first evaluation
+			mutable bool Compiled = false;
+			mutable PlayerDataProperty Property = PlayerDataProperty::None;
+			mutable const wyrmgus::resource *Resource = nullptr;
+			mutable const wyrmgus::unit_type *UnitType = nullptr;
 		} PlayerData; /// conditional string.
 	} D;
 };
@@ -327,6 +453,7 @@ struct StringDesc {
 		} Line; /// For specific line.
 		std::unique_ptr<NumberDesc> PlayerName;  /// Player name.
 	} D;
+	mutable StringDescMemo Memo; /// Memoized result.
 };
 
 /*----------------------------------------------------------------------------
@@ -407,3 +534,5 @@ std::unique_ptr<StringDesc> CclParseStringDesc(lua_State *l);        /// Parse a
 extern int EvalNumber(const NumberDesc *numberdesc); /// Evaluate the number.
 extern CUnit *EvalUnit(const UnitDesc *unitdesc);    /// Evaluate the unit.
 std::string EvalString(const StringDesc *s);         /// Evaluate the string.
+extern void InvalidateDescMemos(const unsigned int dependencies); /// Invalidate the memoized descriptions depending on game state which changed.
+extern void InvalidatePlayerDescMemos(const CPlayer &player); /// Invalidate the memoized descriptions referring to a player whose state changed.
@@ -70,6 +70,8 @@ extern void UpgradeAcquire(CPlayer &player, const CUpgrade *upgrade);
 extern void UpgradeLost(CPlayer &player, int id);
 /// Apply researched upgrades when map is loading
 extern void ApplyUpgrades();
+/// Benchmark applying and removing the upgrade modifiers for the players in the loaded game
+extern void BenchmarkUpgradeModifiers();
 
 extern void ApplyIndividualUpgradeModifier(CUnit &unit, const wyrmgus::upgrade_modifier *um); /// Apply upgrade modifier of an individual upgrade
 //Wyrmgus start
@@ -73,6 +73,34 @@ public:
 	}
 
 	bool applies_to(const unit_type *unit_type) const;
+
+	void build_indexes() const;
+
+	//the non-template unit types the modifier applies to, in slot order
+	const std::vector<unit_type *> &get_affected_unit_types() const
+	{
+		this->check_indexes();
+		return this->affected_unit_types;
+	}
+
+	//the slots of the non-template unit types whose allowance the modifier changes, in order
+	const std::vector<int> &get_changed_unit_slots() const
+	{
+		this->check_indexes();
+		return this->changed_unit_slots;
+	}
+
+	//the IDs of the upgrades whose allowance the modifier changes, in order
+	const std::vector<int> &get_changed_upgrade_ids() const
+	{
+		this->check_indexes();
+		return this->changed_upgrade_ids;
+	}
+
+private:
+	void check_indexes() const;
+
+public:
 	
 	int GetUnitStock(unit_type *unit_type) const;
 	void SetUnitStock(unit_type *unit_type, int quantity);
@@ -94,6 +122,10 @@ public:
 private:
 	std::vector<unit_type *> unit_types; //which unit types are affected
 	std::vector<unit_class *> unit_classes; //which unit classes are affected
+	mutable std::vector<unit_type *> affected_unit_types; //index of the unit types the modifier applies to
+	mutable std::vector<int> changed_unit_slots;
+	mutable std::vector<int> changed_upgrade_ids;
+	mutable size_t indexed_unit_type_count = static_cast<size_t>(-1); //the number of unit types when the indexes were built
 
 public:
 	unit_type *ConvertTo = nullptr;			/// convert to this unit-type.
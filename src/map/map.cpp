@@ -47,6 +47,8 @@
 #include "map/terrain_type.h"
 #include "map/tile.h"
 #include "map/tileset.h"
+#include "pathfinder/flow_field_cache.h"
+#include "pathfinder/hierarchical_pathfinder.h"
 #include "plane.h"
 #include "player.h"
 //Wyrmgus start
@@ -208,8 +210,14 @@ void CMap::Reveal(bool only_person_players)
 			wyrmgus::tile &mf = *this->Field(i, z);
 			const std::unique_ptr<wyrmgus::tile_player_info> &player_info = mf.player_info;
 			for (int p = 0; p < PlayerMax; ++p) {
+				//player slots which are not in the game get no visibility plane
+				if (CPlayer::Players[p]->Type == PlayerNobody) {
+					continue;
+				}
+
 				if (CPlayer::Players[p]->Type == PlayerPerson || !only_person_players) {
-					player_info->Visible[p] = std::max<unsigned short>(1, player_info->Visible[p]);
+					unsigned short &visible = player_info->get_visible_ref(p);
+					visible = std::max<unsigned short>(1, visible);
 				}
 			}
 			MarkSeenTile(mf);
@@ -1580,9 +1588,10 @@ void CMap::ClearMapLayers()
 /**
 ** Save the complete map.
 **
-** @param file Output file.
+** @param file                      Output file.
+** @param fields_snapshot_filename  Name of the savegame snapshot file the map fields have been saved to, if any; it is in the same directory as the output file.
 */
-void CMap::Save(CFile &file) const
+void CMap::Save(CFile &file, const std::string &fields_snapshot_filename) const
 {
 	file.printf("\n--- -----------------------------------------\n");
 	file.printf("--- MODULE: map\n");
@@ -1617,15 +1626,22 @@ void CMap::Save(CFile &file) const
 	file.printf("  },\n");
 	file.printf("  \"landmasses\", {\n");
 	for (int i = 1; i <= this->Landmasses; ++i) {
-		file.printf("  {");
+		file.write_string("  {");
 		for (size_t j = 0; j < this->BorderLandmasses[i].size(); ++j) {
-			file.printf("%d, ", this->BorderLandmasses[i][j]);
+			file.write_int(this->BorderLandmasses[i][j]);
+			file.write_string(", ");
 		}
-		file.printf("},\n");
+		file.write_string("},\n");
 	}
 	file.printf("  },\n");
 	//Wyrmgus end
 
+	if (!fields_snapshot_filename.empty()) {
+		file.printf("  \"map-fields-snapshot\", {save_directory, \"%s\"},\n", fields_snapshot_filename.c_str());
+		file.printf("}})\n");
+		return;
+	}
+
 	file.printf("  \"map-fields\", {\n");
 	//Wyrmgus start
 	/*
@@ -1644,26 +1660,138 @@ void CMap::Save(CFile &file) const
 	}
 	*/
 	for (size_t z = 0; z < this->MapLayers.size(); ++z) {
-		file.printf("  {\n");
+		//bring the values of decaying and regenerating tiles up to date, as they are only updated when their timers are due
+		this->MapLayers[z]->update_timed_tile_values();
+
+		file.write_string("  {\n");
 		for (int h = 0; h < this->Info.MapHeights[z]; ++h) {
-			file.printf("  -- %d\n", h);
+			file.write_string("  -- ");
+			file.write_int(h);
+			file.write_string("\n");
 			for (int w = 0; w < this->Info.MapWidths[z]; ++w) {
 				const wyrmgus::tile &mf = *this->Field(w, h, z);
 
 				mf.Save(file);
 				if (w & 1) {
-					file.printf(",\n");
+					file.write_string(",\n");
 				} else {
-					file.printf(", ");
+					file.write_string(", ");
 				}
 			}
 		}
-		file.printf("  },\n");
+		file.write_string("  },\n");
 	}
 	//Wyrmgus end
 	file.printf("}})\n");
 }
 
+/**
+**	@brief	Copy the map fields which are stored in a savegame snapshot
+**
+**	This must be done between game cycles, while the copy can be saved to the snapshot on another thread.
+**
+**	@return	The copies of the map layers.
+*/
+std::vector<wyrmgus::map_layer_snapshot> CMap::get_fields_snapshot() const
+{
+	std::vector<wyrmgus::map_layer_snapshot> map_layers(this->MapLayers.size());
+
+	for (size_t z = 0; z < this->MapLayers.size(); ++z) {
+		//bring the values of decaying and regenerating tiles up to date, as they are only updated when their timers are due
+		this->MapLayers[z]->update_timed_tile_values();
+
+		wyrmgus::map_layer_snapshot &map_layer = map_layers[z];
+		map_layer.width = this->Info.MapWidths[z];
+		map_layer.height = this->Info.MapHeights[z];
+
+		const int tile_count = map_layer.width * map_layer.height;
+		map_layer.tiles.reserve(tile_count);
+		for (int i = 0; i < tile_count; ++i) {
+			map_layer.tiles.push_back(this->MapLayers[z]->Field(i)->get_snapshot());
+		}
+	}
+
+	return map_layers;
+}
+
+/**
+**	@brief	Save copied map fields to a savegame snapshot
+**
+**	@param	writer		The snapshot writer.
+**	@param	map_layers	The copies of the map layers.
+*/
+void CMap::save_fields_snapshot(wyrmgus::snapshot_writer &writer, const std::vector<wyrmgus::map_layer_snapshot> &map_layers)
+{
+	wyrmgus::tile_snapshot_tables tables;
+
+	for (const wyrmgus::map_layer_snapshot &map_layer : map_layers) {
+		for (const wyrmgus::tile_snapshot &field : map_layer.tiles) {
+			field.add_entries(tables);
+		}
+	}
+
+	writer.write_uint32(static_cast<uint32_t>(wyrmgus::snapshot_section::map_fields));
+
+	tables.terrain_types.write(writer);
+	tables.terrain_features.write(writer);
+	tables.settlements.write(writer);
+
+	writer.write_uint32(static_cast<uint32_t>(map_layers.size()));
+	for (const wyrmgus::map_layer_snapshot &map_layer : map_layers) {
+		writer.write_int32(map_layer.width);
+		writer.write_int32(map_layer.height);
+
+		for (const wyrmgus::tile_snapshot &field : map_layer.tiles) {
+			field.save(writer, tables);
+		}
+	}
+}
+
+/**
+**	@brief	Load the map fields from a savegame snapshot
+**
+**	The map layers must already have been created with the sizes they had when the snapshot was saved.
+**
+**	@param	reader	The snapshot reader.
+*/
+void CMap::load_fields_snapshot(wyrmgus::snapshot_reader &reader)
+{
+	if (reader.read_uint32() != static_cast<uint32_t>(wyrmgus::snapshot_section::map_fields)) {
+		throw std::runtime_error("The savegame snapshot doesn't start with the map fields section.");
+	}
+
+	wyrmgus::tile_snapshot_tables tables;
+	tables.terrain_types.read(reader);
+	tables.terrain_features.read(reader);
+	tables.settlements.read(reader);
+
+	const uint32_t map_layer_count = reader.read_uint32();
+	if (map_layer_count != this->MapLayers.size()) {
+		throw std::runtime_error("The savegame snapshot has " + std::to_string(map_layer_count) + " map layers, while the map has " + std::to_string(this->MapLayers.size()) + ".");
+	}
+
+	for (size_t z = 0; z < this->MapLayers.size(); ++z) {
+		const std::unique_ptr<CMapLayer> &map_layer = this->MapLayers[z];
+
+		const int width = reader.read_int32();
+		const int height = reader.read_int32();
+		if (width != this->Info.MapWidths[z] || height != this->Info.MapHeights[z]) {
+			throw std::runtime_error("The size of map layer " + std::to_string(z) + " in the savegame snapshot doesn't match that of the map.");
+		}
+
+		const int tile_count = width * height;
+		for (int i = 0; i < tile_count; ++i) {
+			wyrmgus::tile &mf = *map_layer->Field(i);
+			mf.load_snapshot(reader, tables);
+			if (mf.is_destroyed_tree_tile()) {
+				map_layer->add_destroyed_tree_tile(map_layer->GetPosFromIndex(i));
+			} else if (mf.get_overlay_terrain() != nullptr && mf.OverlayTerrainDestroyed) {
+				map_layer->add_destroyed_overlay_terrain_tile(map_layer->GetPosFromIndex(i));
+			}
+		}
+	}
+}
+
 /*----------------------------------------------------------------------------
 -- Map Tile Update Functions
 ----------------------------------------------------------------------------*/
@@ -1811,6 +1939,14 @@ void CMap::SetTileTerrain(const Vec2i &pos, const wyrmgus::terrain_type *terrain
 	}
 	
 	mf.SetTerrain(terrain);
+
+	if (terrain->is_overlay() || mf.get_overlay_terrain() == nullptr) {
+		//the destroyed overlay terrain of the tile has been replaced or removed
+		this->MapLayers[z]->cancel_tile_timers(pos);
+	}
+
+	wyrmgus::hierarchical_pathfinder::get()->on_tile_passability_changed(pos, z);
+	wyrmgus::flow_field_cache::get()->on_tile_passability_changed(pos, z);
 	
 	if (terrain->is_overlay()) {
 		//remove decorations if the overlay terrain has changed
@@ -1873,6 +2009,10 @@ void CMap::RemoveTileOverlayTerrain(const Vec2i &pos, int z)
 	}
 	
 	mf.RemoveOverlayTerrain();
+	this->MapLayers[z]->cancel_tile_timers(pos);
+
+	wyrmgus::hierarchical_pathfinder::get()->on_tile_passability_changed(pos, z);
+	wyrmgus::flow_field_cache::get()->on_tile_passability_changed(pos, z);
 	
 	this->CalculateTileTransitions(pos, true, z);
 	
@@ -1920,7 +2060,6 @@ void CMap::SetOverlayTerrainDestroyed(const Vec2i &pos, bool destroyed, int z)
 		if (mf.get_overlay_terrain()->Flags & MapFieldForest) {
 			mf.Flags &= ~(MapFieldForest | MapFieldUnpassable);
 			mf.Flags |= MapFieldStumps;
-			map_layer->destroyed_tree_tiles.push_back(pos);
 		} else {
 			if (mf.get_overlay_terrain()->Flags & MapFieldRocks) {
 				mf.Flags &= ~(MapFieldRocks | MapFieldUnpassable);
@@ -1932,18 +2071,27 @@ void CMap::SetOverlayTerrainDestroyed(const Vec2i &pos, bool destroyed, int z)
 					mf.Flags &= ~(MapFieldAirUnpassable);
 				}
 			}
-
-			map_layer->destroyed_overlay_terrain_tiles.push_back(pos);
 		}
 
 		mf.set_value(0);
+
+		if (mf.Flags & MapFieldStumps) {
+			map_layer->add_destroyed_tree_tile(pos);
+		} else {
+			map_layer->add_destroyed_overlay_terrain_tile(pos);
+		}
 	} else {
+		map_layer->cancel_tile_timers(pos);
+
 		if (mf.Flags & MapFieldStumps) { //if is a cleared tree tile regrowing trees
 			mf.Flags &= ~(MapFieldStumps);
 			mf.Flags |= MapFieldForest | MapFieldUnpassable;
 			mf.set_value(mf.get_overlay_terrain()->get_resource()->get_default_amount());
 		}
 	}
+
+	wyrmgus::hierarchical_pathfinder::get()->on_tile_passability_changed(pos, z);
+	wyrmgus::flow_field_cache::get()->on_tile_passability_changed(pos, z);
 	
 	if (destroyed) {
 		if (mf.get_overlay_terrain()->get_destroyed_tiles().size() > 0) {
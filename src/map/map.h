@@ -86,8 +86,11 @@ namespace wyrmgus {
 	class faction;
 	class generated_terrain;
 	class map_template;
+	class map_layer_snapshot;
 	class plane;
 	class site;
+	class snapshot_reader;
+	class snapshot_writer;
 	class terrain_type;
 	class tile;
 	class unit_type;
@@ -248,7 +251,10 @@ public:
 	void Reveal(bool only_person_players = false);
 	//Wyrmgus end
 	/// Save the map.
-	void Save(CFile &file) const;
+	void Save(CFile &file, const std::string &fields_snapshot_filename = "") const;
+	std::vector<wyrmgus::map_layer_snapshot> get_fields_snapshot() const;
+	static void save_fields_snapshot(wyrmgus::snapshot_writer &writer, const std::vector<wyrmgus::map_layer_snapshot> &map_layers);
+	void load_fields_snapshot(wyrmgus::snapshot_reader &reader);
 
 	//
 	// Wall
@@ -410,6 +416,27 @@ extern MapMarkerFunc MapUnmarkTileDetectEthereal;
 /// Mark sight changes
 extern void MapSight(const CPlayer &player, const Vec2i &pos, int w,
 					 int h, int range, MapMarkerFunc *marker, int z);
+/// Mark the sight changes of a unit moving to a nearby position, touching only the tiles which came into or left its sight
+extern void MapSightMove(const CPlayer &player, const Vec2i &old_pos, const Vec2i &new_pos, int w,
+						 int h, int range, MapMarkerFunc *marker, MapMarkerFunc *unmarker, int z);
+
+/// Numbers of sight updates and of the tiles they touched
+class MapSightStatistics
+{
+public:
+	unsigned long FullUpdates = 0;        /// sight areas (un)marked as a whole
+	unsigned long IncrementalUpdates = 0; /// sight areas updated by their changes only
+	unsigned long TilesTouched = 0;       /// tiles (un)marked by the updates
+};
+
+/// Get the sight statistics of the last complete game cycle
+extern const MapSightStatistics &GetLastCycleMapSightStatistics();
+/// Get the sight statistics accumulated since the start of the game
+extern const MapSightStatistics &GetTotalMapSightStatistics();
+/// Reset the sight statistics
+extern void ResetMapSightStatistics();
+/// Compare the sight calculation with the precomputed lines against walking the lines on the map
+extern void BenchmarkMapSight(int range, int step);
 /// Update fog of war
 extern void UpdateFogOfWarChange();
 
@@ -507,6 +534,8 @@ extern void SetSeasonSchedule(const std::string &season_schedule_ident, int z =
 void MapMarkUnitSight(CUnit &unit);
 /// Unmark on vision table the Sight of the unit.
 void MapUnmarkUnitSight(CUnit &unit);
+/// Update on vision table the Sight of a unit which has moved from a nearby position.
+void MapMoveUnitSight(CUnit &unit, const Vec2i &old_pos);
 
 /// Can a unit with 'mask' enter the field
 extern bool CanMoveToMask(const Vec2i &pos, int mask, int z);
@@ -47,6 +47,8 @@
 #include "video/intern_video.h"
 #include "video/video.h"
 
+#include <chrono>
+
 
 int FogOfWarOpacity;                 /// Fog of war Opacity.
 uint32_t FogOfWarColorSDL;
@@ -252,7 +254,7 @@ void MapMarkTileSight(const CPlayer &player, const unsigned int index, int z)
 //	wyrmgus::tile &mf = *CMap::Map.Field(index);
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
 	//Wyrmgus end
-	unsigned short *v = &(mf.player_info->Visible[player.Index]);
+	unsigned short *v = &mf.player_info->get_visible_ref(player.Index);
 	if (*v == 0 || *v == 1) { // Unexplored or unseen
 		// When there is no fog only unexplored tiles are marked.
 		if (!CMap::Map.NoFogOfWar || *v == 0) {
@@ -295,7 +297,7 @@ void MapUnmarkTileSight(const CPlayer &player, const unsigned int index, int z)
 //	wyrmgus::tile &mf = *CMap::Map.Field(index);
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
 	//Wyrmgus end
-	unsigned short *v = &mf.player_info->Visible[player.Index];
+	unsigned short *v = &mf.player_info->get_visible_ref(player.Index);
 	switch (*v) {
 		case 0:  // Unexplored
 		case 1:
@@ -343,7 +345,7 @@ void MapMarkTileDetectCloak(const CPlayer &player, const unsigned int index, int
 //	wyrmgus::tile &mf = *CMap::Map.Field(index);
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
 	//Wyrmgus end
-	unsigned char *v = &mf.player_info->VisCloak[player.Index];
+	unsigned char *v = &mf.player_info->get_vis_cloak_ref(player.Index);
 	if (*v == 0) {
 		//Wyrmgus start
 //		UnitsOnTileMarkSeen(player, mf, 1);
@@ -380,7 +382,7 @@ void MapUnmarkTileDetectCloak(const CPlayer &player, const unsigned int index, i
 //	wyrmgus::tile &mf = *CMap::Map.Field(index);
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
 	//Wyrmgus end
-	unsigned char *v = &mf.player_info->VisCloak[player.Index];
+	unsigned char *v = &mf.player_info->get_vis_cloak_ref(player.Index);
 	Assert(*v != 0);
 	if (*v == 1) {
 		//Wyrmgus start
@@ -412,7 +414,7 @@ void MapUnmarkTileDetectCloak(const CPlayer &player, const Vec2i &pos, int z)
 void MapMarkTileDetectEthereal(const CPlayer &player, const unsigned int index, int z)
 {
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
-	unsigned char *v = &mf.player_info->VisEthereal[player.Index];
+	unsigned char *v = &mf.player_info->get_vis_ethereal_ref(player.Index);
 	if (*v == 0) {
 		UnitsOnTileMarkSeen(player, mf, 0, 1);
 	}
@@ -434,7 +436,7 @@ void MapMarkTileDetectEthereal(const CPlayer &player, const Vec2i &pos, int z)
 void MapUnmarkTileDetectEthereal(const CPlayer &player, const unsigned int index, int z)
 {
 	wyrmgus::tile &mf = *CMap::Map.Field(index, z);
-	unsigned char *v = &mf.player_info->VisEthereal[player.Index];
+	unsigned char *v = &mf.player_info->get_vis_ethereal_ref(player.Index);
 	Assert(*v != 0);
 	if (*v == 1) {
 		UnitsOnTileUnmarkSeen(player, mf, 0, 1);
@@ -448,6 +450,253 @@ void MapUnmarkTileDetectEthereal(const CPlayer &player, const Vec2i &pos, int z)
 }
 //Wyrmgus end
 
+/**
+**  The tiles which CheckObstaclesBetweenTiles checks for obstacles on the line from a tile to each other tile within a range.
+**
+**  Bresenham's lines only depend on the difference between their end points, so the tiles of each line are stored relative to its start,
+**  leaving out those near enough to the end point to be tolerated by the maximum obstacle difference.
+*/
+class SightRayTable
+{
+public:
+	explicit SightRayTable(const int max_obstacle_difference) : MaxObstacleDifference(max_obstacle_difference)
+	{
+	}
+
+	/// Make sure that the lines to all tiles within the range have been calculated
+	void Reserve(const int range)
+	{
+		if (range <= this->Range) {
+			return;
+		}
+
+		this->Range = range;
+		this->RayStarts.clear();
+		this->RayTiles.clear();
+
+		for (int dy = -range; dy <= range; ++dy) {
+			for (int dx = -range; dx <= range; ++dx) {
+				this->RayStarts.push_back(static_cast<int>(this->RayTiles.size()));
+
+				//the same line as in CheckObstaclesBetweenTiles, from (0, 0) to (dx, dy)
+				const Vec2i goalPos(dx, dy);
+				const Vec2i delta(abs(dx), abs(dy));
+				const Vec2i sign(0 < dx ? 1 : -1, 0 < dy ? 1 : -1);
+				int error = delta.x - delta.y;
+				Vec2i pos(0, 0);
+
+				while (pos.x != goalPos.x || pos.y != goalPos.y) {
+					const int error2 = error * 2;
+
+					if (error2 > -delta.y) {
+						error -= delta.y;
+						pos.x += sign.x;
+					}
+					if (error2 < delta.x) {
+						error += delta.x;
+						pos.y += sign.y;
+					}
+
+					if (pos != goalPos && (abs(pos.x - goalPos.x) > this->MaxObstacleDifference || abs(pos.y - goalPos.y) > this->MaxObstacleDifference)) {
+						this->RayTiles.push_back(pos);
+					}
+				}
+			}
+		}
+		this->RayStarts.push_back(static_cast<int>(this->RayTiles.size()));
+	}
+
+	const Vec2i *GetRayBegin(const Vec2i &delta) const
+	{
+		return this->RayTiles.data() + this->RayStarts[this->GetRayIndex(delta)];
+	}
+
+	const Vec2i *GetRayEnd(const Vec2i &delta) const
+	{
+		return this->RayTiles.data() + this->RayStarts[this->GetRayIndex(delta) + 1];
+	}
+
+private:
+	int GetRayIndex(const Vec2i &delta) const
+	{
+		Assert(abs(delta.x) <= this->Range && abs(delta.y) <= this->Range);
+		return (delta.y + this->Range) * (this->Range * 2 + 1) + delta.x + this->Range;
+	}
+
+	const int MaxObstacleDifference;
+	int Range = -1;
+	std::vector<int> RayStarts;  /// the index of the first tile of each line in RayTiles, plus the end of the last line
+	std::vector<Vec2i> RayTiles; /// the tiles of all lines, relative to their start
+};
+
+/**
+**  The sight obstacles within the area seen by a unit, copied out of the map so that they can be looked up contiguously.
+*/
+class SightObstacleWindow
+{
+public:
+	SightObstacleWindow(const Vec2i &pos, const int w, const int h, const int range, const unsigned long obstacle_flag, const int z)
+	{
+		this->TopLeft.x = std::max(0, pos.x - range);
+		this->TopLeft.y = std::max(0, pos.y - range);
+		this->Width = std::min(CMap::Map.Info.MapWidths[z], pos.x + w + range) - this->TopLeft.x;
+		this->Height = std::min(CMap::Map.Info.MapHeights[z], pos.y + h + range) - this->TopLeft.y;
+
+		this->Obstacles.resize(std::max(this->Width, 0) * std::max(this->Height, 0));
+
+		for (int y = 0; y < this->Height; ++y) {
+			const wyrmgus::tile *mf = CMap::Map.Field(this->TopLeft.x, this->TopLeft.y + y, z);
+			for (int x = 0; x < this->Width; ++x) {
+				const bool obstacle = (mf->Flags & obstacle_flag) != 0;
+				this->Obstacles[y * this->Width + x] = obstacle;
+				this->AnyObstacle = this->AnyObstacle || obstacle;
+				++mf;
+			}
+		}
+	}
+
+	bool IsObstacle(const Vec2i &pos) const
+	{
+		const int x = pos.x - this->TopLeft.x;
+		const int y = pos.y - this->TopLeft.y;
+
+		//tiles outside of the map are not obstacles, as in CheckObstaclesBetweenTiles
+		if (static_cast<unsigned int>(x) >= static_cast<unsigned int>(this->Width) || static_cast<unsigned int>(y) >= static_cast<unsigned int>(this->Height)) {
+			return false;
+		}
+
+		return this->Obstacles[y * this->Width + x];
+	}
+
+	/// Whether there is any obstacle within the window, if not the sight area is an exact circle
+	bool HasObstacles() const
+	{
+		return this->AnyObstacle;
+	}
+
+private:
+	Vec2i TopLeft;
+	int Width = 0;
+	int Height = 0;
+	std::vector<char> Obstacles;
+	bool AnyObstacle = false;
+};
+
+static constexpr unsigned long sight_obstacle_flag = MapFieldAirUnpassable;
+static constexpr int max_obstacle_difference = 1; //how many tiles are seen after the obstacle; set to 1 here so that the obstacle tiles themselves don't have fog drawn over them
+
+static SightRayTable sight_ray_table(max_obstacle_difference);
+
+static MapSightStatistics current_cycle_sight_statistics;
+static MapSightStatistics last_cycle_sight_statistics;
+static MapSightStatistics total_sight_statistics;
+static unsigned long sight_statistics_cycle = 0;
+
+/**
+**  Count a sight update in the statistics, moving the statistics of the current cycle to the last cycle ones when a new cycle has started.
+*/
+static void CountSightUpdate(const bool incremental, const unsigned long tiles_touched)
+{
+	if (sight_statistics_cycle != GameCycle) {
+		//if no sight update happened in the previous cycle, it has no statistics
+		last_cycle_sight_statistics = sight_statistics_cycle + 1 == GameCycle ? current_cycle_sight_statistics : MapSightStatistics();
+		current_cycle_sight_statistics = MapSightStatistics();
+		sight_statistics_cycle = GameCycle;
+	}
+
+	for (MapSightStatistics *statistics : {&current_cycle_sight_statistics, &total_sight_statistics}) {
+		if (incremental) {
+			statistics->IncrementalUpdates++;
+		} else {
+			statistics->FullUpdates++;
+		}
+		statistics->TilesTouched += tiles_touched;
+	}
+}
+
+const MapSightStatistics &GetLastCycleMapSightStatistics()
+{
+	if (sight_statistics_cycle == GameCycle) {
+		return last_cycle_sight_statistics;
+	}
+
+	if (sight_statistics_cycle + 1 == GameCycle) {
+		return current_cycle_sight_statistics;
+	}
+
+	//no sight update has happened since before the last cycle
+	static const MapSightStatistics empty_statistics;
+	return empty_statistics;
+}
+
+const MapSightStatistics &GetTotalMapSightStatistics()
+{
+	return total_sight_statistics;
+}
+
+void ResetMapSightStatistics()
+{
+	current_cycle_sight_statistics = MapSightStatistics();
+	last_cycle_sight_statistics = MapSightStatistics();
+	total_sight_statistics = MapSightStatistics();
+	sight_statistics_cycle = GameCycle;
+}
+
+static inline void MarkSightTile(MapMarkerFunc *marker, const CPlayer &player, const Vec2i &pos, const int z)
+{
+#ifdef MARKER_ON_INDEX
+	marker(player, CMap::Map.getIndex(pos, z), z);
+#else
+	marker(player, pos, z);
+#endif
+}
+
+/**
+**  Check whether a tile can be seen from any of the tiles of a unit, i.e. whether the line from one of them to it has no obstacles.
+*/
+static bool IsTileInSight(const SightObstacleWindow &window, const Vec2i &pos, int w, int h, const Vec2i &mpos)
+{
+	for (int x = 0; x < w; ++x) {
+		for (int y = 0; y < h; ++y) {
+			const Vec2i source_pos = pos + Vec2i(x, y);
+			const Vec2i delta = mpos - source_pos;
+			const Vec2i *ray_end = sight_ray_table.GetRayEnd(delta);
+
+			bool obstacle_found = false;
+			for (const Vec2i *ray_tile = sight_ray_table.GetRayBegin(delta); ray_tile != ray_end; ++ray_tile) {
+				if (window.IsObstacle(source_pos + *ray_tile)) {
+					obstacle_found = true;
+					break;
+				}
+			}
+
+			if (!obstacle_found) { //the obstacle must be avoidable from at least one of the unit's tiles
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/**
+**  Check whether a tile can be seen from any of the tiles of a unit, walking the lines between them on the map.
+**
+**  This is the reference implementation for IsTileInSight, used for benchmarking.
+*/
+static bool IsTileInSightOnMap(const Vec2i &pos, int w, int h, const Vec2i &mpos, int z)
+{
+	for (int x = 0; x < w; ++x) {
+		for (int y = 0; y < h; ++y) {
+			if (CheckObstaclesBetweenTiles(pos + Vec2i(x, y), mpos, sight_obstacle_flag, z, max_obstacle_difference)) { //the obstacle must be avoidable from at least one of the unit's tiles
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
 /**
 **  Mark the sight of unit. (Explore and make visible.)
 **
@@ -468,9 +717,10 @@ void MapSight(const CPlayer &player, const Vec2i &pos, int w, int h, int range,
 		return;
 	}
 
-	static constexpr unsigned long sight_obstacle_flag = MapFieldAirUnpassable;
-	static constexpr int max_obstacle_difference = 1; //how many tiles are seen after the obstacle; set to 1 here so that the obstacle tiles themselves don't have fog drawn over them
-	
+	sight_ray_table.Reserve(range + std::max(w, h));
+	const SightObstacleWindow window(pos, w, h, range, sight_obstacle_flag, z);
+	unsigned long tiles_touched = 0;
+
 	// Up hemi-cyle
 	const int miny = std::max(-range, 0 - pos.y);
 	
@@ -490,19 +740,7 @@ void MapSight(const CPlayer &player, const Vec2i &pos, int w, int h, int range,
 #endif
 
 		for (mpos.x = minx; mpos.x < maxx; ++mpos.x) {
-			bool obstacle_check = false;
-			for (int x = 0; x < w; ++x) {
-				for (int y = 0; y < h; ++y) {
-					if (CheckObstaclesBetweenTiles(pos + Vec2i(x, y), mpos, sight_obstacle_flag, z, max_obstacle_difference)) { //the obstacle must be avoidable from at least one of the unit's tiles
-						obstacle_check = true;
-						break;
-					}
-				}
-				if (obstacle_check) {
-					break;
-				}
-			}
-			if (!obstacle_check) {
+			if (!IsTileInSight(window, pos, w, h, mpos)) {
 				continue;
 			}
 
@@ -517,6 +755,7 @@ void MapSight(const CPlayer &player, const Vec2i &pos, int w, int h, int range,
 			marker(player, mpos, z);
 			//Wyrmgus end
 #endif
+			++tiles_touched;
 		}
 	}
 	for (int offsety = 0; offsety < h; ++offsety) {
@@ -534,19 +773,7 @@ void MapSight(const CPlayer &player, const Vec2i &pos, int w, int h, int range,
 #endif
 
 		for (mpos.x = minx; mpos.x < maxx; ++mpos.x) {
-			bool obstacle_check = false;
-			for (int x = 0; x < w; ++x) {
-				for (int y = 0; y < h; ++y) {
-					if (CheckObstaclesBetweenTiles(pos + Vec2i(x, y), mpos, sight_obstacle_flag, z, max_obstacle_difference)) { //the obstacle must be avoidable from at least one of the unit's tiles
-						obstacle_check = true;
-						break;
-					}
-				}
-				if (obstacle_check) {
-					break;
-				}
-			}
-			if (!obstacle_check) {
+			if (!IsTileInSight(window, pos, w, h, mpos)) {
 				continue;
 			}
 
@@ -561,6 +788,7 @@ void MapSight(const CPlayer &player, const Vec2i &pos, int w, int h, int range,
 			marker(player, mpos, z);
 			//Wyrmgus end
 #endif
+			++tiles_touched;
 		}
 	}
 	// bottom hemi-cycle
@@ -584,19 +812,7 @@ void MapSight(const CPlayer &player, const Vec2i &pos, int w, int h, int range,
 #endif
 
 		for (mpos.x = minx; mpos.x < maxx; ++mpos.x) {
-			bool obstacle_check = false;
-			for (int x = 0; x < w; ++x) {
-				for (int y = 0; y < h; ++y) {
-					if (CheckObstaclesBetweenTiles(pos + Vec2i(x, y), mpos, sight_obstacle_flag, z, max_obstacle_difference)) { //the obstacle must be avoidable from at least one of the unit's tiles
-						obstacle_check = true;
-						break;
-					}
-				}
-				if (obstacle_check) {
-					break;
-				}
-			}
-			if (!obstacle_check) {
+			if (!IsTileInSight(window, pos, w, h, mpos)) {
 				continue;
 			}
 
@@ -611,8 +827,203 @@ void MapSight(const CPlayer &player, const Vec2i &pos, int w, int h, int range,
 			marker(player, mpos, z);
 			//Wyrmgus end
 #endif
+			++tiles_touched;
+		}
+	}
+
+	CountSightUpdate(false, tiles_touched);
+}
+
+/**
+**  Get the tiles of a map row which are within the sight range of a unit, without taking obstacles into account.
+**
+**  The sight area has the same shape as in MapSight.
+**
+**  @param pos    Top left tile of the unit.
+**  @param w      Width of the unit, in tiles.
+**  @param h      Height of the unit, in tiles.
+**  @param range  Sight range.
+**  @param y      Map row.
+**  @param min_x  Set to the first tile of the row in the sight range.
+**  @param max_x  Set to the tile after the last one of the row in the sight range.
+**
+**  @return       True if any tile of the row is in the sight range.
+*/
+static bool GetSightRowSpan(const Vec2i &pos, const int w, const int h, const int range, const int y, const int z, int &min_x, int &max_x)
+{
+	int offsetx;
+	if (y < pos.y) {
+		const int distance = pos.y - y;
+		if (distance > range) {
+			return false;
+		}
+		offsetx = isqrt(square(range + 1) - square(distance) - 1);
+	} else if (y < pos.y + h) {
+		offsetx = range;
+	} else {
+		const int distance = y - (pos.y + h) + 1;
+		if (distance > range) {
+			return false;
+		}
+		offsetx = isqrt(square(range + 1) - square(distance) - 1);
+	}
+
+	min_x = std::max(0, pos.x - offsetx);
+	max_x = std::min(CMap::Map.Info.MapWidths[z], pos.x + w + offsetx);
+	return min_x < max_x;
+}
+
+/**
+**  Mark the sight changes of a unit which moved to a nearby position.
+**
+**  Instead of unmarking the whole sight area at the old position and marking it again at the new one,
+**  only the tiles which came into sight are marked, and only those which left it are unmarked.
+**  For a unit moving by one tile these are the leading and trailing arcs of its sight area,
+**  so tiles which stay in sight keep their visibility, and don't go through the unseen state.
+**
+**  @param player    Player to mark the sight for.
+**  @param old_pos   Location of the unit before moving.
+**  @param new_pos   Location of the unit after moving.
+**  @param w         Width of the unit, in tiles.
+**  @param h         Height of the unit, in tiles.
+**  @param range     Sight range.
+**  @param marker    Function to mark sight.
+**  @param unmarker  Function to unmark sight.
+*/
+void MapSightMove(const CPlayer &player, const Vec2i &old_pos, const Vec2i &new_pos, int w, int h, int range, MapMarkerFunc *marker, MapMarkerFunc *unmarker, int z)
+{
+	// Units under construction have no sight range.
+	if (!range) {
+		return;
+	}
+
+	sight_ray_table.Reserve(range + std::max(w, h));
+	const SightObstacleWindow old_window(old_pos, w, h, range, sight_obstacle_flag, z);
+	const SightObstacleWindow new_window(new_pos, w, h, range, sight_obstacle_flag, z);
+
+	//without obstacles the sight areas are exact, so the tiles within both of them can be skipped without checking them
+	const bool has_obstacles = old_window.HasObstacles() || new_window.HasObstacles();
+
+	const int min_y = std::max(0, std::min(old_pos.y, new_pos.y) - range);
+	const int max_y = std::min(CMap::Map.Info.MapHeights[z], std::max(old_pos.y, new_pos.y) + h + range);
+
+	unsigned long tiles_touched = 0;
+
+	//(un)mark the tiles in the sight of the unit at to_pos which are not in its sight at from_pos
+	const auto mark_sight_difference = [&](const Vec2i &to_pos, const SightObstacleWindow &to_window, const Vec2i &from_pos, const SightObstacleWindow &from_window, MapMarkerFunc *difference_marker) {
+		for (int y = min_y; y < max_y; ++y) {
+			int to_min_x = 0;
+			int to_max_x = 0;
+			if (!GetSightRowSpan(to_pos, w, h, range, y, z, to_min_x, to_max_x)) {
+				continue;
+			}
+
+			int from_min_x = 0;
+			int from_max_x = 0;
+			GetSightRowSpan(from_pos, w, h, range, y, z, from_min_x, from_max_x);
+
+			Vec2i mpos(to_min_x, y);
+			for (mpos.x = to_min_x; mpos.x < to_max_x; ++mpos.x) {
+				const bool in_from_range = mpos.x >= from_min_x && mpos.x < from_max_x;
+
+				if (!has_obstacles) {
+					if (in_from_range) {
+						mpos.x = from_max_x - 1;
+						continue;
+					}
+				} else {
+					if (!IsTileInSight(to_window, to_pos, w, h, mpos)) {
+						continue;
+					}
+
+					if (in_from_range && IsTileInSight(from_window, from_pos, w, h, mpos)) {
+						continue;
+					}
+				}
+
+				MarkSightTile(difference_marker, player, mpos, z);
+				++tiles_touched;
+			}
+		}
+	};
+
+	//mark the tiles which came into sight, and unmark those which left it
+	mark_sight_difference(new_pos, new_window, old_pos, old_window, marker);
+	mark_sight_difference(old_pos, old_window, new_pos, new_window, unmarker);
+
+	CountSightUpdate(true, tiles_touched);
+}
+
+/**
+**  Compare the time taken to calculate sight with the precomputed lines and by walking the lines on the map.
+**
+**  Sight is calculated from every step-th tile of each map layer, for units of 1x1 and 2x2 tiles.
+**  The timings are printed along with the number of tiles whose visibility differs between both.
+**
+**  @param range  Sight range to use.
+**  @param step   Distance between the tiles from which sight is calculated.
+*/
+void BenchmarkMapSight(const int range, const int step)
+{
+	std::chrono::steady_clock::duration ray_time(0);
+	std::chrono::steady_clock::duration map_time(0);
+	long long checked_count = 0;
+	long long mismatch_count = 0;
+	std::vector<bool> ray_visibility;
+	std::vector<bool> map_visibility;
+
+	for (size_t z = 0; z < CMap::Map.MapLayers.size(); ++z) {
+		const int map_width = CMap::Map.Info.MapWidths[z];
+		const int map_height = CMap::Map.Info.MapHeights[z];
+
+		for (int size = 1; size <= 2; ++size) {
+			for (int y = 0; y + size <= map_height; y += step) {
+				for (int x = 0; x + size <= map_width; x += step) {
+					const Vec2i pos(x, y);
+					const Vec2i min_pos(std::max(0, x - range), std::max(0, y - range));
+					const Vec2i max_pos(std::min(map_width, x + size + range), std::min(map_height, y + size + range));
+
+					ray_visibility.clear();
+					map_visibility.clear();
+
+					const auto start_time = std::chrono::steady_clock::now();
+
+					sight_ray_table.Reserve(range + size);
+					const SightObstacleWindow window(pos, size, size, range, sight_obstacle_flag, z);
+					Vec2i mpos;
+					for (mpos.y = min_pos.y; mpos.y < max_pos.y; ++mpos.y) {
+						for (mpos.x = min_pos.x; mpos.x < max_pos.x; ++mpos.x) {
+							ray_visibility.push_back(IsTileInSight(window, pos, size, size, mpos));
+						}
+					}
+
+					const auto ray_end_time = std::chrono::steady_clock::now();
+
+					for (mpos.y = min_pos.y; mpos.y < max_pos.y; ++mpos.y) {
+						for (mpos.x = min_pos.x; mpos.x < max_pos.x; ++mpos.x) {
+							map_visibility.push_back(IsTileInSightOnMap(pos, size, size, mpos, z));
+						}
+					}
+
+					const auto map_end_time = std::chrono::steady_clock::now();
+
+					ray_time += ray_end_time - start_time;
+					map_time += map_end_time - ray_end_time;
+
+					checked_count += ray_visibility.size();
+					for (size_t i = 0; i < ray_visibility.size(); ++i) {
+						if (ray_visibility[i] != map_visibility[i]) {
+							++mismatch_count;
+						}
+					}
+				}
+			}
 		}
 	}
+
+	const long long ray_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(ray_time).count();
+	const long long map_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(map_time).count();
+	fprintf(stdout, "Checked the sight of %lld tiles: precomputed lines %lld us, lines walked on the map %lld us, %lld differing results.\n", checked_count, ray_microseconds, map_microseconds, mismatch_count);
 }
 
 /**
@@ -997,5 +1408,7 @@ void CMap::CleanFogOfWar()
 {
 	VisibleTable.clear();
 
+	ResetMapSightStatistics();
+
 	CMap::FogGraphics.reset();
 }
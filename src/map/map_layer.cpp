@@ -34,6 +34,7 @@
 #include "map/minimap.h"
 #include "map/terrain_type.h"
 #include "map/tile.h"
+#include "map/tile_timer_queue.h"
 #include "map/tileset.h"
 #include "sound/music.h"
 #include "sound/sound_server.h"
@@ -44,6 +45,23 @@
 #include "unit/unit.h"
 #include "unit/unit_manager.h"
 
+//the cycle within each second in which the main loop handles the tile timers, see GameLogicLoop()
+static constexpr unsigned long TileTimerCycleOffset = 5;
+
+/**
+**	@brief	Get the tile timer step handled in the current game cycle, or the next one to be handled if there is none
+**
+**	Decaying and regenerating tiles advance by one step per second, and their timers are keyed by the step in which they are due.
+*/
+static unsigned long GetNextTileTimerStep()
+{
+	if (GameCycle <= TileTimerCycleOffset) {
+		return 0;
+	}
+
+	return (GameCycle - TileTimerCycleOffset + CYCLES_PER_SECOND - 1) / CYCLES_PER_SECOND;
+}
+
 CMapLayer::CMapLayer(const QSize &size) : size(size)
 {
 	if (size.width() > MaxMapWidth) {
@@ -61,6 +79,13 @@ CMapLayer::CMapLayer(const QSize &size) : size(size)
 	} catch (const std::bad_alloc &) {
 		std::throw_with_nested(std::runtime_error("Failed to allocate map layer with a tile area of " + std::to_string(max_tile_index) + ", for " + std::to_string(max_tile_index * sizeof(wyrmgus::tile)) + " bytes in total."));
 	}
+
+	this->visibility_planes = std::make_unique<wyrmgus::tile_visibility_planes>(max_tile_index);
+	this->destroyed_overlay_terrain_timers = std::make_unique<wyrmgus::tile_timer_queue>(max_tile_index);
+	this->destroyed_tree_timers = std::make_unique<wyrmgus::tile_timer_queue>(max_tile_index);
+	for (int i = 0; i < max_tile_index; ++i) {
+		this->Fields[i].player_info->set_visibility_planes(this->visibility_planes.get(), i);
+	}
 }
 
 CMapLayer::~CMapLayer()
@@ -79,36 +104,6 @@ wyrmgus::tile *CMapLayer::Field(const unsigned int index) const
 	return &this->Fields[index];
 }
 
-/**
-**	@brief	Perform the map layer's per-cycle loop
-*/
-void CMapLayer::DoPerCycleLoop()
-{
-	if (GameCycle > 0) {
-		//do tile animation
-		if (GameCycle % (CYCLES_PER_SECOND / 4) == 0) { // same speed as color-cycling
-			const int max_tile_index = this->get_width() * this->get_height();
-			for (int i = 0; i < max_tile_index; ++i) {
-				wyrmgus::tile &mf = *this->Field(i);
-				
-				if (mf.get_terrain() != nullptr && mf.get_terrain()->SolidAnimationFrames > 0) {
-					mf.AnimationFrame += 1;
-					if (mf.AnimationFrame >= mf.get_terrain()->SolidAnimationFrames) {
-						mf.AnimationFrame = 0;
-					}
-				}
-				
-				if (mf.get_overlay_terrain() != nullptr && mf.get_overlay_terrain()->SolidAnimationFrames > 0) {
-					mf.OverlayAnimationFrame += 1;
-					if (mf.OverlayAnimationFrame >= mf.get_overlay_terrain()->SolidAnimationFrames) {
-						mf.OverlayAnimationFrame = 0;
-					}
-				}
-			}
-		}
-	}
-}
-
 /**
 **	@brief	Perform the map layer's per-hour loop
 */
@@ -118,24 +113,77 @@ void CMapLayer::DoPerHourLoop()
 	this->DecrementRemainingTimeOfDayHours();
 }
 
-void CMapLayer::handle_destroyed_overlay_terrain()
+void CMapLayer::add_destroyed_overlay_terrain_tile(const QPoint &pos)
 {
-	if (wyrmgus::defines::get()->get_destroyed_overlay_terrain_decay_threshold() == 0) {
+	const int decay_threshold = wyrmgus::defines::get()->get_destroyed_overlay_terrain_decay_threshold();
+
+	if (decay_threshold == 0) {
 		return;
 	}
 
-	for (size_t i = 0; i < this->destroyed_overlay_terrain_tiles.size();) {
-		const QPoint &pos = this->destroyed_overlay_terrain_tiles[i];
-		wyrmgus::tile &mf = *this->Field(pos);
+	//the tile's value decreases by one in each step, and the overlay terrain is removed once the value reaches the threshold
+	const int decay_steps = std::max(this->Field(pos)->get_value() - decay_threshold, 1);
+	this->destroyed_overlay_terrain_timers->schedule(this->get_tile_index(pos), GetNextTileTimerStep() + decay_steps - 1);
+}
 
-		if (mf.get_overlay_terrain() == nullptr || !mf.OverlayTerrainDestroyed || (mf.get_flags() & MapFieldStumps)) {
-			//the destroyed overlay terrain tile may have become invalid, e.g. because the terrain changed, or because of the handling of destroyed overlay tiles itself; we keep the removal of elements centralized here so that we can loop through the tiles reliably
-			this->destroyed_overlay_terrain_tiles.erase(this->destroyed_overlay_terrain_tiles.begin() + i);
-		} else {
-			this->decay_destroyed_overlay_terrain_tile(pos);
-			++i;
-		}
+void CMapLayer::add_destroyed_tree_tile(const QPoint &pos)
+{
+	const int forest_regeneration_threshold = wyrmgus::defines::get()->get_forest_regeneration_threshold();
+
+	if (forest_regeneration_threshold == 0) {
+		return;
 	}
+
+	//the tile's value increases by one in each step, and the tree can regrow once the value reaches the threshold
+	const int growth_steps = std::max(forest_regeneration_threshold - this->Field(pos)->get_value(), 1);
+	this->destroyed_tree_timers->schedule(this->get_tile_index(pos), GetNextTileTimerStep() + growth_steps - 1);
+}
+
+/**
+**	@brief	Cancel the pending decay or regeneration of a tile, e.g. because its terrain has changed
+*/
+void CMapLayer::cancel_tile_timers(const QPoint &pos)
+{
+	const unsigned int tile_index = this->get_tile_index(pos);
+	this->destroyed_overlay_terrain_timers->cancel(tile_index);
+	this->destroyed_tree_timers->cancel(tile_index);
+}
+
+/**
+**	@brief	Set the values of tiles with pending timers to what the per-step updates would have made them
+**
+**	The values of decaying and regenerating tiles are only updated when their timers are due, so this needs to be called before they are saved.
+*/
+void CMapLayer::update_timed_tile_values()
+{
+	const unsigned long next_step = GetNextTileTimerStep();
+
+	const auto get_remaining_steps = [next_step](const unsigned long due_step) {
+		return due_step >= next_step ? static_cast<int>(due_step - next_step + 1) : 1;
+	};
+
+	const int decay_threshold = wyrmgus::defines::get()->get_destroyed_overlay_terrain_decay_threshold();
+	this->destroyed_overlay_terrain_timers->for_each_scheduled_tile([&](const unsigned int tile_index, const unsigned long due_step) {
+		this->Field(tile_index)->set_value(decay_threshold + get_remaining_steps(due_step));
+	});
+
+	const int forest_regeneration_threshold = wyrmgus::defines::get()->get_forest_regeneration_threshold();
+	this->destroyed_tree_timers->for_each_scheduled_tile([&](const unsigned int tile_index, const unsigned long due_step) {
+		wyrmgus::tile *tile = this->Field(tile_index);
+
+		if (tile->get_value() >= forest_regeneration_threshold) {
+			return; //fully grown, and waiting for the adjacent tiles
+		}
+
+		tile->set_value(std::max(forest_regeneration_threshold - get_remaining_steps(due_step), 0));
+	});
+}
+
+void CMapLayer::handle_destroyed_overlay_terrain()
+{
+	this->destroyed_overlay_terrain_timers->process_due_timers(GetNextTileTimerStep(), [this](const unsigned int tile_index) {
+		this->decay_destroyed_overlay_terrain_tile(this->GetPosFromIndex(tile_index));
+	});
 }
 
 void CMapLayer::decay_destroyed_overlay_terrain_tile(const QPoint &pos)
@@ -146,9 +194,8 @@ void CMapLayer::decay_destroyed_overlay_terrain_tile(const QPoint &pos)
 
 	wyrmgus::tile &mf = *this->Field(pos);
 
-	mf.decrement_value();
-
-	if (mf.get_value() > wyrmgus::defines::get()->get_destroyed_overlay_terrain_decay_threshold()) {
+	if (mf.get_overlay_terrain() == nullptr || !mf.OverlayTerrainDestroyed || (mf.get_flags() & MapFieldStumps)) {
+		//the tile may no longer be a destroyed overlay terrain tile, e.g. because the terrain changed
 		return;
 	}
 
@@ -158,20 +205,9 @@ void CMapLayer::decay_destroyed_overlay_terrain_tile(const QPoint &pos)
 
 void CMapLayer::regenerate_forests()
 {
-	if (wyrmgus::defines::get()->get_forest_regeneration_threshold() == 0) {
-		return;
-	}
-
-	for (size_t i = 0; i < this->destroyed_tree_tiles.size();) {
-		const QPoint &pos = this->destroyed_tree_tiles[i];
-		wyrmgus::tile &mf = *this->Field(pos);
-		if (!mf.is_destroyed_tree_tile()) { //the destroyed forest tile may have become invalid, e.g. because the terrain changed, or because of the regeneration itself; we keep the removal of elements centralized here so that we can loop through the tiles reliably
-			this->destroyed_tree_tiles.erase(this->destroyed_tree_tiles.begin() + i);
-		} else {
-			this->regenerate_tree_tile(pos);
-			++i;
-		}
-	}
+	this->destroyed_tree_timers->process_due_timers(GetNextTileTimerStep(), [this](const unsigned int tile_index) {
+		this->regenerate_tree_tile(this->GetPosFromIndex(tile_index));
+	});
 }
 
 void CMapLayer::regenerate_tree_tile(const QPoint &pos)
@@ -182,30 +218,33 @@ void CMapLayer::regenerate_tree_tile(const QPoint &pos)
 	
 	wyrmgus::tile &mf = *this->Field(pos);
 
-	//  Increment each value of no wood.
+	if (!mf.is_destroyed_tree_tile()) {
+		//the tile may no longer be a destroyed tree tile, e.g. because the terrain changed
+		return;
+	}
+
+	//  Called when the tile's regeneration timer is due.
 	//  If grown up, place new wood.
 	//  FIXME: a better looking result would be fine
 	//    Allow general updates to any tiletype that regrows
 
 	const unsigned long permanent_occupied_flag = (MapFieldWall | MapFieldUnpassable | MapFieldBuilding);
 	const unsigned long occupied_flag = (permanent_occupied_flag | MapFieldLandUnit | MapFieldItem);
+	const int forest_regeneration_threshold = wyrmgus::defines::get()->get_forest_regeneration_threshold();
+	const unsigned int tile_index = this->get_tile_index(pos);
+	const unsigned long step = GetNextTileTimerStep();
 	
 	if ((mf.Flags & permanent_occupied_flag)) { //if the tree tile is permanently occupied by buildings and the like, reset the regeneration process
 		mf.set_value(0);
+		this->destroyed_tree_timers->schedule(tile_index, step + forest_regeneration_threshold);
 		return;
 	}
 
-	if (mf.Flags & occupied_flag) { // if the tree tile is temporarily occupied (e.g. by an item or unit), don't continue the regrowing process while the occupation occurs, but don't reset it either
+	if (mf.Flags & occupied_flag) { // if the tree tile is temporarily occupied (e.g. by an item or unit), don't finish the regrowing process while the occupation occurs, but don't reset it either
+		this->destroyed_tree_timers->schedule(tile_index, step + 1);
 		return;
 	}
 	
-	mf.increment_value();
-
-	const int forest_regeneration_threshold = wyrmgus::defines::get()->get_forest_regeneration_threshold();
-
-	if (mf.get_value() < forest_regeneration_threshold) {
-		return;
-	}
 	mf.set_value(forest_regeneration_threshold);
 	
 	//Wyrmgus start
@@ -271,6 +310,9 @@ void CMapLayer::regenerate_tree_tile(const QPoint &pos)
 		FixNeighbors(MapFieldForest, 0, pos);
 	}
 	*/
+
+	//the adjacent tiles are not ready yet, so check again in the next step
+	this->destroyed_tree_timers->schedule(tile_index, step + 1);
 }
 
 /**
@@ -40,6 +40,8 @@ namespace wyrmgus {
 	class plane;
 	class season;
 	class tile;
+	class tile_timer_queue;
+	class tile_visibility_planes;
 	class time_of_day;
 	class world;
 }
@@ -89,6 +91,11 @@ public:
 		return this->Field(pos.x, pos.y);
 	}
 	
+	unsigned int get_tile_index(const QPoint &pos) const
+	{
+		return pos.x() + pos.y() * this->get_width();
+	}
+
 	Vec2i GetPosFromIndex(unsigned int index) const
 	{
 		Vec2i pos;
@@ -112,8 +119,11 @@ public:
 		return this->get_size().height();
 	}
 	
-	void DoPerCycleLoop();
 	void DoPerHourLoop();
+	void add_destroyed_overlay_terrain_tile(const QPoint &pos);
+	void add_destroyed_tree_tile(const QPoint &pos);
+	void cancel_tile_timers(const QPoint &pos);
+	void update_timed_tile_values();
 	void handle_destroyed_overlay_terrain();
 	void decay_destroyed_overlay_terrain_tile(const QPoint &pos);
 	void regenerate_forests();
@@ -154,6 +164,9 @@ public:
 	int ID = -1;
 private:
 	std::unique_ptr<wyrmgus::tile[]> Fields; //fields on the map layer
+	std::unique_ptr<wyrmgus::tile_visibility_planes> visibility_planes; //the visibility of the fields for each player
+	std::unique_ptr<wyrmgus::tile_timer_queue> destroyed_overlay_terrain_timers; //decay timers for destroyed overlay terrain tiles (excluding trees)
+	std::unique_ptr<wyrmgus::tile_timer_queue> destroyed_tree_timers; //regeneration timers for destroyed tree tiles
 	QSize size;									/// the size in tiles of the map layer
 public:
 	CScheduledTimeOfDay *TimeOfDay = nullptr;	/// the time of day for the map layer
@@ -166,6 +179,4 @@ public:
 	const wyrmgus::world *world = nullptr;			/// the world pointer (if any) for the map layer
 	std::vector<CUnit *> LayerConnectors;		/// connectors in the map layer which lead to other map layers
 	wyrmgus::map_template_map<QRect> subtemplate_areas;
-	std::vector<QPoint> destroyed_overlay_terrain_tiles; /// destroyed overlay terrain tiles (excluding trees)
-	std::vector<QPoint> destroyed_tree_tiles;	/// destroyed tree tiles; this list is used for forest regeneration
 };
@@ -39,14 +39,12 @@
 
 static inline unsigned char IsTileRadarVisible(const CPlayer &pradar, const CPlayer &punit, const wyrmgus::tile_player_info &mfp)
 {
-	if (mfp.RadarJammer[punit.Index]) {
+	if (mfp.get_radar_jammer(punit.Index)) {
 		return 0;
 	}
 
 	const int p = pradar.Index;
 	if (pradar.IsVisionSharing()) {
-		const unsigned char *const radar = mfp.Radar;
-		const unsigned char *const jamming = mfp.RadarJammer;
 		unsigned char radarvision = 0;
 
 		// Check jamming first, if we are jammed, exit
@@ -55,7 +53,7 @@ static inline unsigned char IsTileRadarVisible(const CPlayer &pradar, const CPla
 				continue;
 			}
 
-			if (jamming[i] > 0) {
+			if (mfp.get_radar_jammer(i) > 0) {
 				if (CPlayer::Players[i]->has_shared_vision_with(punit.Index)) { //if the shared vision is mutual
 					// We are jammed, return nothing
 					return 0;
@@ -68,17 +66,18 @@ static inline unsigned char IsTileRadarVisible(const CPlayer &pradar, const CPla
 				continue;
 			}
 
-			if (radar[i] > 0) {
+			const unsigned char radar = mfp.get_radar(i);
+			if (radar > 0) {
 				if (CPlayer::Players[i]->has_shared_vision_with(p)) { //if the shared vision is mutual
-					radarvision |= radar[i];
+					radarvision |= radar;
 				}
 			}
 		}
 
 		// Can't exit until the end, as we might be jammed
-		return (radarvision | mfp.Radar[p]);
+		return (radarvision | mfp.get_radar(p));
 	}
-	return mfp.Radar[p];
+	return mfp.get_radar(p);
 }
 
 bool CUnit::IsVisibleOnRadar(const CPlayer &pradar) const
@@ -113,8 +112,9 @@ bool CUnit::IsVisibleOnRadar(const CPlayer &pradar) const
 */
 void MapMarkTileRadar(const CPlayer &player, const unsigned int index, int z)
 {
-	Assert(CMap::Map.Field(index, z)->player_info->Radar[player.Index] != 255);
-	CMap::Map.Field(index, z)->player_info->Radar[player.Index]++;
+	unsigned char &radar = CMap::Map.Field(index, z)->player_info->get_radar_ref(player.Index);
+	Assert(radar != 255);
+	radar++;
 }
 
 void MapMarkTileRadar(const CPlayer &player, int x, int y, int z)
@@ -136,7 +136,7 @@ void MapUnmarkTileRadar(const CPlayer &player, const unsigned int index, int z)
 	// Reduce radar coverage if it exists.
 	//Wyrmgus start
 //	unsigned char *v = &(CMap::Map.Field(index)->player_info->Radar[player.Index]);
-	unsigned char *v = &(CMap::Map.Field(index, z)->player_info->Radar[player.Index]);
+	unsigned char *v = &CMap::Map.Field(index, z)->player_info->get_radar_ref(player.Index);
 	//Wyrmgus end
 	if (*v) {
 		--*v;
@@ -165,8 +165,9 @@ void MapMarkTileRadarJammer(const CPlayer &player, const unsigned int index, int
 	//Wyrmgus start
 //	Assert(CMap::Map.Field(index)->player_info->RadarJammer[player.Index] != 255);
 //	CMap::Map.Field(index)->player_info->RadarJammer[player.Index]++;
-	Assert(CMap::Map.Field(index, z)->player_info->RadarJammer[player.Index] != 255);
-	CMap::Map.Field(index, z)->player_info->RadarJammer[player.Index]++;
+	unsigned char &radar_jammer = CMap::Map.Field(index, z)->player_info->get_radar_jammer_ref(player.Index);
+	Assert(radar_jammer != 255);
+	radar_jammer++;
 	//Wyrmgus end
 }
 
@@ -191,7 +192,7 @@ void MapUnmarkTileRadarJammer(const CPlayer &player, const unsigned int index, i
 	// Reduce radar coverage if it exists.
 	//Wyrmgus start
 //	unsigned char *v = &(CMap::Map.Field(index)->player_info->RadarJammer[player.Index]);
-	unsigned char *v = &(CMap::Map.Field(index, z)->player_info->RadarJammer[player.Index]);
+	unsigned char *v = &CMap::Map.Field(index, z)->player_info->get_radar_jammer_ref(player.Index);
 	//Wyrmgus end
 	if (*v) {
 		--*v;
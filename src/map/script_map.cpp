@@ -286,9 +286,9 @@ static int CclStratagusMap(lua_State *l)
 							wyrmgus::tile &mf = *map_layer->Field(i);
 							mf.parse(l);
 							if (mf.is_destroyed_tree_tile()) {
-								map_layer->destroyed_tree_tiles.push_back(map_layer->GetPosFromIndex(i));
+								map_layer->add_destroyed_tree_tile(map_layer->GetPosFromIndex(i));
 							} else if (mf.get_overlay_terrain() != nullptr && mf.OverlayTerrainDestroyed) {
-								map_layer->destroyed_overlay_terrain_tiles.push_back(map_layer->GetPosFromIndex(i));
+								map_layer->add_destroyed_overlay_terrain_tile(map_layer->GetPosFromIndex(i));
 							}
 							lua_pop(l, 1);
 						}
@@ -296,6 +296,15 @@ static int CclStratagusMap(lua_State *l)
 					}
 					lua_pop(l, 1);
 					//Wyrmgus end
+				} else if (!strcmp(subvalue, "map-fields-snapshot")) {
+					lua_rawgeti(l, j + 1, k + 1);
+					if (!lua_istable(l, -1) || lua_rawlen(l, -1) != 2) {
+						LuaError(l, "incorrect argument");
+					}
+					const std::string save_directory = LuaToString(l, -1, 1);
+					const std::string snapshot_filename = LuaToString(l, -1, 2);
+					lua_pop(l, 1);
+					LoadMapFieldsSnapshot(save_directory, snapshot_filename);
 				} else {
 					LuaError(l, "Unsupported tag: %s" _C_ subvalue);
 				}
@@ -348,6 +357,47 @@ static int CclRevealMap(lua_State *l)
 	return 0;
 }
 
+/**
+**  Benchmark the calculation of unit sight on the current map.
+**
+**  @param l  Lua state.
+*/
+static int CclMapSightBenchmark(lua_State *l)
+{
+	LuaCheckArgs(l, 2);
+
+	const int range = LuaToNumber(l, 1);
+	const int step = LuaToNumber(l, 2);
+	if (range <= 0 || step <= 0) {
+		LuaError(l, "The sight range and the step must be positive.");
+	}
+
+	BenchmarkMapSight(range, step);
+
+	return 0;
+}
+
+/**
+**  Get the numbers of tiles touched by sight updates, to verify how much incremental updates reduce them.
+**
+**  @param l  Lua state.
+**
+**  @return   The tiles touched in the last game cycle, and the tiles touched, full sight updates and incremental sight updates since the start of the game.
+*/
+static int CclGetMapSightStatistics(lua_State *l)
+{
+	LuaCheckArgs(l, 0);
+
+	const MapSightStatistics &last_cycle_statistics = GetLastCycleMapSightStatistics();
+	const MapSightStatistics &total_statistics = GetTotalMapSightStatistics();
+
+	lua_pushnumber(l, last_cycle_statistics.TilesTouched);
+	lua_pushnumber(l, total_statistics.TilesTouched);
+	lua_pushnumber(l, total_statistics.FullUpdates);
+	lua_pushnumber(l, total_statistics.IncrementalUpdates);
+	return 4;
+}
+
 /**
 **  Center the map.
 **
@@ -1919,6 +1969,8 @@ void MapCclRegister()
 {
 	lua_register(Lua, "StratagusMap", CclStratagusMap);
 	lua_register(Lua, "RevealMap", CclRevealMap);
+	lua_register(Lua, "MapSightBenchmark", CclMapSightBenchmark);
+	lua_register(Lua, "GetMapSightStatistics", CclGetMapSightStatistics);
 	lua_register(Lua, "CenterMap", CclCenterMap);
 	lua_register(Lua, "SetStartView", CclSetStartView);
 	lua_register(Lua, "ShowMapLocation", CclShowMapLocation);
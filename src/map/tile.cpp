@@ -45,6 +45,16 @@
 #include "unit/unit_manager.h"
 #include "util/vector_util.h"
 
+#include <bit>
+
+/**
+**	@brief	Get the tile animation clock, which advances by one tile animation frame every quarter second of game time, at the same speed as color-cycling
+*/
+static unsigned long GetTileAnimationTick()
+{
+	return GameCycle / (CYCLES_PER_SECOND / 4);
+}
+
 namespace wyrmgus {
 
 tile::tile()
@@ -152,16 +162,21 @@ void tile::SetTerrain(const terrain_type *terrain_type)
 	}
 
 	if (Editor.Running == EditorNotRunning && terrain_type->SolidAnimationFrames > 0) {
+		//start the animation at a random frame, storing it as an offset from the animation clock so that the frame can be derived from the clock when drawing
+		const int animation_frames = terrain_type->SolidAnimationFrames;
+		const int start_frame = SyncRand(animation_frames);
+		const unsigned char animation_phase = static_cast<unsigned char>((start_frame + animation_frames - static_cast<int>(GetTileAnimationTick() % animation_frames)) % animation_frames);
+
 		if (terrain_type->is_overlay()) {
-			this->OverlayAnimationFrame = SyncRand(terrain_type->SolidAnimationFrames);
+			this->OverlayAnimationPhase = animation_phase;
 		} else {
-			this->AnimationFrame = SyncRand(terrain_type->SolidAnimationFrames);
+			this->AnimationPhase = animation_phase;
 		}
 	} else {
 		if (terrain_type->is_overlay()) {
-			this->OverlayAnimationFrame = 0;
+			this->OverlayAnimationPhase = 0;
 		} else {
-			this->AnimationFrame = 0;
+			this->AnimationPhase = 0;
 		}
 	}
 
@@ -369,82 +384,83 @@ void tile::Save(CFile &file) const
 	}
 	//Wyrmgus end
 	for (int i = 0; i != PlayerMax; ++i) {
-		if (player_info->Visible[i] == 1) {
-			file.printf(", \"explored\", %d", i);
+		if (player_info->get_visible(i) == 1) {
+			file.write_string(", \"explored\", ");
+			file.write_int(i);
 		}
 	}
 	if (Flags & MapFieldLandAllowed) {
-		file.printf(", \"land\"");
+		file.write_string(", \"land\"");
 	}
 	if (Flags & MapFieldCoastAllowed) {
-		file.printf(", \"coast\"");
+		file.write_string(", \"coast\"");
 	}
 	if (Flags & MapFieldWaterAllowed) {
-		file.printf(", \"water\"");
+		file.write_string(", \"water\"");
 	}
 	if (Flags & MapFieldSpace) {
-		file.printf(", \"space\"");
+		file.write_string(", \"space\"");
 	}
 	if (Flags & MapFieldUnderground) {
-		file.printf(", \"underground\"");
+		file.write_string(", \"underground\"");
 	}
 	if (Flags & MapFieldNoBuilding) {
 		//Wyrmgus start
 //		file.printf(", \"mud\"");
-		file.printf(", \"no-building\"");
+		file.write_string(", \"no-building\"");
 		//Wyrmgus end
 	}
 	if (Flags & MapFieldUnpassable) {
-		file.printf(", \"block\"");
+		file.write_string(", \"block\"");
 	}
 	if (Flags & MapFieldWall) {
-		file.printf(", \"wall\"");
+		file.write_string(", \"wall\"");
 	}
 	if (Flags & MapFieldRocks) {
-		file.printf(", \"rock\"");
+		file.write_string(", \"rock\"");
 	}
 	if (Flags & MapFieldForest) {
-		file.printf(", \"wood\"");
+		file.write_string(", \"wood\"");
 	}
 	//Wyrmgus start
 	if (Flags & MapFieldAirUnpassable) {
-		file.printf(", \"air-unpassable\"");
+		file.write_string(", \"air-unpassable\"");
 	}
 	if (Flags & MapFieldDesert) {
-		file.printf(", \"desert\"");
+		file.write_string(", \"desert\"");
 	}
 	if (Flags & MapFieldDirt) {
-		file.printf(", \"dirt\"");
+		file.write_string(", \"dirt\"");
 	}
 	if (Flags & MapFieldIce) {
-		file.printf(", \"ice\"");
+		file.write_string(", \"ice\"");
 	}
 	if (Flags & MapFieldGrass) {
-		file.printf(", \"grass\"");
+		file.write_string(", \"grass\"");
 	}
 	if (Flags & MapFieldGravel) {
-		file.printf(", \"gravel\"");
+		file.write_string(", \"gravel\"");
 	}
 	if (Flags & MapFieldMud) {
-		file.printf(", \"mud\"");
+		file.write_string(", \"mud\"");
 	}
 	if (Flags & MapFieldRailroad) {
-		file.printf(", \"railroad\"");
+		file.write_string(", \"railroad\"");
 	}
 	if (Flags & MapFieldRoad) {
-		file.printf(", \"road\"");
+		file.write_string(", \"road\"");
 	}
 	if (Flags & MapFieldNoRail) {
-		file.printf(", \"no-rail\"");
+		file.write_string(", \"no-rail\"");
 	}
 	if (Flags & MapFieldSnow) {
-		file.printf(", \"snow\"");
+		file.write_string(", \"snow\"");
 	}
 	if (Flags & MapFieldStoneFloor) {
-		file.printf(", \"stone_floor\"");
+		file.write_string(", \"stone_floor\"");
 	}
 	if (Flags & MapFieldStumps) {
-		file.printf(", \"stumps\"");
+		file.write_string(", \"stumps\"");
 	}
 
 #if 1
@@ -452,27 +468,27 @@ void tile::Save(CFile &file) const
 	// These are required for now, UnitType::FieldFlags is 0 until
 	// UpdateStats is called which is after the game is loaded
 	if (Flags & MapFieldLandUnit) {
-		file.printf(", \"ground\"");
+		file.write_string(", \"ground\"");
 	}
 	if (Flags & MapFieldAirUnit) {
-		file.printf(", \"air\"");
+		file.write_string(", \"air\"");
 	}
 	if (Flags & MapFieldSeaUnit) {
-		file.printf(", \"sea\"");
+		file.write_string(", \"sea\"");
 	}
 	if (Flags & MapFieldBuilding) {
-		file.printf(", \"building\"");
+		file.write_string(", \"building\"");
 	}
 	//Wyrmgus start
 	if (Flags & MapFieldItem) {
-		file.printf(", \"item\"");
+		file.write_string(", \"item\"");
 	}
 	if (Flags & MapFieldBridge) {
-		file.printf(", \"bridge\"");
+		file.write_string(", \"bridge\"");
 	}
 	//Wyrmgus end
 #endif
-	file.printf("}");
+	file.write_string("}");
 }
 
 
@@ -569,7 +585,7 @@ void tile::parse(lua_State *l)
 		} else if (!strcmp(value, "explored")) {
 			//Wyrmgus end
 			++j;
-			this->player_info->Visible[LuaToNumber(l, -1, j + 1)] = 1;
+			this->player_info->get_visible_ref(LuaToNumber(l, -1, j + 1)) = 1;
 		} else if (!strcmp(value, "land")) {
 			this->Flags |= MapFieldLandAllowed;
 		} else if (!strcmp(value, "coast")) {
@@ -637,6 +653,203 @@ void tile::parse(lua_State *l)
 	}
 }
 
+/**
+**	@brief	Copy the data of the tile which is stored in a savegame snapshot
+**
+**	@return	The copy of the tile's data.
+*/
+tile_snapshot tile::get_snapshot() const
+{
+	tile_snapshot snapshot;
+	snapshot.terrain = this->get_terrain();
+	snapshot.overlay_terrain = this->get_overlay_terrain();
+	snapshot.terrain_feature = this->get_terrain_feature();
+	snapshot.overlay_terrain_damaged = this->OverlayTerrainDamaged;
+	snapshot.overlay_terrain_destroyed = this->OverlayTerrainDestroyed;
+	snapshot.seen_terrain = this->player_info->SeenTerrain;
+	snapshot.seen_overlay_terrain = this->player_info->SeenOverlayTerrain;
+	snapshot.solid_tile = this->SolidTile;
+	snapshot.overlay_solid_tile = this->OverlaySolidTile;
+	snapshot.seen_solid_tile = this->player_info->SeenSolidTile;
+	snapshot.seen_overlay_solid_tile = this->player_info->SeenOverlaySolidTile;
+	snapshot.value = this->get_value();
+	snapshot.movement_cost = this->get_movement_cost();
+	snapshot.landmass = this->Landmass;
+	snapshot.settlement = this->get_settlement();
+	snapshot.transition_tiles = this->TransitionTiles;
+	snapshot.overlay_transition_tiles = this->OverlayTransitionTiles;
+	snapshot.seen_transition_tiles = this->player_info->SeenTransitionTiles;
+	snapshot.seen_overlay_transition_tiles = this->player_info->SeenOverlayTransitionTiles;
+
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (this->player_info->get_visible(i) == 1) {
+			snapshot.explored_players |= uint64_t(1) << i;
+		}
+	}
+
+	//the speed mask is the only flag not saved in the Lua format either
+	snapshot.flags = this->Flags & ~MapFieldSpeedMask;
+
+	return snapshot;
+}
+
+/**
+**	@brief	Add the data entries the tile refers to to the tables of a savegame snapshot
+**
+**	@param	tables	The snapshot tables.
+*/
+void tile_snapshot::add_entries(tile_snapshot_tables &tables) const
+{
+	tables.terrain_types.add_entry(this->terrain);
+	tables.terrain_types.add_entry(this->overlay_terrain);
+	tables.terrain_features.add_entry(this->terrain_feature);
+	tables.terrain_types.add_entry(this->seen_terrain);
+	tables.terrain_types.add_entry(this->seen_overlay_terrain);
+	tables.settlements.add_entry(this->settlement);
+
+	for (const auto &transition_tile : this->transition_tiles) {
+		tables.terrain_types.add_entry(transition_tile.first);
+	}
+
+	for (const auto &transition_tile : this->overlay_transition_tiles) {
+		tables.terrain_types.add_entry(transition_tile.first);
+	}
+
+	for (const auto &transition_tile : this->seen_transition_tiles) {
+		tables.terrain_types.add_entry(transition_tile.first);
+	}
+
+	for (const auto &transition_tile : this->seen_overlay_transition_tiles) {
+		tables.terrain_types.add_entry(transition_tile.first);
+	}
+}
+
+static void save_transition_tiles_snapshot(snapshot_writer &writer, const std::vector<std::pair<const terrain_type *, short>> &transition_tiles, const tile_snapshot_tables &tables)
+{
+	writer.write_uint32(static_cast<uint32_t>(transition_tiles.size()));
+	for (const auto &transition_tile : transition_tiles) {
+		writer.write_uint32(tables.terrain_types.get_index(transition_tile.first));
+		writer.write_int16(transition_tile.second);
+	}
+}
+
+static void load_transition_tiles_snapshot(snapshot_reader &reader, std::vector<std::pair<const terrain_type *, short>> &transition_tiles, const tile_snapshot_tables &tables)
+{
+	const uint32_t count = reader.read_uint32();
+	for (uint32_t i = 0; i < count; ++i) {
+		const terrain_type *terrain = tables.terrain_types.get_entry(reader.read_uint32());
+		const short tile_number = reader.read_int16();
+		transition_tiles.emplace_back(terrain, tile_number);
+	}
+}
+
+/**
+**	@brief	Save the tile to a savegame snapshot
+**
+**	This stores the same data as tile::Save(), in the same order in which tile::parse() applies it. It only reads the copy, so it can be called on another thread.
+**
+**	@param	writer	The snapshot writer.
+**	@param	tables	The snapshot tables, which must contain the data entries the tile refers to.
+*/
+void tile_snapshot::save(snapshot_writer &writer, const tile_snapshot_tables &tables) const
+{
+	writer.write_uint32(tables.terrain_types.get_index(this->terrain));
+	writer.write_uint32(tables.terrain_types.get_index(this->overlay_terrain));
+	writer.write_uint32(tables.terrain_features.get_index(this->terrain_feature));
+	writer.write_bool(this->overlay_terrain_damaged);
+	writer.write_bool(this->overlay_terrain_destroyed);
+	writer.write_uint32(tables.terrain_types.get_index(this->seen_terrain));
+	writer.write_uint32(tables.terrain_types.get_index(this->seen_overlay_terrain));
+	writer.write_int16(this->solid_tile);
+	writer.write_int16(this->overlay_solid_tile);
+	writer.write_int16(this->seen_solid_tile);
+	writer.write_int16(this->seen_overlay_solid_tile);
+	writer.write_int16(this->value);
+	writer.write_uint8(this->movement_cost);
+	writer.write_int32(this->landmass);
+	writer.write_uint32(tables.settlements.get_index(this->settlement));
+
+	save_transition_tiles_snapshot(writer, this->transition_tiles, tables);
+	save_transition_tiles_snapshot(writer, this->overlay_transition_tiles, tables);
+	save_transition_tiles_snapshot(writer, this->seen_transition_tiles, tables);
+	save_transition_tiles_snapshot(writer, this->seen_overlay_transition_tiles, tables);
+
+	writer.write_uint8(static_cast<uint8_t>(std::popcount(this->explored_players)));
+	for (int i = 0; i != PlayerMax; ++i) {
+		if (this->explored_players & (uint64_t(1) << i)) {
+			writer.write_uint8(static_cast<uint8_t>(i));
+		}
+	}
+
+	writer.write_uint32(static_cast<uint32_t>(this->flags));
+}
+
+/**
+**	@brief	Load the tile from a savegame snapshot
+**
+**	@param	reader	The snapshot reader.
+**	@param	tables	The snapshot tables, already read from the snapshot.
+*/
+void tile::load_snapshot(snapshot_reader &reader, const tile_snapshot_tables &tables)
+{
+	const terrain_type *terrain = tables.terrain_types.get_entry(reader.read_uint32());
+	if (terrain != nullptr) {
+		this->terrain = terrain;
+	}
+
+	const terrain_type *overlay_terrain = tables.terrain_types.get_entry(reader.read_uint32());
+	if (overlay_terrain != nullptr) {
+		this->overlay_terrain = overlay_terrain;
+	}
+
+	const wyrmgus::terrain_feature *terrain_feature = tables.terrain_features.get_entry(reader.read_uint32());
+	if (terrain_feature != nullptr) {
+		this->terrain_feature = terrain_feature;
+	}
+
+	this->SetOverlayTerrainDamaged(reader.read_bool());
+	this->SetOverlayTerrainDestroyed(reader.read_bool());
+
+	const terrain_type *seen_terrain = tables.terrain_types.get_entry(reader.read_uint32());
+	if (seen_terrain != nullptr) {
+		this->player_info->SeenTerrain = seen_terrain;
+	}
+
+	const terrain_type *seen_overlay_terrain = tables.terrain_types.get_entry(reader.read_uint32());
+	if (seen_overlay_terrain != nullptr) {
+		this->player_info->SeenOverlayTerrain = seen_overlay_terrain;
+	}
+
+	this->SolidTile = reader.read_int16();
+	this->OverlaySolidTile = reader.read_int16();
+	this->player_info->SeenSolidTile = reader.read_int16();
+	this->player_info->SeenOverlaySolidTile = reader.read_int16();
+	this->value = reader.read_int16();
+	this->movement_cost = reader.read_uint8();
+	this->Landmass = reader.read_int32();
+
+	const site *settlement = tables.settlements.get_entry(reader.read_uint32());
+	if (settlement != nullptr) {
+		this->settlement = settlement;
+	}
+
+	load_transition_tiles_snapshot(reader, this->TransitionTiles, tables);
+	load_transition_tiles_snapshot(reader, this->OverlayTransitionTiles, tables);
+	load_transition_tiles_snapshot(reader, this->player_info->SeenTransitionTiles, tables);
+	load_transition_tiles_snapshot(reader, this->player_info->SeenOverlayTransitionTiles, tables);
+
+	const uint8_t explored_count = reader.read_uint8();
+	for (uint8_t i = 0; i < explored_count; ++i) {
+		const uint8_t player_index = reader.read_uint8();
+		if (player_index >= PlayerMax) {
+			throw std::runtime_error("Invalid player index in savegame snapshot: " + std::to_string(player_index) + ".");
+		}
+		this->player_info->get_visible_ref(player_index) = 1;
+	}
+
+	this->Flags |= reader.read_uint32();
+}
+
 /// Check if a field flags.
 bool tile::CheckMask(const int mask) const
 {
@@ -707,8 +920,14 @@ bool tile::isAWall() const
 
 void tile::update_movement_cost()
 {
+	const unsigned char old_movement_cost = this->movement_cost;
+
 	this->movement_cost = DefaultTileMovementCost; // default speed
 	this->movement_cost -= this->get_top_terrain(false, true)->get_movement_bonus();
+
+	if (this->movement_cost != old_movement_cost) {
+		++tile::movement_cost_generation;
+	}
 }
 
 CPlayer *tile::get_owner() const
@@ -734,6 +953,32 @@ bool tile::is_on_trade_route() const
 	return this->get_terrain_feature() != nullptr && this->get_terrain_feature()->is_trade_route();
 }
 
+/**
+**	@brief	Get the current frame of the tile's terrain animation
+**
+**	The frame is derived from the tile animation clock, so that animated tiles need no per-cycle updates.
+*/
+unsigned char tile::get_animation_frame() const
+{
+	if (this->get_terrain() == nullptr || this->get_terrain()->SolidAnimationFrames <= 0) {
+		return 0;
+	}
+
+	return static_cast<unsigned char>((this->AnimationPhase + GetTileAnimationTick()) % this->get_terrain()->SolidAnimationFrames);
+}
+
+/**
+**	@brief	Get the current frame of the tile's overlay terrain animation
+*/
+unsigned char tile::get_overlay_animation_frame() const
+{
+	if (this->get_overlay_terrain() == nullptr || this->get_overlay_terrain()->SolidAnimationFrames <= 0) {
+		return 0;
+	}
+
+	return static_cast<unsigned char>((this->OverlayAnimationPhase + GetTileAnimationTick()) % this->get_overlay_terrain()->SolidAnimationFrames);
+}
+
 //
 //  tile_player_info
 //
@@ -753,7 +998,7 @@ unsigned char tile_player_info::TeamVisibilityState(const CPlayer &player) const
 	const int player_index = player.Index;
 	for (const int i : player.get_shared_vision()) {
 		if (CPlayer::Players[i]->has_shared_vision_with(player_index)) { //if the shared vision is mutual
-			maxVision = std::max<unsigned char>(maxVision, this->Visible[i]);
+			maxVision = std::max<unsigned char>(maxVision, this->get_visible(i));
 			if (maxVision >= 2) {
 				return 2;
 			}
@@ -762,11 +1007,12 @@ unsigned char tile_player_info::TeamVisibilityState(const CPlayer &player) const
 
 	for (const CPlayer *other_player : CPlayer::get_revealed_players()) {
 		const int other_player_index = other_player->Index;
-		if (this->Visible[other_player_index] < 2) { //don't show a revealed player's explored tiles, only the currently visible ones
+		const unsigned short other_player_visible = this->get_visible(other_player_index);
+		if (other_player_visible < 2) { //don't show a revealed player's explored tiles, only the currently visible ones
 			continue;
 		}
 
-		maxVision = std::max<unsigned char>(maxVision, Visible[other_player_index]);
+		maxVision = std::max<unsigned char>(maxVision, other_player_visible);
 		if (maxVision >= 2) {
 			return 2;
 		}
@@ -781,20 +1027,20 @@ unsigned char tile_player_info::TeamVisibilityState(const CPlayer &player) const
 
 bool tile_player_info::IsExplored(const CPlayer &player) const
 {
-	return Visible[player.Index] != 0;
+	return this->get_visible(player.Index) != 0;
 }
 
 //Wyrmgus start
 bool tile_player_info::IsTeamExplored(const CPlayer &player) const
 {
-	return Visible[player.Index] != 0 || TeamVisibilityState(player) != 0;
+	return this->get_visible(player.Index) != 0 || TeamVisibilityState(player) != 0;
 }
 //Wyrmgus end
 
 bool tile_player_info::IsVisible(const CPlayer &player) const
 {
 	const bool fogOfWar = !CMap::Map.NoFogOfWar;
-	return Visible[player.Index] >= 2 || (!fogOfWar && IsExplored(player));
+	return this->get_visible(player.Index) >= 2 || (!fogOfWar && IsExplored(player));
 }
 
 bool tile_player_info::IsTeamVisible(const CPlayer &player) const
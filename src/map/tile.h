@@ -33,23 +33,26 @@
 **    This is the tile number, that the player sitting on the computer
 **    currently knows. Idea: Can be uses for illusions.
 **
-**  tile_player_info::Visible[]
+**  tile_visibility_plane::Visible[]
 **
 **    Counter how many units of the player can see this field. 0 the
 **    field is not explored, 1 explored, n-1 unit see it. Currently
-**    no more than 253 units can see a field.
+**    no more than 65533 units can see a field.
 **
-**  tile_player_info::VisCloak[]
+**  tile_visibility_plane::VisCloak[]
 **
 **    Visiblity for cloaking.
 **
-**  tile_player_info::Radar[]
+**  tile_visibility_plane::Radar[]
 **
 **    Visiblity for radar.
 **
-**  tile_player_info::RadarJammer[]
+**  tile_visibility_plane::RadarJammer[]
 **
 **    Jamming capabilities.
+**
+**  The visibility planes are stored per map layer and per player, and
+**  tile_player_info only refers to the tile's entries in them.
 */
 
 /**
@@ -108,6 +111,7 @@
 **    top and right most map coordinate.
 */
 
+#include "game/snapshot.h"
 #include "unit/unit_cache.h"
 #include "vec2i.h"
 
@@ -126,16 +130,122 @@ class site;
 class terrain_feature;
 class terrain_type;
 
+/**
+**  The visibility of the tiles of a map layer for a player.
+**
+**  Each kind of visibility is stored contiguously for all the tiles of the map layer.
+*/
+class tile_visibility_plane final
+{
+public:
+	explicit tile_visibility_plane(const int tile_count)
+		: Visible(tile_count, 0), VisCloak(tile_count, 0), VisEthereal(tile_count, 0), Radar(tile_count, 0), RadarJammer(tile_count, 0)
+	{
+	}
+
+	std::vector<unsigned short> Visible;    /// Seen counter 0 unexplored
+	std::vector<unsigned char> VisCloak;    /// Visiblity for cloaking.
+	std::vector<unsigned char> VisEthereal; /// Visiblity for ethereal.
+	std::vector<unsigned char> Radar;       /// Visiblity for radar.
+	std::vector<unsigned char> RadarJammer; /// Jamming capabilities.
+};
+
+/**
+**  The visibility planes of a map layer.
+**
+**  A player's plane is only allocated when the visibility of a tile is first changed for them,
+**  so that no memory is used for the player slots which are not in the game.
+*/
+class tile_visibility_planes final
+{
+public:
+	explicit tile_visibility_planes(const int tile_count) : tile_count(tile_count)
+	{
+	}
+
+	const tile_visibility_plane *get_plane(const int player_index) const
+	{
+		return this->planes[player_index].get();
+	}
+
+	tile_visibility_plane &get_or_create_plane(const int player_index)
+	{
+		std::unique_ptr<tile_visibility_plane> &plane = this->planes[player_index];
+
+		if (plane == nullptr) {
+			plane = std::make_unique<tile_visibility_plane>(this->tile_count);
+		}
+
+		return *plane;
+	}
+
+private:
+	const int tile_count = 0;
+	std::unique_ptr<tile_visibility_plane> planes[PlayerMax];
+};
+
 class tile_player_info final
 {
 public:
-	tile_player_info()
+	void set_visibility_planes(tile_visibility_planes *visibility_planes, const int tile_index)
+	{
+		this->visibility_planes = visibility_planes;
+		this->tile_index = tile_index;
+	}
+
+	unsigned short get_visible(const int player_index) const
+	{
+		const tile_visibility_plane *plane = this->visibility_planes->get_plane(player_index);
+		return plane != nullptr ? plane->Visible[this->tile_index] : 0;
+	}
+
+	unsigned short &get_visible_ref(const int player_index)
+	{
+		return this->visibility_planes->get_or_create_plane(player_index).Visible[this->tile_index];
+	}
+
+	unsigned char get_vis_cloak(const int player_index) const
+	{
+		const tile_visibility_plane *plane = this->visibility_planes->get_plane(player_index);
+		return plane != nullptr ? plane->VisCloak[this->tile_index] : 0;
+	}
+
+	unsigned char &get_vis_cloak_ref(const int player_index)
+	{
+		return this->visibility_planes->get_or_create_plane(player_index).VisCloak[this->tile_index];
+	}
+
+	unsigned char get_vis_ethereal(const int player_index) const
+	{
+		const tile_visibility_plane *plane = this->visibility_planes->get_plane(player_index);
+		return plane != nullptr ? plane->VisEthereal[this->tile_index] : 0;
+	}
+
+	unsigned char &get_vis_ethereal_ref(const int player_index)
+	{
+		return this->visibility_planes->get_or_create_plane(player_index).VisEthereal[this->tile_index];
+	}
+
+	unsigned char get_radar(const int player_index) const
+	{
+		const tile_visibility_plane *plane = this->visibility_planes->get_plane(player_index);
+		return plane != nullptr ? plane->Radar[this->tile_index] : 0;
+	}
+
+	unsigned char &get_radar_ref(const int player_index)
+	{
+		return this->visibility_planes->get_or_create_plane(player_index).Radar[this->tile_index];
+	}
+
+	unsigned char get_radar_jammer(const int player_index) const
+	{
+		const tile_visibility_plane *plane = this->visibility_planes->get_plane(player_index);
+		return plane != nullptr ? plane->RadarJammer[this->tile_index] : 0;
+	}
+
+	unsigned char &get_radar_jammer_ref(const int player_index)
 	{
-		memset(Visible, 0, sizeof(Visible));
-		memset(VisCloak, 0, sizeof(VisCloak));
-		memset(VisEthereal, 0, sizeof(VisEthereal));
-		memset(Radar, 0, sizeof(Radar));
-		memset(RadarJammer, 0, sizeof(RadarJammer));
+		return this->visibility_planes->get_or_create_plane(player_index).RadarJammer[this->tile_index];
 	}
 
 	/// Check if a field for the user is explored.
@@ -167,11 +277,71 @@ public:
 	std::vector<std::pair<const wyrmgus::terrain_type *, short>> SeenTransitionTiles;			/// Transition tiles; the pair contains the terrain type and the tile index
 	std::vector<std::pair<const wyrmgus::terrain_type *, short>> SeenOverlayTransitionTiles;		/// Overlay transition tiles; the pair contains the terrain type and the tile index
 	//Wyrmgus end
-	unsigned short Visible[PlayerMax];    /// Seen counter 0 unexplored
-	unsigned char VisCloak[PlayerMax];    /// Visiblity for cloaking.
-	unsigned char VisEthereal[PlayerMax];    /// Visiblity for ethereal.
-	unsigned char Radar[PlayerMax];       /// Visiblity for radar.
-	unsigned char RadarJammer[PlayerMax]; /// Jamming capabilities.
+
+private:
+	tile_visibility_planes *visibility_planes = nullptr; /// the visibility planes of the tile's map layer
+	int tile_index = 0;                                  /// the index of the tile in the visibility planes
+};
+
+/**
+**	@brief	The tables of the data entries referred to by the tiles in a savegame snapshot
+*/
+class tile_snapshot_tables final
+{
+public:
+	snapshot_entry_table<terrain_type> terrain_types;
+	snapshot_entry_table<terrain_feature> terrain_features;
+	snapshot_entry_table<site> settlements;
+};
+
+/**
+**	@brief	Copy of the data of a tile which is stored in a savegame snapshot
+**
+**	Copying the tiles between game cycles is much cheaper than serializing them, which involves looking up the data entries they refer to in the snapshot tables, so the serialization can be done on the background thread while the game keeps running.
+*/
+class tile_snapshot final
+{
+public:
+	void add_entries(tile_snapshot_tables &tables) const;
+	void save(snapshot_writer &writer, const tile_snapshot_tables &tables) const;
+
+private:
+	static_assert(PlayerMax <= 64, "The players which explored a tile are stored as a 64-bit mask.");
+
+	const terrain_type *terrain = nullptr;
+	const terrain_type *overlay_terrain = nullptr;
+	const wyrmgus::terrain_feature *terrain_feature = nullptr;
+	bool overlay_terrain_damaged = false;
+	bool overlay_terrain_destroyed = false;
+	const terrain_type *seen_terrain = nullptr;
+	const terrain_type *seen_overlay_terrain = nullptr;
+	short solid_tile = 0;
+	short overlay_solid_tile = 0;
+	short seen_solid_tile = 0;
+	short seen_overlay_solid_tile = 0;
+	short value = 0;
+	unsigned char movement_cost = 0;
+	int landmass = 0;
+	const site *settlement = nullptr;
+	std::vector<std::pair<const terrain_type *, short>> transition_tiles;
+	std::vector<std::pair<const terrain_type *, short>> overlay_transition_tiles;
+	std::vector<std::pair<const terrain_type *, short>> seen_transition_tiles;
+	std::vector<std::pair<const terrain_type *, short>> seen_overlay_transition_tiles;
+	uint64_t explored_players = 0; /// Mask of the players which have explored the tile.
+	unsigned long flags = 0;
+
+	friend class tile;
+};
+
+/**
+**	@brief	Copy of the tiles of a map layer which are stored in a savegame snapshot
+*/
+class map_layer_snapshot final
+{
+public:
+	int width = 0;
+	int height = 0;
+	std::vector<tile_snapshot> tiles;
 };
 
 /// Describes a field of the map
@@ -182,6 +352,8 @@ public:
 
 	void Save(CFile &file) const;
 	void parse(lua_State *l);
+	tile_snapshot get_snapshot() const;
+	void load_snapshot(snapshot_reader &reader, const tile_snapshot_tables &tables);
 
 	//Wyrmgus start
 	void SetTerrain(const terrain_type *terrain_type);
@@ -265,6 +437,12 @@ public:
 
 	void update_movement_cost();
 
+	//the generation is incremented whenever any tile's movement cost changes, so that values derived from movement costs can be cached
+	static unsigned int get_movement_cost_generation()
+	{
+		return tile::movement_cost_generation;
+	}
+
 	short get_value() const
 	{
 		return this->value;
@@ -328,12 +506,15 @@ public:
 
 	bool is_on_trade_route() const;
 
+	unsigned char get_animation_frame() const;
+	unsigned char get_overlay_animation_frame() const;
+
 public:
 	//Wyrmgus start
 //	unsigned short Flags = 0;      /// field flags
 	unsigned long Flags = 0;      /// field flags
-	unsigned char AnimationFrame = 0;		/// current frame of the tile's animation
-	unsigned char OverlayAnimationFrame = 0;		/// current frame of the overlay tile's animation
+	unsigned char AnimationPhase = 0;		/// offset of the tile's animation from the tile animation clock
+	unsigned char OverlayAnimationPhase = 0;		/// offset of the overlay tile's animation from the tile animation clock
 private:
 	const terrain_type *terrain = nullptr;
 	const terrain_type *overlay_terrain = nullptr;
@@ -347,6 +528,8 @@ public:
 	std::vector<std::pair<const terrain_type *, short>> OverlayTransitionTiles;		/// Overlay transition tiles; the pair contains the terrain type and the tile index
 	//Wyrmgus end
 private:
+	static inline unsigned int movement_cost_generation = 0;
+
 	unsigned char movement_cost = 0; //unit cost to move in this tile
 	short value = 0; //HP for walls/resource quantity/forest regeneration/destroyed wall and rock decay
 public:
@@ -0,0 +1,112 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "stratagus.h"
+
+#include "map/tile_timer_queue.h"
+
+namespace wyrmgus {
+
+void tile_timer_queue::schedule(const unsigned int tile_index, const unsigned long due_step)
+{
+	if (this->tile_states.empty()) {
+		this->tile_states.resize(this->tile_count);
+	}
+
+	tile_state &state = this->tile_states[tile_index];
+
+	if (state.scheduled) {
+		//the pending event is superseded by the new one
+		++this->stale_timer_count;
+	}
+
+	++state.generation;
+	state.due_step = due_step;
+	state.scheduled = true;
+
+	timer new_timer;
+	new_timer.due_step = due_step;
+	new_timer.sequence = this->next_sequence++;
+	new_timer.tile_index = tile_index;
+	new_timer.generation = state.generation;
+	this->timers.push(new_timer);
+
+	if (this->stale_timer_count > this->timers.size() / 2 && this->stale_timer_count > 64) {
+		this->remove_stale_timers();
+	}
+}
+
+void tile_timer_queue::cancel(const unsigned int tile_index)
+{
+	if (!this->is_scheduled(tile_index)) {
+		return;
+	}
+
+	tile_state &state = this->tile_states[tile_index];
+	++state.generation;
+	state.scheduled = false;
+
+	//the event stays in the heap until it is popped, but is ignored then
+	++this->stale_timer_count;
+}
+
+void tile_timer_queue::clear()
+{
+	this->timers = decltype(this->timers)();
+	this->tile_states.clear();
+	this->next_sequence = 0;
+	this->stale_timer_count = 0;
+}
+
+/**
+**	@brief	Rebuild the heap without the events which have been cancelled or rescheduled, so that frequently changing tiles do not make it grow without bounds
+*/
+void tile_timer_queue::remove_stale_timers()
+{
+	std::vector<timer> current_timers;
+	current_timers.reserve(this->timers.size() - this->stale_timer_count);
+
+	while (!this->timers.empty()) {
+		const timer &top_timer = this->timers.top();
+		const tile_state &state = this->tile_states[top_timer.tile_index];
+
+		if (state.scheduled && state.generation == top_timer.generation) {
+			current_timers.push_back(top_timer);
+		}
+
+		this->timers.pop();
+	}
+
+	this->timers = decltype(this->timers)(timer_compare(), std::move(current_timers));
+	this->stale_timer_count = 0;
+}
+
+}
@@ -0,0 +1,123 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+namespace wyrmgus {
+
+//a queue of timed events for the tiles of a map layer, ordered by the step in which they are due
+//each tile can have at most one pending event in a queue; scheduling and cancelling events takes constant time, apart from the logarithmic insertion into the heap
+class tile_timer_queue final
+{
+private:
+	struct timer final
+	{
+		unsigned long due_step = 0;
+		unsigned long long sequence = 0; //keeps events due in the same step in the order in which they were scheduled
+		unsigned int tile_index = 0;
+		unsigned int generation = 0;
+	};
+
+	struct timer_compare final
+	{
+		bool operator()(const timer &a, const timer &b) const
+		{
+			if (a.due_step != b.due_step) {
+				return a.due_step > b.due_step;
+			}
+
+			return a.sequence > b.sequence;
+		}
+	};
+
+	//the state of a tile in the queue; events in the heap whose generation does not match their tile's are stale, having been cancelled or rescheduled
+	struct tile_state final
+	{
+		unsigned long due_step = 0;
+		unsigned int generation = 0;
+		bool scheduled = false;
+	};
+
+public:
+	explicit tile_timer_queue(const unsigned int tile_count) : tile_count(tile_count)
+	{
+	}
+
+	bool is_scheduled(const unsigned int tile_index) const
+	{
+		return !this->tile_states.empty() && this->tile_states[tile_index].scheduled;
+	}
+
+	void schedule(const unsigned int tile_index, const unsigned long due_step);
+	void cancel(const unsigned int tile_index);
+	void clear();
+
+	//call the function for the tile index of each event due at or before the given step, in due order; the function may schedule new events for later steps
+	template <typename function_type>
+	void process_due_timers(const unsigned long step, const function_type &function)
+	{
+		while (!this->timers.empty() && this->timers.top().due_step <= step) {
+			const timer due_timer = this->timers.top();
+			this->timers.pop();
+
+			tile_state &state = this->tile_states[due_timer.tile_index];
+			if (!state.scheduled || state.generation != due_timer.generation) {
+				--this->stale_timer_count;
+				continue;
+			}
+
+			state.scheduled = false;
+			function(due_timer.tile_index);
+		}
+	}
+
+	template <typename function_type>
+	void for_each_scheduled_tile(const function_type &function) const
+	{
+		for (unsigned int i = 0; i < this->tile_states.size(); ++i) {
+			if (this->tile_states[i].scheduled) {
+				function(i, this->tile_states[i].due_step);
+			}
+		}
+	}
+
+private:
+	void remove_stale_timers();
+
+private:
+	unsigned int tile_count = 0;
+	std::priority_queue<timer, std::vector<timer>, timer_compare> timers;
+	std::vector<tile_state> tile_states; //allocated when the first event is scheduled, as most map layers never get any
+	unsigned long long next_sequence = 0;
+	size_t stale_timer_count = 0;
+};
+
+}
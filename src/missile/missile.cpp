@@ -64,14 +64,57 @@
 #include "video/font.h"
 #include "video/video.h"
 
+#include <array>
+
 #ifdef __MORPHOS__
 #undef Wait
 #endif
 
+static constexpr size_t MissileClassCount = static_cast<size_t>(wyrmgus::missile_class::straight_fly) + 1;
+
+/**
+**  Table of missiles, grouped by missile class so that the missiles of each class are handled in a batch.
+**
+**  Missiles are removed by moving the last missile of their batch into their place, and are only deleted at the end of the cycle, so that pointers to them stay valid while missile actions are being handled.
+*/
+class MissileTable final
+{
+public:
+	void AddMissile(std::unique_ptr<Missile> &&missile)
+	{
+		const size_t batch_index = static_cast<size_t>(missile->Type->get_missile_class());
+		this->Batches[batch_index].push_back(std::move(missile));
+	}
+
+	template <typename function_type>
+	void ForEachMissile(const function_type &function) const
+	{
+		for (const std::vector<std::unique_ptr<Missile>> &batch : this->Batches) {
+			for (const std::unique_ptr<Missile> &missile : batch) {
+				function(*missile);
+			}
+		}
+	}
+
+	void HandleActions();
+
+	void Clear()
+	{
+		for (std::vector<std::unique_ptr<Missile>> &batch : this->Batches) {
+			batch.clear();
+		}
+		this->RemovedMissiles.clear();
+	}
+
+private:
+	std::array<std::vector<std::unique_ptr<Missile>>, MissileClassCount> Batches;
+	std::vector<std::unique_ptr<Missile>> RemovedMissiles; /// missiles removed in the current cycle, deleted at its end
+};
+
 unsigned int Missile::Count = 0;
 
-static std::vector<std::unique_ptr<Missile>> GlobalMissiles;    /// all global missiles on map
-static std::vector<std::unique_ptr<Missile>> LocalMissiles;     /// all local missiles on map
+static MissileTable GlobalMissiles;    /// all global missiles on map
+static MissileTable LocalMissiles;     /// all local missiles on map
 
 std::vector<std::unique_ptr<BurningBuildingFrame>> BurningBuildingFrames; /// Burning building frames
 
@@ -324,7 +367,7 @@ Missile *MakeMissile(const wyrmgus::missile_type &mtype, const PixelPos &startPo
 {
 	std::unique_ptr<Missile> missile = Missile::Init(mtype, startPos, destPos, z);
 	Missile *missile_ptr = missile.get();
-	GlobalMissiles.push_back(std::move(missile));
+	GlobalMissiles.AddMissile(std::move(missile));
 	return missile_ptr;
 }
 
@@ -342,7 +385,7 @@ Missile *MakeLocalMissile(const wyrmgus::missile_type &mtype, const PixelPos &st
 	std::unique_ptr<Missile> missile = Missile::Init(mtype, startPos, destPos, z);
 	missile->Local = 1;
 	Missile *missile_ptr = missile.get();
-	LocalMissiles.push_back(std::move(missile));
+	LocalMissiles.AddMissile(std::move(missile));
 	return missile_ptr;
 }
 
@@ -1032,34 +1075,30 @@ static bool MissileDrawLevelCompare(const Missile *const l, const Missile *const
 */
 void FindAndSortMissiles(const CViewport &vp, std::vector<Missile *> &table)
 {
-	typedef std::vector<std::unique_ptr<Missile>>::const_iterator MissilePtrConstiterator;
-
 	// Loop through global missiles, then through locals.
-	for (MissilePtrConstiterator i = GlobalMissiles.begin(); i != GlobalMissiles.end(); ++i) {
-		Missile &missile = *(*i);
+	GlobalMissiles.ForEachMissile([&](Missile &missile) {
 		//Wyrmgus start
 //		if (missile.Delay || missile.Hidden) {
 		if (missile.Delay || missile.Hidden || missile.MapLayer != UI.CurrentMapLayer->ID) {
 		//Wyrmgus end
-			continue;  // delayed or hidden -> aren't shown
+			return;  // delayed or hidden -> aren't shown
 		}
 		// Draw only visible missiles
 		if (MissileVisibleInViewport(vp, missile)) {
 			table.push_back(&missile);
 		}
-	}
+	});
 
-	for (MissilePtrConstiterator i = LocalMissiles.begin(); i != LocalMissiles.end(); ++i) {
-		Missile &missile = *(*i);
+	LocalMissiles.ForEachMissile([&](Missile &missile) {
 		//Wyrmgus start
 //		if (missile.Delay || missile.Hidden) {
 		if (missile.Delay || missile.Hidden || missile.MapLayer != UI.CurrentMapLayer->ID) {
 		//Wyrmgus end
-			continue;  // delayed or hidden -> aren't shown
+			return;  // delayed or hidden -> aren't shown
 		}
 		// Local missile are visible.
 		table.push_back(&missile);
-	}
+	});
 
 	std::sort(table.begin(), table.end(), MissileDrawLevelCompare);
 }
@@ -1750,39 +1789,108 @@ void Missile::NextMissileFrameCycle()
 }
 
 /**
-**  Handle all missile actions of global/local missiles.
+**  Remove a missile from its batch, moving the last missile of the batch into its place.
 **
-**  @param missiles  Table of missiles.
+**  @param missiles          Batch of missiles.
+**  @param index             Index of the missile in the batch.
+**  @param removed_missiles  Missiles to be deleted at the end of the cycle.
 */
-static void MissilesActionLoop(std::vector<std::unique_ptr<Missile>> &missiles)
+static void RemoveMissileFromBatch(std::vector<std::unique_ptr<Missile>> &missiles, const size_t index, std::vector<std::unique_ptr<Missile>> &removed_missiles)
 {
-	for (size_t i = 0; i != missiles.size(); /* empty */) {
-		Missile &missile = *missiles[i];
+	removed_missiles.push_back(std::move(missiles[index]));
+	if (index != missiles.size() - 1) {
+		missiles[index] = std::move(missiles.back());
+	}
+	missiles.pop_back();
+}
+
+/**
+**  Handle the missile actions of a batch of missiles of the same class.
+**
+**  Missiles after the index haven't been handled yet in this cycle, including the ones moved into the place of a removed missile and the ones created in this cycle.
+**
+**  @param missiles          Batch of missiles.
+**  @param index             Index of the next missile to be handled, updated as missiles are handled.
+**  @param removed_missiles  Missiles to be deleted at the end of the cycle.
+*/
+template <typename missile_class_type>
+static void MissilesBatchActionLoop(std::vector<std::unique_ptr<Missile>> &missiles, size_t &index, std::vector<std::unique_ptr<Missile>> &removed_missiles)
+{
+	while (index < missiles.size()) {
+		//the missile class types are final, so the action calls are resolved statically
+		missile_class_type &missile = static_cast<missile_class_type &>(*missiles[index]);
 
 		if (missile.Delay) {
 			missile.Delay--;
-			++i;
+			++index;
 			continue;  // delay start of missile
 		}
 		if (missile.TTL > 0) {
 			missile.TTL--;  // overall time to live if specified
 		}
 		if (missile.TTL == 0) {
-			missiles.erase(missiles.begin() + i);
+			RemoveMissileFromBatch(missiles, index, removed_missiles);
 			continue;
 		}
 		Assert(missile.Wait);
 		if (--missile.Wait) {  // wait until time is over
-			++i;
+			++index;
 			continue;
 		}
-		missile.Action(); // may create other missiles, and so modifies the array
+		missile.Action(); // may create other missiles, and so modifies the batches
 		if (missile.TTL == 0) {
-			missiles.erase(missiles.begin() + i);
+			RemoveMissileFromBatch(missiles, index, removed_missiles);
 			continue;
 		}
-		++i;
+		++index;
+	}
+}
+
+using MissilesBatchActionLoopFunction = void (*)(std::vector<std::unique_ptr<Missile>> &, size_t &, std::vector<std::unique_ptr<Missile>> &);
+
+/// Batch action loops, in the order of the missile classes
+static constexpr std::array<MissilesBatchActionLoopFunction, MissileClassCount> MissilesBatchActionLoops = {
+	&MissilesBatchActionLoop<MissileNone>,
+	&MissilesBatchActionLoop<MissilePointToPoint>,
+	&MissilesBatchActionLoop<MissilePointToPointWithHit>,
+	&MissilesBatchActionLoop<MissilePointToPointCycleOnce>,
+	&MissilesBatchActionLoop<MissilePointToPointBounce>,
+	&MissilesBatchActionLoop<MissileStay>,
+	&MissilesBatchActionLoop<MissileCycleOnce>,
+	&MissilesBatchActionLoop<MissileFire>,
+	&MissilesBatchActionLoop<::MissileHit>,
+	&MissilesBatchActionLoop<MissileParabolic>,
+	&MissilesBatchActionLoop<MissileLandMine>,
+	&MissilesBatchActionLoop<MissileWhirlwind>,
+	&MissilesBatchActionLoop<MissileFlameShield>,
+	&MissilesBatchActionLoop<MissileDeathCoil>,
+	&MissilesBatchActionLoop<MissileTracer>,
+	&MissilesBatchActionLoop<MissileClipToTarget>,
+	&MissilesBatchActionLoop<wyrmgus::missile_continuous>,
+	&MissilesBatchActionLoop<MissileStraightFly>
+};
+
+/**
+**  Handle all missile actions of the table, batch by batch.
+*/
+void MissileTable::HandleActions()
+{
+	std::array<size_t, MissileClassCount> next_indexes{};
+
+	//missiles created by the actions of a later batch are handled in the same cycle, by going through the batches again
+	bool handled_all = false;
+	while (!handled_all) {
+		handled_all = true;
+
+		for (size_t i = 0; i < MissileClassCount; ++i) {
+			if (next_indexes[i] < this->Batches[i].size()) {
+				handled_all = false;
+				MissilesBatchActionLoops[i](this->Batches[i], next_indexes[i], this->RemovedMissiles);
+			}
+		}
 	}
+
+	this->RemovedMissiles.clear();
 }
 
 /**
@@ -1790,8 +1898,8 @@ static void MissilesActionLoop(std::vector<std::unique_ptr<Missile>> &missiles)
 */
 void MissileActions()
 {
-	MissilesActionLoop(GlobalMissiles);
-	MissilesActionLoop(LocalMissiles);
+	GlobalMissiles.HandleActions();
+	LocalMissiles.HandleActions();
 }
 
 /**
@@ -1880,12 +1988,12 @@ void SaveMissiles(CFile &file)
 	file.printf("\n--- -----------------------------------------\n");
 	file.printf("--- MODULE: missiles\n\n");
 
-	for (const std::unique_ptr<Missile> &missile : GlobalMissiles) {
-		missile->SaveMissile(file);
-	}
-	for (const std::unique_ptr<Missile> &missile : LocalMissiles) {
-		missile->SaveMissile(file);
-	}
+	GlobalMissiles.ForEachMissile([&](const Missile &missile) {
+		missile.SaveMissile(file);
+	});
+	LocalMissiles.ForEachMissile([&](const Missile &missile) {
+		missile.SaveMissile(file);
+	});
 }
 
 namespace wyrmgus {
@@ -1952,8 +2060,8 @@ Missile::~Missile()
 */
 void CleanMissiles()
 {
-	GlobalMissiles.clear();
-	LocalMissiles.clear();
+	GlobalMissiles.Clear();
+	LocalMissiles.Clear();
 }
 
 void FreeBurningBuildingFrames()
@@ -38,25 +38,41 @@
 #include "time/time_of_day.h"
 #include "unit/unit.h"
 #include "unit/unit_find.h"
+#include "unit/unit_manager.h"
 #include "unit/unit_type_type.h"
 #include "util/number_util.h"
 
 #include "pathfinder.h"
 
+#include <atomic>
+#include <chrono>
+
 struct Node {
 	int CostFromStart;  /// Real costs to reach this point
 	short int CostToGoal;     /// Estimated cost to goal
 	char InGoal;        /// is this point in the goal
 	char Direction;     /// Direction for trace back
+	int OpenSetIndex;   /// Position of the node in the open set heap, or -1 if it isn't in it
+	unsigned int Generation; /// Search generation in which the node was last written
 };
 
 struct Open {
 	Vec2i pos;
-	short int Costs; /// complete costs to goal
+	//Wyrmgus start
+//	short int Costs; /// complete costs to goal
+	int Costs; /// complete costs to goal
+	//Wyrmgus end
 	//Wyrmgus start
 //	unsigned short int O;     /// Offset into matrix
 	unsigned int O;     /// Offset into matrix
 	//Wyrmgus end
+	int CostToGoal;     /// Estimated cost to goal, used to break ties between equal costs
+	int Dist;           /// Manhattan distance to goal, used to break ties between equal estimates
+};
+
+struct CostMoveToCacheEntry {
+	int Cost;                /// Cached cost of moving to the tile
+	unsigned int Generation; /// Search generation in which the cost was cached
 };
 
 /// heuristic cost function for a*
@@ -70,32 +86,8 @@ static int AStarCosts(const Vec2i &pos, const Vec2i &goalPos)
 //                      //  N NE  E SE  S SW  W NW
 const int Heading2X[9] = {  0, +1, +1, +1, 0, -1, -1, -1, 0 };
 const int Heading2Y[9] = { -1, -1, 0, +1, +1, +1, 0, -1, 0 };
-//Wyrmgus start
-//int Heading2O[9];//heading to offset
-std::vector<int> Heading2O[9];//heading to offset
-//Wyrmgus end
 const int XY2Heading[3][3] = { {7, 6, 5}, {0, 0, 4}, {1, 2, 3}};
 
-/// cost matrix
-//Wyrmgus start
-//static Node *AStarMatrix;
-static std::vector<std::unique_ptr<Node[]>> AStarMatrix;
-//Wyrmgus end
-
-/// a list of close nodes, helps to speed up the matrix cleaning
-//Wyrmgus start
-//static int *CloseSet;
-//static int CloseSetSize;
-//static int Threshold;
-//static int OpenSetMaxSize;
-//static int AStarMatrixSize;
-static std::vector<std::unique_ptr<int[]>> CloseSet;
-static std::vector<int> CloseSetSize;
-static std::vector<int> Threshold;
-static std::vector<int> OpenSetMaxSize;
-static std::vector<int> AStarMatrixSize;
-//Wyrmgus end
-static constexpr int MAX_CLOSE_SET_RATIO = 4;
 static constexpr int MAX_OPEN_SET_RATIO = 8; // 10,16 to small
 
 /// see pathfinder.h
@@ -104,37 +96,141 @@ int AStarMovingUnitCrossingCost = 5;
 bool AStarKnowUnseenTerrain = false;
 int AStarUnknownTerrainCost = 2;
 
-//Wyrmgus start
-//static int AStarMapWidth;
-//static int AStarMapHeight;
-static std::vector<int> AStarMapWidth;
-static std::vector<int> AStarMapHeight;
-//Wyrmgus end
-
-static int AStarGoalX;
-static int AStarGoalY;
+/// incremented whenever the A* data structures are (re)initialized, so that contexts know when to resize their buffers
+static std::atomic<unsigned int> AStarMapGeneration = 0;
 
 /**
-**  The Open set is handled by a stored array
-**  the end of the array holds the item with the smallest cost.
+**  The state of an A* search for each map layer.
+**
+**  Each thread has its own context, so that several searches can be run
+**  at the same time. Instead of clearing the cost matrix and the move cost
+**  cache before each search, their entries are stamped with the search
+**  generation, and entries from older searches are treated as unset.
 */
+class AStarContext
+{
+public:
+	struct Layer {
+		int Width = 0;
+		int Height = 0;
+		std::unique_ptr<Node[]> Matrix;                  /// cost matrix
+		std::unique_ptr<CostMoveToCacheEntry[]> CostMoveToCache;
+		/**
+		**  The Open set is handled by a 4-ary min-heap, with each node
+		**  storing its position in it, so that its cost can be decreased in place.
+		*/
+		std::vector<Open> OpenHeap;                      /// The set of Open nodes
+		/**
+		**  The legacy Open set, handled by a sorted array whose end holds the item with the smallest cost.
+		**  It is only allocated when benchmarking against the heap.
+		*/
+		std::unique_ptr<Open[]> OpenSet;
+		int OpenSetSize = 0;                             /// The size of the sorted open node set
+		int OpenSetMaxSize = 0;
+		int Heading2O[9];                                /// heading to offset
+	};
 
-/// The set of Open nodes
-//Wyrmgus start
-//static Open *OpenSet;
-static std::vector<std::unique_ptr<Open[]>> OpenSet;
-//Wyrmgus end
-/// The size of the open node set
-//Wyrmgus start
-//static int OpenSetSize;
-static std::vector<int> OpenSetSize;
-//Wyrmgus end
+	/// Get the context of the current thread
+	static AStarContext &Get()
+	{
+		thread_local AStarContext context;
 
-//Wyrmgus start
-//static int *CostMoveToCache;
-static std::vector<std::unique_ptr<int[]>> CostMoveToCache;
-//Wyrmgus end
-static constexpr int CacheNotSet = -5;
+		if (context.MapGeneration != AStarMapGeneration) {
+			context.Init();
+		}
+
+		return context;
+	}
+
+	/// Set up the context for the current map layers; the buffers of a layer are only allocated when it is first searched
+	void Init()
+	{
+		this->Layers.clear();
+		this->Generation = 0;
+		this->MapGeneration = AStarMapGeneration;
+
+		for (size_t z = 0; z < CMap::Map.Info.MapWidths.size(); ++z) {
+			Layer &layer = this->Layers.emplace_back();
+			layer.Width = CMap::Map.Info.MapWidths[z];
+			layer.Height = CMap::Map.Info.MapHeights[z];
+
+			for (int i = 0; i < 9; ++i) {
+				layer.Heading2O[i] = Heading2Y[i] * layer.Width;
+			}
+		}
+	}
+
+	/// Start a new search on a map layer, invalidating the results of previous ones
+	Layer &BeginSearch(const int z, const Vec2i &goalPos)
+	{
+		++this->Generation;
+
+		if (this->Generation == 0) {
+			//the generation counter wrapped around, so the stamps of all entries have to be reset
+			for (Layer &layer : this->Layers) {
+				if (layer.Matrix == nullptr) {
+					continue;
+				}
+
+				const int size = layer.Width * layer.Height;
+				memset(layer.Matrix.get(), 0, sizeof(Node) * size);
+				memset(layer.CostMoveToCache.get(), 0, sizeof(CostMoveToCacheEntry) * size);
+			}
+			this->Generation = 1;
+		}
+
+		this->GoalX = goalPos.x;
+		this->GoalY = goalPos.y;
+
+		Layer &layer = this->Layers[z];
+		if (layer.Matrix == nullptr) {
+			const int size = layer.Width * layer.Height;
+			layer.Matrix = std::make_unique<Node[]>(size);
+			memset(layer.Matrix.get(), 0, sizeof(Node) * size);
+			layer.CostMoveToCache = std::make_unique<CostMoveToCacheEntry[]>(size);
+			memset(layer.CostMoveToCache.get(), 0, sizeof(CostMoveToCacheEntry) * size);
+		}
+		return layer;
+	}
+
+	Layer &GetLayer(const int z)
+	{
+		return this->Layers[z];
+	}
+
+	/// Get a node of the cost matrix, resetting it if it was last written by a previous search
+	Node &GetNode(const int z, const unsigned int offset)
+	{
+		Node &node = this->Layers[z].Matrix[offset];
+		if (node.Generation != this->Generation) {
+			node.CostFromStart = 0;
+			node.InGoal = 0;
+			node.OpenSetIndex = -1;
+			node.Generation = this->Generation;
+		}
+		return node;
+	}
+
+	CostMoveToCacheEntry &GetCostMoveToCacheEntry(const int z, const unsigned int offset)
+	{
+		CostMoveToCacheEntry &entry = this->Layers[z].CostMoveToCache[offset];
+		if (entry.Generation != this->Generation) {
+			entry.Cost = CacheNotSet;
+			entry.Generation = this->Generation;
+		}
+		return entry;
+	}
+
+	static constexpr int CacheNotSet = -5;
+
+	int GoalX = 0;
+	int GoalY = 0;
+
+private:
+	std::vector<Layer> Layers;
+	unsigned int Generation = 0;
+	unsigned int MapGeneration = 0;
+};
 
 /*----------------------------------------------------------------------------
 --  Profile
@@ -267,57 +363,8 @@ inline void ProfilePrint()
 void InitAStar()
 //Wyrmgus end
 {
-	//Wyrmgus start
-	/*
-	// Should only be called once
-	Assert(!AStarMatrix);
-
-	AStarMapWidth = mapWidth;
-	AStarMapHeight = mapHeight;
-
-	AStarMatrixSize = sizeof(Node) * AStarMapWidth * AStarMapHeight;
-	AStarMatrix = new Node[AStarMapWidth * AStarMapHeight];
-	memset(AStarMatrix, 0, AStarMatrixSize);
-
-	Threshold = AStarMapWidth * AStarMapHeight / MAX_CLOSE_SET_RATIO;
-	CloseSet = new int[Threshold];
-
-	OpenSetMaxSize = AStarMapWidth * AStarMapHeight / MAX_OPEN_SET_RATIO;
-	OpenSet = new Open[OpenSetMaxSize];
-
-	CostMoveToCache = new int[AStarMapWidth * AStarMapHeight];
-
-	for (int i = 0; i < 9; ++i) {
-		Heading2O[i] = Heading2Y[i] * AStarMapWidth;
-	}
-	*/
-
-	for (size_t z = 0; z < CMap::Map.MapLayers.size(); ++z) {
-		// Should only be called once
-		Assert(AStarMatrix.size() <= z);
-	
-		AStarMapWidth.push_back(CMap::Map.Info.MapWidths[z]);
-		AStarMapHeight.push_back(CMap::Map.Info.MapHeights[z]);
-		
-		AStarMatrixSize.push_back(sizeof(Node) * AStarMapWidth[z] * AStarMapHeight[z]);
-		AStarMatrix.push_back(std::make_unique<Node[]>(AStarMapWidth[z] * AStarMapHeight[z]));
-		memset(AStarMatrix[z].get(), 0, AStarMatrixSize[z]);
-
-		Threshold.push_back(AStarMapWidth[z] * AStarMapHeight[z] / MAX_CLOSE_SET_RATIO);
-		CloseSet.push_back(std::make_unique<int[]>(Threshold[z]));
-		CloseSetSize.push_back(0);
-
-		OpenSetMaxSize.push_back(AStarMapWidth[z] * AStarMapHeight[z] / MAX_OPEN_SET_RATIO);
-		OpenSet.push_back(std::make_unique<Open[]>(OpenSetMaxSize[z]));
-		OpenSetSize.push_back(0);
-
-		CostMoveToCache.push_back(std::make_unique<int[]>(AStarMapWidth[z] * AStarMapHeight[z]));
-
-		for (int i = 0; i < 9; ++i) {
-			Heading2O[i].push_back(Heading2Y[i] * AStarMapWidth[z]);
-		}
-	}
-	//Wyrmgus end
+	// the per-thread contexts are (re)initialized lazily, when they are next used
+	++AStarMapGeneration;
 
 	ProfileInit();
 }
@@ -327,168 +374,25 @@ void InitAStar()
 */
 void FreeAStar()
 {
-	//Wyrmgus start
-	AStarMapWidth.clear();
-	AStarMapHeight.clear();
-	//Wyrmgus end
-	//Wyrmgus start
-	/*
-	delete[] AStarMatrix;
-	AStarMatrix = nullptr;
-	delete[] CloseSet;
-	CloseSet = nullptr;
-	CloseSetSize = 0;
-	delete[] OpenSet;
-	OpenSet = nullptr;
-	OpenSetSize = 0;
-	delete[] CostMoveToCache;
-	CostMoveToCache = nullptr;
-	*/
-	AStarMatrix.clear();
-	AStarMatrixSize.clear();
-	Threshold.clear();
-	CloseSet.clear();
-	CloseSetSize.clear();
-	OpenSet.clear();
-	OpenSetSize.clear();
-	OpenSetMaxSize.clear();
-	CostMoveToCache.clear();
-	
-	for (int i = 0; i < 9; ++i) {
-		Heading2O[i].clear();
-	}
-	//Wyrmgus end
+	++AStarMapGeneration;
 
 	ProfilePrint();
 }
 
-/**
-**  Prepare pathfinder.
-*/
-//Wyrmgus start
-//static void AStarPrepare()
-static void AStarPrepare(int z)
-//Wyrmgus end
-{
-	//Wyrmgus start
-//	memset(AStarMatrix, 0, AStarMatrixSize);
-	memset(AStarMatrix[z].get(), 0, AStarMatrixSize[z]);
-	//Wyrmgus end
-}
-
-/**
-**  Clean up A*
-*/
-//Wyrmgus start
-//static void AStarCleanUp()
-static void AStarCleanUp(int z)
-//Wyrmgus end
-{
-	ProfileBegin("AStarCleanUp");
-
-	//Wyrmgus start
-//	if (CloseSetSize >= Threshold) {
-	if (CloseSetSize[z] >= Threshold[z]) {
-	//Wyrmgus end
-		//Wyrmgus start
-//		AStarPrepare();
-		AStarPrepare(z);
-		//Wyrmgus end
-	} else {
-		for (int i = 0; i < CloseSetSize[z]; ++i) {
-			//Wyrmgus start
-//			AStarMatrix[CloseSet[i]].CostFromStart = 0;
-//			AStarMatrix[CloseSet[i]].InGoal = 0;
-			AStarMatrix[z][CloseSet[z][i]].CostFromStart = 0;
-			AStarMatrix[z][CloseSet[z][i]].InGoal = 0;
-			//Wyrmgus end
-		}
-	}
-	ProfileEnd("AStarCleanUp");
-}
-
-//Wyrmgus start
-//static void CostMoveToCacheCleanUp()
-static void CostMoveToCacheCleanUp(int z)
-//Wyrmgus end
-{
-	ProfileBegin("CostMoveToCacheCleanUp");
-	//Wyrmgus start
-//	int AStarMapMax =  AStarMapWidth * AStarMapHeight;
-	int AStarMapMax =  AStarMapWidth[z] * AStarMapHeight[z];
-	//Wyrmgus end
-#if 1
-	//Wyrmgus start
-//	int *ptr = CostMoveToCache;
-	int *ptr = CostMoveToCache[z].get();
-	//Wyrmgus end
-#ifdef __x86_64__
-	union {
-		intptr_t d;
-		int i[2];
-	} conv;
-	conv.i[0] = CacheNotSet;
-	conv.i[1] = CacheNotSet;
-
-	if (((uintptr_t)ptr) & 4) {
-		*ptr++ = CacheNotSet;
-		--AStarMapMax;
-	}
-#endif
-	while (AStarMapMax > 3) {
-#ifdef __x86_64__
-		*((intptr_t *)ptr) = conv.d;
-		*((intptr_t *)(ptr + 2)) = conv.d;
-		ptr += 4;
-#else
-		*ptr++ = CacheNotSet;
-		*ptr++ = CacheNotSet;
-		*ptr++ = CacheNotSet;
-		*ptr++ = CacheNotSet;
-#endif
-		AStarMapMax -= 4;
-	};
-	while (AStarMapMax) {
-		*ptr++ = CacheNotSet;
-		--AStarMapMax;
-	}
-#else
-	for (int i = 0; i < AStarMapMax; ++i) {
-		//Wyrmgus start
-//		CostMoveToCache[i] = CacheNotSet;
-		CostMoveToCache[z][i] = CacheNotSet;
-		//Wyrmgus end
-	}
-#endif
-	ProfileEnd("CostMoveToCacheCleanUp");
-}
-
 /**
 **  Find the best node in the current open node set
 **  Returns the position of this node in the open node set
 */
-//Wyrmgus start
-//#define AStarFindMinimum() (OpenSetSize - 1)
-#define AStarFindMinimum(z) (OpenSetSize[(z)] - 1)
-//Wyrmgus end
+#define AStarFindMinimum(layer) ((layer).OpenSetSize - 1)
 
 /**
 **  Remove the minimum from the open node set
 */
-//Wyrmgus start
-//static void AStarRemoveMinimum(int pos)
-static void AStarRemoveMinimum(int pos, int z)
-//Wyrmgus end
+static void AStarRemoveMinimum(AStarContext::Layer &layer, int pos)
 {
-	//Wyrmgus start
-//	Assert(pos == OpenSetSize - 1);
-	Assert(pos == OpenSetSize[z] - 1);
-	//Wyrmgus end
+	Assert(pos == layer.OpenSetSize - 1);
 
-	//Wyrmgus start
-//	OpenSetSize--;
-	OpenSetSize[z]--;
-	//Wyrmgus end
+	layer.OpenSetSize--;
 }
 
 /**
@@ -496,56 +400,36 @@ static void AStarRemoveMinimum(int pos, int z)
 **
 **  @return  0 or PF_FAILED
 */
-//Wyrmgus start
-//static inline int AStarAddNode(const Vec2i &pos, int o, int costs)
-static inline int AStarAddNode(const Vec2i &pos, int o, int costs, int z)
-//Wyrmgus end
+static inline int AStarAddNode(AStarContext &context, const Vec2i &pos, int o, int costs, int z)
 {
 	ProfileBegin("AStarAddNode");
 
-	//Wyrmgus start
-//	int bigi = 0, smalli = OpenSetSize;
-	int bigi = 0, smalli = OpenSetSize[z];
-	//Wyrmgus end
+	AStarContext::Layer &layer = context.GetLayer(z);
+	int bigi = 0, smalli = layer.OpenSetSize;
 	int midcost;
 	int midi;
 	int midCostToGoal;
 	int midDist;
 	const Open *open;
 
-	//Wyrmgus start
-//	if (OpenSetSize + 1 >= OpenSetMaxSize) {
-	if (OpenSetSize[z] + 1 >= OpenSetMaxSize[z]) {
-	//Wyrmgus end
+	if (layer.OpenSetSize + 1 >= layer.OpenSetMaxSize) {
 		fprintf(stderr, "A* internal error: raise Open Set Max Size "
-				//Wyrmgus start
-//				"(current value %d)\n", OpenSetMaxSize);
-				"(current value %d)\n", OpenSetMaxSize[z]);
-				//Wyrmgus end
+				"(current value %d)\n", layer.OpenSetMaxSize);
 		ProfileEnd("AStarAddNode");
 		return PF_FAILED;
 	}
 
-	//Wyrmgus start
-//	const int costToGoal = AStarMatrix[o].CostToGoal;
-	const int costToGoal = AStarMatrix[z][o].CostToGoal;
-	//Wyrmgus end
-	const int dist = wyrmgus::number::fast_abs(pos.x - AStarGoalX) + wyrmgus::number::fast_abs(pos.y - AStarGoalY);
+	const int costToGoal = context.GetNode(z, o).CostToGoal;
+	const int dist = wyrmgus::number::fast_abs(pos.x - context.GoalX) + wyrmgus::number::fast_abs(pos.y - context.GoalY);
 
 	// find where we should insert this node.
 	// binary search where to insert the new node
 	while (bigi < smalli) {
 		midi = (smalli + bigi) >> 1;
-		//Wyrmgus start
-//		open = &OpenSet[midi];
-		open = &OpenSet[z][midi];
-		//Wyrmgus end
+		open = &layer.OpenSet[midi];
 		midcost = open->Costs;
-		//Wyrmgus start
-//		midCostToGoal = AStarMatrix[open->O].CostToGoal;
-		midCostToGoal = AStarMatrix[z][open->O].CostToGoal;
-		//Wyrmgus end
-		midDist = wyrmgus::number::fast_abs(open->pos.x - AStarGoalX) + wyrmgus::number::fast_abs(open->pos.y - AStarGoalY);
+		midCostToGoal = context.GetNode(z, open->O).CostToGoal;
+		midDist = wyrmgus::number::fast_abs(open->pos.x - context.GoalX) + wyrmgus::number::fast_abs(open->pos.y - context.GoalY);
 		if (costs > midcost || (costs == midcost
 								&& (costToGoal > midCostToGoal || (costToGoal == midCostToGoal
 																   && dist > midDist)))) {
@@ -564,28 +448,18 @@ static inline int AStarAddNode(const Vec2i &pos, int o, int costs, int z)
 		}
 	}
 
-	//Wyrmgus start
-//	if (OpenSetSize > bigi) {
-	if (OpenSetSize[z] > bigi) {
-	//Wyrmgus end
+	if (layer.OpenSetSize > bigi) {
 		// free a the slot for our node
-		//Wyrmgus start
-//		memmove(&OpenSet[bigi + 1], &OpenSet[bigi], (OpenSetSize - bigi) * sizeof(Open));
-		memmove(&OpenSet[z][bigi + 1], &OpenSet[z][bigi], (OpenSetSize[z] - bigi) * sizeof(Open));
-		//Wyrmgus end
+		memmove(&layer.OpenSet[bigi + 1], &layer.OpenSet[bigi], (layer.OpenSetSize - bigi) * sizeof(Open));
 	}
 
 	// fill our new node
-	//Wyrmgus start
-//	OpenSet[bigi].pos = pos;
-//	OpenSet[bigi].O = o;
-//	OpenSet[bigi].Costs = costs;
-//	++OpenSetSize;
-	OpenSet[z][bigi].pos = pos;
-	OpenSet[z][bigi].O = o;
-	OpenSet[z][bigi].Costs = costs;
-	++OpenSetSize[z];
-	//Wyrmgus end
+	layer.OpenSet[bigi].pos = pos;
+	layer.OpenSet[bigi].O = o;
+	layer.OpenSet[bigi].Costs = costs;
+	layer.OpenSet[bigi].CostToGoal = costToGoal;
+	layer.OpenSet[bigi].Dist = dist;
+	++layer.OpenSetSize;
 
 	ProfileEnd("AStarAddNode");
 
@@ -597,30 +471,20 @@ static inline int AStarAddNode(const Vec2i &pos, int o, int costs, int z)
 **  Can be further optimised knowing that the new cost MUST BE LOWER
 **  than the old one.
 */
-//Wyrmgus start
-//static void AStarReplaceNode(int pos)
-static void AStarReplaceNode(int pos, int z)
-//Wyrmgus end
+static void AStarReplaceNode(AStarContext &context, int pos, int z)
 {
 	ProfileBegin("AStarReplaceNode");
 
+	AStarContext::Layer &layer = context.GetLayer(z);
 	Open node;
 
 	// Remove the outdated node
-	//Wyrmgus start
-//	node = OpenSet[pos];
-//	OpenSetSize--;
-//	memmove(&OpenSet[pos], &OpenSet[pos+1], sizeof(Open) * (OpenSetSize-pos));
-	node = OpenSet[z][pos];
-	OpenSetSize[z]--;
-	memmove(&OpenSet[z][pos], &OpenSet[z][pos+1], sizeof(Open) * (OpenSetSize[z]-pos));
-	//Wyrmgus end
+	node = layer.OpenSet[pos];
+	layer.OpenSetSize--;
+	memmove(&layer.OpenSet[pos], &layer.OpenSet[pos+1], sizeof(Open) * (layer.OpenSetSize-pos));
 
 	// Re-add the node with the new cost
-	//Wyrmgus start
-//	AStarAddNode(node.pos, node.O, node.Costs);
-	AStarAddNode(node.pos, node.O, node.Costs, z);
-	//Wyrmgus end
+	AStarAddNode(context, node.pos, node.O, node.Costs, z);
 	ProfileEnd("AStarReplaceNode");
 }
 
@@ -630,21 +494,12 @@ static void AStarReplaceNode(int pos, int z)
 **
 **  @return  -1 if not found and the position of the node in the table if found.
 */
-//Wyrmgus start
-//static int AStarFindNode(int eo)
-static int AStarFindNode(int eo, int z)
-//Wyrmgus end
+static int AStarFindNode(const AStarContext::Layer &layer, int eo)
 {
 	ProfileBegin("AStarFindNode");
 
-	//Wyrmgus start
-//	for (int i = 0; i < OpenSetSize; ++i) {
-	for (int i = 0; i < OpenSetSize[z]; ++i) {
-	//Wyrmgus end
-		//Wyrmgus start
-//		if (OpenSet[i].O == eo) {
-		if (OpenSet[z][i].O == eo) {
-		//Wyrmgus end
+	for (int i = 0; i < layer.OpenSetSize; ++i) {
+		if (layer.OpenSet[i].O == eo) {
 			ProfileEnd("AStarFindNode");
 			return i;
 		}
@@ -654,28 +509,222 @@ static int AStarFindNode(int eo, int z)
 }
 
 /**
-**  Add a node to the closed set
+**  The legacy open set, kept as a sorted array.
+**
+**  It is only used to benchmark the heap open set against.
 */
-//Wyrmgus start
-//static void AStarAddToClose(int node)
-static void AStarAddToClose(int node, int z)
-//Wyrmgus end
+class AStarSortedOpenSet
 {
-	//Wyrmgus start
-//	if (CloseSetSize < Threshold) {
-	if (CloseSetSize[z] < Threshold[z]) {
-	//Wyrmgus end
-		//Wyrmgus start
-//		CloseSet[CloseSetSize++] = node;
-		CloseSet[z][CloseSetSize[z]++] = node;
-		//Wyrmgus end
+public:
+	explicit AStarSortedOpenSet(AStarContext &context, const int z)
+		: context(context), layer(context.GetLayer(z)), z(z)
+	{
+		if (this->layer.OpenSet == nullptr) {
+			this->layer.OpenSetMaxSize = this->layer.Width * this->layer.Height / MAX_OPEN_SET_RATIO;
+			this->layer.OpenSet = std::make_unique<Open[]>(this->layer.OpenSetMaxSize);
+		}
+		this->layer.OpenSetSize = 0;
 	}
-}
 
-//Wyrmgus start
-//#define GetIndex(x, y) (x) + (y) * AStarMapWidth
-#define GetIndex(x, y, z) (x) + (y) * AStarMapWidth[(z)]
-//Wyrmgus end
+	bool IsEmpty() const
+	{
+		return this->layer.OpenSetSize <= 0;
+	}
+
+	int Add(const Vec2i &pos, const int o, const int costs)
+	{
+		return AStarAddNode(this->context, pos, o, costs, this->z);
+	}
+
+	Open PopMinimum()
+	{
+		const int shortest = AStarFindMinimum(this->layer);
+		const Open minimum = this->layer.OpenSet[shortest];
+		AStarRemoveMinimum(this->layer, shortest);
+		return minimum;
+	}
+
+	int Update(const Vec2i &pos, const int o, const int costs)
+	{
+		const int j = AStarFindNode(this->layer, o);
+		if (j == -1) {
+			return this->Add(pos, o, costs);
+		}
+
+		AStarReplaceNode(this->context, j, this->z);
+		return 0;
+	}
+
+private:
+	AStarContext &context;
+	AStarContext::Layer &layer;
+	const int z;
+};
+
+/**
+**  The open set, handled by a 4-ary min-heap.
+**
+**  The position of each open node in the heap is stored in the cost matrix,
+**  so that lowering the cost of a node doesn't require searching for it,
+**  and the heap grows as needed instead of having a fixed maximum size.
+*/
+class AStarHeapOpenSet
+{
+public:
+	static constexpr int Arity = 4;
+
+	explicit AStarHeapOpenSet(AStarContext &context, const int z)
+		: context(context), heap(context.GetLayer(z).OpenHeap), z(z)
+	{
+		this->heap.clear();
+	}
+
+	bool IsEmpty() const
+	{
+		return this->heap.empty();
+	}
+
+	/**
+	**  Add a new node to the open set
+	**
+	**  @return  0
+	*/
+	int Add(const Vec2i &pos, const int o, const int costs)
+	{
+		ProfileBegin("AStarHeapOpenSet::Add");
+
+		Open open;
+		open.pos = pos;
+		open.O = o;
+		open.Costs = costs;
+		open.CostToGoal = this->context.GetNode(this->z, o).CostToGoal;
+		open.Dist = wyrmgus::number::fast_abs(pos.x - this->context.GoalX) + wyrmgus::number::fast_abs(pos.y - this->context.GoalY);
+
+		this->heap.push_back(open);
+		this->SiftUp(static_cast<int>(this->heap.size()) - 1);
+
+		ProfileEnd("AStarHeapOpenSet::Add");
+		return 0;
+	}
+
+	/// Remove the best node from the open set, and return it
+	Open PopMinimum()
+	{
+		ProfileBegin("AStarHeapOpenSet::PopMinimum");
+
+		const Open minimum = this->heap.front();
+		this->context.GetNode(this->z, minimum.O).OpenSetIndex = -1;
+
+		const Open last = this->heap.back();
+		this->heap.pop_back();
+		if (!this->heap.empty()) {
+			this->heap.front() = last;
+			this->SiftDown(0);
+		}
+
+		ProfileEnd("AStarHeapOpenSet::PopMinimum");
+		return minimum;
+	}
+
+	/**
+	**  Lower the cost of a node, adding it to the open set if it isn't in it
+	**
+	**  @return  0
+	*/
+	int Update(const Vec2i &pos, const int o, const int costs)
+	{
+		const Node &node = this->context.GetNode(this->z, o);
+		const int index = node.OpenSetIndex;
+		if (index == -1) {
+			return this->Add(pos, o, costs);
+		}
+
+		ProfileBegin("AStarHeapOpenSet::Update");
+
+		Open &open = this->heap[index];
+		Assert(costs <= open.Costs);
+		open.Costs = costs;
+		open.CostToGoal = node.CostToGoal;
+		this->SiftUp(index);
+
+		ProfileEnd("AStarHeapOpenSet::Update");
+		return 0;
+	}
+
+private:
+	/// Whether an open node should be expanded before another; the offset is compared last to keep the order deterministic
+	static bool IsBetter(const Open &lhs, const Open &rhs)
+	{
+		if (lhs.Costs != rhs.Costs) {
+			return lhs.Costs < rhs.Costs;
+		}
+		if (lhs.CostToGoal != rhs.CostToGoal) {
+			return lhs.CostToGoal < rhs.CostToGoal;
+		}
+		if (lhs.Dist != rhs.Dist) {
+			return lhs.Dist < rhs.Dist;
+		}
+		return lhs.O < rhs.O;
+	}
+
+	void Place(const int index, const Open &open)
+	{
+		this->heap[index] = open;
+		this->context.GetNode(this->z, open.O).OpenSetIndex = index;
+	}
+
+	void SiftUp(int index)
+	{
+		const Open open = this->heap[index];
+
+		while (index > 0) {
+			const int parent = (index - 1) / Arity;
+			if (!IsBetter(open, this->heap[parent])) {
+				break;
+			}
+			this->Place(index, this->heap[parent]);
+			index = parent;
+		}
+
+		this->Place(index, open);
+	}
+
+	void SiftDown(int index)
+	{
+		const Open open = this->heap[index];
+		const int size = static_cast<int>(this->heap.size());
+
+		while (true) {
+			const int first_child = index * Arity + 1;
+			if (first_child >= size) {
+				break;
+			}
+
+			const int last_child = std::min(first_child + Arity, size);
+			int best_child = first_child;
+			for (int child = first_child + 1; child < last_child; ++child) {
+				if (IsBetter(this->heap[child], this->heap[best_child])) {
+					best_child = child;
+				}
+			}
+
+			if (!IsBetter(this->heap[best_child], open)) {
+				break;
+			}
+			this->Place(index, this->heap[best_child]);
+			index = best_child;
+		}
+
+		this->Place(index, open);
+	}
+
+	AStarContext &context;
+	std::vector<Open> &heap;
+	const int z;
+};
+
+#define GetIndex(x, y, z) (x) + (y) * CMap::Map.Info.MapWidths[(z)]
+
 
 /* build-in costmoveto code */
 static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit, int z)
@@ -779,10 +828,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit, int
 
 			++mf;
 		} while (--i);
-		//Wyrmgus start
-//		index += AStarMapWidth;
-		index += AStarMapWidth[z];
-		//Wyrmgus end
+		index += CMap::Map.Info.MapWidths[z];
 	} while (--h);
 	return cost;
 }
@@ -799,10 +845,7 @@ static int CostMoveToCallBack_Default(unsigned int index, const CUnit &unit, int
 **                0 -> no induced cost, except move
 **               >0 -> costly tile
 */
-//Wyrmgus start
-//static inline int CostMoveTo(unsigned int index, const CUnit &unit)
-static inline int CostMoveTo(unsigned int index, const CUnit &unit, int z)
-//Wyrmgus end
+static inline int CostMoveTo(AStarContext &context, unsigned int index, const CUnit &unit, int z)
 {
 	//Wyrmgus start
 	if (!&unit) {
@@ -810,25 +853,19 @@ static inline int CostMoveTo(unsigned int index, const CUnit &unit, int z)
 		return -1;
 	}
 	//Wyrmgus end
-	//Wyrmgus start
-//	int *c = &CostMoveToCache[index];
-	int *c = &CostMoveToCache[z][index];
-	//Wyrmgus end
-	if (*c != CacheNotSet) {
-		return *c;
+	CostMoveToCacheEntry &entry = context.GetCostMoveToCacheEntry(z, index);
+	if (entry.Cost != AStarContext::CacheNotSet) {
+		return entry.Cost;
 	}
-	//Wyrmgus start
-//	*c = CostMoveToCallBack_Default(index, unit);
-	*c = CostMoveToCallBack_Default(index, unit, z);
-	//Wyrmgus end
-	return *c;
+	entry.Cost = CostMoveToCallBack_Default(index, unit, z);
+	return entry.Cost;
 }
 
 class AStarGoalMarker
 {
 public:
-	AStarGoalMarker(const CUnit &unit, bool *goal_reachable) :
-		unit(unit), goal_reachable(goal_reachable)
+	AStarGoalMarker(AStarContext &context, const CUnit &unit, bool *goal_reachable) :
+		context(context), unit(unit), goal_reachable(goal_reachable)
 	{}
 
 	//Wyrmgus start
@@ -836,22 +873,13 @@ public:
 	void operator()(int offset, int z) const
 	//Wyrmgus end
 	{
-		//Wyrmgus start
-//		if (CostMoveTo(offset, unit) >= 0) {
-		if (CostMoveTo(offset, unit, z) >= 0) {
-		//Wyrmgus end
-			//Wyrmgus start
-//			AStarMatrix[offset].InGoal = 1;
-			AStarMatrix[z][offset].InGoal = 1;
-			//Wyrmgus end
+		if (CostMoveTo(context, offset, unit, z) >= 0) {
+			context.GetNode(z, offset).InGoal = 1;
 			*goal_reachable = true;
 		}
-		//Wyrmgus start
-//		AStarAddToClose(offset);
-		AStarAddToClose(offset, z);
-		//Wyrmgus end
 	}
 private:
+	AStarContext &context;
 	const CUnit &unit;
 	bool *goal_reachable;
 };
@@ -1082,7 +1110,7 @@ private:
 /**
 **  MarkAStarGoal
 */
-static int AStarMarkGoal(const Vec2i &goal, int gw, int gh,
+static int AStarMarkGoal(AStarContext &context, const Vec2i &goal, int gw, int gh,
 						 //Wyrmgus start
 //						 int tilesizex, int tilesizey, int minrange, int maxrange, const CUnit &unit)
 						 int tilesizex, int tilesizey, int minrange, int maxrange, const CUnit &unit, int z)
@@ -1091,23 +1119,14 @@ static int AStarMarkGoal(const Vec2i &goal, int gw, int gh,
 	ProfileBegin("AStarMarkGoal");
 
 	if (minrange == 0 && maxrange == 0 && gw == 0 && gh == 0) {
-		//Wyrmgus start
-//		if (goal.x + tilesizex > AStarMapWidth || goal.y + tilesizey > AStarMapHeight) {
-		if (goal.x + tilesizex - 1 > AStarMapWidth[z] || goal.y + tilesizey - 1 > AStarMapHeight[z]) {
-		//Wyrmgus end
+		const AStarContext::Layer &layer = context.GetLayer(z);
+		if (goal.x + tilesizex - 1 > layer.Width || goal.y + tilesizey - 1 > layer.Height) {
 			ProfileEnd("AStarMarkGoal");
 			return 0;
 		}
-		//Wyrmgus start
-//		unsigned int offset = GetIndex(goal.x, goal.y);
-//		if (CostMoveTo(offset, unit) >= 0) {
 		unsigned int offset = GetIndex(goal.x, goal.y, z);
-		if (CostMoveTo(offset, unit, z) >= 0) {
-		//Wyrmgus end
-			//Wyrmgus start
-//			AStarMatrix[offset].InGoal = 1;
-			AStarMatrix[z][offset].InGoal = 1;
-			//Wyrmgus end
+		if (CostMoveTo(context, offset, unit, z) >= 0) {
+			context.GetNode(z, offset).InGoal = 1;
 			ProfileEnd("AStarMarkGoal");
 			return 1;
 		} else {
@@ -1121,7 +1140,7 @@ static int AStarMarkGoal(const Vec2i &goal, int gw, int gh,
 	gw = std::max(gw, 1);
 	gh = std::max(gh, 1);
 
-	AStarGoalMarker aStarGoalMarker(unit, &goal_reachable);
+	AStarGoalMarker aStarGoalMarker(context, unit, &goal_reachable);
 	MinMaxRangeVisitor<AStarGoalMarker> visitor(aStarGoalMarker);
 
 	const Vec2i goalBottomRigth(goal.x + gw - 1, goal.y + gh - 1);
@@ -1146,13 +1165,11 @@ static int AStarMarkGoal(const Vec2i &goal, int gw, int gh,
 **
 **  @return  The length of the path
 */
-//Wyrmgus start
-//static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path, int pathLen)
-static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path, int pathLen, int z)
-//Wyrmgus end
+static int AStarSavePath(AStarContext &context, const Vec2i &startPos, const Vec2i &endPos, char *path, int pathLen, int z)
 {
 	ProfileBegin("AStarSavePath");
 
+	const AStarContext::Layer &layer = context.GetLayer(z);
 	int fullPathLength;
 	int pathPos;
 	int direction;
@@ -1160,21 +1177,12 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 	// Figure out the full path length
 	fullPathLength = 0;
 	Vec2i curr = endPos;
-	//Wyrmgus start
-//	int currO = curr.y * AStarMapWidth;
-	int currO = curr.y * AStarMapWidth[z];
-	//Wyrmgus end
+	int currO = curr.y * layer.Width;
 	while (curr != startPos) {
-		//Wyrmgus start
-//		direction = AStarMatrix[currO + curr.x].Direction;
-		direction = AStarMatrix[z][currO + curr.x].Direction;
-		//Wyrmgus end
+		direction = context.GetNode(z, currO + curr.x).Direction;
 		curr.x -= Heading2X[direction];
 		curr.y -= Heading2Y[direction];
-		//Wyrmgus start
-//		currO -= Heading2O[direction];
-		currO -= Heading2O[direction][z];
-		//Wyrmgus end
+		currO -= layer.Heading2O[direction];
 		fullPathLength++;
 	}
 
@@ -1183,21 +1191,12 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 		pathLen = std::min<int>(fullPathLength, pathLen);
 		pathPos = fullPathLength;
 		curr = endPos;
-		//Wyrmgus start
-//		currO = curr.y * AStarMapWidth;
-		currO = curr.y * AStarMapWidth[z];
-		//Wyrmgus end
+		currO = curr.y * layer.Width;
 		while (curr != startPos) {
-			//Wyrmgus start
-//			direction = AStarMatrix[currO + curr.x].Direction;
-			direction = AStarMatrix[z][currO + curr.x].Direction;
-			//Wyrmgus end
+			direction = context.GetNode(z, currO + curr.x).Direction;
 			curr.x -= Heading2X[direction];
 			curr.y -= Heading2Y[direction];
-			//Wyrmgus start
-//			currO -= Heading2O[direction];
-			currO -= Heading2O[direction][z];
-			//Wyrmgus end
+			currO -= layer.Heading2O[direction];
 			--pathPos;
 			if (pathPos < pathLen) {
 				path[pathLen - pathPos - 1] = direction;
@@ -1213,7 +1212,7 @@ static int AStarSavePath(const Vec2i &startPos, const Vec2i &endPos, char *path,
 **  Optimization to find a simple path
 **  Check if we're at the goal or if it's 1 tile away
 */
-static int AStarFindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw, int gh,
+static int AStarFindSimplePath(AStarContext &context, const Vec2i &startPos, const Vec2i &goal, int gw, int gh,
 							   int, int, int minrange, int maxrange,
 							   //Wyrmgus start
 //							   char *path, const CUnit &unit)
@@ -1250,10 +1249,7 @@ static int AStarFindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw,
 	if (minrange <= distance && wyrmgus::number::fast_abs(diff.x) <= 1 && wyrmgus::number::fast_abs(diff.y) <= 1 && (allow_diagonal || diff.x == 0 || diff.y == 0)) {
 	//Wyrmgus end
 		// Move to adjacent cell
-		//Wyrmgus start
-//		if (CostMoveTo(GetIndex(goal.x, goal.y), unit) == -1) {
-		if (CostMoveTo(GetIndex(goal.x, goal.y, z), unit, z) == -1) {
-		//Wyrmgus end
+		if (CostMoveTo(context, GetIndex(goal.x, goal.y, z), unit, z) == -1) {
 			ProfileEnd("AStarFindSimplePath");
 			return PF_UNREACHABLE;
 		}
@@ -1270,14 +1266,12 @@ static int AStarFindSimplePath(const Vec2i &startPos, const Vec2i &goal, int gw,
 }
 
 /**
-**  Find path.
+**  Find path, using the given type of open set.
 */
-int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
-				  int tilesizex, int tilesizey, int minrange, int maxrange,
-				  //Wyrmgus start
-//				  char *path, int pathlen, const CUnit &unit)
-				  char *path, int pathlen, const CUnit &unit, int max_length, int z, bool allow_diagonal)
-				  //Wyrmgus end
+template <typename OpenSetType>
+static int AStarSearch(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+					   int tilesizex, int tilesizey, int minrange, int maxrange,
+					   char *path, int pathlen, const CUnit &unit, int max_length, int z, bool allow_diagonal)
 {
 	Assert(CMap::Map.Info.IsPointOnMap(startPos, z));
 	
@@ -1291,11 +1285,12 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 
 	ProfileBegin("AStarFindPath");
 
-	AStarGoalX = goalPos.x;
-	AStarGoalY = goalPos.y;
+	//  Initialize
+	AStarContext &context = AStarContext::Get();
+	AStarContext::Layer &layer = context.BeginSearch(z, goalPos);
 
 	//  Check for simple cases first
-	int ret = AStarFindSimplePath(startPos, goalPos, gw, gh, tilesizex, tilesizey,
+	int ret = AStarFindSimplePath(context, startPos, goalPos, gw, gh, tilesizex, tilesizey,
 								  //Wyrmgus start
 //								  minrange, maxrange, path, unit);
 								  minrange, maxrange, path, unit, z, allow_diagonal);
@@ -1305,65 +1300,32 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 		return ret;
 	}
 
-	//  Initialize
-	//Wyrmgus start
-//	AStarCleanUp();
-//	CostMoveToCacheCleanUp();
-	AStarCleanUp(z);
-	CostMoveToCacheCleanUp(z);
-	//Wyrmgus end
-
-	//Wyrmgus start
-//	OpenSetSize = 0;
-//	CloseSetSize = 0;
-	OpenSetSize[z] = 0;
-	CloseSetSize[z] = 0;
-	//Wyrmgus end
-
-	//Wyrmgus start
-//	if (!AStarMarkGoal(goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange, unit)) {
-	if (!AStarMarkGoal(goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange, unit, z)) {
-	//Wyrmgus end
+	if (!AStarMarkGoal(context, goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange, unit, z)) {
 		// goal is not reachable
 		ret = PF_UNREACHABLE;
 		ProfileEnd("AStarFindPath");
 		return ret;
 	}
 
-	//Wyrmgus start
-//	int eo = startPos.y * AStarMapWidth + startPos.x;
-	int eo = startPos.y * AStarMapWidth[z] + startPos.x;
-	//Wyrmgus end
+	OpenSetType open_set(context, z);
+
+	int eo = startPos.y * layer.Width + startPos.x;
 	// it is quite important to start from 1 rather than 0, because we use
 	// 0 as a way to represent nodes that we have not visited yet.
-	//Wyrmgus start
-//	AStarMatrix[eo].CostFromStart = 1;
-	AStarMatrix[z][eo].CostFromStart = 1;
-	//Wyrmgus end
+	Node &start_node = context.GetNode(z, eo);
+	start_node.CostFromStart = 1;
 	// 8 to say we are came from nowhere.
-	//Wyrmgus start
-//	AStarMatrix[eo].Direction = 8;
-	AStarMatrix[z][eo].Direction = 8;
-	//Wyrmgus end
+	start_node.Direction = 8;
 
 	// place start point in open, it that failed, try another pathfinder
 	int costToGoal = AStarCosts(startPos, goalPos);
-	//Wyrmgus start
-//	AStarMatrix[eo].CostToGoal = costToGoal;
-//	if (AStarAddNode(startPos, eo, 1 + costToGoal) == PF_FAILED) {
-	AStarMatrix[z][eo].CostToGoal = costToGoal;
-	if (AStarAddNode(startPos, eo, 1 + costToGoal, z) == PF_FAILED) {
-	//Wyrmgus end
+	start_node.CostToGoal = costToGoal;
+	if (open_set.Add(startPos, eo, 1 + costToGoal) == PF_FAILED) {
 		ret = PF_FAILED;
 		ProfileEnd("AStarFindPath");
 		return ret;
 	}
-	//Wyrmgus start
-//	AStarAddToClose(OpenSet[0].O);
-//	if (AStarMatrix[eo].InGoal) {
-	AStarAddToClose(OpenSet[z][0].O, z);
-	if (AStarMatrix[z][eo].InGoal) {
-	//Wyrmgus end
+	if (start_node.InGoal) {
 		ret = PF_REACHED;
 		ProfileEnd("AStarFindPath");
 		return ret;
@@ -1385,27 +1347,15 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 		//Wyrmgus end
 		
 		// Find the best node of from the open set
-		//Wyrmgus start
-//		const int shortest = AStarFindMinimum();
-//		const int x = OpenSet[shortest].pos.x;
-//		const int y = OpenSet[shortest].pos.y;
-//		const int o = OpenSet[shortest].O;
-		const int shortest = AStarFindMinimum(z);
-		const int x = OpenSet[z][shortest].pos.x;
-		const int y = OpenSet[z][shortest].pos.y;
-		const int o = OpenSet[z][shortest].O;
-		//Wyrmgus end
+		const Open shortest = open_set.PopMinimum();
+		const int x = shortest.pos.x;
+		const int y = shortest.pos.y;
+		const int o = shortest.O;
 
-		//Wyrmgus start
-//		AStarRemoveMinimum(shortest);
-		AStarRemoveMinimum(shortest, z);
-		//Wyrmgus end
+		const Node &node = context.GetNode(z, o);
 
 		// If we have reached the goal, then exit.
-		//Wyrmgus start
-//		if (AStarMatrix[o].InGoal == 1) {
-		if (AStarMatrix[z][o].InGoal == 1) {
-		//Wyrmgus end
+		if (node.InGoal == 1) {
 			endPos.x = x;
 			endPos.y = y;
 			break;
@@ -1426,12 +1376,8 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 		// Generate successors of this node.
 
 		// Node that this node was generated from.
-		//Wyrmgus start
-//		const int px = x - Heading2X[(int)AStarMatrix[o].Direction];
-//		const int py = y - Heading2Y[(int)AStarMatrix[o].Direction];
-		const int px = x - Heading2X[(int)AStarMatrix[z][o].Direction];
-		const int py = y - Heading2Y[(int)AStarMatrix[z][o].Direction];
-		//Wyrmgus end
+		const int px = x - Heading2X[(int)node.Direction];
+		const int py = y - Heading2Y[(int)node.Direction];
 
 		for (int i = 0; i < 8; ++i) {
 			//Wyrmgus start
@@ -1451,31 +1397,21 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 			}
 
 			// Outside the map or can't be entered.
-			//Wyrmgus start
-//			if (endPos.x < 0 || endPos.x + tilesizex - 1 >= AStarMapWidth
-			if (endPos.x < 0 || endPos.x + tilesizex - 1 >= AStarMapWidth[z]
-			//Wyrmgus end
+			if (endPos.x < 0 || endPos.x + tilesizex - 1 >= layer.Width
+				|| endPos.y < 0 || endPos.y + tilesizey - 1 >= layer.Height
 				//Wyrmgus start
-//				|| endPos.y < 0 || endPos.y + tilesizey - 1 >= AStarMapHeight) {
-				|| endPos.y < 0 || endPos.y + tilesizey - 1 >= AStarMapHeight[z]
 				|| !CMap::Map.Info.IsPointOnMap(endPos, z)) {
 				//Wyrmgus end
 				continue;
 			}
 
 			//eo = GetIndex(ex, ey);
-			//Wyrmgus start
-//			eo = endPos.x + (o - x) + Heading2O[i];
-			eo = endPos.x + (o - x) + Heading2O[i][z];
-			//Wyrmgus end
+			eo = endPos.x + (o - x) + layer.Heading2O[i];
 
 			// if the point is "move to"-able and
 			// if we have not reached this point before,
 			// or if we have a better path to it, we add it to open set
-			//Wyrmgus start
-//			int new_cost = CostMoveTo(eo, unit);
-			int new_cost = CostMoveTo(eo, unit, z);
-			//Wyrmgus end
+			int new_cost = CostMoveTo(context, eo, unit, z);
 			if (new_cost == -1) {
 				// uncrossable tile
 				continue;
@@ -1483,80 +1419,36 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 
 			// Add a cost for walking to make paths more realistic for the user.
 			new_cost++;
-			//Wyrmgus start
-//			new_cost += AStarMatrix[o].CostFromStart;
-//			if (AStarMatrix[eo].CostFromStart == 0) {
-			new_cost += AStarMatrix[z][o].CostFromStart;
-			if (AStarMatrix[z][eo].CostFromStart == 0) {
-			//Wyrmgus end
+			new_cost += node.CostFromStart;
+			Node &end_node = context.GetNode(z, eo);
+			if (end_node.CostFromStart == 0) {
 				// we are sure the current node has not been already visited
-				//Wyrmgus start
-//				AStarMatrix[eo].CostFromStart = new_cost;
-//				AStarMatrix[eo].Direction = i;
-				AStarMatrix[z][eo].CostFromStart = new_cost;
-				AStarMatrix[z][eo].Direction = i;
-				//Wyrmgus end
+				end_node.CostFromStart = new_cost;
+				end_node.Direction = i;
 				costToGoal = AStarCosts(endPos, goalPos);
-				//Wyrmgus start
-//				AStarMatrix[eo].CostToGoal = costToGoal;
-//				if (AStarAddNode(endPos, eo, AStarMatrix[eo].CostFromStart + costToGoal) == PF_FAILED) {
-				AStarMatrix[z][eo].CostToGoal = costToGoal;
-				if (AStarAddNode(endPos, eo, AStarMatrix[z][eo].CostFromStart + costToGoal, z) == PF_FAILED) {
-				//Wyrmgus end
+				end_node.CostToGoal = costToGoal;
+				if (open_set.Add(endPos, eo, end_node.CostFromStart + costToGoal) == PF_FAILED) {
 					ret = PF_FAILED;
 					ProfileEnd("AStarFindPath");
 					return ret;
 				}
-				// we add the point to the close set
-				//Wyrmgus start
-//				AStarAddToClose(eo);
-				AStarAddToClose(eo, z);
-				//Wyrmgus end
-			//Wyrmgus start
-//			} else if (new_cost < AStarMatrix[eo].CostFromStart) {
-			} else if (new_cost < AStarMatrix[z][eo].CostFromStart) {
-			//Wyrmgus end
+			} else if (new_cost < end_node.CostFromStart) {
 				// Already visited node, but we have here a better path
 				// I know, it's redundant (but simpler like this)
-				//Wyrmgus start
-//				AStarMatrix[eo].CostFromStart = new_cost;
-//				AStarMatrix[eo].Direction = i;
-				AStarMatrix[z][eo].CostFromStart = new_cost;
-				AStarMatrix[z][eo].Direction = i;
-				//Wyrmgus end
+				end_node.CostFromStart = new_cost;
+				end_node.Direction = i;
 				// this point might be already in the OpenSet
-				//Wyrmgus start
-//				const int j = AStarFindNode(eo);
-				const int j = AStarFindNode(eo, z);
-				//Wyrmgus end
-				if (j == -1) {
-					costToGoal = AStarCosts(endPos, goalPos);
-					//Wyrmgus start
-//					AStarMatrix[eo].CostToGoal = costToGoal;
-//					if (AStarAddNode(endPos, eo, AStarMatrix[eo].CostFromStart + costToGoal) == PF_FAILED) {
-					AStarMatrix[z][eo].CostToGoal = costToGoal;
-					if (AStarAddNode(endPos, eo, AStarMatrix[z][eo].CostFromStart + costToGoal, z) == PF_FAILED) {
-					//Wyrmgus end
-						ret = PF_FAILED;
-						ProfileEnd("AStarFindPath");
-						return ret;
-					}
-				} else {
-					costToGoal = AStarCosts(endPos, goalPos);
-					//Wyrmgus start
-//					AStarMatrix[eo].CostToGoal = costToGoal;
-//					AStarReplaceNode(j);
-					AStarMatrix[z][eo].CostToGoal = costToGoal;
-					AStarReplaceNode(j, z);
-					//Wyrmgus end
+				costToGoal = AStarCosts(endPos, goalPos);
+				end_node.CostToGoal = costToGoal;
+				if (open_set.Update(endPos, eo, end_node.CostFromStart + costToGoal) == PF_FAILED) {
+					ret = PF_FAILED;
+					ProfileEnd("AStarFindPath");
+					return ret;
 				}
 				// we don't have to add this point to the close set
 			}
 		}
-		//Wyrmgus start
-//		if (OpenSetSize <= 0) { // no new nodes generated
-		if (OpenSetSize[z] <= 0) { // no new nodes generated
-		//Wyrmgus end
+		if (open_set.IsEmpty()) { // no new nodes generated
 			ret = PF_UNREACHABLE;
 			ProfileEnd("AStarFindPath");
 			return ret;
@@ -1567,10 +1459,7 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 		//Wyrmgus end
 	}
 
-	//Wyrmgus start
-//	const int path_length = AStarSavePath(startPos, endPos, path, pathlen);
-	const int path_length = AStarSavePath(startPos, endPos, path, pathlen, z);
-	//Wyrmgus end
+	const int path_length = AStarSavePath(context, startPos, endPos, path, pathlen, z);
 
 	ret = path_length;
 
@@ -1578,6 +1467,45 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
 	return ret;
 }
 
+/// A call to AStarFindPath, recorded so that it can be replayed when benchmarking
+struct AStarQuery {
+	Vec2i StartPos;
+	Vec2i GoalPos;
+	int GoalWidth;
+	int GoalHeight;
+	int TileSizeX;
+	int TileSizeY;
+	int MinRange;
+	int MaxRange;
+	int PathLength;
+	int UnitSlot;
+	int MaxLength;
+	int Z;
+	bool AllowDiagonal;
+};
+
+static std::atomic<bool> AStarQueryRecording = false;
+static std::mutex AStarQueryMutex;
+static std::vector<AStarQuery> AStarQueries;
+
+/**
+**  Find path.
+*/
+int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, int gw, int gh,
+				  int tilesizex, int tilesizey, int minrange, int maxrange,
+				  //Wyrmgus start
+//				  char *path, int pathlen, const CUnit &unit)
+				  char *path, int pathlen, const CUnit &unit, int max_length, int z, bool allow_diagonal)
+				  //Wyrmgus end
+{
+	if (AStarQueryRecording) {
+		std::lock_guard<std::mutex> lock(AStarQueryMutex);
+		AStarQueries.push_back({startPos, goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange, pathlen, unit.UnitManagerData.GetUnitId(), max_length, z, allow_diagonal});
+	}
+
+	return AStarSearch<AStarHeapOpenSet>(startPos, goalPos, gw, gh, tilesizex, tilesizey, minrange, maxrange, path, pathlen, unit, max_length, z, allow_diagonal);
+}
+
 struct StatsNode {
 	int Direction = 0;
 	int InGoal = 0;
@@ -1591,46 +1519,116 @@ struct StatsNode {
 static std::unique_ptr<StatsNode[]> AStarGetStats(const int z)
 //Wyrmgus end
 {
-	//Wyrmgus start
-//	StatsNode *stats = new StatsNode[AStarMapWidth * AStarMapHeight];
-	auto stats = std::make_unique<StatsNode[]>(AStarMapWidth[z] * AStarMapHeight[z]);
-	//Wyrmgus end
+	AStarContext &context = AStarContext::Get();
+	const AStarContext::Layer &layer = context.GetLayer(z);
+
+	auto stats = std::make_unique<StatsNode[]>(layer.Width * layer.Height);
 	StatsNode *s = stats.get();
-	//Wyrmgus start
-//	Node *m = AStarMatrix;
-	Node *m = AStarMatrix[z].get();
-	//Wyrmgus end
 
-	//Wyrmgus start
-//	for (int j = 0; j < AStarMapHeight; ++j) {
-	for (int j = 0; j < AStarMapHeight[z]; ++j) {
-	//Wyrmgus end
-		//Wyrmgus start
-//		for (int i = 0; i < AStarMapWidth; ++i) {
-		for (int i = 0; i < AStarMapWidth[z]; ++i) {
-		//Wyrmgus end
-			s->Direction = m->Direction;
-			s->InGoal = m->InGoal;
-			s->CostFromStart = m->CostFromStart;
-			s->CostToGoal = m->CostToGoal;
-			++s;
-			++m;
-		}
+	if (layer.Matrix == nullptr) {
+		return stats;
 	}
 
-	//Wyrmgus start
-//	for (int i = 0; i < OpenSetSize; ++i) {
-	for (int i = 0; i < OpenSetSize[z]; ++i) {
-	//Wyrmgus end
-		//Wyrmgus start
-//		stats[OpenSet[i].O].Costs = OpenSet[i].Costs;
-		stats[OpenSet[z][i].O].Costs = OpenSet[z][i].Costs;
-		//Wyrmgus end
+	for (int i = 0; i < layer.Width * layer.Height; ++i) {
+		const Node &node = context.GetNode(z, i);
+		s->Direction = node.Direction;
+		s->InGoal = node.InGoal;
+		s->CostFromStart = node.CostFromStart;
+		s->CostToGoal = node.CostToGoal;
+		++s;
+	}
+
+	for (const Open &open : layer.OpenHeap) {
+		stats[open.O].Costs = open.Costs;
 	}
 
 	return stats;
 }
 
+/*----------------------------------------------------------------------------
+--  Benchmark
+----------------------------------------------------------------------------*/
+
+/**
+**  Start or stop recording the A* queries, discarding previously recorded ones when starting
+*/
+void SetAStarQueryRecording(const bool recording)
+{
+	std::lock_guard<std::mutex> lock(AStarQueryMutex);
+
+	if (recording) {
+		AStarQueries.clear();
+	}
+
+	AStarQueryRecording = recording;
+}
+
+/**
+**  Replay the recorded A* queries with both the heap and the legacy sorted array open sets,
+**  and print the time taken by each and the number of queries for which their results differ.
+**
+**  The queries are replayed against the current state of the map, skipping those whose unit is gone.
+**
+**  @param iterations  Number of times to replay the recorded queries.
+*/
+void BenchmarkAStarQueries(const int iterations)
+{
+	std::vector<AStarQuery> queries;
+	{
+		std::lock_guard<std::mutex> lock(AStarQueryMutex);
+		queries = AStarQueries;
+	}
+
+	if (queries.empty()) {
+		fprintf(stdout, "No A* queries have been recorded.\n");
+		return;
+	}
+
+	//don't record the replayed queries themselves
+	const bool recording = AStarQueryRecording.exchange(false);
+
+	std::vector<char> path;
+	std::chrono::steady_clock::duration heap_time(0);
+	std::chrono::steady_clock::duration sorted_time(0);
+	int replayed_count = 0;
+	int mismatch_count = 0;
+
+	for (int i = 0; i < iterations; ++i) {
+		for (const AStarQuery &query : queries) {
+			if (query.UnitSlot < 0 || query.UnitSlot >= static_cast<int>(wyrmgus::unit_manager::get()->GetUsedSlotCount())) {
+				continue;
+			}
+
+			const CUnit &unit = wyrmgus::unit_manager::get()->GetSlotUnit(query.UnitSlot);
+			if (unit.Destroyed || unit.MapLayer == nullptr || !CMap::Map.Info.IsPointOnMap(query.StartPos, query.Z)) {
+				continue;
+			}
+
+			path.resize(std::max(query.PathLength, 1));
+
+			const auto start_time = std::chrono::steady_clock::now();
+			const int heap_result = AStarSearch<AStarHeapOpenSet>(query.StartPos, query.GoalPos, query.GoalWidth, query.GoalHeight, query.TileSizeX, query.TileSizeY, query.MinRange, query.MaxRange, path.data(), query.PathLength, unit, query.MaxLength, query.Z, query.AllowDiagonal);
+			const auto heap_end_time = std::chrono::steady_clock::now();
+			const int sorted_result = AStarSearch<AStarSortedOpenSet>(query.StartPos, query.GoalPos, query.GoalWidth, query.GoalHeight, query.TileSizeX, query.TileSizeY, query.MinRange, query.MaxRange, path.data(), query.PathLength, unit, query.MaxLength, query.Z, query.AllowDiagonal);
+			const auto sorted_end_time = std::chrono::steady_clock::now();
+
+			heap_time += heap_end_time - start_time;
+			sorted_time += sorted_end_time - heap_end_time;
+			++replayed_count;
+
+			if (heap_result != sorted_result) {
+				++mismatch_count;
+			}
+		}
+	}
+
+	AStarQueryRecording = recording;
+
+	const long long heap_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(heap_time).count();
+	const long long sorted_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(sorted_time).count();
+	fprintf(stdout, "Replayed %d A* queries: heap open set %lld us, sorted array open set %lld us, %d differing results.\n", replayed_count, heap_microseconds, sorted_microseconds, mismatch_count);
+}
+
 /*----------------------------------------------------------------------------
 --  Configurable costs
 ----------------------------------------------------------------------------*/
@@ -0,0 +1,408 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "stratagus.h"
+
+#include "pathfinder/flow_field_cache.h"
+
+#include "map/map.h"
+#include "map/map_layer.h"
+#include "map/tile.h"
+#include "map/tileset.h"
+#include "pathfinder.h"
+#include "pathfinder/hierarchical_pathfinder.h"
+#include "player.h"
+#include "unit/unit.h"
+#include "unit/unit_type.h"
+#include "unit/unit_type_type.h"
+#include "util/point_util.h"
+
+namespace wyrmgus {
+
+class flow_field_cache::flow_field final
+{
+public:
+	explicit flow_field(const QRect &goal_rect, const int max_range, const unsigned long mask, const CPlayer *player, const int z)
+		: mask(mask), player(player), z(z), build_cycle(GameCycle)
+	{
+		const QRect map_rect(QPoint(0, 0), QSize(CMap::Map.Info.MapWidths[z], CMap::Map.Info.MapHeights[z]));
+		this->rect = goal_rect.adjusted(-field_radius, -field_radius, field_radius, field_radius).intersected(map_rect);
+		this->costs.resize(this->rect.width() * this->rect.height(), -1);
+
+		using queue_entry = std::pair<int, int>; //cost and index
+		std::priority_queue<queue_entry, std::vector<queue_entry>, std::greater<queue_entry>> queue;
+
+		//the goal area includes the tiles in range of the goal, and those adjacent to it, so that an occupied goal (e.g. a building) can still be reached
+		const int goal_range = std::max(max_range, 0) + 1;
+		const QRect seed_rect = goal_rect.adjusted(-goal_range, -goal_range, goal_range, goal_range).intersected(this->rect);
+		for (int y = seed_rect.top(); y <= seed_rect.bottom(); ++y) {
+			for (int x = seed_rect.left(); x <= seed_rect.right(); ++x) {
+				const QPoint seed_pos(x, y);
+				if (this->is_tile_passable(seed_pos)) {
+					const int index = this->get_index(seed_pos);
+					this->costs[index] = 0;
+					queue.emplace(0, index);
+				}
+			}
+		}
+
+		while (!queue.empty()) {
+			const auto [cost, index] = queue.top();
+			queue.pop();
+
+			if (cost > this->costs[index]) {
+				continue;
+			}
+
+			const QPoint pos = this->rect.topLeft() + point::from_index(index, this->rect.width());
+
+			//as in A*, the cost of a step is that of the tile being moved to, plus one for walking, and the cost of crossing unknown tiles if they are unexplored
+			int neighbor_cost = cost + CMap::Map.Field(pos, this->z)->get_movement_cost() + 1;
+			if (!this->is_tile_explored(pos)) {
+				neighbor_cost += AStarUnknownTerrainCost;
+			}
+
+			for (int i = 0; i < 8; ++i) {
+				const QPoint neighbor_pos = pos + QPoint(Heading2X[i], Heading2Y[i]);
+				if (!this->rect.contains(neighbor_pos) || !this->is_tile_passable(neighbor_pos)) {
+					continue;
+				}
+
+				const int neighbor_index = this->get_index(neighbor_pos);
+				if (this->costs[neighbor_index] != -1 && this->costs[neighbor_index] <= neighbor_cost) {
+					continue;
+				}
+
+				this->costs[neighbor_index] = neighbor_cost;
+				queue.emplace(neighbor_cost, neighbor_index);
+			}
+		}
+	}
+
+	const QRect &get_rect() const
+	{
+		return this->rect;
+	}
+
+	bool has_unexplored_tiles() const
+	{
+		return this->unexplored_tiles;
+	}
+
+	unsigned long get_build_cycle() const
+	{
+		return this->build_cycle;
+	}
+
+	//get the cost to reach the goal from a tile, or -1 if it can't be reached within the field
+	int get_cost(const QPoint &pos) const
+	{
+		if (!this->rect.contains(pos)) {
+			return -1;
+		}
+
+		return this->costs[this->get_index(pos)];
+	}
+
+	//get the direction of the neighbor with the lowest cost to the goal, or -1 if none is closer to the goal than the tile itself
+	int get_direction(const QPoint &pos, const CUnit *unit) const
+	{
+		const int cost = this->get_cost(pos);
+		int best_direction = -1;
+		int best_cost = cost;
+
+		for (int i = 0; i < 8; ++i) {
+			const QPoint neighbor_pos = pos + QPoint(Heading2X[i], Heading2Y[i]);
+			const int neighbor_cost = this->get_cost(neighbor_pos);
+			if (neighbor_cost == -1 || neighbor_cost >= best_cost) {
+				continue;
+			}
+
+			//if a unit is given, steer it around the other units in its way
+			if (unit != nullptr && !UnitCanBeAt(*unit, neighbor_pos, this->z)) {
+				continue;
+			}
+
+			best_direction = i;
+			best_cost = neighbor_cost;
+		}
+
+		return best_direction;
+	}
+
+private:
+	int get_index(const QPoint &pos) const
+	{
+		return point::to_index(pos - this->rect.topLeft(), this->rect.width());
+	}
+
+	bool is_tile_explored(const QPoint &pos) const
+	{
+		if (this->player == nullptr) {
+			return true;
+		}
+
+		return CMap::Map.Field(pos, this->z)->player_info->IsTeamExplored(*this->player);
+	}
+
+	//as in A*, tiles which the player's team hasn't explored are considered passable
+	bool is_tile_passable(const QPoint &pos)
+	{
+		if (!this->is_tile_explored(pos)) {
+			this->unexplored_tiles = true;
+			return true;
+		}
+
+		const tile *tile = CMap::Map.Field(pos, this->z);
+
+		//for purposes of this check, don't count MapFieldWaterAllowed and MapFieldCoastAllowed if there is a bridge present, as in A*
+		unsigned long flags = tile->Flags;
+		if (flags & MapFieldBridge) {
+			flags &= ~(MapFieldWaterAllowed | MapFieldCoastAllowed);
+		}
+
+		return (flags & this->mask) == 0;
+	}
+
+private:
+	const unsigned long mask = 0;
+	const CPlayer *player = nullptr; //the player whose explored tiles the field is built for, or null if it is built from the actual terrain
+	const int z = 0;
+	const unsigned long build_cycle = 0;
+	QRect rect;
+	std::vector<int> costs;
+	bool unexplored_tiles = false; //whether the field contains tiles the player's team hadn't explored when it was built
+};
+
+flow_field_cache::flow_field_cache()
+{
+}
+
+flow_field_cache::~flow_field_cache()
+{
+}
+
+void flow_field_cache::init()
+{
+	this->clear();
+
+	std::unique_lock<std::shared_mutex> lock(this->mutex);
+	this->entries.resize(CMap::Map.MapLayers.size());
+}
+
+void flow_field_cache::clear()
+{
+	std::unique_lock<std::shared_mutex> lock(this->mutex);
+	this->entries.clear();
+}
+
+void flow_field_cache::on_tile_passability_changed(const QPoint &pos, const int z)
+{
+	this->on_rect_passability_changed(QRect(pos, pos), z);
+}
+
+void flow_field_cache::on_rect_passability_changed(const QRect &rect, const int z)
+{
+	std::unique_lock<std::shared_mutex> lock(this->mutex);
+
+	if (z >= static_cast<int>(this->entries.size())) {
+		return;
+	}
+
+	//discard the fields containing the changed tiles; they are rebuilt when next requested
+	for (auto &[key, entry] : this->entries[z]) {
+		if (entry.field != nullptr && entry.field->get_rect().intersects(rect)) {
+			entry.field.reset();
+		}
+	}
+}
+
+void flow_field_cache::remove_stale_entries(std::map<field_key, field_entry> &layer_entries)
+{
+	for (auto iterator = layer_entries.begin(); iterator != layer_entries.end();) {
+		if (GameCycle - iterator->second.last_request_cycle > static_cast<unsigned long>(field_lifetime)) {
+			iterator = layer_entries.erase(iterator);
+		} else {
+			++iterator;
+		}
+	}
+}
+
+/**
+**	@brief	Get the key of the flow field a unit would use to reach a goal
+**
+**	@return	The key, or nothing if the unit's path should be calculated by another pathfinder
+*/
+std::optional<flow_field_cache::field_key> flow_field_cache::get_field_key(const CUnit &unit, const QPoint &goal_pos, const QSize &goal_size, const int min_range, const int max_range, const int z)
+{
+	if (unit.MapLayer->ID != z) {
+		return std::nullopt;
+	}
+
+	//only single-tile units moving on the ground or water are handled, with other units being left to A*
+	if (unit.Type->get_tile_size() != QSize(1, 1) || unit.Type->BoolFlag[RAIL_INDEX].value || min_range != 0) {
+		return std::nullopt;
+	}
+
+	switch (unit.Type->UnitType) {
+		case UnitTypeType::Fly:
+		case UnitTypeType::FlyLow:
+		case UnitTypeType::Space:
+			return std::nullopt;
+		default:
+			break;
+	}
+
+	const QRect goal_rect(goal_pos, goal_size.expandedTo(QSize(1, 1)));
+	const unsigned long mask = hierarchical_pathfinder::get_unit_mask(unit);
+
+	//as players have explored different tiles, each player gets fields of their own, unless unexplored terrain is known to all
+	const int player_index = AStarKnowUnseenTerrain ? -1 : unit.Player->Index;
+
+	return field_key(goal_rect.x(), goal_rect.y(), goal_rect.width(), goal_rect.height(), max_range, mask, player_index);
+}
+
+/**
+**	@brief	Register a unit's request for a path to a goal, building the flow field for the goal once enough units have requested it
+**
+**	This changes the cache, so it has to be called on the main thread before the path is searched, and never while paths are being searched on other threads.
+*/
+void flow_field_cache::request_field(const CUnit &unit, const QPoint &goal_pos, const QSize &goal_size, const int min_range, const int max_range, const int z)
+{
+	const std::optional<field_key> key = flow_field_cache::get_field_key(unit, goal_pos, goal_size, min_range, max_range, z);
+	if (!key.has_value()) {
+		return;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(this->mutex);
+
+	if (z >= static_cast<int>(this->entries.size())) {
+		return;
+	}
+
+	std::map<field_key, field_entry> &layer_entries = this->entries[z];
+
+	auto find_iterator = layer_entries.find(key.value());
+	if (find_iterator == layer_entries.end()) {
+		this->remove_stale_entries(layer_entries);
+		find_iterator = layer_entries.emplace(key.value(), field_entry()).first;
+	}
+
+	field_entry &entry = find_iterator->second;
+	entry.requesting_units.insert(unit.UnitManagerData.GetUnitId());
+	entry.last_request_cycle = GameCycle;
+
+	if (entry.field != nullptr && entry.field->has_unexplored_tiles() && GameCycle - entry.field->get_build_cycle() >= static_cast<unsigned long>(unexplored_field_lifetime)) {
+		entry.field.reset();
+	}
+
+	//for a single unit, a field would cost more than an A* search
+	if (entry.field == nullptr && static_cast<int>(entry.requesting_units.size()) >= min_group_size) {
+		const QRect goal_rect(goal_pos, goal_size.expandedTo(QSize(1, 1)));
+		const int player_index = std::get<6>(key.value());
+		const CPlayer *player = player_index != -1 ? CPlayer::Players[player_index] : nullptr;
+		entry.field = std::make_shared<const flow_field>(goal_rect, max_range, std::get<5>(key.value()), player, z);
+	}
+}
+
+/**
+**	@brief	Find the next segment of a path by following the flow field shared by the units moving to the same goal
+**
+**	This only reads the cache, so it can be called for several units concurrently; the unit's request has to have been registered with request_field beforehand.
+**
+**	@return	The length of the path segment, or PF_FAILED if the path should be calculated by another pathfinder
+*/
+int flow_field_cache::find_path(const CUnit &unit, const QPoint &goal_pos, const QSize &goal_size, const int min_range, const int max_range, char *path, const int path_length, const int z) const
+{
+	const std::optional<field_key> key = flow_field_cache::get_field_key(unit, goal_pos, goal_size, min_range, max_range, z);
+	if (!key.has_value()) {
+		return PF_FAILED;
+	}
+
+	std::shared_ptr<const flow_field> field;
+
+	{
+		std::shared_lock<std::shared_mutex> lock(this->mutex);
+
+		if (z >= static_cast<int>(this->entries.size())) {
+			return PF_FAILED;
+		}
+
+		const std::map<field_key, field_entry> &layer_entries = this->entries[z];
+
+		const auto find_iterator = layer_entries.find(key.value());
+		if (find_iterator == layer_entries.end() || find_iterator->second.field == nullptr) {
+			return PF_FAILED;
+		}
+
+		field = find_iterator->second.field;
+	}
+
+	const QPoint start_pos = unit.tilePos;
+
+	//once the unit is next to the goal, let A* handle reaching it, as it takes the exact range into account
+	const int start_cost = field->get_cost(start_pos);
+	if (start_cost <= 0) {
+		return PF_FAILED;
+	}
+
+	//the first step is chosen among the tiles which aren't occupied by other units
+	const int first_direction = field->get_direction(start_pos, &unit);
+	if (first_direction == -1) {
+		return PF_FAILED;
+	}
+
+	std::vector<char> directions;
+	directions.push_back(static_cast<char>(first_direction));
+
+	QPoint pos = start_pos + QPoint(Heading2X[first_direction], Heading2Y[first_direction]);
+	while (static_cast<int>(directions.size()) < path_length && field->get_cost(pos) > 0) {
+		const int direction = field->get_direction(pos, nullptr);
+		if (direction == -1) {
+			break;
+		}
+
+		directions.push_back(static_cast<char>(direction));
+		pos += QPoint(Heading2X[direction], Heading2Y[direction]);
+	}
+
+	//the path is stored in reverse order, with its first step at the end, as in A*
+	const int length = static_cast<int>(directions.size());
+	if (path != nullptr) {
+		for (int i = 0; i < length; ++i) {
+			path[length - i - 1] = directions[i];
+		}
+	}
+
+	return length;
+}
+
+}
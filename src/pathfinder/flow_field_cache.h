@@ -0,0 +1,85 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "util/singleton.h"
+
+class CUnit;
+
+namespace wyrmgus {
+
+//cache of flow fields for units moving to the same goal
+//a flow field holds the cost to reach the goal from each tile in a window around it (a Dijkstra integration field), so that each unit only has to follow the field downhill instead of running its own A* search
+class flow_field_cache final : public singleton<flow_field_cache>
+{
+public:
+	static constexpr int field_radius = 64; //how far from the goal a field extends
+	static constexpr int min_group_size = 4; //how many units have to be requesting paths to the same goal for a field to be built
+	static constexpr int field_lifetime = CYCLES_PER_SECOND * 10; //the number of cycles without any requests after which a field is discarded
+	static constexpr int unexplored_field_lifetime = CYCLES_PER_SECOND; //the number of cycles after which a field containing tiles its player hadn't explored is rebuilt, so that it takes the tiles explored since into account
+
+	class flow_field;
+
+	flow_field_cache();
+	~flow_field_cache();
+
+	void init();
+	void clear();
+
+	void on_tile_passability_changed(const QPoint &pos, const int z);
+	void on_rect_passability_changed(const QRect &rect, const int z);
+
+	void request_field(const CUnit &unit, const QPoint &goal_pos, const QSize &goal_size, const int min_range, const int max_range, const int z);
+	int find_path(const CUnit &unit, const QPoint &goal_pos, const QSize &goal_size, const int min_range, const int max_range, char *path, const int path_length, const int z) const;
+
+private:
+	//the goal rectangle and range, the static passability mask, and the index of the player whose explored tiles the field is built for, or -1 if the field is built from the actual terrain
+	using field_key = std::tuple<int, int, int, int, int, unsigned long, int>;
+
+	struct field_entry final
+	{
+		std::shared_ptr<const flow_field> field;
+		std::set<int> requesting_units; //the slots of the units which requested paths to the goal
+		unsigned long last_request_cycle = 0;
+	};
+
+	static std::optional<field_key> get_field_key(const CUnit &unit, const QPoint &goal_pos, const QSize &goal_size, const int min_range, const int max_range, const int z);
+
+	void remove_stale_entries(std::map<field_key, field_entry> &layer_entries);
+
+private:
+	//the flow field entries for each map layer
+	std::vector<std::map<field_key, field_entry>> entries;
+	mutable std::shared_mutex mutex; //the cache is read by path searches on other threads
+};
+
+}
@@ -0,0 +1,674 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2019-2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "stratagus.h"
+
+#include "pathfinder/hierarchical_pathfinder.h"
+
+#include "map/map.h"
+#include "map/map_layer.h"
+#include "map/tile.h"
+#include "map/tileset.h"
+#include "pathfinder.h"
+#include "unit/unit.h"
+#include "unit/unit_type.h"
+#include "unit/unit_type_type.h"
+#include "util/number_util.h"
+#include "util/point_util.h"
+
+namespace wyrmgus {
+
+static int get_chebyshev_distance(const QPoint &pos, const QPoint &other_pos)
+{
+	return std::max(number::fast_abs(pos.x() - other_pos.x()), number::fast_abs(pos.y() - other_pos.y()));
+}
+
+class hierarchical_pathfinder::abstract_graph final
+{
+public:
+	struct portal_edge final
+	{
+		int target_index = 0; //the tile index of the target portal
+		int cost = 0;
+	};
+
+	struct portal final
+	{
+		explicit portal(const QPoint &pos) : pos(pos)
+		{
+		}
+
+		QPoint pos;
+		std::vector<portal_edge> edges;
+	};
+
+	struct cluster final
+	{
+		QRect rect;
+		std::vector<portal> portals;
+		bool dirty = true;
+	};
+
+	explicit abstract_graph(const unsigned long mask, const int z) : mask(mask), z(z)
+	{
+		this->map_size = QSize(CMap::Map.Info.MapWidths[z], CMap::Map.Info.MapHeights[z]);
+		this->cluster_grid_size = QSize((this->map_size.width() + cluster_size - 1) / cluster_size, (this->map_size.height() + cluster_size - 1) / cluster_size);
+		this->clusters.resize(this->cluster_grid_size.width() * this->cluster_grid_size.height());
+
+		for (int y = 0; y < this->cluster_grid_size.height(); ++y) {
+			for (int x = 0; x < this->cluster_grid_size.width(); ++x) {
+				const QPoint top_left(x * cluster_size, y * cluster_size);
+				const QPoint bottom_right(std::min(top_left.x() + cluster_size, this->map_size.width()) - 1, std::min(top_left.y() + cluster_size, this->map_size.height()) - 1);
+				this->clusters[point::to_index(x, y, this->cluster_grid_size)].rect = QRect(top_left, bottom_right);
+			}
+		}
+	}
+
+	int get_tile_index(const QPoint &pos) const
+	{
+		return point::to_index(pos, this->map_size);
+	}
+
+	QPoint get_cluster_pos(const QPoint &tile_pos) const
+	{
+		return QPoint(tile_pos.x() / cluster_size, tile_pos.y() / cluster_size);
+	}
+
+	int get_cluster_index(const QPoint &tile_pos) const
+	{
+		return point::to_index(this->get_cluster_pos(tile_pos), this->cluster_grid_size);
+	}
+
+	cluster &get_cluster(const QPoint &tile_pos)
+	{
+		return this->clusters[this->get_cluster_index(tile_pos)];
+	}
+
+	int get_cluster_count() const
+	{
+		return static_cast<int>(this->clusters.size());
+	}
+
+	int get_tile_count() const
+	{
+		return this->map_size.width() * this->map_size.height();
+	}
+
+	//get whether all tiles of a cluster have been explored by a player's team; the graph is built from the actual terrain, so it can only be used for the player's paths through such clusters without revealing unexplored terrain
+	bool is_cluster_explored(const cluster &cluster, const CPlayer &player) const
+	{
+		for (int y = cluster.rect.top(); y <= cluster.rect.bottom(); ++y) {
+			for (int x = cluster.rect.left(); x <= cluster.rect.right(); ++x) {
+				if (!CMap::Map.Field(QPoint(x, y), this->z)->player_info->IsTeamExplored(player)) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	const portal *get_portal(const int tile_index)
+	{
+		const QPoint tile_pos = point::from_index(tile_index, this->map_size);
+
+		for (const portal &portal : this->get_cluster(tile_pos).portals) {
+			if (portal.pos == tile_pos) {
+				return &portal;
+			}
+		}
+
+		return nullptr;
+	}
+
+	bool is_tile_passable(const QPoint &pos) const
+	{
+		const tile *tile = CMap::Map.Field(pos, this->z);
+
+		//for purposes of this check, don't count MapFieldWaterAllowed and MapFieldCoastAllowed if there is a bridge present, as in A*
+		unsigned long flags = tile->Flags;
+		if (flags & MapFieldBridge) {
+			flags &= ~(MapFieldWaterAllowed | MapFieldCoastAllowed);
+		}
+
+		return (flags & this->mask) == 0;
+	}
+
+	int get_step_cost(const QPoint &pos) const
+	{
+		//as in A*, a cost is added for walking to make paths more realistic
+		return CMap::Map.Field(pos, this->z)->get_movement_cost() + 1;
+	}
+
+	void mark_dirty(const QRect &rect)
+	{
+		//a change to a tile on the border of a cluster affects the entrances of the adjacent cluster as well
+		const QPoint min_cluster_pos = this->get_cluster_pos(QPoint(std::max(rect.left() - 1, 0), std::max(rect.top() - 1, 0)));
+		const QPoint max_cluster_pos = this->get_cluster_pos(QPoint(std::min(rect.right() + 1, this->map_size.width() - 1), std::min(rect.bottom() + 1, this->map_size.height() - 1)));
+
+		for (int y = min_cluster_pos.y(); y <= max_cluster_pos.y(); ++y) {
+			for (int x = min_cluster_pos.x(); x <= max_cluster_pos.x(); ++x) {
+				this->clusters[point::to_index(x, y, this->cluster_grid_size)].dirty = true;
+			}
+		}
+	}
+
+	void update()
+	{
+		for (cluster &cluster : this->clusters) {
+			if (cluster.dirty) {
+				this->build_cluster(cluster);
+			}
+		}
+	}
+
+	//calculate the costs to reach each tile of a cluster from the given seed tiles, within the cluster's bounds
+	std::vector<int> calculate_cluster_costs(const cluster &cluster, const std::vector<QPoint> &seeds) const
+	{
+		const QRect &rect = cluster.rect;
+		std::vector<int> costs(rect.width() * rect.height(), -1);
+
+		using queue_entry = std::pair<int, int>; //cost and local index
+		std::priority_queue<queue_entry, std::vector<queue_entry>, std::greater<queue_entry>> queue;
+
+		for (const QPoint &seed : seeds) {
+			const int local_index = point::to_index(seed - rect.topLeft(), rect.width());
+			costs[local_index] = 0;
+			queue.emplace(0, local_index);
+		}
+
+		while (!queue.empty()) {
+			const auto [cost, local_index] = queue.top();
+			queue.pop();
+
+			if (cost > costs[local_index]) {
+				continue;
+			}
+
+			const QPoint pos = point::from_index(local_index, rect.width()) + rect.topLeft();
+
+			for (int i = 0; i < 8; ++i) {
+				const QPoint adjacent_pos(pos.x() + Heading2X[i], pos.y() + Heading2Y[i]);
+
+				if (!rect.contains(adjacent_pos) || !this->is_tile_passable(adjacent_pos)) {
+					continue;
+				}
+
+				const int adjacent_local_index = point::to_index(adjacent_pos - rect.topLeft(), rect.width());
+				const int adjacent_cost = cost + this->get_step_cost(adjacent_pos);
+
+				if (costs[adjacent_local_index] == -1 || adjacent_cost < costs[adjacent_local_index]) {
+					costs[adjacent_local_index] = adjacent_cost;
+					queue.emplace(adjacent_cost, adjacent_local_index);
+				}
+			}
+		}
+
+		return costs;
+	}
+
+private:
+	portal &get_or_add_portal(cluster &cluster, const QPoint &pos)
+	{
+		for (portal &portal : cluster.portals) {
+			if (portal.pos == pos) {
+				return portal;
+			}
+		}
+
+		cluster.portals.emplace_back(pos);
+		return cluster.portals.back();
+	}
+
+	//scan a border of the cluster for entrances to the adjacent cluster, creating portals for them
+	void build_border_portals(cluster &cluster, const QPoint &start_pos, const QPoint &step, const QPoint &outside_offset, const int length)
+	{
+		int entrance_start = -1;
+
+		for (int i = 0; i <= length; ++i) {
+			bool crossable = false;
+			const QPoint pos = start_pos + step * i;
+
+			if (i < length) {
+				const QPoint outside_pos = pos + outside_offset;
+				crossable = CMap::Map.Info.IsPointOnMap(outside_pos, this->z) && this->is_tile_passable(pos) && this->is_tile_passable(outside_pos);
+			}
+
+			if (crossable) {
+				if (entrance_start == -1) {
+					entrance_start = i;
+				}
+				continue;
+			}
+
+			if (entrance_start == -1) {
+				continue;
+			}
+
+			const int entrance_end = i - 1;
+			const int entrance_width = entrance_end - entrance_start + 1;
+
+			std::vector<int> portal_offsets;
+			if (entrance_width > max_single_portal_entrance_width) {
+				portal_offsets.push_back(entrance_start);
+				portal_offsets.push_back(entrance_end);
+			} else {
+				portal_offsets.push_back((entrance_start + entrance_end) / 2);
+			}
+
+			for (const int portal_offset : portal_offsets) {
+				const QPoint portal_pos = start_pos + step * portal_offset;
+				const QPoint outside_pos = portal_pos + outside_offset;
+
+				portal &portal = this->get_or_add_portal(cluster, portal_pos);
+				portal.edges.push_back({ this->get_tile_index(outside_pos), this->get_step_cost(outside_pos) });
+			}
+
+			entrance_start = -1;
+		}
+	}
+
+	void build_cluster(cluster &cluster)
+	{
+		cluster.portals.clear();
+
+		const QRect &rect = cluster.rect;
+
+		//the portals are always placed in the same way on both sides of a border, so that the portals of adjacent clusters pair up
+		this->build_border_portals(cluster, rect.topLeft(), QPoint(1, 0), QPoint(0, -1), rect.width());
+		this->build_border_portals(cluster, rect.bottomLeft(), QPoint(1, 0), QPoint(0, 1), rect.width());
+		this->build_border_portals(cluster, rect.topLeft(), QPoint(0, 1), QPoint(-1, 0), rect.height());
+		this->build_border_portals(cluster, rect.topRight(), QPoint(0, 1), QPoint(1, 0), rect.height());
+
+		//calculate the intra-cluster edges between the portals
+		for (portal &portal : cluster.portals) {
+			const std::vector<int> costs = this->calculate_cluster_costs(cluster, { portal.pos });
+
+			for (const hierarchical_pathfinder::abstract_graph::portal &other_portal : cluster.portals) {
+				if (&other_portal == &portal) {
+					continue;
+				}
+
+				const int cost = costs[point::to_index(other_portal.pos - rect.topLeft(), rect.width())];
+				if (cost != -1) {
+					portal.edges.push_back({ this->get_tile_index(other_portal.pos), cost });
+				}
+			}
+		}
+
+		cluster.dirty = false;
+	}
+
+private:
+	const unsigned long mask = 0;
+	const int z = 0;
+	QSize map_size;
+	QSize cluster_grid_size;
+	std::vector<cluster> clusters;
+};
+
+/**
+**	@brief	The state of the abstract graph searches of a thread
+**
+**	As for A*, the entries are stamped with the search generation instead of being cleared before each search, and entries from older searches are treated as unset.
+*/
+class hierarchical_pathfinder_search_context final
+{
+public:
+	struct node_state final
+	{
+		int cost_from_start = 0;
+		int parent_index = 0;
+		unsigned int generation = 0;
+	};
+
+	struct cluster_state final
+	{
+		bool explored = false;
+		unsigned int generation = 0;
+	};
+
+	static hierarchical_pathfinder_search_context &get()
+	{
+		thread_local hierarchical_pathfinder_search_context context;
+		return context;
+	}
+
+	void begin_search(const int tile_count, const int cluster_count)
+	{
+		if (static_cast<int>(this->nodes.size()) != tile_count || static_cast<int>(this->clusters.size()) != cluster_count) {
+			this->nodes.assign(tile_count, node_state());
+			this->clusters.assign(cluster_count, cluster_state());
+			this->generation = 0;
+		}
+
+		++this->generation;
+
+		if (this->generation == 0) {
+			//the generation counter wrapped around, so the stamps of all entries have to be reset
+			std::fill(this->nodes.begin(), this->nodes.end(), node_state());
+			std::fill(this->clusters.begin(), this->clusters.end(), cluster_state());
+			this->generation = 1;
+		}
+	}
+
+	node_state *get_node(const int index)
+	{
+		node_state &node = this->nodes[index];
+		return node.generation == this->generation ? &node : nullptr;
+	}
+
+	node_state &set_node(const int index, const int cost_from_start, const int parent_index)
+	{
+		node_state &node = this->nodes[index];
+		node.cost_from_start = cost_from_start;
+		node.parent_index = parent_index;
+		node.generation = this->generation;
+		return node;
+	}
+
+	template <typename function_type>
+	bool is_cluster_explored(const int cluster_index, const function_type &check_function)
+	{
+		cluster_state &cluster = this->clusters[cluster_index];
+		if (cluster.generation != this->generation) {
+			cluster.explored = check_function();
+			cluster.generation = this->generation;
+		}
+
+		return cluster.explored;
+	}
+
+private:
+	std::vector<node_state> nodes; //the search state of the portals, by tile index
+	std::vector<cluster_state> clusters; //whether the clusters have been explored by the searching unit's team, by cluster index
+	unsigned int generation = 0;
+};
+
+hierarchical_pathfinder::hierarchical_pathfinder()
+{
+}
+
+hierarchical_pathfinder::~hierarchical_pathfinder()
+{
+}
+
+void hierarchical_pathfinder::init()
+{
+	this->clear();
+	this->graphs.resize(CMap::Map.MapLayers.size());
+}
+
+void hierarchical_pathfinder::clear()
+{
+	this->graphs.clear();
+}
+
+void hierarchical_pathfinder::on_tile_passability_changed(const QPoint &pos, const int z)
+{
+	this->on_rect_passability_changed(QRect(pos, pos), z);
+}
+
+void hierarchical_pathfinder::on_rect_passability_changed(const QRect &rect, const int z)
+{
+	if (z >= static_cast<int>(this->graphs.size())) {
+		return;
+	}
+
+	for (const auto &[mask, graph] : this->graphs[z]) {
+		graph->mark_dirty(rect);
+	}
+}
+
+unsigned long hierarchical_pathfinder::get_unit_mask(const CUnit &unit)
+{
+	//units are ignored for the abstract graph, only terrain and buildings are taken into account
+	return unit.Type->MovementMask & ~(MapFieldLandUnit | MapFieldSeaUnit | MapFieldAirUnit | MapFieldItem);
+}
+
+hierarchical_pathfinder::abstract_graph *hierarchical_pathfinder::get_graph(const unsigned long mask, const int z)
+{
+	std::map<unsigned long, std::unique_ptr<abstract_graph>> &layer_graphs = this->graphs[z];
+
+	auto find_iterator = layer_graphs.find(mask);
+	if (find_iterator == layer_graphs.end()) {
+		find_iterator = layer_graphs.emplace(mask, std::make_unique<abstract_graph>(mask, z)).first;
+	}
+
+	abstract_graph *graph = find_iterator->second.get();
+	graph->update();
+
+	return graph;
+}
+
+/**
+**	@brief	Build or update the abstract graph used for a unit's paths
+**
+**	This has to be called before finding paths on other threads, as the searches themselves then only read the graph.
+*/
+void hierarchical_pathfinder::prepare_graph(const CUnit &unit, const int z)
+{
+	if (z >= static_cast<int>(this->graphs.size())) {
+		return;
+	}
+
+	this->get_graph(hierarchical_pathfinder::get_unit_mask(unit), z);
+}
+
+/**
+**	@brief	Find the next segment of a long path by planning on the abstract graph
+**
+**	@return	The length of the refined path segment, or PF_FAILED if the path should be calculated by A* directly
+*/
+int hierarchical_pathfinder::find_path(const CUnit &unit, const QPoint &goal_pos, const QSize &goal_size, const int min_range, const int max_range, char *path, const int path_length, const int z)
+{
+	if (z >= static_cast<int>(this->graphs.size()) || unit.MapLayer->ID != z) {
+		return PF_FAILED;
+	}
+
+	//only single-tile units moving on the ground or water are handled, with other units being left to A*
+	if (unit.Type->get_tile_size() != QSize(1, 1) || unit.Type->BoolFlag[RAIL_INDEX].value || min_range != 0) {
+		return PF_FAILED;
+	}
+
+	switch (unit.Type->UnitType) {
+		case UnitTypeType::Fly:
+		case UnitTypeType::FlyLow:
+		case UnitTypeType::Space:
+			return PF_FAILED;
+		default:
+			break;
+	}
+
+	const QPoint start_pos = unit.tilePos;
+	if (get_chebyshev_distance(start_pos, goal_pos) < min_path_distance) {
+		return PF_FAILED;
+	}
+
+	abstract_graph *graph = this->get_graph(hierarchical_pathfinder::get_unit_mask(unit), z);
+
+	abstract_graph::cluster &start_cluster = graph->get_cluster(start_pos);
+	abstract_graph::cluster &goal_cluster = graph->get_cluster(goal_pos);
+
+	const QPoint cluster_distance = graph->get_cluster_pos(goal_pos) - graph->get_cluster_pos(start_pos);
+	if (std::max(number::fast_abs(cluster_distance.x()), number::fast_abs(cluster_distance.y())) <= 1) {
+		return PF_FAILED;
+	}
+
+	hierarchical_pathfinder_search_context &context = hierarchical_pathfinder_search_context::get();
+	context.begin_search(graph->get_tile_count(), graph->get_cluster_count());
+
+	//A* treats the tiles the unit's team hasn't explored as passable, with an additional cost, so the graph, which is built from the actual terrain, is only used through clusters the team has fully explored
+	const auto is_cluster_explored = [&](const QPoint &tile_pos) {
+		if (AStarKnowUnseenTerrain) {
+			return true;
+		}
+
+		return context.is_cluster_explored(graph->get_cluster_index(tile_pos), [&]() {
+			return graph->is_cluster_explored(graph->get_cluster(tile_pos), *unit.Player);
+		});
+	};
+
+	if (!is_cluster_explored(start_pos) || !is_cluster_explored(goal_pos)) {
+		return PF_FAILED;
+	}
+
+	//connect the start position to the portals of its cluster
+	const std::vector<int> start_costs = graph->calculate_cluster_costs(start_cluster, { start_pos });
+
+	//connect the goal area to the portals of its cluster; the area includes the tiles in range of the goal, and those adjacent to it, so that an occupied goal (e.g. a building) can still be reached
+	const int goal_range = std::max(max_range, 0) + 1;
+	const QRect goal_rect = QRect(goal_pos, goal_size.expandedTo(QSize(1, 1))).adjusted(-goal_range, -goal_range, goal_range, goal_range).intersected(goal_cluster.rect);
+	std::vector<QPoint> goal_seeds;
+	for (int y = goal_rect.top(); y <= goal_rect.bottom(); ++y) {
+		for (int x = goal_rect.left(); x <= goal_rect.right(); ++x) {
+			const QPoint seed_pos(x, y);
+			if (graph->is_tile_passable(seed_pos)) {
+				goal_seeds.push_back(seed_pos);
+			}
+		}
+	}
+
+	if (goal_seeds.empty()) {
+		return PF_FAILED;
+	}
+
+	const std::vector<int> goal_costs = graph->calculate_cluster_costs(goal_cluster, goal_seeds);
+
+	//plan on the abstract graph; the goal is represented by a virtual node with index -1, whose state is kept apart from that of the portals
+	static constexpr int goal_node_index = -1;
+
+	using queue_entry = std::tuple<int, int, int>; //estimated total cost, cost from start and tile index
+	std::priority_queue<queue_entry, std::vector<queue_entry>, std::greater<queue_entry>> open_set;
+	int goal_cost_from_start = -1;
+	int goal_parent_index = goal_node_index;
+
+	const auto add_node = [&](const int index, const int parent_index, const int cost_from_start, const QPoint &pos) {
+		if (index == goal_node_index) {
+			if (goal_cost_from_start != -1 && goal_cost_from_start <= cost_from_start) {
+				return;
+			}
+
+			goal_cost_from_start = cost_from_start;
+			goal_parent_index = parent_index;
+		} else {
+			const hierarchical_pathfinder_search_context::node_state *node = context.get_node(index);
+			if (node != nullptr && node->cost_from_start <= cost_from_start) {
+				return;
+			}
+
+			context.set_node(index, cost_from_start, parent_index);
+		}
+
+		open_set.emplace(cost_from_start + get_chebyshev_distance(pos, goal_pos), cost_from_start, index);
+	};
+
+	for (const abstract_graph::portal &portal : start_cluster.portals) {
+		const int cost = start_costs[point::to_index(portal.pos - start_cluster.rect.topLeft(), start_cluster.rect.width())];
+		if (cost != -1) {
+			add_node(graph->get_tile_index(portal.pos), goal_node_index, cost, portal.pos);
+		}
+	}
+
+	bool goal_reached = false;
+	while (!open_set.empty()) {
+		const auto [estimated_cost, cost_from_start, index] = open_set.top();
+		open_set.pop();
+
+		if (index == goal_node_index) {
+			goal_reached = true;
+			break;
+		}
+
+		if (cost_from_start > context.get_node(index)->cost_from_start) {
+			continue;
+		}
+
+		const abstract_graph::portal *portal = graph->get_portal(index);
+		if (portal == nullptr) {
+			continue;
+		}
+
+		if (goal_cluster.rect.contains(portal->pos)) {
+			const int goal_cost = goal_costs[point::to_index(portal->pos - goal_cluster.rect.topLeft(), goal_cluster.rect.width())];
+			if (goal_cost != -1) {
+				add_node(goal_node_index, index, cost_from_start + goal_cost, goal_pos);
+			}
+		}
+
+		for (const abstract_graph::portal_edge &edge : portal->edges) {
+			const QPoint target_pos = point::from_index(edge.target_index, CMap::Map.Info.MapWidths[z]);
+			if (!is_cluster_explored(target_pos)) {
+				continue;
+			}
+
+			add_node(edge.target_index, index, cost_from_start + edge.cost, target_pos);
+		}
+	}
+
+	if (!goal_reached) {
+		//the goal may still be reachable through unexplored terrain, or by diagonal moves between clusters
+		return PF_FAILED;
+	}
+
+	std::vector<int> abstract_path;
+	for (int index = goal_parent_index; index != goal_node_index; index = context.get_node(index)->parent_index) {
+		abstract_path.push_back(index);
+	}
+
+	//refine the path to the furthest portal within the refinement distance
+	std::optional<QPoint> waypoint;
+	for (auto iterator = abstract_path.rbegin(); iterator != abstract_path.rend(); ++iterator) {
+		const QPoint portal_pos = point::from_index(*iterator, CMap::Map.Info.MapWidths[z]);
+
+		if (waypoint.has_value() && get_chebyshev_distance(start_pos, portal_pos) > max_refinement_distance) {
+			break;
+		}
+
+		if (portal_pos != start_pos) {
+			waypoint = portal_pos;
+		}
+	}
+
+	if (!waypoint.has_value()) {
+		return PF_FAILED;
+	}
+
+	const int result = AStarFindPath(start_pos, waypoint.value(), 0, 0, 1, 1, 0, 0, path, path_length, unit, 0, z);
+
+	if (result <= 0) {
+		return PF_FAILED;
+	}
+
+	return result;
+}
+
+}
@@ -0,0 +1,74 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2019-2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "util/singleton.h"
+
+class CUnit;
+
+namespace wyrmgus {
+
+//hierarchical pathfinding (HPA*) on top of the A* pathfinder
+//each map layer is divided into square clusters, and the passable crossings between adjacent clusters (portals) form the nodes of an abstract graph; long paths are planned on that graph first, and only the path segment to the next portal is then refined with A*
+class hierarchical_pathfinder final : public singleton<hierarchical_pathfinder>
+{
+public:
+	static constexpr int cluster_size = 16;
+	static constexpr int min_path_distance = hierarchical_pathfinder::cluster_size * 3; //paths shorter than this are left to A* alone
+	static constexpr int max_refinement_distance = hierarchical_pathfinder::cluster_size * 2; //the maximum distance to the portal to which the next path segment is refined
+	static constexpr int max_single_portal_entrance_width = 6; //entrances wider than this get a portal at each of their ends, instead of a single one in their middle
+
+	class abstract_graph;
+
+	static unsigned long get_unit_mask(const CUnit &unit);
+
+	hierarchical_pathfinder();
+	~hierarchical_pathfinder();
+
+	void init();
+	void clear();
+
+	void on_tile_passability_changed(const QPoint &pos, const int z);
+	void on_rect_passability_changed(const QRect &rect, const int z);
+
+	void prepare_graph(const CUnit &unit, const int z);
+	int find_path(const CUnit &unit, const QPoint &goal_pos, const QSize &goal_size, const int min_range, const int max_range, char *path, const int path_length, const int z);
+
+private:
+	abstract_graph *get_graph(const unsigned long mask, const int z);
+
+private:
+	//the abstract graphs for each map layer, mapped to the static passability mask they were built for
+	std::vector<std::map<unsigned long, std::unique_ptr<abstract_graph>>> graphs;
+};
+
+}
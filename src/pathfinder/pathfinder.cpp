@@ -38,9 +38,15 @@
 #include "map/map_layer.h"
 #include "map/tile.h"
 #include "map/tileset.h"
+#include "pathfinder/flow_field_cache.h"
+#include "pathfinder/hierarchical_pathfinder.h"
 #include "unit/unit.h"
+#include "unit/unit_manager.h"
 #include "unit/unit_type.h"
 #include "util/size_util.h"
+#include "util/thread_pool.h"
+
+#include <chrono>
 
 //astar.cpp
 
@@ -258,6 +264,9 @@ void InitPathfinder()
 //	InitAStar(Map.Info.MapWidth, Map.Info.MapHeight);
 	InitAStar();
 	//Wyrmgus end
+
+	wyrmgus::hierarchical_pathfinder::get()->init();
+	wyrmgus::flow_field_cache::get()->init();
 }
 
 /**
@@ -266,6 +275,9 @@ void InitPathfinder()
 void FreePathfinder()
 {
 	FreeAStar();
+
+	wyrmgus::hierarchical_pathfinder::get()->clear();
+	wyrmgus::flow_field_cache::get()->clear();
 }
 
 /*----------------------------------------------------------------------------
@@ -469,9 +481,28 @@ PathFinderOutput::PathFinderOutput()
 	memset(this, 0, sizeof(*this));
 }
 
+/**
+**  Prepare the shared pathfinding state used to find a new path for a unit.
+**
+**  This registers the unit's request for a flow field, building the field if
+**  enough units are requesting it, and builds or updates the abstract graph.
+**  It changes shared state, so it must be called on the main thread before
+**  NewPath, and never while paths are being calculated on other threads.
+**
+**  @param input  The path finder input of the unit.
+*/
+static void PrepareNewPath(const PathFinderInput &input)
+{
+	wyrmgus::flow_field_cache::get()->request_field(*input.GetUnit(), input.GetGoalPos(), input.GetGoalSize(),
+		input.GetMinRange(), input.GetMaxRange(), input.GetGoalMapLayer());
+	wyrmgus::hierarchical_pathfinder::get()->prepare_graph(*input.GetUnit(), input.GetGoalMapLayer());
+}
+
 /**
 **  Find new path.
 **
+**  PrepareNewPath must have been called for the input beforehand.
+**
 **  The destination could be a unit or a field.
 **  Range gives how far we must reach the goal.
 **
@@ -485,16 +516,29 @@ PathFinderOutput::PathFinderOutput()
 static int NewPath(PathFinderInput &input, PathFinderOutput &output)
 {
 	char *path = output.Path;
-	int i = AStarFindPath(input.GetUnitPos(),
-						  input.GetGoalPos(),
-						  input.GetGoalSize().x, input.GetGoalSize().y,
-						  input.GetUnitSize().x, input.GetUnitSize().y,
-						  input.GetMinRange(), input.GetMaxRange(),
-						  path, PathFinderOutput::MAX_PATH_LENGTH,
-						  //Wyrmgus start
-//						  *input.GetUnit());
-						  *input.GetUnit(), 0, input.GetGoalMapLayer());
-						  //Wyrmgus end
+
+	//when several units are moving to the same goal, follow the flow field they share
+	int i = wyrmgus::flow_field_cache::get()->find_path(*input.GetUnit(), input.GetGoalPos(), input.GetGoalSize(),
+		input.GetMinRange(), input.GetMaxRange(), path, PathFinderOutput::MAX_PATH_LENGTH, input.GetGoalMapLayer());
+
+	//for long paths, plan on the abstract graph, and only calculate the path to the next portal
+	if (i == PF_FAILED) {
+		i = wyrmgus::hierarchical_pathfinder::get()->find_path(*input.GetUnit(), input.GetGoalPos(), input.GetGoalSize(),
+			input.GetMinRange(), input.GetMaxRange(), path, PathFinderOutput::MAX_PATH_LENGTH, input.GetGoalMapLayer());
+	}
+
+	if (i == PF_FAILED) {
+		i = AStarFindPath(input.GetUnitPos(),
+							  input.GetGoalPos(),
+							  input.GetGoalSize().x, input.GetGoalSize().y,
+							  input.GetUnitSize().x, input.GetUnitSize().y,
+							  input.GetMinRange(), input.GetMaxRange(),
+							  path, PathFinderOutput::MAX_PATH_LENGTH,
+							  //Wyrmgus start
+//							  *input.GetUnit());
+							  *input.GetUnit(), 0, input.GetGoalMapLayer());
+							  //Wyrmgus end
+	}
 	input.PathRacalculated();
 	if (i == PF_FAILED) {
 		i = PF_UNREACHABLE;
@@ -511,6 +555,131 @@ static int NewPath(PathFinderInput &input, PathFinderOutput &output)
 	return i;
 }
 
+static std::vector<int> NewPreparedPathBatch(const std::vector<PathFinderData *> &batch);
+
+/**
+**  Calculate new paths for a batch of path finder data in parallel.
+**
+**  The requests of all units are first registered on the calling thread,
+**  which builds the flow fields and abstract graphs the batch needs. Each
+**  search then only reads the map and the pathfinding caches, and has its
+**  own A* context, so the results do not depend on thread timing, and are
+**  the same as preparing all the paths and then calculating them one after
+**  another. The map must not be changed while the batch is being processed.
+**
+**  @param batch  The path finder data of the units, whose outputs are updated.
+**
+**  @return       The NewPath result for each element of the batch.
+*/
+std::vector<int> NewPathBatch(const std::vector<PathFinderData *> &batch)
+{
+	//the flow fields and abstract graphs are built or updated beforehand on this thread, so that the searches only need to read them
+	for (const PathFinderData *data : batch) {
+		PrepareNewPath(data->input);
+	}
+
+	return NewPreparedPathBatch(batch);
+}
+
+/**
+**  Calculate the paths of a batch of path finder data, whose pathfinding state has already been prepared, in parallel.
+**
+**  @param batch  The path finder data of the units, whose outputs are updated.
+**
+**  @return       The NewPath result for each element of the batch.
+*/
+static std::vector<int> NewPreparedPathBatch(const std::vector<PathFinderData *> &batch)
+{
+	std::vector<int> results(batch.size(), PF_UNREACHABLE);
+
+	wyrmgus::thread_pool::get()->parallel_for(batch.size(), [&batch, &results](const size_t i) {
+		results[i] = NewPath(batch[i]->input, batch[i]->output);
+	});
+
+	return results;
+}
+
+/**
+**  Calculate the current paths of the moving units both one after another and as a batch,
+**  and print the time taken by each and the number of units for which their results differ.
+**
+**  The paths are calculated on copies of the units' path finder data, so the units keep their own paths.
+**
+**  @param iterations  Number of times to calculate the paths.
+*/
+void BenchmarkNewPathBatch(const int iterations)
+{
+	std::vector<PathFinderData> serial_data;
+	std::vector<PathFinderData> batch_data;
+
+	for (CUnit *unit : wyrmgus::unit_manager::get()->get_units()) {
+		if (unit->pathFinderData == nullptr || !unit->IsAliveOnMap() || !unit->CanMove()) {
+			continue;
+		}
+
+		COrder *order = unit->CurrentOrder();
+		if (order->Finished || (order->Action != UnitAction::Move && order->Action != UnitAction::Attack)) {
+			continue;
+		}
+
+		PathFinderData data = *unit->pathFinderData;
+		order->UpdatePathFinderData(data.input);
+		serial_data.push_back(data);
+	}
+
+	if (serial_data.empty()) {
+		fprintf(stdout, "No units are moving.\n");
+		return;
+	}
+
+	//prepare all the paths once, so that both runs see the same flow fields and abstract graphs
+	for (const PathFinderData &data : serial_data) {
+		PrepareNewPath(data.input);
+	}
+
+	std::vector<PathFinderData *> batch;
+	std::chrono::steady_clock::duration serial_time(0);
+	std::chrono::steady_clock::duration batch_time(0);
+	int mismatch_count = 0;
+
+	for (int i = 0; i < iterations; ++i) {
+		std::vector<PathFinderData> iteration_serial_data = serial_data;
+		batch_data = serial_data;
+
+		batch.clear();
+		for (PathFinderData &data : batch_data) {
+			batch.push_back(&data);
+		}
+
+		std::vector<int> serial_results;
+		serial_results.reserve(iteration_serial_data.size());
+
+		const auto start_time = std::chrono::steady_clock::now();
+		for (PathFinderData &data : iteration_serial_data) {
+			serial_results.push_back(NewPath(data.input, data.output));
+		}
+		const auto serial_end_time = std::chrono::steady_clock::now();
+		const std::vector<int> batch_results = NewPreparedPathBatch(batch);
+		const auto batch_end_time = std::chrono::steady_clock::now();
+
+		serial_time += serial_end_time - start_time;
+		batch_time += batch_end_time - serial_end_time;
+
+		for (size_t j = 0; j < serial_results.size(); ++j) {
+			const PathFinderOutput &serial_output = iteration_serial_data[j].output;
+			const PathFinderOutput &batch_output = batch_data[j].output;
+
+			if (serial_results[j] != batch_results[j] || serial_output.Length != batch_output.Length || (serial_output.Length > 0 && memcmp(serial_output.Path, batch_output.Path, serial_output.Length) != 0)) {
+				++mismatch_count;
+			}
+		}
+	}
+
+	const long long serial_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(serial_time).count();
+	const long long batch_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(batch_time).count();
+	fprintf(stdout, "Calculated %d paths: serial %lld us, batch %lld us, %d differing results.\n", static_cast<int>(serial_data.size()) * iterations, serial_microseconds, batch_microseconds, mismatch_count);
+}
+
 /**
 **  Returns the next element of a path.
 **
@@ -534,6 +703,7 @@ int NextPathElement(CUnit &unit, short int *pxd, short int *pyd)
 
 	// Goal has moved, need to recalculate path or no cached path
 	if (output.Length <= 0 || input.IsRecalculateNeeded()) {
+		PrepareNewPath(input);
 		const int result = NewPath(input, output);
 
 		if (result == PF_UNREACHABLE) {
@@ -563,6 +733,7 @@ int NextPathElement(CUnit &unit, short int *pxd, short int *pyd)
 		}
 		if (output.Fast == 0 && result != 0) {
 			AstarDebugPrint("WAIT expired\n");
+			PrepareNewPath(input);
 			result = NewPath(input, output);
 			if (result > 0) {
 				*pxd = Heading2X[(int)output.Path[(int)output.Length - 1]];
@@ -74,6 +74,10 @@ static int CclAStar(lua_State *l)
 			AStarKnowUnseenTerrain = true;
 		} else if (!strcmp(value, "dont-know-unseen-terrain")) {
 			AStarKnowUnseenTerrain = false;
+		} else if (!strcmp(value, "record-queries")) {
+			SetAStarQueryRecording(true);
+		} else if (!strcmp(value, "dont-record-queries")) {
+			SetAStarQueryRecording(false);
 		} else if (!strcmp(value, "unseen-terrain-cost")) {
 			++j;
 			i = LuaToNumber(l, j + 1);
@@ -91,10 +95,56 @@ static int CclAStar(lua_State *l)
 	return 0;
 }
 
+/**
+**  Replay the recorded a* queries, comparing the open set implementations.
+**
+**  @param l  Lua state.
+*/
+static int CclAStarBenchmark(lua_State *l)
+{
+	const int args = lua_gettop(l);
+	if (args > 1) {
+		LuaError(l, "incorrect argument");
+	}
+
+	const int iterations = args == 1 ? LuaToNumber(l, 1) : 1;
+	if (iterations <= 0) {
+		LuaError(l, "The number of iterations must be positive.");
+	}
+
+	BenchmarkAStarQueries(iterations);
+
+	return 0;
+}
+
+/**
+**  Calculate the paths of the moving units one after another and as a batch, comparing the results.
+**
+**  @param l  Lua state.
+*/
+static int CclPathBatchBenchmark(lua_State *l)
+{
+	const int args = lua_gettop(l);
+	if (args > 1) {
+		LuaError(l, "incorrect argument");
+	}
+
+	const int iterations = args == 1 ? LuaToNumber(l, 1) : 1;
+	if (iterations <= 0) {
+		LuaError(l, "The number of iterations must be positive.");
+	}
+
+	BenchmarkNewPathBatch(iterations);
+
+	return 0;
+}
+
 /**
 **  Register CCL features for pathfinder.
 */
 void PathfinderCclRegister()
 {
 	lua_register(Lua, "AStar", CclAStar);
+	lua_register(Lua, "AStarBenchmark", CclAStarBenchmark);
+	lua_register(Lua, "PathBatchBenchmark", CclPathBatchBenchmark);
 }
@@ -48,6 +48,15 @@ public:
 	virtual bool check(const CPlayer *player, bool ignore_units = false) const override;
 	virtual bool check(const CUnit *unit, bool ignore_units = false) const override;
 
+	virtual unsigned int get_dependencies() const override
+	{
+		unsigned int dependencies = condition_dependency_none;
+		for (const auto &condition : this->conditions) {
+			dependencies |= condition->get_dependencies();
+		}
+		return dependencies;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		std::string str = "All of these must be true:\n";
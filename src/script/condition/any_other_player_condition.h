@@ -48,6 +48,12 @@ public:
 		return false;
 	}
 
+	virtual unsigned int get_scope_dependencies() const override
+	{
+		//whether players are alive depends on their units
+		return condition_dependency_units;
+	}
+
 	virtual std::string get_scope_name() const override
 	{
 		return "Any other player";
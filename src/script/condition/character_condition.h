@@ -55,6 +55,11 @@ public:
 		return unit->get_character() == this->character;
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_units;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -47,6 +47,11 @@ public:
 		return player->get_civilization() == this->civilization;
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_players;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -52,6 +52,11 @@ public:
 		return player->get_civilization()->is_part_of_group(this->group);
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_players;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -48,6 +48,11 @@ public:
 		return player->has_coastal_settlement();
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_units;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -42,6 +42,19 @@ class sml_property;
 class trigger;
 class unit_type;
 
+//the parts of the game state which conditions can depend on, so that trigger conditions only need to be checked again when any of them has changed
+enum condition_dependency : unsigned int {
+	condition_dependency_none = 0,
+	condition_dependency_units = 1 << 0,		//the units of players, including their types and the settlements and heroes they provide
+	condition_dependency_upgrades = 1 << 1,		//the upgrades acquired by players
+	condition_dependency_date = 1 << 2,			//the in-game date, and the time of day and season which follow from it
+	condition_dependency_quests = 1 << 3,		//the quests of players
+	condition_dependency_triggers = 1 << 4,		//the triggers which have fired
+	condition_dependency_players = 1 << 5,		//the civilization, faction, dynasty, age and diplomacy of players
+	condition_dependency_other = 1 << 6,		//game state for which changes aren't tracked, requiring the condition to be checked periodically
+	condition_dependency_all = ~0u
+};
+
 class condition
 {
 public:
@@ -92,6 +105,12 @@ public:
 	virtual bool check(const CPlayer *player, bool ignore_units = false) const = 0;
 	virtual bool check(const CUnit *unit, bool ignore_units = false) const;
 
+	//get the parts of the game state the condition depends on, as condition_dependency flags
+	virtual unsigned int get_dependencies() const
+	{
+		return condition_dependency_other;
+	}
+
 	//get the condition as a string
 	virtual std::string get_string(const size_t indent) const = 0;
 
@@ -42,6 +42,11 @@ public:
 		return CPlayer::Players[PlayerNumNeutral];
 	}
 
+	virtual unsigned int get_scope_dependencies() const override
+	{
+		return condition_dependency_none;
+	}
+
 	virtual std::string get_scope_name() const override
 	{
 		return "Neutral player";
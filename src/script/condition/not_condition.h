@@ -85,6 +85,15 @@ public:
 		return true;
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		unsigned int dependencies = condition_dependency_none;
+		for (const auto &condition : this->conditions) {
+			dependencies |= condition->get_dependencies();
+		}
+		return dependencies;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		std::string str = "None of these must be true:\n";
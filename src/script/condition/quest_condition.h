@@ -47,6 +47,11 @@ public:
 		return player->has_quest(this->quest);
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_quests;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
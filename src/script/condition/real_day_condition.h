@@ -56,6 +56,11 @@ public:
 		return current_day >= this->day;
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_date;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -58,6 +58,11 @@ public:
 		return static_cast<int>(this->month) == current_month;
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_date;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
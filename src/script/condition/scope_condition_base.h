@@ -51,6 +51,17 @@ public:
 		this->conditions.check_validity();
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return this->conditions.get_dependencies() | this->get_scope_dependencies();
+	}
+
+	//get the parts of the game state on which the choice of the scope depends
+	virtual unsigned int get_scope_dependencies() const
+	{
+		return condition_dependency_other;
+	}
+
 	bool check_scope(const scope_type *scope, const bool ignore_units) const
 	{
 		return this->conditions.check(scope, ignore_units);
@@ -50,6 +50,11 @@ public:
 		return this->scripted_condition->get_conditions()->check(unit, ignore_units);
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return this->scripted_condition->get_conditions()->get_dependencies();
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		return this->scripted_condition->get_conditions()->get_string(indent);
@@ -62,6 +62,11 @@ public:
 		return unit->MapLayer->GetSeason() == this->season;
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_date;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -79,6 +79,11 @@ public:
 		return player->has_settlement(this->settlement);
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_units | condition_dependency_players;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -61,6 +61,11 @@ public:
 		return this->time_of_day == unit_time_of_day;
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_date;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -102,6 +102,11 @@ public:
 		}
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_units;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -58,6 +58,11 @@ public:
 		return this->check(unit->Player, ignore_units) || unit->GetIndividualUpgrade(this->upgrade);
 	}
 
+	virtual unsigned int get_dependencies() const override
+	{
+		return condition_dependency_upgrades;
+	}
+
 	virtual std::string get_string(const size_t indent) const override
 	{
 		Q_UNUSED(indent)
@@ -62,6 +62,7 @@ namespace wyrmgus {
 std::vector<trigger *> trigger::ActiveTriggers;
 std::vector<std::string> trigger::DeactivatedTriggers;
 unsigned int trigger::CurrentTriggerId = 0;
+unsigned int trigger::ChangedConditionDependencies = condition_dependency_all;
 
 }
 
@@ -527,11 +528,111 @@ static int CclSetDeactivatedTriggers(lua_State *l)
 	for (int j = 0; j < args; ++j) {
 		wyrmgus::trigger::DeactivatedTriggers.push_back(LuaToString(l, j + 1));
 	}
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_triggers);
 	return 0;
 }
 
+/**
+**  Maximum number of polled triggers checked per game cycle.
+**
+**  This is a count rather than a time budget, so that the triggers checked in
+**  a given cycle are the same on every machine of a multiplayer game.
+*/
+static constexpr int MaxPolledTriggersPerCycle = 4;
+
+/**
+**  Remove a trigger from the active triggers, marking it as deactivated.
+**
+**  @param index  Index of the trigger in the active triggers
+*/
+static void DeactivateTrigger(const unsigned int index)
+{
+	wyrmgus::trigger *trigger = wyrmgus::trigger::ActiveTriggers[index];
+
+	wyrmgus::trigger::DeactivatedTriggers.push_back(trigger->get_identifier());
+	wyrmgus::trigger::ActiveTriggers.erase(wyrmgus::trigger::ActiveTriggers.begin() + index);
+
+	//keep the round-robin position of the polled triggers
+	if (index < wyrmgus::trigger::CurrentTriggerId) {
+		wyrmgus::trigger::CurrentTriggerId--;
+	}
+
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_triggers);
+
+	if (trigger->Local) {
+		wyrmgus::game::get()->remove_local_trigger(trigger);
+	}
+}
+
+/**
+**  Check an active trigger, applying its effects if its conditions are fulfilled.
+**
+**  @param index  Index of the trigger in the active triggers
+**
+**  @return       True if the trigger was deactivated, false otherwise
+*/
+static bool CheckActiveTrigger(const unsigned int index)
+{
+	wyrmgus::trigger *current_trigger = wyrmgus::trigger::ActiveTriggers[index];
+
+	//old Lua conditions/effects for triggers
+	if (current_trigger->Conditions != nullptr && current_trigger->Effects != nullptr) {
+		try {
+			current_trigger->Conditions->pushPreamble();
+			current_trigger->Conditions->run(1);
+			if (current_trigger->Conditions->popBoolean()) {
+				current_trigger->Effects->pushPreamble();
+				current_trigger->Effects->run(1);
+				if (current_trigger->Effects->popBoolean() == false) {
+					DeactivateTrigger(index);
+					return true;
+				}
+			}
+		} catch (...) {
+			std::throw_with_nested(std::runtime_error("Lua error for trigger \"" + current_trigger->get_identifier() + "\"."));
+		}
+	}
+
+	if (current_trigger->get_effects() != nullptr) {
+		bool triggered = false;
+
+		if (current_trigger->Type == wyrmgus::trigger::TriggerType::GlobalTrigger) {
+			if (check_conditions(current_trigger, CPlayer::Players[PlayerNumNeutral])) {
+				triggered = true;
+				current_trigger->get_effects()->do_effects(CPlayer::Players[PlayerNumNeutral]);
+			}
+		} else if (current_trigger->Type == wyrmgus::trigger::TriggerType::PlayerTrigger) {
+			for (int i = 0; i < PlayerNumNeutral; ++i) {
+				CPlayer *player = CPlayer::Players[i];
+				if (player->Type == PlayerNobody) {
+					continue;
+				}
+				if (!check_conditions(current_trigger, player)) {
+					continue;
+				}
+				triggered = true;
+				current_trigger->get_effects()->do_effects(player);
+				if (current_trigger->fires_only_once()) {
+					break;
+				}
+			}
+		}
+
+		if (triggered && current_trigger->fires_only_once()) {
+			DeactivateTrigger(index);
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /**
 **  Check trigger each game cycle.
+**
+**  Event-driven triggers are only checked in the cycles after a part of the
+**  game state their conditions depend on has changed. The remaining (polled)
+**  triggers are checked in round-robin order, a few per cycle.
 */
 void TriggersEachCycle()
 {
@@ -543,74 +644,45 @@ void TriggersEachCycle()
 		return;
 	}
 
-	// go to the next trigger
-	if (wyrmgus::trigger::CurrentTriggerId < wyrmgus::trigger::ActiveTriggers.size()) {
-		wyrmgus::trigger *current_trigger = wyrmgus::trigger::ActiveTriggers[wyrmgus::trigger::CurrentTriggerId];
+	//changes caused by the effects of the triggers checked now will be handled in the next cycle
+	const unsigned int changed_dependencies = wyrmgus::trigger::ChangedConditionDependencies;
+	wyrmgus::trigger::ChangedConditionDependencies = wyrmgus::condition_dependency_none;
 
-		bool removed_trigger = false;
-		
-		//old Lua conditions/effects for triggers
-		if (current_trigger->Conditions != nullptr && current_trigger->Effects != nullptr) {
-			try {
-				current_trigger->Conditions->pushPreamble();
-				current_trigger->Conditions->run(1);
-				if (current_trigger->Conditions->popBoolean()) {
-					current_trigger->Effects->pushPreamble();
-					current_trigger->Effects->run(1);
-					if (current_trigger->Effects->popBoolean() == false) {
-						wyrmgus::trigger::DeactivatedTriggers.push_back(current_trigger->get_identifier());
-						wyrmgus::trigger::ActiveTriggers.erase(wyrmgus::trigger::ActiveTriggers.begin() + wyrmgus::trigger::CurrentTriggerId);
-						removed_trigger = true;
-						if (current_trigger->Local) {
-							wyrmgus::game::get()->remove_local_trigger(current_trigger);
-						}
-					}
-				}
-			} catch (...) {
-				std::throw_with_nested(std::runtime_error("Lua error for trigger \"" + current_trigger->get_identifier() + "\"."));
-			}
-		}
-		
-		if (current_trigger->get_effects() != nullptr) {
-			bool triggered = false;
-			
-			if (current_trigger->Type == wyrmgus::trigger::TriggerType::GlobalTrigger) {
-				if (check_conditions(current_trigger, CPlayer::Players[PlayerNumNeutral])) {
-					triggered = true;
-					current_trigger->get_effects()->do_effects(CPlayer::Players[PlayerNumNeutral]);
-				}
-			} else if (current_trigger->Type == wyrmgus::trigger::TriggerType::PlayerTrigger) {
-				for (int i = 0; i < PlayerNumNeutral; ++i) {
-					CPlayer *player = CPlayer::Players[i];
-					if (player->Type == PlayerNobody) {
-						continue;
-					}
-					if (!check_conditions(current_trigger, player)) {
-						continue;
-					}
-					triggered = true;
-					current_trigger->get_effects()->do_effects(player);
-					if (current_trigger->fires_only_once()) {
-						break;
-					}
-				}
+	if (changed_dependencies != wyrmgus::condition_dependency_none) {
+		for (unsigned int i = 0; i < wyrmgus::trigger::ActiveTriggers.size();) {
+			const wyrmgus::trigger *trigger = wyrmgus::trigger::ActiveTriggers[i];
+
+			if (!trigger->is_event_driven() || (trigger->get_condition_dependencies() & changed_dependencies) == 0) {
+				++i;
+				continue;
 			}
-			
-			if (triggered && current_trigger->fires_only_once()) {
-				wyrmgus::trigger::DeactivatedTriggers.push_back(current_trigger->get_identifier());
-				wyrmgus::trigger::ActiveTriggers.erase(wyrmgus::trigger::ActiveTriggers.begin() + wyrmgus::trigger::CurrentTriggerId);
-				removed_trigger = true;
-				if (current_trigger->Local) {
-					wyrmgus::game::get()->remove_local_trigger(current_trigger);
-				}
+
+			if (!CheckActiveTrigger(i)) {
+				++i;
 			}
 		}
-		
-		if (!removed_trigger) {
+	}
+
+	//go to the next polled triggers
+	int checked_triggers = 0;
+	size_t visited_triggers = 0;
+	while (checked_triggers < MaxPolledTriggersPerCycle && visited_triggers < wyrmgus::trigger::ActiveTriggers.size()) {
+		if (wyrmgus::trigger::CurrentTriggerId >= wyrmgus::trigger::ActiveTriggers.size()) {
+			wyrmgus::trigger::CurrentTriggerId = 0;
+		}
+
+		++visited_triggers;
+
+		if (wyrmgus::trigger::ActiveTriggers[wyrmgus::trigger::CurrentTriggerId]->is_event_driven()) {
+			wyrmgus::trigger::CurrentTriggerId++;
+			continue;
+		}
+
+		++checked_triggers;
+
+		if (!CheckActiveTrigger(wyrmgus::trigger::CurrentTriggerId)) {
 			wyrmgus::trigger::CurrentTriggerId++;
 		}
-	} else {
-		wyrmgus::trigger::CurrentTriggerId = 0;
 	}
 }
 
@@ -647,6 +719,9 @@ void trigger::InitActiveTriggers()
 		}
 		trigger::ActiveTriggers.push_back(trigger);
 	}
+
+	//check all event-driven triggers at least once at the start of the game
+	trigger::ChangedConditionDependencies = condition_dependency_all;
 }
 
 void trigger::ClearActiveTriggers()
@@ -658,6 +733,7 @@ void trigger::ClearActiveTriggers()
 	lua_setglobal(Lua, "Triggers");
 
 	trigger::CurrentTriggerId = 0;
+	trigger::ChangedConditionDependencies = condition_dependency_all;
 
 	wyrmgus::game::get()->clear_local_triggers();
 	trigger::ActiveTriggers.clear();
@@ -713,6 +789,21 @@ void trigger::process_sml_scope(const sml_data &scope)
 	}
 }
 
+void trigger::initialize()
+{
+	this->condition_dependencies = condition_dependency_none;
+
+	if (this->get_preconditions() != nullptr) {
+		this->condition_dependencies |= this->get_preconditions()->get_dependencies();
+	}
+
+	if (this->get_conditions() != nullptr) {
+		this->condition_dependencies |= this->get_conditions()->get_dependencies();
+	}
+
+	data_entry::initialize();
+}
+
 void trigger::check() const
 {
 	if (this->get_preconditions() != nullptr) {
@@ -728,6 +819,21 @@ void trigger::check() const
 	}
 }
 
+/**
+**	Get whether the trigger only needs to be checked when the game state its conditions depend on changes.
+**
+**	Triggers which can fire repeatedly are polled instead, so that they keep their previous firing rate,
+**	as are triggers using Lua conditions or conditions whose dependencies are not tracked.
+*/
+bool trigger::is_event_driven() const
+{
+	if (this->Conditions != nullptr || !this->fires_only_once()) {
+		return false;
+	}
+
+	return (this->get_condition_dependencies() & condition_dependency_other) == 0;
+}
+
 }
 
 /**
@@ -90,15 +90,23 @@ public:
 	static void InitActiveTriggers();	/// Setup triggers
 	static void ClearActiveTriggers();
 
+	//mark a part of the game state as changed, so that the triggers whose conditions depend on it are checked again
+	static void on_condition_dependency_changed(const unsigned int dependency)
+	{
+		trigger::ChangedConditionDependencies |= dependency;
+	}
+
 	static std::vector<trigger *> ActiveTriggers; //triggers that are active for the current game
 	static std::vector<std::string> DeactivatedTriggers;
 	static unsigned int CurrentTriggerId;
+	static unsigned int ChangedConditionDependencies; //the condition dependencies which changed since the event-driven triggers were last checked
 
 	explicit trigger(const std::string &identifier);
 	~trigger();
 	
 	virtual void process_sml_property(const sml_property &property) override;
 	virtual void process_sml_scope(const sml_data &scope) override;
+	virtual void initialize() override;
 	virtual void check() const override;
 
 	bool fires_only_once() const
@@ -126,6 +134,13 @@ public:
 		return this->effects;
 	}
 
+	unsigned int get_condition_dependencies() const
+	{
+		return this->condition_dependencies;
+	}
+
+	bool is_event_driven() const;
+
 	TriggerType Type = TriggerType::GlobalTrigger;
 	bool Local = false;
 private:
@@ -138,6 +153,7 @@ private:
 	std::unique_ptr<condition> preconditions;
 	std::unique_ptr<condition> conditions;
 	std::unique_ptr<effect_list<CPlayer>> effects;
+	unsigned int condition_dependencies = ~0u; //the parts of the game state on which the trigger's conditions depend
 };
 
 }
@@ -54,6 +54,8 @@
 #include <physfs.h>
 #endif
 
+#include <charconv>
+
 #ifdef __MORPHOS__
 #undef tell
 #endif
@@ -71,8 +73,15 @@ public:
 	int seek(long offset, int whence);
 	long tell();
 	int write(const void *buf, size_t len);
+	int write_formatted(const char *format, va_list ap);
+	std::string take_buffer();
 
 private:
+	int write_direct(const void *buf, size_t len);
+	char *reserve_write_buffer(size_t len);
+	int check_write_buffer_flush();
+	int flush_write_buffer();
+
 	PImpl(const PImpl &rhs); // No implementation
 	const PImpl &operator = (const PImpl &rhs); // No implementation
 
@@ -88,6 +97,11 @@ private:
 #ifdef USE_PHYSFS
 	PHYSFS_File *cl_pf;
 #endif
+	std::string cl_memory; /// in-memory buffer
+	std::vector<char> cl_write_buffer; /// buffer for data waiting to be written in a large block
+	size_t cl_write_buffer_size = 0;   /// size of the data in the write buffer
+
+	static constexpr size_t write_buffer_flush_size = 64 * 1024; /// size from which the write buffer is flushed
 };
 
 CFile::CFile() : pimpl(std::make_unique<CFile::PImpl>())
@@ -155,6 +169,49 @@ long CFile::tell()
 	return pimpl->tell();
 }
 
+/**
+**  CLwrite Library file write
+**
+**  @param buf  Pointer to the data to be written.
+**  @param len  number of bytes to write.
+*/
+int CFile::write(const void *buf, size_t len)
+{
+	return pimpl->write(buf, len);
+}
+
+/**
+**  Take the data written to a file opened with CL_WRITE_MEMORY
+**
+**  @return The written data, leaving the buffer empty.
+*/
+std::string CFile::take_buffer()
+{
+	return pimpl->take_buffer();
+}
+
+/**
+**  Write an integer as text
+**
+**  @param value  The integer to be written.
+*/
+int CFile::write_int(const int64_t value)
+{
+	char buf[24];
+	const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value);
+	return pimpl->write(buf, result.ptr - buf);
+}
+
+/**
+**  Write a string as it is, without any formatting
+**
+**  @param str  The string to be written.
+*/
+int CFile::write_string(const std::string_view &str)
+{
+	return pimpl->write(str.data(), str.size());
+}
+
 /**
 **  CLprintf Library file write
 **
@@ -163,34 +220,10 @@ long CFile::tell()
 */
 int CFile::printf(const char *format, ...)
 {
-	int size = 500;
-	auto p = std::make_unique<char[]>(size);
-	if (p == nullptr) {
-		return -1;
-	}
-	while (1) {
-		// Try to print in the allocated space.
-		va_list ap;
-		va_start(ap, format);
-		const int n = vsnprintf(p.get(), size, format, ap);
-		va_end(ap);
-		// If that worked, string was processed.
-		if (n > -1 && n < size) {
-			break;
-		}
-		// Else try again with more space.
-		if (n > -1) { // glibc 2.1
-			size = n + 1; // precisely what is needed
-		} else {    /* glibc 2.0, vc++ */
-			size *= 2;  // twice the old size
-		}
-		p = std::make_unique<char[]>(size);
-		if (p == nullptr) {
-			return -1;
-		}
-	}
-	size = strlen(p.get());
-	int ret = pimpl->write(p.get(), size);
+	va_list ap;
+	va_start(ap, format);
+	const int ret = pimpl->write_formatted(format, ap);
+	va_end(ap);
 	return ret;
 }
 
@@ -278,6 +311,13 @@ int CFile::PImpl::open(const char *name, long openflags)
 
 	cl_type = CLF_TYPE_INVALID;
 
+	if ((openflags & CL_WRITE_MEMORY) && (openflags & CL_OPEN_WRITE)) {
+		//the data is kept in memory, to be written to a file later on
+		cl_memory.clear();
+		cl_type = CLF_TYPE_MEMORY;
+		return 0;
+	}
+
 	if (openflags & CL_OPEN_WRITE) {
 #ifdef USE_BZ2LIB
 		if ((openflags & CL_WRITE_BZ2)
@@ -365,10 +405,15 @@ int CFile::PImpl::close()
 	int ret = EOF;
 	int tp = cl_type;
 
+	const bool flushed = tp == CLF_TYPE_INVALID || flush_write_buffer() == 0;
+
 	if (tp != CLF_TYPE_INVALID) {
 		if (tp == CLF_TYPE_PLAIN) {
 			ret = fclose(cl_plain);
 		}
+		if (tp == CLF_TYPE_MEMORY) {
+			ret = 0;
+		}
 #ifdef USE_ZLIB
 		if (tp == CLF_TYPE_GZIP) {
 			ret = gzclose(cl_gz);
@@ -389,6 +434,9 @@ int CFile::PImpl::close()
 		errno = EBADF;
 	}
 	cl_type = CLF_TYPE_INVALID;
+	if (!flushed) {
+		ret = EOF;
+	}
 	return ret;
 }
 
@@ -424,6 +472,7 @@ int CFile::PImpl::read(void *buf, size_t len)
 void CFile::PImpl::flush()
 {
 	if (cl_type != CLF_TYPE_INVALID) {
+		flush_write_buffer();
 		if (cl_type == CLF_TYPE_PLAIN) {
 			fflush(cl_plain);
 		}
@@ -442,7 +491,119 @@ void CFile::PImpl::flush()
 	}
 }
 
+/**
+**  Write data, gathering small writes in the write buffer so that the backend receives them in large blocks
+*/
 int CFile::PImpl::write(const void *buf, size_t size)
+{
+	if (cl_type == CLF_TYPE_INVALID) {
+		errno = EBADF;
+		return -1;
+	}
+
+	if (size >= write_buffer_flush_size) {
+		if (flush_write_buffer() == -1) {
+			return -1;
+		}
+		return write_direct(buf, size);
+	}
+
+	memcpy(reserve_write_buffer(size), buf, size);
+	cl_write_buffer_size += size;
+
+	if (check_write_buffer_flush() == -1) {
+		return -1;
+	}
+
+	return size;
+}
+
+/**
+**  Format text directly into the tail of the write buffer
+*/
+int CFile::PImpl::write_formatted(const char *format, va_list ap)
+{
+	if (cl_type == CLF_TYPE_INVALID) {
+		errno = EBADF;
+		return -1;
+	}
+
+	const size_t available = cl_write_buffer.size() - cl_write_buffer_size;
+
+	va_list ap_copy;
+	va_copy(ap_copy, ap);
+	int n = vsnprintf(cl_write_buffer.data() + cl_write_buffer_size, available, format, ap_copy);
+	va_end(ap_copy);
+
+	if (n < 0) {
+		return -1;
+	}
+
+	if (static_cast<size_t>(n) >= available) {
+		//the formatted text didn't fit, grow the buffer and format it again
+		char *tail = reserve_write_buffer(n + 1);
+		n = vsnprintf(tail, n + 1, format, ap);
+
+		if (n < 0) {
+			return -1;
+		}
+	}
+
+	cl_write_buffer_size += n;
+
+	if (check_write_buffer_flush() == -1) {
+		return -1;
+	}
+
+	return n;
+}
+
+/**
+**  Make room for the given amount of data at the tail of the write buffer
+**
+**  @return Pointer to the tail of the write buffer.
+*/
+char *CFile::PImpl::reserve_write_buffer(size_t size)
+{
+	const size_t required_size = cl_write_buffer_size + size;
+	if (required_size > cl_write_buffer.size()) {
+		cl_write_buffer.resize(std::max(required_size, std::max(cl_write_buffer.size() * 2, write_buffer_flush_size * 2)));
+	}
+
+	return cl_write_buffer.data() + cl_write_buffer_size;
+}
+
+int CFile::PImpl::check_write_buffer_flush()
+{
+	if (cl_write_buffer_size >= write_buffer_flush_size) {
+		return flush_write_buffer();
+	}
+
+	return 0;
+}
+
+/**
+**  Pass the data in the write buffer to the backend
+**
+**  @return 0 if all OK, -1 if writing failed
+*/
+int CFile::PImpl::flush_write_buffer()
+{
+	if (cl_write_buffer_size == 0) {
+		return 0;
+	}
+
+	const int ret = write_direct(cl_write_buffer.data(), cl_write_buffer_size);
+	cl_write_buffer_size = 0;
+
+	if (ret <= 0) {
+		return -1;
+	}
+
+	return 0;
+}
+
+int CFile::PImpl::write_direct(const void *buf, size_t size)
 {
 	int tp = cl_type;
 	int ret = -1;
@@ -451,6 +612,10 @@ int CFile::PImpl::write(const void *buf, size_t size)
 		if (tp == CLF_TYPE_PLAIN) {
 			ret = fwrite(buf, size, 1, cl_plain);
 		}
+		if (tp == CLF_TYPE_MEMORY) {
+			cl_memory.append(static_cast<const char *>(buf), size);
+			ret = size;
+		}
 #ifdef USE_ZLIB
 		if (tp == CLF_TYPE_GZIP) {
 			ret = gzwrite(cl_gz, buf, size);
@@ -467,11 +632,19 @@ int CFile::PImpl::write(const void *buf, size_t size)
 	return ret;
 }
 
+std::string CFile::PImpl::take_buffer()
+{
+	flush_write_buffer();
+	return std::move(cl_memory);
+}
+
 int CFile::PImpl::seek(long offset, int whence)
 {
 	int ret = -1;
 	int tp = cl_type;
 
+	flush_write_buffer();
+
 	if (tp != CLF_TYPE_INVALID) {
 		if (tp == CLF_TYPE_PLAIN) {
 			ret = fseek(cl_plain, offset, whence);
@@ -507,6 +680,9 @@ long CFile::PImpl::tell()
 		if (tp == CLF_TYPE_PLAIN) {
 			ret = ftell(cl_plain);
 		}
+		if (tp == CLF_TYPE_MEMORY) {
+			ret = cl_memory.size();
+		}
 #ifdef USE_ZLIB
 		if (tp == CLF_TYPE_GZIP) {
 			ret = gztell(cl_gz);
@@ -523,6 +699,9 @@ long CFile::PImpl::tell()
 			ret = PHYSFS_tell(cl_pf);
 		}
 #endif
+		if (ret != -1) {
+			ret += cl_write_buffer_size;
+		}
 	} else {
 		errno = EBADF;
 	}
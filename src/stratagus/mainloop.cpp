@@ -198,6 +198,12 @@ void DrawMapArea()
 */
 void UpdateDisplay()
 {
+	//descriptions evaluated more than once while drawing, e.g. for popups, only need to be evaluated once; outside of a running game, changes to the state they depend on aren't tracked
+	if (!GameRunning) {
+		InvalidateDescMemos(DescDependency_All);
+	}
+	const DescMemoizationScope desc_memoization_scope;
+
 	if (GameRunning || Editor.Running == EditorEditing) {
 		// to prevent empty spaces in the UI
 #if defined(USE_OPENGL) || defined(USE_GLES)
@@ -317,10 +323,6 @@ static void GameLogicLoop()
 		PlayersEachCycle(); // handle players
 		UpdateTimer();      // update game timer
 
-		for (const std::unique_ptr<CMapLayer> &map_layer : CMap::Map.MapLayers) {
-			map_layer->DoPerCycleLoop();
-		}
-		
 		//
 		// Work todo each second.
 		// Split into different frames, to reduce cpu time.
@@ -400,11 +402,13 @@ static void GameLogicLoop()
 			UI.StatusLine.Set(_("Autosave"));
 			//Wyrmgus start
 //			SaveGame("autosave.sav");
-			CclCommand("if (RunSaveGame ~= nil) then RunSaveGame(\"autosave.sav\") end;");
+			RunAutosave();
 			//Wyrmgus end
 		}
 	}
 
+	UpdateSaveGameProgress();
+
 	UpdateMessages();     // update messages
 	ParticleManager.update(); // handle particles
 	CheckMusicFinished(); // Check for next song
@@ -504,6 +508,7 @@ void GameMainLoop()
 	GameEstablishing = false;
 	//Wyrmgus end
 	GameRunning = true;
+	InvalidateDescMemos(DescDependency_All); //descriptions memoized before the game started refer to its setup, not to its state
 
 	CParticleManager::init();
 
@@ -82,6 +82,7 @@
 #include "script.h"
 #include "script/condition/and_condition.h"
 #include "script/effect/effect_list.h"
+#include "script/trigger.h"
 //Wyrmgus start
 #include "settings.h"
 #include "sound/sound.h"
@@ -1197,6 +1198,8 @@ void CPlayer::set_civilization(const wyrmgus::civilization *civilization)
 	}
 
 	this->Race = civilization->ID;
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_players);
+	InvalidatePlayerDescMemos(*this);
 
 	if (this->get_civilization() != nullptr) {
 		//if the civilization of the person player changed, update the UI
@@ -1271,6 +1274,8 @@ void CPlayer::SetFaction(const wyrmgus::faction *faction)
 	}
 	
 	this->Faction = faction_id;
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_players);
+	InvalidatePlayerDescMemos(*this);
 
 	if (this->Index == CPlayer::GetThisPlayer()->Index) {
 		UI.Load();
@@ -1422,7 +1427,8 @@ void CPlayer::SetRandomFaction()
 		}
 
 		const wyrmgus::faction_type faction_type = faction->get_type();
-		const bool has_writing = this->has_upgrade_class(wyrmgus::upgrade_class::get("writing"));
+		static const wyrmgus::data_handle<wyrmgus::upgrade_class> writing_class = wyrmgus::upgrade_class::get_handle("writing");
+		const bool has_writing = this->has_upgrade_class(writing_class.get());
 		if (
 			!(faction_type == wyrmgus::faction_type::tribe && !has_writing)
 			&& !(faction_type == wyrmgus::faction_type::polity && has_writing)
@@ -1456,6 +1462,8 @@ void CPlayer::set_dynasty(const wyrmgus::dynasty *dynasty)
 	}
 
 	this->dynasty = dynasty;
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_players);
+	InvalidatePlayerDescMemos(*this);
 
 	if (dynasty == nullptr) {
 		return;
@@ -1518,6 +1526,8 @@ void CPlayer::set_age(const wyrmgus::age *age)
 	}
 	
 	this->age = age;
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_players);
+	InvalidatePlayerDescMemos(*this);
 	
 	if (this == CPlayer::GetThisPlayer()) {
 		if (this->age != nullptr) {
@@ -2565,6 +2575,7 @@ void CPlayer::accept_quest(wyrmgus::quest *quest)
 	
 	wyrmgus::vector::remove(this->available_quests, quest);
 	this->current_quests.push_back(quest);
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_quests);
 	
 	for (const auto &quest_objective : quest->get_objectives()) {
 		auto objective = std::make_unique<wyrmgus::player_quest_objective>(quest_objective.get(), this);
@@ -2596,6 +2607,7 @@ void CPlayer::complete_quest(wyrmgus::quest *quest)
 	this->remove_current_quest(quest);
 	
 	this->completed_quests.push_back(quest);
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_quests);
 	if (quest->is_competitive()) {
 		quest->CurrentCompleted = true;
 	}
@@ -2658,6 +2670,7 @@ void CPlayer::fail_quest(wyrmgus::quest *quest, const std::string &fail_reason)
 void CPlayer::remove_current_quest(wyrmgus::quest *quest)
 {
 	wyrmgus::vector::remove(this->current_quests, quest);
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_quests);
 	
 	for (int i = (this->quest_objectives.size()  - 1); i >= 0; --i) {
 		if (this->quest_objectives[i]->get_quest_objective()->get_quest() == quest) {
@@ -2919,6 +2932,8 @@ void CPlayer::change_resource(const wyrmgus::resource *resource, const int value
 			this->Resources[resource->get_index()] += value;
 		}
 	}
+
+	InvalidateButtonAllowedCache();
 }
 
 /**
@@ -2943,6 +2958,8 @@ void CPlayer::set_resource(const wyrmgus::resource *resource, const int value, c
 	} else if (type == STORE_OVERALL) {
 		this->Resources[resource->get_index()] = value;
 	}
+
+	InvalidateButtonAllowedCache();
 }
 
 /**
@@ -3534,6 +3551,7 @@ void CPlayer::IncreaseCountsForUnit(CUnit *unit, bool type_change)
 
 	this->ChangeUnitTypeCount(type, 1);
 	this->units_by_type[type].push_back(unit);
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_units);
 
 	if (type->get_unit_class() != nullptr) {
 		this->units_by_class[type->get_unit_class()].push_back(unit);
@@ -3568,6 +3586,7 @@ void CPlayer::DecreaseCountsForUnit(CUnit *unit, bool type_change)
 	const wyrmgus::unit_type *type = unit->Type;
 
 	this->ChangeUnitTypeCount(type, -1);
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_units);
 	
 	wyrmgus::vector::remove(this->units_by_type[type], unit);
 
@@ -3850,6 +3869,9 @@ void CPlayer::SetDiplomacyNeutralWith(const CPlayer &player)
 {
 	this->enemies.erase(player.Index);
 	this->allies.erase(player.Index);
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_players);
+	InvalidatePlayerDescMemos(*this);
+	InvalidatePlayerDescMemos(player);
 
 	//Wyrmgus start
 	if (GameCycle > 0 && player.Index == CPlayer::GetThisPlayer()->Index) {
@@ -3862,6 +3884,9 @@ void CPlayer::SetDiplomacyAlliedWith(const CPlayer &player)
 {
 	this->enemies.erase(player.Index);
 	this->allies.insert(player.Index);
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_players);
+	InvalidatePlayerDescMemos(*this);
+	InvalidatePlayerDescMemos(player);
 	
 	if (GameCycle > 0 && player.Index == CPlayer::GetThisPlayer()->Index) {
 		CPlayer::GetThisPlayer()->Notify(_("%s changed their diplomatic stance with us to Ally"), _(this->Name.c_str()));
@@ -3872,6 +3897,9 @@ void CPlayer::SetDiplomacyEnemyWith(CPlayer &player)
 {
 	this->enemies.insert(player.Index);
 	this->allies.erase(player.Index);
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_players);
+	InvalidatePlayerDescMemos(*this);
+	InvalidatePlayerDescMemos(player);
 	
 	if (GameCycle > 0) {
 		if (player.Index == CPlayer::GetThisPlayer()->Index) {
@@ -3902,6 +3930,9 @@ void CPlayer::SetDiplomacyCrazyWith(const CPlayer &player)
 {
 	this->enemies.insert(player.Index);
 	this->allies.insert(player.Index);
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_players);
+	InvalidatePlayerDescMemos(*this);
+	InvalidatePlayerDescMemos(player);
 	
 	if (GameCycle > 0 && player.Index == CPlayer::GetThisPlayer()->Index) {
 		CPlayer::GetThisPlayer()->Notify(_("%s changed their diplomatic stance with us to Crazy"), _(this->Name.c_str()));
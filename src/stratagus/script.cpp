@@ -792,128 +792,231 @@ static std::string CallLuaStringFunction(unsigned int handler)
 }
 
 /**
-**  Gets the player data.
+**  Get the player data property corresponding to a string.
 **
-**  @param player  Player number.
-**  @param prop    Player's property.
-**  @param arg     Additional argument (for resource and unit).
+**  @param prop  Player's property.
 **
-**  @return  Returning value (only integer).
+**  @return  The property.
 */
-static int GetPlayerData(const int player_index, const char *prop, const char *arg)
+static PlayerDataProperty GetPlayerDataProperty(const char *prop)
 {
-	const CPlayer *player = CPlayer::Players[player_index];
-
 	if (!strcmp(prop, "RaceName")) {
-		return player->Race;
+		return PlayerDataProperty::RaceName;
 	} else if (!strcmp(prop, "Resources")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->Resources[res_id] + player->StoredResources[res_id];
+		return PlayerDataProperty::Resources;
 	} else if (!strcmp(prop, "StoredResources")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->StoredResources[res_id];
+		return PlayerDataProperty::StoredResources;
 	} else if (!strcmp(prop, "MaxResources")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->MaxResources[res_id];
+		return PlayerDataProperty::MaxResources;
 	} else if (!strcmp(prop, "Incomes")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->Incomes[res_id];
-		//Wyrmgus start
+		return PlayerDataProperty::Incomes;
 	} else if (!strcmp(prop, "Prices")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->GetResourcePrice(res_id);
+		return PlayerDataProperty::Prices;
 	} else if (!strcmp(prop, "ResourceDemand")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->ResourceDemand[res_id];
+		return PlayerDataProperty::ResourceDemand;
 	} else if (!strcmp(prop, "StoredResourceDemand")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->StoredResourceDemand[res_id];
+		return PlayerDataProperty::StoredResourceDemand;
 	} else if (!strcmp(prop, "EffectiveResourceDemand")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->GetEffectiveResourceDemand(res_id);
+		return PlayerDataProperty::EffectiveResourceDemand;
 	} else if (!strcmp(prop, "EffectiveResourceBuyPrice")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->GetEffectiveResourceBuyPrice(res_id);
+		return PlayerDataProperty::EffectiveResourceBuyPrice;
 	} else if (!strcmp(prop, "EffectiveResourceSellPrice")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->GetEffectiveResourceSellPrice(res_id);
+		return PlayerDataProperty::EffectiveResourceSellPrice;
 	} else if (!strcmp(prop, "TradeCost")) {
-		return player->TradeCost;
-		//Wyrmgus end
+		return PlayerDataProperty::TradeCost;
 	} else if (!strcmp(prop, "UnitTypesCount")) {
-		const std::string unit(arg);
-		wyrmgus::unit_type *type = wyrmgus::unit_type::get(unit);
-		return player->GetUnitTypeCount(type);
+		return PlayerDataProperty::UnitTypesCount;
 	} else if (!strcmp(prop, "UnitTypesUnderConstructionCount")) {
-		const std::string unit(arg);
-		wyrmgus::unit_type *type = wyrmgus::unit_type::get(unit);
-		return player->GetUnitTypeUnderConstructionCount(type);
+		return PlayerDataProperty::UnitTypesUnderConstructionCount;
 	} else if (!strcmp(prop, "UnitTypesAiActiveCount")) {
-		const std::string unit(arg);
-		wyrmgus::unit_type *type = wyrmgus::unit_type::get(unit);
-		return player->GetUnitTypeAiActiveCount(type);
+		return PlayerDataProperty::UnitTypesAiActiveCount;
 	} else if (!strcmp(prop, "AiEnabled")) {
-		return player->AiEnabled;
+		return PlayerDataProperty::AiEnabled;
 	} else if (!strcmp(prop, "TotalNumUnits")) {
-		return player->GetUnitCount();
+		return PlayerDataProperty::TotalNumUnits;
 	} else if (!strcmp(prop, "NumBuildings")) {
-		return player->NumBuildings;
-		//Wyrmgus start
+		return PlayerDataProperty::NumBuildings;
 	} else if (!strcmp(prop, "NumBuildingsUnderConstruction")) {
-		return player->NumBuildingsUnderConstruction;
-		//Wyrmgus end
+		return PlayerDataProperty::NumBuildingsUnderConstruction;
 	} else if (!strcmp(prop, "Supply")) {
-		return player->Supply;
+		return PlayerDataProperty::Supply;
 	} else if (!strcmp(prop, "Demand")) {
-		return player->Demand;
+		return PlayerDataProperty::Demand;
 	} else if (!strcmp(prop, "UnitLimit")) {
-		return player->UnitLimit;
+		return PlayerDataProperty::UnitLimit;
 	} else if (!strcmp(prop, "BuildingLimit")) {
-		return player->BuildingLimit;
+		return PlayerDataProperty::BuildingLimit;
 	} else if (!strcmp(prop, "TotalUnitLimit")) {
-		return player->TotalUnitLimit;
+		return PlayerDataProperty::TotalUnitLimit;
 	} else if (!strcmp(prop, "Score")) {
-		return player->Score;
+		return PlayerDataProperty::Score;
 	} else if (!strcmp(prop, "TotalUnits")) {
-		return player->TotalUnits;
+		return PlayerDataProperty::TotalUnits;
 	} else if (!strcmp(prop, "TotalBuildings")) {
-		return player->TotalBuildings;
+		return PlayerDataProperty::TotalBuildings;
 	} else if (!strcmp(prop, "TotalResources")) {
-		const wyrmgus::resource *resource = wyrmgus::resource::get(arg);
-		const int res_id = resource->get_index();
-		return player->TotalResources[res_id];
+		return PlayerDataProperty::TotalResources;
 	} else if (!strcmp(prop, "TotalRazings")) {
-		return player->TotalRazings;
+		return PlayerDataProperty::TotalRazings;
 	} else if (!strcmp(prop, "TotalKills")) {
-		return player->TotalKills;
+		return PlayerDataProperty::TotalKills;
 	} else if (!strcmp(prop, "Population")) {
-		return player->get_population();
+		return PlayerDataProperty::Population;
 	} else if (!strcmp(prop, "Overlord")) {
-		if (player->get_overlord() != nullptr) {
-			return player->get_overlord()->Index;
-		}
-		return -1;
+		return PlayerDataProperty::Overlord;
 	} else if (!strcmp(prop, "TopOverlord")) {
-		if (player->get_overlord() != nullptr) {
-			return player->get_top_overlord()->Index;
-		}
-		return -1;
+		return PlayerDataProperty::TopOverlord;
 	} else {
 		throw std::runtime_error("Invalid field: \"" + std::string(prop) + "\".");
 	}
+}
+
+/**
+**  Resolve the additional argument of a player data property.
+**
+**  @param property   Player's property.
+**  @param arg        Additional argument (for resource and unit).
+**  @param resource   Set to the resource, for resource properties.
+**  @param unit_type  Set to the unit type, for unit type properties.
+*/
+static void ResolvePlayerDataArgument(const PlayerDataProperty property, const char *arg, const wyrmgus::resource *&resource, const wyrmgus::unit_type *&unit_type)
+{
+	switch (property) {
+		case PlayerDataProperty::Resources:
+		case PlayerDataProperty::StoredResources:
+		case PlayerDataProperty::MaxResources:
+		case PlayerDataProperty::Incomes:
+		case PlayerDataProperty::Prices:
+		case PlayerDataProperty::ResourceDemand:
+		case PlayerDataProperty::StoredResourceDemand:
+		case PlayerDataProperty::EffectiveResourceDemand:
+		case PlayerDataProperty::EffectiveResourceBuyPrice:
+		case PlayerDataProperty::EffectiveResourceSellPrice:
+		case PlayerDataProperty::TotalResources:
+			resource = wyrmgus::resource::get(arg);
+			break;
+		case PlayerDataProperty::UnitTypesCount:
+		case PlayerDataProperty::UnitTypesUnderConstructionCount:
+		case PlayerDataProperty::UnitTypesAiActiveCount:
+			unit_type = wyrmgus::unit_type::get(arg);
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+**  Gets the player data.
+**
+**  @param player     Player.
+**  @param property   Player's property.
+**  @param resource   Resource, for resource properties.
+**  @param unit_type  Unit type, for unit type properties.
+**
+**  @return  Returning value (only integer).
+*/
+static int GetPlayerData(const CPlayer *player, const PlayerDataProperty property, const wyrmgus::resource *resource, const wyrmgus::unit_type *unit_type)
+{
+	const int res_id = resource != nullptr ? resource->get_index() : -1;
+
+	switch (property) {
+		case PlayerDataProperty::RaceName:
+			return player->Race;
+		case PlayerDataProperty::Resources:
+			return player->Resources[res_id] + player->StoredResources[res_id];
+		case PlayerDataProperty::StoredResources:
+			return player->StoredResources[res_id];
+		case PlayerDataProperty::MaxResources:
+			return player->MaxResources[res_id];
+		case PlayerDataProperty::Incomes:
+			return player->Incomes[res_id];
+		case PlayerDataProperty::Prices:
+			return player->GetResourcePrice(res_id);
+		case PlayerDataProperty::ResourceDemand:
+			return player->ResourceDemand[res_id];
+		case PlayerDataProperty::StoredResourceDemand:
+			return player->StoredResourceDemand[res_id];
+		case PlayerDataProperty::EffectiveResourceDemand:
+			return player->GetEffectiveResourceDemand(res_id);
+		case PlayerDataProperty::EffectiveResourceBuyPrice:
+			return player->GetEffectiveResourceBuyPrice(res_id);
+		case PlayerDataProperty::EffectiveResourceSellPrice:
+			return player->GetEffectiveResourceSellPrice(res_id);
+		case PlayerDataProperty::TradeCost:
+			return player->TradeCost;
+		case PlayerDataProperty::UnitTypesCount:
+			return player->GetUnitTypeCount(unit_type);
+		case PlayerDataProperty::UnitTypesUnderConstructionCount:
+			return player->GetUnitTypeUnderConstructionCount(unit_type);
+		case PlayerDataProperty::UnitTypesAiActiveCount:
+			return player->GetUnitTypeAiActiveCount(unit_type);
+		case PlayerDataProperty::AiEnabled:
+			return player->AiEnabled;
+		case PlayerDataProperty::TotalNumUnits:
+			return player->GetUnitCount();
+		case PlayerDataProperty::NumBuildings:
+			return player->NumBuildings;
+		case PlayerDataProperty::NumBuildingsUnderConstruction:
+			return player->NumBuildingsUnderConstruction;
+		case PlayerDataProperty::Supply:
+			return player->Supply;
+		case PlayerDataProperty::Demand:
+			return player->Demand;
+		case PlayerDataProperty::UnitLimit:
+			return player->UnitLimit;
+		case PlayerDataProperty::BuildingLimit:
+			return player->BuildingLimit;
+		case PlayerDataProperty::TotalUnitLimit:
+			return player->TotalUnitLimit;
+		case PlayerDataProperty::Score:
+			return player->Score;
+		case PlayerDataProperty::TotalUnits:
+			return player->TotalUnits;
+		case PlayerDataProperty::TotalBuildings:
+			return player->TotalBuildings;
+		case PlayerDataProperty::TotalResources:
+			return player->TotalResources[res_id];
+		case PlayerDataProperty::TotalRazings:
+			return player->TotalRazings;
+		case PlayerDataProperty::TotalKills:
+			return player->TotalKills;
+		case PlayerDataProperty::Population:
+			return player->get_population();
+		case PlayerDataProperty::Overlord:
+			if (player->get_overlord() != nullptr) {
+				return player->get_overlord()->Index;
+			}
+			return -1;
+		case PlayerDataProperty::TopOverlord:
+			if (player->get_overlord() != nullptr) {
+				return player->get_top_overlord()->Index;
+			}
+			return -1;
+		default:
+			break;
+	}
 	return 0;
 }
 
+/**
+**  Gets the player data.
+**
+**  @param player  Player number.
+**  @param prop    Player's property.
+**  @param arg     Additional argument (for resource and unit).
+**
+**  @return  Returning value (only integer).
+*/
+static int GetPlayerData(const int player_index, const char *prop, const char *arg)
+{
+	const PlayerDataProperty property = GetPlayerDataProperty(prop);
+	const wyrmgus::resource *resource = nullptr;
+	const wyrmgus::unit_type *unit_type = nullptr;
+	ResolvePlayerDataArgument(property, arg, resource, unit_type);
+
+	return GetPlayerData(CPlayer::Players[player_index], property, resource, unit_type);
+}
+
 /**
 **  Return number.
 **
@@ -1325,15 +1428,20 @@ std::unique_ptr<StringDesc> CclParseStringDesc(lua_State *l)
 **
 **  @return          the result unit.
 */
-CUnit *EvalUnit(const UnitDesc *unitdesc)
+static void UpdateActiveUnit()
 {
-	Assert(unitdesc);
-
 	if (!Selected.empty()) {
 		TriggerData.Active = Selected[0];
 	} else {
 		TriggerData.Active = UnitUnderCursor;
 	}
+}
+
+CUnit *EvalUnit(const UnitDesc *unitdesc)
+{
+	Assert(unitdesc);
+
+	UpdateActiveUnit();
 	switch (unitdesc->e) {
 		case EUnit_Ref :
 			return *unitdesc->D.AUnit;
@@ -1467,8 +1575,22 @@ int EvalNumber(const NumberDesc *number)
 			} else { // ERROR.
 				return 0;
 			}
-		case ENumber_PlayerData : // getplayerdata(player, data, res);
-			int player = EvalNumber(number->D.PlayerData.Player.get());
+		case ENumber_PlayerData : { // getplayerdata(player, data, res);
+			const int player = EvalNumber(number->D.PlayerData.Player.get());
+
+			//compile constant data and resource types once, instead of resolving their strings on every evaluation
+			const auto &player_data = number->D.PlayerData;
+			if (player_data.DataType->e == EString_Dir && (player_data.ResType == nullptr || player_data.ResType->e == EString_Dir)) {
+				if (!player_data.Compiled) {
+					player_data.Property = GetPlayerDataProperty(player_data.DataType->D.Val.c_str());
+					const char *arg = player_data.ResType != nullptr ? player_data.ResType->D.Val.c_str() : "";
+					ResolvePlayerDataArgument(player_data.Property, arg, player_data.Resource, player_data.UnitType);
+					player_data.Compiled = true;
+				}
+
+				return GetPlayerData(CPlayer::Players[player], player_data.Property, player_data.Resource, player_data.UnitType);
+			}
+
 			std::string data = EvalString(number->D.PlayerData.DataType.get());
 			//Wyrmgus start
 //			std::string res = EvalString(number->D.PlayerData.ResType);
@@ -1478,10 +1600,422 @@ int EvalNumber(const NumberDesc *number)
 			}
 			//Wyrmgus end
 			return GetPlayerData(player, data.c_str(), res.c_str());
+		}
 	}
 	return 0;
 }
 
+const void *DescReference::GetValue() const
+{
+	switch (this->kind) {
+		case Kind::Unit:
+			return *static_cast<CUnit *const *>(this->Address);
+		case Kind::UnitType:
+			return *static_cast<const wyrmgus::unit_type *const *>(this->Address);
+		case Kind::Upgrade:
+			return *static_cast<const CUpgrade *const *>(this->Address);
+		case Kind::Faction:
+			return *static_cast<const wyrmgus::faction *const *>(this->Address);
+		case Kind::Resource:
+			return *static_cast<const wyrmgus::resource *const *>(this->Address);
+		case Kind::Player:
+			return *static_cast<const CPlayer *const *>(this->Address);
+	}
+	return nullptr;
+}
+
+static constexpr int DescDependencyCount = 3;
+static unsigned long DescDependencyGenerations[DescDependencyCount] = {}; /// The number of times each part of the game state has changed.
+static unsigned long PlayerDescGenerations[PlayerMax] = {}; /// The number of times the state of each player has changed.
+static int DescMemoizationScopeDepth = 0;
+static int StringDescMemoizedEvaluationDepth = 0;
+
+DescMemoizationScope::DescMemoizationScope()
+{
+	if (DescMemoizationScopeDepth == 0) {
+		InvalidateDescMemos(DescDependency_Other);
+	}
+	++DescMemoizationScopeDepth;
+}
+
+DescMemoizationScope::~DescMemoizationScope()
+{
+	--DescMemoizationScopeDepth;
+}
+
+/**
+**  Invalidate the memoized results of the descriptions which depend on game state which changed.
+**
+**  @param dependencies  The DescDependency flags of the parts of the game state which changed.
+*/
+void InvalidateDescMemos(const unsigned int dependencies)
+{
+	for (int i = 0; i < DescDependencyCount; ++i) {
+		if (dependencies & (1u << i)) {
+			++DescDependencyGenerations[i];
+		}
+	}
+}
+
+/**
+**  Invalidate the memoized results of the descriptions which refer to a player whose civilization, faction or diplomacy changed.
+**
+**  @param player  The player which changed.
+*/
+void InvalidatePlayerDescMemos(const CPlayer &player)
+{
+	++PlayerDescGenerations[player.get_index()];
+}
+
+static unsigned long GetPlayerDescGeneration(const CPlayer *player)
+{
+	if (player == nullptr) {
+		return 0;
+	}
+
+	return PlayerDescGenerations[player->get_index()];
+}
+
+/**
+**  Get the generation of parts of the game state.
+**
+**  The generations only increase, so their sum changes whenever any of the parts changes.
+*/
+static unsigned long GetDescDependencyGeneration(const unsigned int dependencies)
+{
+	unsigned long generation = 0;
+	for (int i = 0; i < DescDependencyCount; ++i) {
+		if (dependencies & (1u << i)) {
+			generation += DescDependencyGenerations[i];
+		}
+	}
+	return generation;
+}
+
+/**
+**  Get the parts of the game state a number description's own evaluation depends on, not counting its operands.
+*/
+static unsigned int GetNumberDescDependencies(const NumberDesc *number)
+{
+	switch (number->e) {
+		case ENumber_Dir:
+		case ENumber_Add:
+		case ENumber_Sub:
+		case ENumber_Mul:
+		case ENumber_Div:
+		case ENumber_Min:
+		case ENumber_Max:
+		case ENumber_Gt:
+		case ENumber_GtEq:
+		case ENumber_Lt:
+		case ENumber_LtEq:
+		case ENumber_Eq:
+		case ENumber_NEq:
+		case ENumber_VideoTextLength:
+		case ENumber_StringFind:
+		case ENumber_NumIf:
+		case ENumber_UnitStat: //read directly into the memo key
+		case ENumber_PlayerData:
+			return DescDependency_None;
+		case ENumber_TypeStat:
+		case ENumber_TypeTrainQuantity:
+			return DescDependency_Upgrades;
+		default:
+			return DescDependency_Other;
+	}
+}
+
+/**
+**  Get the parts of the game state a string description's own evaluation depends on, not counting its operands.
+*/
+static unsigned int GetStringDescDependencies(const StringDesc *s)
+{
+	switch (s->e) {
+		case EString_Dir:
+		case EString_Concat:
+		case EString_String:
+		case EString_InverseVideo:
+		case EString_If:
+		case EString_SubString:
+		case EString_Line:
+		case EString_TypeIdent:
+		case EString_UpgradeCivilization:
+		case EString_UpgradeEffectsString:
+		case EString_UpgradeMaxLimit:
+		case EString_FactionCivilization:
+		case EString_FactionType:
+		case EString_ResourceIdent:
+		case EString_ResourceName:
+		case EString_TypeRequirementsString:
+		case EString_TypeExperienceRequirementsString:
+		case EString_TypeBuildingRulesString:
+		case EString_UpgradeRequirementsString:
+			return DescDependency_None;
+		case EString_UnitName: //read directly into the memo key
+		case EString_UnitTypeName:
+		case EString_UnitTrait:
+		case EString_UnitSpell:
+		case EString_UnitQuote:
+		case EString_UnitSettlementName:
+		case EString_UnitUniqueSet:
+		case EString_UnitUniqueSetItems:
+		case EString_PlayerName:
+		case EString_PlayerFullName:
+			return DescDependency_None;
+		case EString_TypeName:
+		case EString_TypeClass:
+		case EString_TypeDescription:
+		case EString_TypeQuote:
+			//names can depend on the civilization and faction of the player
+			return DescDependency_Players;
+		case EString_TypeImproveIncomes:
+		case EString_TypeLuxuryDemand:
+			return DescDependency_Upgrades;
+		case EString_ResourceConversionRates:
+		case EString_ResourceImproveIncomes:
+			return DescDependency_Players | DescDependency_Upgrades;
+		default:
+			return DescDependency_Other;
+	}
+}
+
+static void AnalyzeStringDesc(const StringDesc *s, StringDescMemo &memo);
+
+/**
+**  Get whether a string description reads the state of a unit or player, and is thus evaluated as part of the memo key.
+*/
+static bool IsStringDescReadIntoMemoKey(const StringDesc *s)
+{
+	switch (s->e) {
+		case EString_UnitName:
+		case EString_UnitTypeName:
+		case EString_UnitTrait:
+		case EString_UnitSpell:
+		case EString_UnitQuote:
+		case EString_UnitSettlementName:
+		case EString_UnitUniqueSet:
+		case EString_UnitUniqueSetItems:
+		case EString_PlayerName:
+		case EString_PlayerFullName:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static void AddDescReference(StringDescMemo &memo, const DescReference::Kind kind, const void *address)
+{
+	if (address == nullptr) {
+		return;
+	}
+
+	DescReference reference;
+	reference.kind = kind;
+	reference.Address = address;
+	memo.References.push_back(reference);
+}
+
+static void AnalyzeUnitDesc(const UnitDesc *unitdesc, StringDescMemo &memo)
+{
+	if (unitdesc == nullptr) {
+		return;
+	}
+
+	memo.ReferencesUnit = true;
+	AddDescReference(memo, DescReference::Kind::Unit, unitdesc->D.AUnit);
+}
+
+/**
+**  Gather the references of a number description into a memo, marking the memo as not memoizable if the number is not deterministic.
+*/
+static void AnalyzeNumberDesc(const NumberDesc *number, StringDescMemo &memo)
+{
+	if (number == nullptr) {
+		return;
+	}
+
+	if (number->e == ENumber_Lua || number->e == ENumber_Rand) {
+		memo.Memoizable = false;
+		return;
+	}
+
+	memo.Dependencies |= GetNumberDescDependencies(number);
+	if (number->e == ENumber_UnitStat || number->e == ENumber_PlayerData) {
+		memo.KeyNumbers.push_back(number);
+	}
+
+	AnalyzeNumberDesc(number->D.N.get(), memo);
+	AddDescReference(memo, DescReference::Kind::UnitType, number->D.Type);
+	AddDescReference(memo, DescReference::Kind::Upgrade, number->D.Upgrade);
+	AddDescReference(memo, DescReference::Kind::Faction, number->D.Faction);
+	AddDescReference(memo, DescReference::Kind::Player, number->D.player);
+	AnalyzeNumberDesc(number->D.binOp.Left.get(), memo);
+	AnalyzeNumberDesc(number->D.binOp.Right.get(), memo);
+	AnalyzeUnitDesc(number->D.UnitStat.Unit.get(), memo);
+	AddDescReference(memo, DescReference::Kind::UnitType, number->D.TypeStat.Type);
+	AnalyzeStringDesc(number->D.VideoTextLength.String.get(), memo);
+	AnalyzeStringDesc(number->D.StringFind.String.get(), memo);
+	AnalyzeNumberDesc(number->D.NumIf.Cond.get(), memo);
+	AnalyzeNumberDesc(number->D.NumIf.BTrue.get(), memo);
+	AnalyzeNumberDesc(number->D.NumIf.BFalse.get(), memo);
+	AnalyzeNumberDesc(number->D.PlayerData.Player.get(), memo);
+	AnalyzeStringDesc(number->D.PlayerData.DataType.get(), memo);
+	AnalyzeStringDesc(number->D.PlayerData.ResType.get(), memo);
+}
+
+/**
+**  Gather the references of a string description into a memo, marking the memo as not memoizable if the string is not deterministic.
+*/
+static void AnalyzeStringDesc(const StringDesc *s, StringDescMemo &memo)
+{
+	if (s == nullptr) {
+		return;
+	}
+
+	if (s->e == EString_Lua) {
+		memo.Memoizable = false;
+		return;
+	}
+
+	memo.Dependencies |= GetStringDescDependencies(s);
+	if (IsStringDescReadIntoMemoKey(s)) {
+		memo.KeyStrings.push_back(s);
+	}
+
+	for (const std::unique_ptr<StringDesc> &string : s->D.Concat.Strings) {
+		AnalyzeStringDesc(string.get(), memo);
+	}
+	AnalyzeNumberDesc(s->D.Number.get(), memo);
+	AnalyzeStringDesc(s->D.String.get(), memo);
+	AnalyzeUnitDesc(s->D.Unit.get(), memo);
+	AddDescReference(memo, DescReference::Kind::UnitType, s->D.Type);
+	AddDescReference(memo, DescReference::Kind::Upgrade, s->D.Upgrade);
+	AddDescReference(memo, DescReference::Kind::Faction, s->D.Faction);
+	AddDescReference(memo, DescReference::Kind::Resource, s->D.Resource);
+	AnalyzeNumberDesc(s->D.If.Cond.get(), memo);
+	AnalyzeStringDesc(s->D.If.BTrue.get(), memo);
+	AnalyzeStringDesc(s->D.If.BFalse.get(), memo);
+	AnalyzeStringDesc(s->D.SubString.String.get(), memo);
+	AnalyzeNumberDesc(s->D.SubString.Begin.get(), memo);
+	AnalyzeNumberDesc(s->D.SubString.End.get(), memo);
+	AnalyzeStringDesc(s->D.Line.String.get(), memo);
+	AnalyzeNumberDesc(s->D.Line.Line.get(), memo);
+	AnalyzeNumberDesc(s->D.Line.MaxLen.get(), memo);
+	AnalyzeNumberDesc(s->D.PlayerName.get(), memo);
+}
+
+static std::string EvalStringDirect(const StringDesc *s);
+
+/**
+**  Get the key of a memoized string description.
+**
+**  Unit and player state changes too often to track, so the unit stats, player data and names the description reads are evaluated into the key instead, which is much cheaper than evaluating the whole description.
+*/
+static StringDescMemoKey GetStringDescMemoKey(const StringDescMemo &memo)
+{
+	if (memo.ReferencesUnit) {
+		//evaluating a unit description updates the active unit, so do it before reading the references
+		UpdateActiveUnit();
+	}
+
+	StringDescMemoKey key;
+	key.References.reserve(memo.References.size() + 1);
+	key.References.push_back(CPlayer::GetThisPlayer());
+	for (const DescReference &reference : memo.References) {
+		key.References.push_back(reference.GetValue());
+	}
+
+	if (memo.Dependencies & DescDependency_Players) {
+		key.PlayerGenerations.push_back(GetPlayerDescGeneration(CPlayer::GetThisPlayer()));
+		for (const DescReference &reference : memo.References) {
+			if (reference.kind == DescReference::Kind::Player) {
+				key.PlayerGenerations.push_back(GetPlayerDescGeneration(static_cast<const CPlayer *>(reference.GetValue())));
+			}
+		}
+	}
+
+	++StringDescMemoizedEvaluationDepth;
+	try {
+		key.Numbers.reserve(memo.KeyNumbers.size());
+		for (const NumberDesc *number : memo.KeyNumbers) {
+			key.Numbers.push_back(EvalNumber(number));
+		}
+
+		key.Strings.reserve(memo.KeyStrings.size());
+		for (const StringDesc *string : memo.KeyStrings) {
+			key.Strings.push_back(EvalStringDirect(string));
+		}
+	} catch (...) {
+		--StringDescMemoizedEvaluationDepth;
+		throw;
+	}
+	--StringDescMemoizedEvaluationDepth;
+
+	return key;
+}
+
+/**
+**  compute the string expression
+**
+**  Within a memoization scope, the result of a top-level evaluation is reused if the values the description refers to and the game state it depends on are unchanged.
+**
+**  @param s  struct with definition of the calculation.
+**
+**  @return   the result string.
+*/
+std::string EvalString(const StringDesc *s)
+{
+	Assert(s);
+
+	if (DescMemoizationScopeDepth == 0 || StringDescMemoizedEvaluationDepth > 0) {
+		return EvalStringDirect(s);
+	}
+
+	StringDescMemo &memo = s->Memo;
+	if (memo.Analyzed && !memo.Memoizable) {
+		return EvalStringDirect(s);
+	}
+
+	StringDescMemoKey key;
+	if (memo.Analyzed) {
+		key = GetStringDescMemoKey(memo);
+
+		if (memo.HasResult && memo.Generation == GetDescDependencyGeneration(memo.Dependencies) && memo.Key == key) {
+			return memo.Result;
+		}
+	}
+
+	memo.HasResult = false;
+
+	++StringDescMemoizedEvaluationDepth;
+	try {
+		memo.Result = EvalStringDirect(s);
+	} catch (...) {
+		--StringDescMemoizedEvaluationDepth;
+		throw;
+	}
+	--StringDescMemoizedEvaluationDepth;
+
+	if (!memo.Analyzed) {
+		//the description is analyzed after its first evaluation, as the player data it refers to is compiled by the evaluation
+		memo.Memoizable = true;
+		memo.Dependencies = DescDependency_None;
+		AnalyzeStringDesc(s, memo);
+		memo.Analyzed = true;
+
+		if (!memo.Memoizable) {
+			return memo.Result;
+		}
+
+		key = GetStringDescMemoKey(memo);
+	}
+
+	memo.HasResult = true;
+	memo.Generation = GetDescDependencyGeneration(memo.Dependencies);
+	memo.Key = std::move(key);
+	return memo.Result;
+}
+
 /**
 **  compute the string expression
 **
@@ -1491,7 +2025,7 @@ int EvalNumber(const NumberDesc *number)
 **
 **  @todo Manage better the error.
 */
-std::string EvalString(const StringDesc *s)
+static std::string EvalStringDirect(const StringDesc *s)
 {
 	std::string res;    // Result string.
 	std::string tmp1;   // Temporary string.
@@ -3147,6 +3681,25 @@ static int CclStdOutPrint(lua_State *l)
 	return 1;
 }
 
+/**
+**  Benchmark the lookup of data entries by their identifiers.
+**
+**  @param l  Lua state.
+*/
+static int CclIdentifierLookupBenchmark(lua_State *l)
+{
+	const int args = lua_gettop(l);
+	if (args > 1) {
+		LuaError(l, "incorrect argument");
+	}
+
+	const int rounds = args == 1 ? LuaToNumber(l, 1) : 100;
+
+	wyrmgus::database::get()->benchmark_identifier_lookups(std::max(rounds, 1));
+
+	return 0;
+}
+
 /**
 **  Get a date from lua state
 **
@@ -3634,5 +4187,6 @@ void ScriptRegister()
 	lua_register(Lua, "DebugPrint", CclDebugPrint);
 	//Wyrmgus start
 	lua_register(Lua, "StdOutPrint", CclStdOutPrint);
+	lua_register(Lua, "IdentifierLookupBenchmark", CclIdentifierLookupBenchmark);
 	//Wyrmgus end
 }
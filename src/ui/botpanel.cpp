@@ -114,6 +114,32 @@ const wyrmgus::button *LastDrawnButtonPopup = nullptr;
 const wyrmgus::button_level *CurrentButtonLevel = nullptr;
 /// Pointer to current buttons
 std::vector<std::unique_ptr<wyrmgus::button>> CurrentButtons;
+/// Cached results of IsButtonAllowed, cleared when the state they depend on changes
+static std::map<std::pair<const CUnit *, const wyrmgus::button *>, bool> ButtonAllowedCache;
+
+/**
+**  Clear the cached results of IsButtonAllowed for a button, e.g. because one of the current buttons was overwritten with another button.
+**
+**  @param button  The button whose results are cleared.
+*/
+static void InvalidateButtonAllowedCache(const wyrmgus::button &button)
+{
+	std::erase_if(ButtonAllowedCache, [&button](const auto &kv_pair) {
+		return kv_pair.first.second == &button;
+	});
+}
+
+/**
+**  Clear the current buttons, and the cached results of IsButtonAllowed for them.
+*/
+static void ClearCurrentButtons()
+{
+	for (const std::unique_ptr<wyrmgus::button> &button : CurrentButtons) {
+		InvalidateButtonAllowedCache(*button);
+	}
+
+	CurrentButtons.clear();
+}
 
 void InitButtons()
 {
@@ -123,7 +149,7 @@ void InitButtons()
 			button->Icon.Load();
 		}
 	}
-	CurrentButtons.clear();
+	ClearCurrentButtons();
 }
 
 /*----------------------------------------------------------------------------
@@ -138,6 +164,8 @@ void CleanButtons()
 	CurrentButtonLevel = nullptr;
 	LastDrawnButtonPopup = nullptr;
 	CurrentButtons.clear();
+	wyrmgus::button::clear_unit_buttons();
+	InvalidateButtonAllowedCache();
 }
 
 /**
@@ -1168,12 +1196,8 @@ void CButtonPanel::Draw()
 **  @todo FIXME: better check. (dependency, resource, ...)
 **  @todo FIXME: make difference with impossible and not yet researched.
 */
-bool IsButtonAllowed(const CUnit &unit, const wyrmgus::button &buttonaction)
+static bool CheckButtonAllowed(const CUnit &unit, const wyrmgus::button &buttonaction)
 {
-	if (buttonaction.is_always_shown()) {
-		return true;
-	}
-	
 	bool res = false;
 	if (buttonaction.Allowed) {
 		res = buttonaction.Allowed(unit, buttonaction);
@@ -1345,6 +1369,42 @@ bool IsButtonAllowed(const CUnit &unit, const wyrmgus::button &buttonaction)
 	return res;
 }
 
+/**
+**  Check if the button is allowed for the unit, reusing the result of a previous check if the state it depends on hasn't changed since.
+**
+**  @param unit          unit which checks for allow.
+**  @param buttonaction  button to check if it is allowed.
+**
+**  @return 1 if button is allowed, 0 else.
+*/
+bool IsButtonAllowed(const CUnit &unit, const wyrmgus::button &buttonaction)
+{
+	if (buttonaction.is_always_shown()) {
+		return true;
+	}
+
+	const std::pair<const CUnit *, const wyrmgus::button *> key(&unit, &buttonaction);
+
+	const auto find_iterator = ButtonAllowedCache.find(key);
+	if (find_iterator != ButtonAllowedCache.end()) {
+		return find_iterator->second;
+	}
+
+	const bool allowed = CheckButtonAllowed(unit, buttonaction);
+	ButtonAllowedCache[key] = allowed;
+	return allowed;
+}
+
+/**
+**  Clear the cached results of IsButtonAllowed.
+**
+**  This is done when orders, upgrades or resources change, or when the selection or the selected units change.
+*/
+void InvalidateButtonAllowedCache()
+{
+	ButtonAllowedCache.clear();
+}
+
 //Wyrmgus start
 /**
 **	Check if the button is usable for the unit.
@@ -1504,40 +1564,46 @@ int GetButtonCooldownPercent(const CUnit &unit, const wyrmgus::button &buttonact
 */
 static void UpdateButtonPanelMultipleUnits(const std::vector<std::unique_ptr<wyrmgus::button>> &buttonActions)
 {
-	char unit_ident[128];
-	//Wyrmgus start
-	char individual_unit_ident[200][128]; // the 200 there is the max selectable quantity; not nice to hardcode it like this, should be changed in the future
-	//Wyrmgus end
-
-	sprintf(unit_ident, ",%s-group,", wyrmgus::civilization::get_all()[CPlayer::GetThisPlayer()->Race]->get_identifier().c_str());
+	const std::string group_ident = wyrmgus::civilization::get_all()[CPlayer::GetThisPlayer()->Race]->get_identifier() + "-group";
 	
 	//Wyrmgus start
+	//get the buttons of the current level for each of the selected unit types, checking each type only once
+	std::vector<const wyrmgus::unit_type *> selected_unit_types;
+	std::vector<const std::vector<const wyrmgus::button *> *> selected_unit_type_buttons;
 	for (size_t i = 0; i != Selected.size(); ++i) {
-		sprintf(individual_unit_ident[i], ",%s,", Selected[i]->Type->Ident.c_str());
+		const wyrmgus::unit_type *unit_type = Selected[i]->Type;
+		if (wyrmgus::vector::contains(selected_unit_types, unit_type)) {
+			continue;
+		}
+
+		selected_unit_types.push_back(unit_type);
+		selected_unit_type_buttons.push_back(&wyrmgus::button::get_unit_buttons(unit_type->Ident, unit_type->get_unit_class(), CurrentButtonLevel));
 	}
 	//Wyrmgus end
 
-	for (const wyrmgus::button *button : wyrmgus::button::get_all()) {
-		if (button->get_level() != CurrentButtonLevel) {
-			continue;
-		}
+	//the buttons of the current level for any unit or for the group
+	const std::vector<const wyrmgus::button *> &group_buttons = wyrmgus::button::get_unit_buttons(group_ident, nullptr, CurrentButtonLevel);
 
-		//Wyrmgus start
-		bool used_by_all = true;
-		for (size_t i = 0; i != Selected.size(); ++i) {
-			if (!strstr(button->UnitMask.c_str(), individual_unit_ident[i]) && !wyrmgus::vector::contains(button->get_unit_classes(), Selected[i]->Type->get_unit_class())) {
-				used_by_all = false;
-				break;
-			}
-		}
-		//Wyrmgus end
-		
-		// any unit or unit in list
-		if (button->UnitMask[0] != '*'
-			&& !strstr(button->UnitMask.c_str(), unit_ident) && !used_by_all) {
-			continue;
-		}
+	//the button lists are in definition order, so the buttons used by all selected unit types can be found by intersecting them, and then merged with the group buttons
+	static constexpr auto button_index_less = [](const wyrmgus::button *lhs, const wyrmgus::button *rhs) {
+		return lhs->get_index() < rhs->get_index();
+	};
+
+	//Wyrmgus start
+	std::vector<const wyrmgus::button *> used_by_all_buttons = *selected_unit_type_buttons.front();
+	std::vector<const wyrmgus::button *> intersection;
+	for (size_t i = 1; i < selected_unit_type_buttons.size() && !used_by_all_buttons.empty(); ++i) {
+		intersection.clear();
+		std::set_intersection(used_by_all_buttons.begin(), used_by_all_buttons.end(), selected_unit_type_buttons[i]->begin(), selected_unit_type_buttons[i]->end(), std::back_inserter(intersection), button_index_less);
+		used_by_all_buttons.swap(intersection);
+	}
+	//Wyrmgus end
+
+	// any unit or unit in list
+	std::vector<const wyrmgus::button *> buttons;
+	std::set_union(used_by_all_buttons.begin(), used_by_all_buttons.end(), group_buttons.begin(), group_buttons.end(), std::back_inserter(buttons), button_index_less);
 
+	for (const wyrmgus::button *button : buttons) {
 		bool allow = true;
 		if (button->is_always_shown() == false) {
 			for (size_t i = 0; i != Selected.size(); ++i) {
@@ -1571,41 +1637,33 @@ static void UpdateButtonPanelMultipleUnits(const std::vector<std::unique_ptr<wyr
 */
 static void UpdateButtonPanelSingleUnit(const CUnit &unit, const std::vector<std::unique_ptr<wyrmgus::button>> &buttonActions)
 {
-	char unit_ident[128];
+	std::string unit_ident;
+	const wyrmgus::unit_class *unit_class = nullptr;
 
 	//
 	//  FIXME: johns: some hacks for cancel buttons
 	//
-	bool only_cancel_allowed = true;
 	if (unit.CurrentAction() == UnitAction::Built) {
 		// Trick 17 to get the cancel-build button
-		strcpy_s(unit_ident, sizeof(unit_ident), ",cancel-build,");
+		unit_ident = "cancel-build";
 	} else if (unit.CurrentAction() == UnitAction::UpgradeTo) {
 		// Trick 17 to get the cancel-upgrade button
-		strcpy_s(unit_ident, sizeof(unit_ident), ",cancel-upgrade,");
+		unit_ident = "cancel-upgrade";
 	} else if (unit.CurrentAction() == UnitAction::Research) {
 		if (CurrentButtonLevel != nullptr) {
 			CurrentButtonLevel = nullptr;
 		}
 		// Trick 17 to get the cancel-upgrade button
-		strcpy_s(unit_ident, sizeof(unit_ident), ",cancel-upgrade,");
+		unit_ident = "cancel-upgrade";
 	} else {
-		sprintf(unit_ident, ",%s,", unit.Type->Ident.c_str());
-		only_cancel_allowed = false;
+		unit_ident = unit.Type->Ident;
+		unit_class = unit.Type->get_unit_class();
 	}
-	for (const wyrmgus::button *button : wyrmgus::button::get_all()) {
-		Assert(0 < button->get_pos() && button->get_pos() <= (int)UI.ButtonPanel.Buttons.size());
 
-		// Same level
-		if (button->get_level() != CurrentButtonLevel) {
-			continue;
-		}
+	//the buttons of the current level for any unit, or with the unit in their list
+	for (const wyrmgus::button *button : wyrmgus::button::get_unit_buttons(unit_ident, unit_class, CurrentButtonLevel)) {
+		Assert(0 < button->get_pos() && button->get_pos() <= (int)UI.ButtonPanel.Buttons.size());
 
-		// any unit or unit in list
-		if (button->UnitMask[0] != '*'
-			&& !strstr(button->UnitMask.c_str(), unit_ident) && (only_cancel_allowed || !wyrmgus::vector::contains(button->get_unit_classes(), unit.Type->get_unit_class()))) {
-			continue;
-		}
 		//Wyrmgus start
 //		int allow = IsButtonAllowed(unit, buttonaction);
 		bool allow = true; // check all selected units, as different units of the same type may have different allowed buttons
@@ -1649,7 +1707,7 @@ void CButtonPanel::Update()
 //	if (Selected.empty()) {
 	if (Selected.empty() || (!GameRunning && !GameEstablishing)) {
 	//Wyrmgus end
-		CurrentButtons.clear();
+		ClearCurrentButtons();
 		return;
 	}
 
@@ -1659,7 +1717,7 @@ void CButtonPanel::Update()
 //	if (unit.Player != CPlayer::GetThisPlayer() && !CPlayer::GetThisPlayer()->IsTeamed(unit)) {
 	if (unit.Player != CPlayer::GetThisPlayer() && !CPlayer::GetThisPlayer()->IsTeamed(unit) && !CPlayer::GetThisPlayer()->has_building_access(&unit)) {
 	//Wyrmgus end
-		CurrentButtons.clear();
+		ClearCurrentButtons();
 		return;
 	}
 	
@@ -1679,6 +1737,8 @@ void CButtonPanel::Update()
 				continue;
 			}
 
+			const int old_value = button->Value;
+
 			if (button->Action == ButtonCmd::Faction) {
 				if (CPlayer::GetThisPlayer()->get_faction() == nullptr || potential_faction_count >= CPlayer::GetThisPlayer()->get_faction()->DevelopsTo.size()) {
 					button->Value = -1;
@@ -1728,6 +1788,11 @@ void CButtonPanel::Update()
 				}
 				sold_unit_count += 1;
 			}
+
+			//whether the button is allowed depends on its value
+			if (button->Value != old_value) {
+				InvalidateButtonAllowedCache(*button);
+			}
 		}
 	}
 	//Wyrmgus end
@@ -1745,8 +1810,10 @@ void CButtonPanel::Update()
 		CurrentButtons.push_back(std::make_unique<wyrmgus::button>());
 	}
 
+	//the current buttons are overwritten with the buttons to show
 	for (const std::unique_ptr<wyrmgus::button> &button : CurrentButtons) {
 		button->pos = -1;
+		InvalidateButtonAllowedCache(*button);
 	}
 
 	// We have selected different units types
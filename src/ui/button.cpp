@@ -43,6 +43,7 @@
 #include "upgrade/upgrade.h"
 #include "upgrade/upgrade_class.h"
 #include "util/string_util.h"
+#include "util/vector_util.h"
 #include "video/font.h"
 #include "video/video.h"
 #include "widgets.h"
@@ -173,6 +174,56 @@ void button::add_button_key_to_name(std::string &name, const std::string &key)
 	}
 }
 
+/**
+**	@brief	Get the buttons available for a unit
+**
+**	The result is cached, so that the command panel doesn't need to check the unit mask of every button each time it is updated.
+**
+**	@param	unit_ident	The identifier to look for in the unit masks of buttons, e.g. the identifier of the unit's type, or "cancel-build".
+**	@param	unit_class	The unit class for which buttons are available, or null if unit classes shouldn't be checked.
+**	@param	level		The button level.
+**
+**	@return	The buttons available for the unit, in the order in which they were defined.
+*/
+const std::vector<const button *> &button::get_unit_buttons(const std::string &unit_ident, const unit_class *unit_class, const button_level *level)
+{
+	static const std::vector<const button *> empty_vector;
+
+	if (button::unit_buttons_button_count != button::get_all().size() || button::unit_buttons.empty()) {
+		button::unit_buttons.clear();
+		button::unit_buttons_button_count = button::get_all().size();
+
+		for (size_t i = 0; i < button::get_all().size(); ++i) {
+			button::get_all()[i]->index = i;
+		}
+	}
+
+	const std::pair<std::string, const wyrmgus::unit_class *> key(unit_ident, unit_class);
+	auto find_iterator = button::unit_buttons.find(key);
+
+	if (find_iterator == button::unit_buttons.end()) {
+		std::map<const button_level *, std::vector<const button *>> level_buttons;
+		const std::string mask_ident = "," + unit_ident + ",";
+
+		for (const button *candidate : button::get_all()) {
+			if (candidate->UnitMask[0] != '*' && candidate->UnitMask.find(mask_ident) == std::string::npos && (unit_class == nullptr || !vector::contains(candidate->get_unit_classes(), unit_class))) {
+				continue;
+			}
+
+			level_buttons[candidate->get_level()].push_back(candidate);
+		}
+
+		find_iterator = button::unit_buttons.emplace(key, std::move(level_buttons)).first;
+	}
+
+	const auto level_find_iterator = find_iterator->second.find(level);
+	if (level_find_iterator == find_iterator->second.end()) {
+		return empty_vector;
+	}
+
+	return level_find_iterator->second;
+}
+
 button::button(const std::string &identifier) : data_entry(identifier), Action(ButtonCmd::Move)
 {
 }
@@ -359,6 +410,8 @@ void button::initialize()
 		this->UnitMask = "," + this->UnitMask + ",";
 	}
 
+	button::clear_unit_buttons();
+
 	data_entry::initialize();
 }
 
@@ -62,6 +62,20 @@ public:
 
 	static void add_button_key_to_name(std::string &value_name, const std::string &button_key);
 
+	static const std::vector<const button *> &get_unit_buttons(const std::string &unit_ident, const unit_class *unit_class, const button_level *level);
+
+	static void clear_unit_buttons()
+	{
+		button::unit_buttons.clear();
+	}
+
+private:
+	//buttons available for a unit identifier and unit class, per button level, in the order in which they were defined
+	static inline std::map<std::pair<std::string, const unit_class *>, std::map<const button_level *, std::vector<const button *>>> unit_buttons;
+	static inline size_t unit_buttons_button_count = 0; //the quantity of buttons when the unit buttons were cached
+
+public:
+
 	button(const std::string &identifier = "");
 
 	button &operator =(const button &other_button)
@@ -102,6 +116,12 @@ public:
 		return this->level;
 	}
 
+	//the button's position in the list of all buttons, set when the unit buttons are cached
+	size_t get_index() const
+	{
+		return this->index;
+	}
+
 	bool is_always_shown() const
 	{
 		return this->always_show;
@@ -138,6 +158,7 @@ public:
 	button_level *level = nullptr;		/// requires button level
 private:
 	bool always_show = false;			/// button is always shown but drawn grayscale if not available
+	size_t index = 0;
 public:
 	ButtonCmd Action;	/// command on button press
 	int Value = 0;					/// extra value for command
@@ -173,6 +194,9 @@ extern void CleanButtons();
 // Check if the button is allowed for the unit.
 extern bool IsButtonAllowed(const CUnit &unit, const wyrmgus::button &buttonaction);
 
+// Clear the cached results of IsButtonAllowed, to be called when the state they depend on changes.
+extern void InvalidateButtonAllowedCache();
+
 // Check if the button is usable for the unit.
 extern bool IsButtonUsable(const CUnit &unit, const wyrmgus::button &buttonaction);
 
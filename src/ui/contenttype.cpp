@@ -87,13 +87,22 @@ void CContentTypeText::Draw(const CUnit &unit, wyrmgus::font *defaultfont) const
 
 	if (this->Text != nullptr) {
 		text = EvalString(this->Text.get());
-		std::string::size_type pos;
-		if ((pos = text.find("~|")) != std::string::npos) {
-			x += (label.Draw(x - font->getWidth(text.substr(0, pos)), y, text) - font->getWidth(text.substr(0, pos)));
+
+		//only lay the text out again if it changed
+		if (text != this->LastText || font != this->LastFont) {
+			label.Layout(text, this->LastLayout);
+			this->LastText = std::move(text);
+			this->LastFont = font;
+		}
+
+		const CTextLayout &layout = this->LastLayout;
+		if (layout.PrefixWidth != -1) {
+			x += (label.DrawLayout(x - layout.PrefixWidth, y, layout) - layout.PrefixWidth);
 		} else if (this->Centered) {
-			x += (label.DrawCentered(x, y, text) * 2);
+			label.DrawLayout(x - layout.Width / 2, y, layout);
+			x += (layout.Width / 2) * 2;
 		} else {
-			x += label.Draw(x, y, text);
+			x += label.DrawLayout(x, y, layout);
 		}
 	}
 
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "vec2i.h"
+#include "video/font.h"
 
 class CUnit;
 class ConditionPanel;
@@ -83,6 +84,10 @@ private:
 	VariableAttribute Component; /// Component of the variable.
 	char ShowName = 0;           /// If true, Show name's unit.
 	char Stat = 0;               /// true to special display.(value or value + diff)
+	//layout of the last drawn text, reused while the text is unchanged
+	mutable std::string LastText;
+	mutable const wyrmgus::font *LastFont = nullptr;
+	mutable CTextLayout LastLayout; /// Layout of LastText, drawn again while the text does not change.
 };
 
 /**
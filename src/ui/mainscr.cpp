@@ -342,12 +342,14 @@ UStrInt GetComponent(const CUnit &unit, const int index, const VariableAttribute
 {
 	UStrInt val;
 	const wyrmgus::unit_variable *var = nullptr;
+	wyrmgus::unit_variable unit_variable; //copy of the unit's variable, as it is stored in the unit manager's variable table
 
 	Assert((unsigned int) index < UnitTypeVar.GetNumberVariable());
 	
 	switch (t) {
 		case 0: // Unit:
-			var = &unit.Variable[index];
+			unit_variable = unit.Variable[index];
+			var = &unit_variable;
 			break;
 		case 1: // Type:
 			var = &unit.Type->MapDefaultStat.Variables[index];
@@ -357,7 +359,8 @@ UStrInt GetComponent(const CUnit &unit, const int index, const VariableAttribute
 			break;
 		default:
 			DebugPrint("Bad value for GetComponent: t = %d" _C_ t);
-			var = &unit.Variable[index];
+			unit_variable = unit.Variable[index];
+			var = &unit_variable;
 			break;
 	}
 
@@ -1046,6 +1046,8 @@ static int CclDefineButton(lua_State *l)
 		lua_pop(l, 1);
 	}
 
+	wyrmgus::button::clear_unit_buttons();
+
 	return 0;
 }
 
@@ -1060,6 +1062,7 @@ void SelectionChanged()
 	CurrentButtonLevel = nullptr;
 	LastDrawnButtonPopup = nullptr;
 
+	InvalidateButtonAllowedCache();
 	UI.ButtonPanel.Update();
 	GameCursor = UI.get_cursor(wyrmgus::cursor_type::point);
 	CursorBuilding = nullptr;
@@ -1072,6 +1075,7 @@ void SelectionChanged()
 */
 void SelectedUnitChanged()
 {
+	InvalidateButtonAllowedCache();
 	UI.ButtonPanel.Update();
 }
 
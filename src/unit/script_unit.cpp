@@ -31,6 +31,7 @@
 
 #include "unit/unit.h"
 
+#include "action/order_pool.h"
 #include "actions.h"
 //Wyrmgus start
 #include "ai/ai_local.h"
@@ -120,6 +121,26 @@ static int CclResourcesMultiBuildersMultiplier(lua_State *l)
 	return 0;
 }
 
+/**
+**  Get the statistics of the unit order pool
+**
+**  @param l  Lua state.
+**
+**  @return   The order allocations, the allocations reusing pooled memory, the live orders and the bytes reserved by the pool
+*/
+static int CclGetOrderPoolStatistics(lua_State *l)
+{
+	LuaCheckArgs(l, 0);
+
+	const wyrmgus::order_pool::statistics statistics = wyrmgus::order_pool::get_total_statistics();
+
+	lua_pushnumber(l, statistics.allocations);
+	lua_pushnumber(l, statistics.reused_allocations);
+	lua_pushnumber(l, statistics.live_blocks);
+	lua_pushnumber(l, wyrmgus::order_pool::get_reserved_bytes());
+	return 4;
+}
+
 /**
 **  Get a unit pointer
 **
@@ -712,7 +733,9 @@ static int CclUnit(lua_State *l)
 			const int index = UnitTypeVar.VariableNameLookup[value];// User variables
 			if (index != -1) { // Valid index
 				lua_rawgeti(l, 2, j + 1);
-				DefineVariableField(l, unit->Variable[index], -1);
+				wyrmgus::unit_variable variable = unit->Variable[index];
+				DefineVariableField(l, variable, -1);
+				unit->Variable[index] = variable;
 				lua_pop(l, 1);
 				continue;
 			}
@@ -2114,6 +2137,7 @@ void UnitCclRegister()
 	lua_register(Lua, "SetBuildingCapture", CclSetBuildingCapture);
 	lua_register(Lua, "SetRevealAttacker", CclSetRevealAttacker);
 	lua_register(Lua, "ResourcesMultiBuildersMultiplier", CclResourcesMultiBuildersMultiplier);
+	lua_register(Lua, "GetOrderPoolStatistics", CclGetOrderPoolStatistics);
 
 	lua_register(Lua, "Unit", CclUnit);
 
@@ -65,6 +65,8 @@
 #include "name_generator.h"
 #include "network.h"
 #include "pathfinder.h"
+#include "pathfinder/flow_field_cache.h"
+#include "pathfinder/hierarchical_pathfinder.h"
 #include "plane.h"
 #include "player.h"
 #include "quest/achievement.h"
@@ -2845,6 +2847,8 @@ void CUnit::Init(const wyrmgus::unit_type &type, const bool loading_saved_unit)
 
 	Assert(Orders.empty());
 
+	//units mostly have one or two orders; the capacity is kept when the orders are cleared and when the unit is reused after being released, so issuing orders does not reallocate the order list
+	Orders.reserve(2);
 	Orders.push_back(COrder::NewActionStill());
 
 	Assert(NewOrder == nullptr);
@@ -3260,6 +3264,67 @@ void MapUnmarkUnitSight(CUnit &unit)
 	}
 }
 
+/**
+**  Update on vision table the Sight of the unit which moved
+**  (and units inside for transporter (recursively))
+**
+**  @param unit     Unit to update.
+**  @param old_pos  coord of the first container of unit before moving.
+**  @param new_pos  coord of the first container of unit after moving.
+**  @param width    Width of the first container of unit.
+**  @param height   Height of the first container of unit.
+*/
+static void MapMoveUnitSightRec(const CUnit &unit, const Vec2i &old_pos, const Vec2i &new_pos, int width, int height)
+{
+	const int range = unit.Container && unit.Container->CurrentSightRange >= unit.CurrentSightRange ? unit.Container->CurrentSightRange : unit.CurrentSightRange;
+
+	MapSightMove(*unit.Player, old_pos, new_pos, width, height, range, MapMarkTileSight, MapUnmarkTileSight, unit.MapLayer->ID);
+
+	if (unit.Type && unit.Type->BoolFlag[DETECTCLOAK_INDEX].value) {
+		MapSightMove(*unit.Player, old_pos, new_pos, width, height, range, MapMarkTileDetectCloak, MapUnmarkTileDetectCloak, unit.MapLayer->ID);
+	}
+
+	if (unit.Variable[ETHEREALVISION_INDEX].Value) {
+		MapSightMove(*unit.Player, old_pos, new_pos, width, height, range, MapMarkTileDetectEthereal, MapUnmarkTileDetectEthereal, unit.MapLayer->ID);
+	}
+
+	CUnit *unit_inside = unit.UnitInside;
+	for (int i = unit.InsideCount; i--; unit_inside = unit_inside->NextContained) {
+		MapMoveUnitSightRec(*unit_inside, old_pos, new_pos, width, height);
+	}
+}
+
+/**
+**  Update on vision table the Sight of a unit which moved from a nearby tile
+**  of the same map layer, with its sight range unchanged
+**  (and units inside for transporter)
+**
+**  Only the tiles which came into or left the sight of the unit are touched.
+**
+**  @param unit     unit to update its vision, already placed at its new position.
+**  @param old_pos  coord of the unit before moving.
+**  @see MapMarkUnitSight.
+*/
+void MapMoveUnitSight(CUnit &unit, const Vec2i &old_pos)
+{
+	Assert(unit.Type);
+	Assert(unit.Container == nullptr);
+
+	const int width = unit.Type->get_tile_width();
+	const int height = unit.Type->get_tile_height();
+
+	MapMoveUnitSightRec(unit, old_pos, unit.tilePos, width, height);
+
+	if (!unit.IsUnusable()) {
+		if (unit.Stats->Variables[RADAR_INDEX].Value) {
+			MapSightMove(*unit.Player, old_pos, unit.tilePos, width, height, unit.Stats->Variables[RADAR_INDEX].Value, MapMarkTileRadar, MapUnmarkTileRadar, unit.MapLayer->ID);
+		}
+		if (unit.Stats->Variables[RADARJAMMER_INDEX].Value) {
+			MapSightMove(*unit.Player, old_pos, unit.tilePos, width, height, unit.Stats->Variables[RADARJAMMER_INDEX].Value, MapMarkTileRadarJammer, MapUnmarkTileRadarJammer, unit.MapLayer->ID);
+		}
+	}
+}
+
 /**
 **  Update the Unit Current sight range to good value and transported units inside.
 **
@@ -3341,6 +3406,11 @@ void MarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += unit.MapLayer->get_width();
 	} while (--h);
+
+	if (flags & MapFieldBuilding) {
+		wyrmgus::hierarchical_pathfinder::get()->on_rect_passability_changed(unit.get_tile_rect(), unit.MapLayer->ID);
+		wyrmgus::flow_field_cache::get()->on_rect_passability_changed(unit.get_tile_rect(), unit.MapLayer->ID);
+	}
 }
 
 class _UnmarkUnitFieldFlags
@@ -3389,6 +3459,11 @@ void UnmarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += unit.MapLayer->get_width();
 	} while (--h);
+
+	if (unit.Type->FieldFlags & MapFieldBuilding) {
+		wyrmgus::hierarchical_pathfinder::get()->on_rect_passability_changed(unit.get_tile_rect(), unit.MapLayer->ID);
+		wyrmgus::flow_field_cache::get()->on_rect_passability_changed(unit.get_tile_rect(), unit.MapLayer->ID);
+	}
 }
 
 /**
@@ -3718,7 +3793,19 @@ static void UnitInXY(CUnit &unit, const Vec2i &pos, const int z)
 void CUnit::MoveToXY(const Vec2i &pos, int z)
 //Wyrmgus end
 {
-	MapUnmarkUnitSight(*this);
+	//a unit moving to an adjacent tile of the same map layer only needs the changes of its sight to be marked, unless the time of day of its new tile changes its sight range
+	const Vec2i old_pos = this->tilePos;
+	bool incremental_sight = false;
+	if (this->Container == nullptr && this->MapLayer != nullptr && this->MapLayer->ID == z && abs(pos.x - old_pos.x) <= 1 && abs(pos.y - old_pos.y) <= 1) {
+		const QPoint old_tile_pos = old_pos;
+		const QPoint new_tile_pos = pos;
+		const QPoint new_center_tile_pos = this->get_center_tile_pos() - old_tile_pos + new_tile_pos;
+		incremental_sight = this->MapLayer->get_tile_time_of_day(new_center_tile_pos) == this->get_center_tile_time_of_day();
+	}
+
+	if (!incremental_sight) {
+		MapUnmarkUnitSight(*this);
+	}
 	CMap::Map.Remove(*this);
 	UnmarkUnitFieldFlags(*this);
 
@@ -3736,7 +3823,11 @@ void CUnit::MoveToXY(const Vec2i &pos, int z)
 	MarkUnitFieldFlags(*this);
 	//  Recalculate the seen count.
 	UnitCountSeen(*this);
-	MapMarkUnitSight(*this);
+	if (incremental_sight) {
+		MapMoveUnitSight(*this, old_pos);
+	} else {
+		MapMarkUnitSight(*this);
+	}
 	
 	//Wyrmgus start
 	// if there is a trap in the new tile, trigger it
@@ -4534,12 +4625,12 @@ void UnitCountSeen(CUnit &unit)
 				int x = width;
 				do {
 					if (unit.Type->BoolFlag[PERMANENTCLOAK_INDEX].value && unit.Player != CPlayer::Players[p]) {
-						if (mf->player_info->VisCloak[p]) {
+						if (mf->player_info->get_vis_cloak(p)) {
 							newv++;
 						}
 					//Wyrmgus start
 					} else if (unit.Type->BoolFlag[ETHEREAL_INDEX].value && unit.Player != CPlayer::Players[p]) {
-						if (mf->player_info->VisEthereal[p]) {
+						if (mf->player_info->get_vis_ethereal(p)) {
 							newv++;
 						}
 					//Wyrmgus end
@@ -5596,12 +5687,26 @@ int CUnit::GetModifiedVariable(const int index, const VariableAttribute variable
 	}
 	
 	switch (index) {
-		case ATTACKRANGE_INDEX:
+		case ATTACKRANGE_INDEX: {
+			int container_bonus = 0;
 			if (this->Container != nullptr && this->Container->Variable[GARRISONEDRANGEBONUS_INDEX].Enable && this->Type->BoolFlag[ATTACKFROMTRANSPORTER_INDEX].value) {
-				value += this->Container->Variable[GARRISONEDRANGEBONUS_INDEX].Value; //treat the container's attack range as a bonus to the unit's attack range
+				container_bonus = this->Container->Variable[GARRISONEDRANGEBONUS_INDEX].Value; //treat the container's attack range as a bonus to the unit's attack range
+			}
+
+			//the modified attack range is cached, and only recalculated if the unit's container, its range, the container's upgrade-given bonus or its sight range changed
+			wyrmgus::modified_variable_cache &cache = this->Variable.get_modified_variable_cache();
+			if (!cache.attack_range_valid || cache.attack_range_container != this->Container || cache.attack_range_base != value || cache.attack_range_container_bonus != container_bonus || cache.attack_range_sight_range != this->CurrentSightRange) {
+				cache.attack_range_valid = true;
+				cache.attack_range_container = this->Container;
+				cache.attack_range_base = value;
+				cache.attack_range_container_bonus = container_bonus;
+				cache.attack_range_sight_range = this->CurrentSightRange;
+				cache.attack_range = std::min<int>(this->CurrentSightRange, value + container_bonus); // if the unit's current sight range is smaller than its attack range, use it instead
 			}
-			value = std::min<int>(this->CurrentSightRange, value); // if the unit's current sight range is smaller than its attack range, use it instead
+
+			value = cache.attack_range;
 			break;
+		}
 		case SPEED_INDEX: {
 			const wyrmgus::unit_type *unit_type = this->Type;
 
@@ -5617,18 +5722,30 @@ int CUnit::GetModifiedVariable(const int index, const VariableAttribute variable
 
 			const UnitTypeType unit_type_type = unit_type->UnitType;
 			if (unit_type_type != UnitTypeType::Fly && unit_type_type != UnitTypeType::FlyLow && unit_type_type != UnitTypeType::Space) {
-				int movement_cost = 0;
+				//the terrain modifier is cached, and only recalculated if the unit's position, its type or the movement cost of tiles changed
+				wyrmgus::modified_variable_cache &cache = this->Variable.get_modified_variable_cache();
+				const unsigned int movement_cost_generation = wyrmgus::tile::get_movement_cost_generation();
 
-				for (int x = 0; x < unit_type->get_tile_width(); ++x) {
-					for (int y = 0; y < unit_type->get_tile_height(); ++y) {
-						movement_cost += map_layer->Field(this->tilePos + Vec2i(x, y))->get_movement_cost();
+				if (cache.speed_map_layer != map_layer || cache.speed_tile_pos != this->tilePos || cache.speed_type != unit_type || cache.movement_cost_generation != movement_cost_generation) {
+					int movement_cost = 0;
+
+					for (int x = 0; x < unit_type->get_tile_width(); ++x) {
+						for (int y = 0; y < unit_type->get_tile_height(); ++y) {
+							movement_cost += map_layer->Field(this->tilePos + Vec2i(x, y))->get_movement_cost();
+						}
 					}
-				}
 
-				const int tile_count = unit_type->get_tile_width() * unit_type->get_tile_height();
-				movement_cost /= tile_count;
+					const int tile_count = unit_type->get_tile_width() * unit_type->get_tile_height();
+					movement_cost /= tile_count;
+
+					cache.speed_map_layer = map_layer;
+					cache.speed_tile_pos = this->tilePos;
+					cache.speed_type = unit_type;
+					cache.movement_cost_generation = movement_cost_generation;
+					cache.speed_modifier = DefaultTileMovementCost - movement_cost;
+				}
 
-				value += DefaultTileMovementCost - movement_cost;
+				value += cache.speed_modifier;
 			}
 			break;
 		}
@@ -31,7 +31,7 @@
 #include "player.h"
 #include "player_container.h"
 #include "unit/unit_type.h"
-#include "unit/unit_variable.h"
+#include "unit/unit_variable_table.h"
 #include "vec2i.h"
 
 class CAnimation;
@@ -464,12 +464,12 @@ public:
 
 	int get_variable_value(const int var_index) const
 	{
-		return this->Variable.at(var_index).Value;
+		return this->Variable[var_index].Value;
 	}
 
 	void set_variable_value(const int var_index, const int value)
 	{
-		this->Variable.at(var_index).Value = value;
+		this->Variable[var_index].Value = value;
 	}
 
 	void change_variable_value(const int var_index, const int change)
@@ -479,17 +479,17 @@ public:
 
 	int get_variable_max(const int var_index) const
 	{
-		return this->Variable.at(var_index).Max;
+		return this->Variable[var_index].Max;
 	}
 
 	void set_variable_max(const int var_index, const int max)
 	{
-		this->Variable.at(var_index).Max = max;
+		this->Variable[var_index].Max = max;
 	}
 
 	char get_variable_increase(const int var_index) const
 	{
-		return this->Variable.at(var_index).Increase;
+		return this->Variable[var_index].Increase;
 	}
 
 	int GetModifiedVariable(const int index, const VariableAttribute variable_type) const;
@@ -742,7 +742,7 @@ public:
 		wyrmgus::player_index_set by_player;   /// Track unit seen by player
 	} Seen;
 
-	std::vector<wyrmgus::unit_variable> Variable; /// array of User Defined variables.
+	wyrmgus::unit_variable_array Variable; /// array of User Defined variables, stored in the unit manager's variable table
 
 	unsigned long TTL;  /// time to live
 
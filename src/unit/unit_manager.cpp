@@ -56,6 +56,7 @@ void unit_manager::init()
 	this->units.clear();
 	this->released_units.clear();
 	this->unit_slots.clear();
+	this->variable_table.clear();
 }
 
 void unit_manager::clean_units()
@@ -125,14 +126,23 @@ CUnit *unit_manager::AllocUnit()
 		unit->UnitManagerData.unitSlot = -1;
 		return unit;
 	} else {
-		auto unit = std::make_unique<CUnit>();
+		return this->create_unit_slot();
+	}
+}
+
+CUnit *unit_manager::create_unit_slot()
+{
+	auto unit = std::make_unique<CUnit>();
 
-		unit->UnitManagerData.slot = this->unit_slots.size();
-		CUnit *unit_ptr = unit.get();
-		this->unit_slots.push_back(std::move(unit));
+	const size_t slot = this->unit_slots.size();
+	unit->UnitManagerData.slot = static_cast<int>(slot);
+	this->variable_table.add_slot(UnitTypeVar.GetNumberVariable());
+	unit->Variable.bind(&this->variable_table, slot);
 
-		return unit_ptr;
-	}
+	CUnit *unit_ptr = unit.get();
+	this->unit_slots.push_back(std::move(unit));
+
+	return unit_ptr;
 }
 
 /**
@@ -243,9 +253,7 @@ void unit_manager::Load(lua_State *l)
 		LuaError(l, "incorrect argument");
 	}
 	for (unsigned int i = 0; i < unitCount; i++) {
-		auto unit = std::make_unique<CUnit>();
-		unit->UnitManagerData.slot = i;
-		this->unit_slots.push_back(std::move(unit));
+		this->create_unit_slot();
 	}
 
 	const unsigned int args = lua_rawlen(l, 2);
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include "unit/unit_variable_table.h"
 #include "util/singleton.h"
 
 class CUnit;
@@ -69,10 +70,21 @@ public:
 	void add_unit_seen_under_fog(CUnit *unit);
 	void remove_unit_seen_under_fog(CUnit *unit);
 
+	unit_variable_table &get_variable_table()
+	{
+		return this->variable_table;
+	}
+
+private:
+	CUnit *create_unit_slot();
+
 private:
 	//units currently in use
 	std::vector<CUnit *> units;
 
+	//the variables of all unit slots, in structure-of-arrays form; declared before the slots so that it outlives them
+	unit_variable_table variable_table;
+
 	//all units, including released ones; the unit's index here is its slot
 	std::vector<std::unique_ptr<CUnit>> unit_slots;
 
@@ -62,10 +62,10 @@ std::string UnitReference(const CUnit *unit)
 
 void PathFinderInput::Save(CFile &file) const
 {
-	file.printf("\"pathfinder-input\", {");
+	file.write_string("\"pathfinder-input\", {");
 
 	if (this->isRecalculatePathNeeded) {
-		file.printf("\"invalid\"");
+		file.write_string("\"invalid\"");
 	} else {
 		file.printf("\"unit-size\", {%d, %d}, ", this->unitSize.x, this->unitSize.y);
 		file.printf("\"goalpos\", {%d, %d}, ", this->goalPos.x, this->goalPos.y);
@@ -73,26 +73,26 @@ void PathFinderInput::Save(CFile &file) const
 		file.printf("\"minrange\", %d, ", this->minRange);
 		file.printf("\"maxrange\", %d", this->maxRange);
 	}
-	file.printf("},\n  ");
+	file.write_string("},\n  ");
 }
 
 void PathFinderOutput::Save(CFile &file) const
 {
-	file.printf("\"pathfinder-output\", {");
+	file.write_string("\"pathfinder-output\", {");
 
 	if (this->Fast) {
-		file.printf("\"fast\", ");
+		file.write_string("\"fast\", ");
 	}
 	if (this->Length > 0) {
-		file.printf("\"path\", {");
+		file.write_string("\"path\", {");
 		for (int i = 0; i < this->Length; ++i) {
 			file.printf("%d, ", this->Path[i]);
 		}
-		file.printf("},");
+		file.write_string("},");
 	}
 	file.printf("\"cycles\", %d", this->Cycles);
 
-	file.printf("},\n  ");
+	file.write_string("},\n  ");
 }
 
 
@@ -142,7 +142,7 @@ void SaveUnit(const CUnit &unit, CFile &file)
 	if (unit.Seen.Frame != UnitNotSeen) {
 		file.printf("\"seen\", %d, ", unit.Seen.Frame);
 	} else {
-		file.printf("\"not-seen\", ");
+		file.write_string("\"not-seen\", ");
 	}
 	file.printf("\"direction\", %d,\n  ", unit.Direction);
 	file.printf("\"damage-type\", %d,", unit.DamagedType);
@@ -183,16 +183,16 @@ void SaveUnit(const CUnit &unit, CFile &file)
 		file.printf("\"unique\", \"%s\", ", unit.get_unique()->get_identifier().c_str());
 	}
 	if (unit.Bound) {
-		file.printf("\"bound\", true, ");
+		file.write_string("\"bound\", true, ");
 	}
 	if (!unit.Identified) {
-		file.printf("\"identified\", false, ");
+		file.write_string("\"identified\", false, ");
 	}
 	if (unit.Type->BoolFlag[ITEM_INDEX].value && unit.Container != nullptr && unit.Container->IsItemEquipped(&unit)) {
-		file.printf("\"equipped\", true, ");
+		file.write_string("\"equipped\", true, ");
 	}
 	if (unit.Container != nullptr && std::find(unit.Container->SoldUnits.begin(), unit.Container->SoldUnits.end(), &unit) != unit.Container->SoldUnits.end()) {
-		file.printf("\"sold-unit\", true, ");
+		file.write_string("\"sold-unit\", true, ");
 	}
 	if (unit.ConnectingDestination != nullptr) {
 		file.printf("\"connecting-destination\", %d, ", UnitNumber(*unit.ConnectingDestination));
@@ -200,25 +200,25 @@ void SaveUnit(const CUnit &unit, CFile &file)
 	//Wyrmgus end
 	file.printf(" \"current-sight-range\", %d,", unit.CurrentSightRange);
 	if (unit.Burning) {
-		file.printf(" \"burning\",");
+		file.write_string(" \"burning\",");
 	}
 	if (unit.Destroyed) {
-		file.printf(" \"destroyed\",");
+		file.write_string(" \"destroyed\",");
 	}
 	if (unit.Removed) {
-		file.printf(" \"removed\",");
+		file.write_string(" \"removed\",");
 	}
 	if (unit.Selected) {
-		file.printf(" \"selected\",");
+		file.write_string(" \"selected\",");
 	}
 	if (unit.Summoned) {
-		file.printf(" \"summoned\",");
+		file.write_string(" \"summoned\",");
 	}
 	if (unit.Waiting) {
-		file.printf(" \"waiting\",");
+		file.write_string(" \"waiting\",");
 	}
 	if (unit.MineLow) {
-		file.printf(" \"mine-low\",");
+		file.write_string(" \"mine-low\",");
 	}
 	if (unit.RescuedFrom) {
 		file.printf(" \"rescued-from\", %d,", unit.RescuedFrom->Index);
@@ -246,25 +246,25 @@ void SaveUnit(const CUnit &unit, CFile &file)
 					unit.Container->Type->get_tile_width(),
 					unit.Container->Type->get_tile_height());
 	}
-	file.printf(" \"seen-by-player\", \"");
+	file.write_string(" \"seen-by-player\", \"");
 	for (int i = 0; i < PlayerMax; ++i) {
-		file.printf("%c", unit.is_seen_by_player(i) ? 'X' : '_');
+		file.write_string(unit.is_seen_by_player(i) ? "X" : "_");
 	}
-	file.printf("\",\n ");
-	file.printf(" \"seen-destroyed\", \"");
+	file.write_string("\",\n ");
+	file.write_string(" \"seen-destroyed\", \"");
 	for (int i = 0; i < PlayerMax; ++i) {
-		file.printf("%c", unit.is_seen_destroyed_by_player(i) ? 'X' : '_');
+		file.write_string(unit.is_seen_destroyed_by_player(i) ? "X" : "_");
 	}
-	file.printf("\",\n ");
+	file.write_string("\",\n ");
 	if (unit.UnderConstruction) {
-		file.printf(" \"under-construction\",");
+		file.write_string(" \"under-construction\",");
 	}
 	if (unit.Seen.UnderConstruction) {
-		file.printf(" \"seen-under-construction\",");
+		file.write_string(" \"seen-under-construction\",");
 	}
 	file.printf(" \"seen-state\", %d, ", unit.Seen.State);
 	if (unit.Active) {
-		file.printf(" \"active\",");
+		file.write_string(" \"active\",");
 	}
 	file.printf("\"ttl\", %lu,\n  ", unit.TTL);
 	file.printf("\"threshold\", %d,\n  ", unit.Threshold);
@@ -303,21 +303,21 @@ void SaveUnit(const CUnit &unit, CFile &file)
 	wyrmgus::animation_set::SaveUnitAnim(file, unit);
 	file.printf(",\n  \"blink\", %d,", unit.Blink);
 	if (unit.Moving) {
-		file.printf(" \"moving\",");
+		file.write_string(" \"moving\",");
 	}
 	if (unit.ReCast) {
-		file.printf(" \"re-cast\",");
+		file.write_string(" \"re-cast\",");
 	}
 	if (unit.Boarded) {
-		file.printf(" \"boarded\",");
+		file.write_string(" \"boarded\",");
 	}
 	if (unit.AutoRepair) {
-		file.printf(" \"auto-repair\",");
+		file.write_string(" \"auto-repair\",");
 	}
 
 	if (!unit.Resource.Workers.empty()) {
 		file.printf(" \"resource-active\", %d,", unit.Resource.Active);
-		file.printf("\n  \"resource-workers\", {");
+		file.write_string("\n  \"resource-workers\", {");
 		for (size_t i = 0; i < unit.Resource.Workers.size(); ++i) {
 			const std::shared_ptr<wyrmgus::unit_ref> &worker_ref = unit.Resource.Workers[i];
 			const CUnit *worker = worker_ref->get();
@@ -329,11 +329,11 @@ void SaveUnit(const CUnit &unit, CFile &file)
 			}
 
 			if (i > 0) {
-				file.printf(", ");
+				file.write_string(", ");
 			}
 			file.printf("\"%s\"", UnitReference(worker).c_str());
 		}
-		file.printf("},\n  ");
+		file.write_string("},\n  ");
 	} else {
 		Assert(unit.Resource.Active == 0);
 	}
@@ -343,34 +343,34 @@ void SaveUnit(const CUnit &unit, CFile &file)
 //	if (unit.UnitInside) {
 	if (unit.UnitInside && !(unit.get_character() != nullptr && unit.HasInventory())) { // don't save items for persistent heroes
 	//Wyrmgus end
-		file.printf("\n  \"units-contained\", {");
+		file.write_string("\n  \"units-contained\", {");
 		CUnit *uins = unit.UnitInside->PrevContained;
 		for (int i = unit.InsideCount; i; --i, uins = uins->PrevContained) {
 			file.printf("\"%s\"", UnitReference(uins).c_str());
 			if (i > 1) {
-				file.printf(", ");
+				file.write_string(", ");
 			}
 		}
-		file.printf("},\n  ");
+		file.write_string("},\n  ");
 	}
-	file.printf("\"orders\", {\n");
+	file.write_string("\"orders\", {\n");
 	Assert(unit.Orders.empty() == false);
 	unit.Orders[0]->Save(file, unit);
 	for (size_t i = 1; i != unit.Orders.size(); ++i) {
-		file.printf(",\n ");
+		file.write_string(",\n ");
 		unit.Orders[i]->Save(file, unit);
 	}
-	file.printf("}");
+	file.write_string("}");
 	if (unit.SavedOrder) {
-		file.printf(",\n  \"saved-order\", ");
+		file.write_string(",\n  \"saved-order\", ");
 		unit.SavedOrder->Save(file, unit);
 	}
 	if (unit.CriticalOrder != nullptr) {
-		file.printf(",\n  \"critical-order\", ");
+		file.write_string(",\n  \"critical-order\", ");
 		unit.CriticalOrder->Save(file, unit);
 	}
 	if (unit.NewOrder) {
-		file.printf(",\n  \"new-order\", ");
+		file.write_string(",\n  \"new-order\", ");
 		unit.NewOrder->Save(file, unit);
 	}
 
@@ -381,14 +381,14 @@ void SaveUnit(const CUnit &unit, CFile &file)
 		file.printf(",\n  \"auto-cast\", \"%s\"", spell->get_identifier().c_str());
 	}
 	if (unit.SpellCoolDownTimers != nullptr) {
-		file.printf(",\n  \"spell-cooldown\", {");
+		file.write_string(",\n  \"spell-cooldown\", {");
 		for (size_t i = 0; i < wyrmgus::spell::get_all().size(); ++i) {
 			if (i) {
-				file.printf(" ,");
+				file.write_string(" ,");
 			}
 			file.printf("%d", unit.SpellCoolDownTimers[i]);
 		}
-		file.printf("}");
+		file.write_string("}");
 	}
 	//Wyrmgus start
 	file.printf(",\n  \"variation\", %d", unit.Variation);
@@ -431,5 +431,5 @@ void SaveUnit(const CUnit &unit, CFile &file)
 	}
 	//Wyrmgus end
 
-	file.printf("})\n");
+	file.write_string("})\n");
 }
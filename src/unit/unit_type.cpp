@@ -1669,6 +1669,8 @@ void unit_type::RemoveButtons(const ButtonCmd button_action, const std::string &
 			button::get_all()[i]->UnitMask = FindAndReplaceString(button::get_all()[i]->UnitMask, this->Ident + ",", "");
 		}
 	}
+
+	button::clear_unit_buttons();
 }
 
 int unit_type::GetAvailableLevelUpUpgrades() const
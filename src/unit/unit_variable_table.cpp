@@ -0,0 +1,154 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#include "stratagus.h"
+
+#include "unit/unit_variable_table.h"
+
+#include "util/util.h"
+
+namespace wyrmgus {
+
+/**
+**	@brief	Copy the first slots of each variable of a column to a column with a different slot capacity
+*/
+template <typename T>
+static void relayout_column(std::vector<T> &column, const size_t variable_count, const size_t slot_count, const size_t old_capacity, const size_t new_capacity)
+{
+	std::vector<T> new_column(variable_count * new_capacity, 0);
+
+	for (size_t i = 0; i < variable_count; ++i) {
+		std::copy_n(column.begin() + i * old_capacity, slot_count, new_column.begin() + i * new_capacity);
+	}
+
+	column = std::move(new_column);
+}
+
+void unit_variable_table::add_slot(const size_t variable_count)
+{
+	if (this->modified_variable_caches.empty()) {
+		this->variable_count = variable_count;
+	} else if (variable_count != this->variable_count) {
+		throw std::runtime_error("Tried to add a unit variable table slot with " + std::to_string(variable_count) + " variables, but the table's slots have " + std::to_string(this->variable_count) + " variables.");
+	}
+
+	if (this->get_slot_count() == this->capacity) {
+		this->set_capacity(std::max(this->capacity * 2, unit_variable_table::initial_capacity));
+	}
+
+	this->modified_variable_caches.emplace_back();
+}
+
+void unit_variable_table::set_capacity(const size_t capacity)
+{
+	const size_t slot_count = this->get_slot_count();
+
+	relayout_column(this->values, this->variable_count, slot_count, this->capacity, capacity);
+	relayout_column(this->maxes, this->variable_count, slot_count, this->capacity, capacity);
+	relayout_column(this->increases, this->variable_count, slot_count, this->capacity, capacity);
+	relayout_column(this->enables, this->variable_count, slot_count, this->capacity, capacity);
+
+	this->capacity = capacity;
+}
+
+void unit_variable_table::clear()
+{
+	this->variable_count = 0;
+	this->capacity = 0;
+	this->values.clear();
+	this->maxes.clear();
+	this->increases.clear();
+	this->enables.clear();
+	this->modified_variable_caches.clear();
+}
+
+void unit_variable_table::set_variables(const size_t slot, const std::vector<unit_variable> &variables)
+{
+	if (variables.size() != this->variable_count) {
+		throw std::runtime_error("Tried to set " + std::to_string(variables.size()) + " unit variables for a unit variable table slot with " + std::to_string(this->variable_count) + " variables.");
+	}
+
+	for (size_t i = 0; i < variables.size(); ++i) {
+		const unit_variable &variable = variables[i];
+		const size_t offset = this->get_offset(slot, i);
+		this->values[offset] = variable.Value;
+		this->maxes[offset] = variable.Max;
+		this->increases[offset] = variable.Increase;
+		this->enables[offset] = variable.Enable;
+	}
+}
+
+/**
+**	@brief	Decrease timer variables of the given slots by one, clamping them to their maximum
+**
+**	This is equivalent to setting the variables' increase to -1 and applying it, for variables without side effects when they change.
+*/
+void unit_variable_table::decrease_timers(const std::vector<size_t> &slots, const int *variable_indexes, const size_t variable_index_count)
+{
+	for (size_t i = 0; i < variable_index_count; ++i) {
+		const size_t column_offset = this->get_offset(0, variable_indexes[i]);
+		int *values = this->values.data() + column_offset;
+		const int *maxes = this->maxes.data() + column_offset;
+		char *increases = this->increases.data() + column_offset;
+
+		for (const size_t slot : slots) {
+			increases[slot] = -1;
+
+			int &value = values[slot];
+			--value;
+			clamp(&value, 0, maxes[slot]);
+		}
+	}
+}
+
+/**
+**	@brief	Apply the increase of the given variables for the given slots, clamping them to their maximum
+**
+**	The variables must not have side effects when they change; variables with no increase or which are disabled are left unchanged.
+*/
+void unit_variable_table::apply_increases(const std::vector<size_t> &slots, const std::vector<int> &variable_indexes)
+{
+	for (const int variable_index : variable_indexes) {
+		const size_t column_offset = this->get_offset(0, variable_index);
+		int *values = this->values.data() + column_offset;
+		const int *maxes = this->maxes.data() + column_offset;
+		const char *increases = this->increases.data() + column_offset;
+		const char *enables = this->enables.data() + column_offset;
+
+		for (const size_t slot : slots) {
+			if (!increases[slot] || !enables[slot]) {
+				continue;
+			}
+
+			int &value = values[slot];
+			value += increases[slot];
+			clamp(&value, 0, maxes[slot]);
+		}
+	}
+}
+
+}
@@ -0,0 +1,268 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+#pragma once
+
+#include "unit/unit_variable.h"
+#include "vec2i.h"
+
+class CMapLayer;
+class CUnit;
+
+namespace wyrmgus {
+
+class unit_type;
+
+/**
+**	@brief	Reference to a unit variable stored in the unit variable table
+**
+**	It exposes the same fields as unit_variable, so that unit.Variable[index].Value and the like keep working.
+*/
+class unit_variable_ref final
+{
+public:
+	explicit unit_variable_ref(int &value, int &max, char &increase, char &enable)
+		: Value(value), Max(max), Increase(increase), Enable(enable)
+	{
+	}
+
+	unit_variable_ref(const unit_variable_ref &other) = default;
+
+	unit_variable_ref &operator =(const unit_variable &variable)
+	{
+		this->Value = variable.Value;
+		this->Max = variable.Max;
+		this->Increase = variable.Increase;
+		this->Enable = variable.Enable;
+		return *this;
+	}
+
+	unit_variable_ref &operator =(const unit_variable_ref &other)
+	{
+		return *this = static_cast<unit_variable>(other);
+	}
+
+	operator unit_variable() const
+	{
+		unit_variable variable;
+		variable.Value = this->Value;
+		variable.Max = this->Max;
+		variable.Increase = this->Increase;
+		variable.Enable = this->Enable;
+		return variable;
+	}
+
+	bool operator ==(const unit_variable &rhs) const
+	{
+		return this->Max == rhs.Max
+			   && this->Value == rhs.Value
+			   && this->Increase == rhs.Increase
+			   && this->Enable == rhs.Enable;
+	}
+	bool operator !=(const unit_variable &rhs) const { return !(*this == rhs); }
+
+public:
+	int &Value;
+	int &Max;
+	char &Increase;
+	char &Enable;
+};
+
+class unit_variable_const_ref final
+{
+public:
+	explicit unit_variable_const_ref(const int &value, const int &max, const char &increase, const char &enable)
+		: Value(value), Max(max), Increase(increase), Enable(enable)
+	{
+	}
+
+	operator unit_variable() const
+	{
+		unit_variable variable;
+		variable.Value = this->Value;
+		variable.Max = this->Max;
+		variable.Increase = this->Increase;
+		variable.Enable = this->Enable;
+		return variable;
+	}
+
+	bool operator ==(const unit_variable &rhs) const
+	{
+		return this->Max == rhs.Max
+			   && this->Value == rhs.Value
+			   && this->Increase == rhs.Increase
+			   && this->Enable == rhs.Enable;
+	}
+	bool operator !=(const unit_variable &rhs) const { return !(*this == rhs); }
+
+public:
+	const int &Value;
+	const int &Max;
+	const char &Increase;
+	const char &Enable;
+};
+
+/**
+**	@brief	Cached modifiers of a unit's variables
+**
+**	The speed modifier only depends on the tiles under the unit, so it is valid for as long as the unit stays in the same position, with the same type, and no tile's movement cost has changed.
+**	The attack range depends on the unit's container, whose garrisoned range bonus comes from its upgrades, so it is valid for as long as the unit stays in the same container, and neither its own range, the container's bonus nor its sight range has changed.
+*/
+class modified_variable_cache final
+{
+public:
+	const CMapLayer *speed_map_layer = nullptr;
+	Vec2i speed_tile_pos = Vec2i(-1, -1);
+	const unit_type *speed_type = nullptr;
+	unsigned int movement_cost_generation = 0;
+	int speed_modifier = 0;
+
+	bool attack_range_valid = false;
+	const CUnit *attack_range_container = nullptr;
+	int attack_range_base = 0;
+	int attack_range_container_bonus = 0;
+	int attack_range_sight_range = 0;
+	int attack_range = 0;
+};
+
+/**
+**	@brief	Structure-of-arrays storage for the variables of all unit slots
+**
+**	Each variable field is kept in its own column-major array: the values of a variable for all unit slots are contiguous, so that ticking a variable for all units is a loop over one column.
+**	The columns are laid out again when the slot capacity grows. Released units keep their slots, so that reusing a unit slot does not allocate.
+*/
+class unit_variable_table final
+{
+public:
+	size_t get_variable_count() const
+	{
+		return this->variable_count;
+	}
+
+	size_t get_slot_count() const
+	{
+		return this->modified_variable_caches.size();
+	}
+
+	void add_slot(const size_t variable_count);
+
+	void clear();
+
+	unit_variable_ref get_variable(const size_t slot, const size_t index)
+	{
+		const size_t offset = this->get_offset(slot, index);
+		return unit_variable_ref(this->values[offset], this->maxes[offset], this->increases[offset], this->enables[offset]);
+	}
+
+	unit_variable_const_ref get_variable(const size_t slot, const size_t index) const
+	{
+		const size_t offset = this->get_offset(slot, index);
+		return unit_variable_const_ref(this->values[offset], this->maxes[offset], this->increases[offset], this->enables[offset]);
+	}
+
+	void set_variables(const size_t slot, const std::vector<unit_variable> &variables);
+
+	void decrease_timers(const std::vector<size_t> &slots, const int *variable_indexes, const size_t variable_index_count);
+	void apply_increases(const std::vector<size_t> &slots, const std::vector<int> &variable_indexes);
+
+	modified_variable_cache &get_modified_variable_cache(const size_t slot)
+	{
+		return this->modified_variable_caches[slot];
+	}
+
+private:
+	size_t get_offset(const size_t slot, const size_t index) const
+	{
+		return index * this->capacity + slot;
+	}
+
+	void set_capacity(const size_t capacity);
+
+private:
+	static constexpr size_t initial_capacity = 64;
+
+	size_t variable_count = 0;
+	size_t capacity = 0;
+	std::vector<int> values;
+	std::vector<int> maxes;
+	std::vector<char> increases;
+	std::vector<char> enables;
+	std::vector<modified_variable_cache> modified_variable_caches;
+};
+
+/**
+**	@brief	A unit's view of its slot in the unit variable table
+*/
+class unit_variable_array final
+{
+public:
+	void bind(unit_variable_table *table, const size_t slot)
+	{
+		this->table = table;
+		this->slot = slot;
+	}
+
+	bool empty() const
+	{
+		return !this->defined;
+	}
+
+	void clear()
+	{
+		this->defined = false;
+	}
+
+	unit_variable_ref operator [](const size_t index)
+	{
+		return this->table->get_variable(this->slot, index);
+	}
+
+	unit_variable_const_ref operator [](const size_t index) const
+	{
+		return static_cast<const unit_variable_table *>(this->table)->get_variable(this->slot, index);
+	}
+
+	unit_variable_array &operator =(const std::vector<unit_variable> &variables)
+	{
+		this->table->set_variables(this->slot, variables);
+		this->defined = true;
+		return *this;
+	}
+
+	//the cache is not part of the unit's logical state, so it can be updated from const functions
+	modified_variable_cache &get_modified_variable_cache() const
+	{
+		return this->table->get_modified_variable_cache(this->slot);
+	}
+
+private:
+	unit_variable_table *table = nullptr;
+	size_t slot = 0;
+	bool defined = false;
+};
+
+}
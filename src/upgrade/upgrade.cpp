@@ -65,6 +65,7 @@
 #include "religion/deity.h"
 #include "script.h"
 #include "script/condition/and_condition.h"
+#include "script/trigger.h"
 //Wyrmgus start
 #include "settings.h"
 #include "translate.h"
@@ -72,6 +73,7 @@
 #include "unit/unit.h"
 #include "unit/unit_find.h"
 //Wyrmgus start
+#include "ui/button.h"
 #include "ui/interface.h"
 #include "ui/ui.h"
 //Wyrmgus end
@@ -87,6 +89,9 @@
 #include "util/util.h"
 #include "util/vector_util.h"
 
+#include <array>
+#include <chrono>
+
 //Wyrmgus start
 //static void AllowUnitId(CPlayer &player, int id, int units);
 //Wyrmgus end
@@ -329,6 +334,10 @@ void CUpgrade::initialize()
 		}
 	}
 
+	for (const std::unique_ptr<const wyrmgus::upgrade_modifier> &modifier : this->get_modifiers()) {
+		modifier->build_indexes();
+	}
+
 	CclCommand("if not (GetArrayIncludes(Units, \"" + this->get_identifier() + "\")) then table.insert(Units, \"" + this->get_identifier() + "\") end"); //FIXME: needed at present to make upgrade data files work without scripting being necessary, but it isn't optimal to interact with a scripting table like "Units" in this manner (that table should probably be replaced with getting a list of unit types from the engine)
 
 	data_entry::initialize();
@@ -1136,6 +1145,20 @@ static int CclGetUpgradeData(lua_State *l)
 }
 //Wyrmgus end
 
+/**
+**  Benchmark applying and removing upgrade modifiers.
+**
+**  @param l  Lua state.
+*/
+static int CclUpgradeModifierBenchmark(lua_State *l)
+{
+	LuaCheckArgs(l, 0);
+
+	BenchmarkUpgradeModifiers();
+
+	return 0;
+}
+
 /**
 **  Register CCL features for upgrades.
 */
@@ -1156,6 +1179,7 @@ void UpgradesCclRegister()
 	lua_register(Lua, "GetRunicSuffixes", CclGetRunicSuffixes);
 	lua_register(Lua, "GetLiteraryWorks", CclGetLiteraryWorks);
 	lua_register(Lua, "GetUpgradeData", CclGetUpgradeData);
+	lua_register(Lua, "UpgradeModifierBenchmark", CclUpgradeModifierBenchmark);
 	//Wyrmgus end
 }
 
@@ -1308,6 +1332,70 @@ static void ConvertUnitTypeTo(CPlayer &player, const wyrmgus::unit_type &src, wy
 	}
 }
 
+/**
+**  Find the units of a player which are of a given type, giving the same result as filtering FindUnitsByType by the player, but without going through all units in the game.
+**
+**  @param player     Player whose units are to be found.
+**  @param type       Type of the units to be found.
+**  @param units      Vector in which the found units are placed.
+**  @param everybody  Whether units under construction should be included as well.
+*/
+static void FindPlayerUnitsOfType(const CPlayer &player, const wyrmgus::unit_type &type, std::vector<CUnit *> &units, const bool everybody = false)
+{
+	if (type.BoolFlag[VANISHES_INDEX].value) {
+		//units of vanishing types aren't in the player's type unit lists
+		std::vector<CUnit *> type_units;
+		FindUnitsByType(type, type_units, everybody);
+		for (CUnit *unit : type_units) {
+			if (unit->Player == &player) {
+				units.push_back(unit);
+			}
+		}
+		return;
+	}
+
+	for (CUnit *unit : player.get_type_units(&type)) {
+		if (!unit->IsUnusable(everybody) || (everybody && unit->IsAlive())) {
+			units.push_back(unit);
+		}
+	}
+
+	//buildings under construction are removed from the type unit lists until they are finished
+	if (everybody && player.GetUnitTypeUnderConstructionCount(&type) > 0) {
+		for (CUnit *unit : player.get_units()) {
+			if (unit->Type == &type && unit->CurrentAction() == UnitAction::Built && unit->IsAlive() && !wyrmgus::vector::contains(units, unit)) {
+				units.push_back(unit);
+			}
+		}
+	}
+}
+
+/**
+**  Get whether any player has a usable unit of a given type.
+**
+**  @param type  The unit type.
+**
+**  @return      True if a unit of the type which is not under construction exists on the map, or false otherwise.
+*/
+static bool HasUsableUnitOfType(const wyrmgus::unit_type &type)
+{
+	if (type.BoolFlag[VANISHES_INDEX].value) {
+		std::vector<CUnit *> type_units;
+		FindUnitsByType(type, type_units);
+		return !type_units.empty();
+	}
+
+	for (const CPlayer *player : CPlayer::Players) {
+		for (const CUnit *unit : player->get_type_units(&type)) {
+			if (!unit->IsUnusable()) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
 /**
 **  Apply the modifiers of an upgrade.
 **
@@ -1338,7 +1426,7 @@ static void ApplyUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifie
 	}
 	//Wyrmgus end
 
-	for (int z = 0; z < UpgradeMax; ++z) {
+	for (const int z : um->get_changed_upgrade_ids()) {
 		// allow/forbid upgrades for player.  only if upgrade is not acquired
 
 		// FIXME: check if modify is allowed
@@ -1356,6 +1444,9 @@ static void ApplyUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifie
 			}
 		}
 	}
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_upgrades);
+	InvalidateButtonAllowedCache();
+	InvalidateDescMemos(DescDependency_Upgrades);
 	
 	//Wyrmgus start
 	for (size_t i = 0; i < um->RemoveUpgrades.size(); ++i) {
@@ -1365,13 +1456,22 @@ static void ApplyUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifie
 	}
 	//Wyrmgus end
 
-	for (wyrmgus::unit_type *unit_type : wyrmgus::unit_type::get_all()) {
-		if (unit_type->is_template()) {
-			continue;
+	// add/remove allowed units
+	for (const int unit_slot : um->get_changed_unit_slots()) {
+		//Wyrmgus start
+		if (wyrmgus::unit_type::get_all()[unit_slot]->Stats[pn].Variables.empty()) { // unit type's stats not initialized
+			break;
 		}
+		//Wyrmgus end
+
+		// FIXME: check if modify is allowed
 
+		player.Allow.Units[unit_slot] += um->ChangeUnits[unit_slot];
+	}
+
+	//only visit the unit types this modifier applies to
+	for (wyrmgus::unit_type *unit_type : um->get_affected_unit_types()) {
 		CUnitStats &stat = unit_type->Stats[pn];
-		// add/remove allowed units
 
 		//Wyrmgus start
 		if (stat.Variables.empty()) { // unit type's stats not initialized
@@ -1379,10 +1479,6 @@ static void ApplyUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifie
 		}
 		//Wyrmgus end
 
-		// FIXME: check if modify is allowed
-
-		player.Allow.Units[unit_type->Slot] += um->ChangeUnits[unit_type->Slot];
-
 		// this modifier should be applied to unittype id == z
 		if (um->applies_to(unit_type)) {
 
@@ -1390,11 +1486,11 @@ static void ApplyUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifie
 			if (um->Modifier.Variables[SUPPLY_INDEX].Value) {
 				std::vector<CUnit *> unitupgrade;
 
-				FindUnitsByType(*unit_type, unitupgrade);
+				FindPlayerUnitsOfType(player, *unit_type, unitupgrade);
 				for (size_t j = 0; j != unitupgrade.size(); ++j) {
 					CUnit &unit = *unitupgrade[j];
-					if (unit.Player->Index == pn && unit.IsAlive()) {
-						unit.Player->Supply += um->Modifier.Variables[SUPPLY_INDEX].Value;
+					if (unit.IsAlive()) {
+						player.Supply += um->Modifier.Variables[SUPPLY_INDEX].Value;
 					}
 				}
 			}
@@ -1403,11 +1499,11 @@ static void ApplyUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifie
 			if (um->Modifier.Variables[DEMAND_INDEX].Value) {
 				std::vector<CUnit *> unitupgrade;
 
-				FindUnitsByType(*unit_type, unitupgrade);
+				FindPlayerUnitsOfType(player, *unit_type, unitupgrade);
 				for (size_t j = 0; j != unitupgrade.size(); ++j) {
 					CUnit &unit = *unitupgrade[j];
-					if (unit.Player->Index == pn && unit.IsAlive()) {
-						unit.Player->Demand += um->Modifier.Variables[DEMAND_INDEX].Value;
+					if (unit.IsAlive()) {
+						player.Demand += um->Modifier.Variables[DEMAND_INDEX].Value;
 					}
 				}
 			}
@@ -1423,9 +1519,7 @@ static void ApplyUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifie
 						stat.ImproveIncomes[j] += um->Modifier.ImproveIncomes[j];
 					}
 					//update player's income
-					std::vector<CUnit *> unitupgrade;
-					FindUnitsByType(*unit_type, unitupgrade);
-					if (unitupgrade.size() > 0) {
+					if (HasUsableUnitOfType(*unit_type)) {
 						player.Incomes[j] = std::max(player.Incomes[j], stat.ImproveIncomes[j]);
 					}
 				}
@@ -1472,10 +1566,7 @@ static void ApplyUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifie
 			}
 			
 			if (um->Modifier.Variables[TRADECOST_INDEX].Value) {
-				std::vector<CUnit *> unitupgrade;
-
-				FindUnitsByType(*unit_type, unitupgrade);
-				if (unitupgrade.size() > 0) {
+				if (HasUsableUnitOfType(*unit_type)) {
 					player.TradeCost = std::min(player.TradeCost, stat.Variables[TRADECOST_INDEX].Value);
 				}
 			}
@@ -1484,7 +1575,7 @@ static void ApplyUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifie
 			//Wyrmgus start
 			std::vector<CUnit *> unitupgrade;
 
-			FindUnitsByType(*unit_type, unitupgrade, true);
+			FindPlayerUnitsOfType(player, *unit_type, unitupgrade, true);
 			//Wyrmgus end
 			
 			if (varModified) {
@@ -1622,7 +1713,7 @@ static void RemoveUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifi
 		player.SpeedResearch -= um->SpeedResearch;
 	}
 
-	for (int z = 0; z < UpgradeMax; ++z) {
+	for (const int z : um->get_changed_upgrade_ids()) {
 		// allow/forbid upgrades for player.  only if upgrade is not acquired
 
 		// FIXME: check if modify is allowed
@@ -1640,24 +1731,32 @@ static void RemoveUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifi
 			}
 		}
 	}
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_upgrades);
+	InvalidateButtonAllowedCache();
+	InvalidateDescMemos(DescDependency_Upgrades);
 
-	for (wyrmgus::unit_type *unit_type : wyrmgus::unit_type::get_all()) {
-		if (unit_type->is_template()) {
-			continue;
+	// add/remove allowed units
+	for (const int unit_slot : um->get_changed_unit_slots()) {
+		//Wyrmgus start
+		if (wyrmgus::unit_type::get_all()[unit_slot]->Stats[pn].Variables.empty()) { // unit type's stats not initialized
+			break;
 		}
+		//Wyrmgus end
 
+		// FIXME: check if modify is allowed
+
+		player.Allow.Units[unit_slot] -= um->ChangeUnits[unit_slot];
+	}
+
+	//only visit the unit types this modifier applies to
+	for (wyrmgus::unit_type *unit_type : um->get_affected_unit_types()) {
 		CUnitStats &stat = unit_type->Stats[pn];
-		// add/remove allowed units
 
 		//Wyrmgus start
 		if (stat.Variables.empty()) { // unit types stats not initialized
 			break;
 		}
 		//Wyrmgus end
-		
-		// FIXME: check if modify is allowed
-
-		player.Allow.Units[unit_type->Slot] -= um->ChangeUnits[unit_type->Slot];
 
 		// this modifier should be applied to unittype id == z
 		if (um->applies_to(unit_type)) {
@@ -1665,11 +1764,11 @@ static void RemoveUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifi
 			if (um->Modifier.Variables[SUPPLY_INDEX].Value) {
 				std::vector<CUnit *> unitupgrade;
 
-				FindUnitsByType(*unit_type, unitupgrade);
+				FindPlayerUnitsOfType(player, *unit_type, unitupgrade);
 				for (size_t j = 0; j != unitupgrade.size(); ++j) {
 					CUnit &unit = *unitupgrade[j];
-					if (unit.Player->Index == pn && unit.IsAlive()) {
-						unit.Player->Supply -= um->Modifier.Variables[SUPPLY_INDEX].Value;
+					if (unit.IsAlive()) {
+						player.Supply -= um->Modifier.Variables[SUPPLY_INDEX].Value;
 					}
 				}
 			}
@@ -1678,11 +1777,11 @@ static void RemoveUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifi
 			if (um->Modifier.Variables[DEMAND_INDEX].Value) {
 				std::vector<CUnit *> unitupgrade;
 
-				FindUnitsByType(*unit_type, unitupgrade);
+				FindPlayerUnitsOfType(player, *unit_type, unitupgrade);
 				for (size_t j = 0; j != unitupgrade.size(); ++j) {
 					CUnit &unit = *unitupgrade[j];
-					if (unit.Player->Index == pn && unit.IsAlive()) {
-						unit.Player->Demand -= um->Modifier.Variables[DEMAND_INDEX].Value;
+					if (unit.IsAlive()) {
+						player.Demand -= um->Modifier.Variables[DEMAND_INDEX].Value;
 					}
 				}
 			}
@@ -1763,7 +1862,7 @@ static void RemoveUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifi
 			//Wyrmgus start
 			std::vector<CUnit *> unitupgrade;
 
-			FindUnitsByType(*unit_type, unitupgrade, true);
+			FindPlayerUnitsOfType(player, *unit_type, unitupgrade, true);
 			//Wyrmgus end
 			
 			// And now modify ingame units
@@ -1882,6 +1981,53 @@ static void RemoveUpgradeModifier(CPlayer &player, const wyrmgus::upgrade_modifi
 	}
 }
 
+/**
+**  Benchmark applying and removing the modifiers of each upgrade for each player in the loaded game.
+**
+**  Each modifier is removed right after being applied, and the player's upgrade allowances are restored afterwards. Modifiers which convert units, remove upgrades or change the player's civilization or faction are skipped, as they can't be undone. Unit variations chosen again and variable values clamped when applying aren't restored, so the game shouldn't be continued afterwards.
+*/
+void BenchmarkUpgradeModifiers()
+{
+	std::chrono::steady_clock::duration apply_time(0);
+	std::chrono::steady_clock::duration remove_time(0);
+	long long applied_count = 0;
+	long long skipped_count = 0;
+	std::array<char, UpgradeMax> allowed_upgrades;
+
+	for (CPlayer *player : CPlayer::Players) {
+		if (player->GetUnitCount() == 0) {
+			continue;
+		}
+
+		for (const CUpgrade *upgrade : CUpgrade::get_all()) {
+			for (const std::unique_ptr<const wyrmgus::upgrade_modifier> &modifier : upgrade->get_modifiers()) {
+				if (modifier->ConvertTo != nullptr || !modifier->RemoveUpgrades.empty() || modifier->change_civilization_to != nullptr || modifier->change_faction_to != nullptr) {
+					++skipped_count;
+					continue;
+				}
+
+				std::copy(std::begin(player->Allow.Upgrades), std::end(player->Allow.Upgrades), allowed_upgrades.begin());
+
+				const auto start_time = std::chrono::steady_clock::now();
+				ApplyUpgradeModifier(*player, modifier.get());
+				const auto apply_end_time = std::chrono::steady_clock::now();
+				RemoveUpgradeModifier(*player, modifier.get());
+				const auto remove_end_time = std::chrono::steady_clock::now();
+
+				std::copy(allowed_upgrades.begin(), allowed_upgrades.end(), std::begin(player->Allow.Upgrades));
+
+				apply_time += apply_end_time - start_time;
+				remove_time += remove_end_time - apply_end_time;
+				++applied_count;
+			}
+		}
+	}
+
+	const long long apply_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(apply_time).count();
+	const long long remove_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(remove_time).count();
+	fprintf(stdout, "Applied and removed %lld upgrade modifiers (%lld skipped): applying took %lld us, removing took %lld us.\n", applied_count, skipped_count, apply_microseconds, remove_microseconds);
+}
+
 /**
 **  Apply the modifiers of an individual upgrade.
 **
@@ -2229,6 +2375,8 @@ void IndividualUpgradeAcquire(CUnit &unit, const CUpgrade *upgrade)
 	}
 	//Wyrmgus end
 	unit.SetIndividualUpgrade(upgrade, unit.GetIndividualUpgrade(upgrade) + 1);
+	InvalidateButtonAllowedCache();
+	InvalidateDescMemos(DescDependency_Upgrades);
 	
 	const wyrmgus::deity *upgrade_deity = upgrade->get_deity();
 	if (upgrade_deity != nullptr) {
@@ -2283,6 +2431,8 @@ void IndividualUpgradeLost(CUnit &unit, const CUpgrade *upgrade, bool lose_all)
 	}
 	//Wyrmgus end
 	unit.SetIndividualUpgrade(upgrade, unit.GetIndividualUpgrade(upgrade) - 1);
+	InvalidateButtonAllowedCache();
+	InvalidateDescMemos(DescDependency_Upgrades);
 
 	const wyrmgus::deity *upgrade_deity = upgrade->get_deity();
 	if (upgrade_deity != nullptr) {
@@ -2367,6 +2517,9 @@ void AllowUpgradeId(CPlayer &player, int id, char af)
 {
 	Assert(af == 'A' || af == 'F' || af == 'R');
 	player.Allow.Upgrades[id] = af;
+	wyrmgus::trigger::on_condition_dependency_changed(wyrmgus::condition_dependency_upgrades);
+	InvalidateButtonAllowedCache();
+	InvalidateDescMemos(DescDependency_Upgrades);
 }
 
 /**
@@ -151,6 +151,43 @@ bool upgrade_modifier::applies_to(const unit_type *unit_type) const
 	return false;
 }
 
+void upgrade_modifier::build_indexes() const
+{
+	this->affected_unit_types.clear();
+	this->changed_unit_slots.clear();
+	this->changed_upgrade_ids.clear();
+
+	for (unit_type *unit_type : unit_type::get_all()) {
+		if (unit_type->is_template()) {
+			continue;
+		}
+
+		if (this->ChangeUnits[unit_type->Slot] != 0) {
+			this->changed_unit_slots.push_back(unit_type->Slot);
+		}
+
+		if (this->applies_to(unit_type)) {
+			this->affected_unit_types.push_back(unit_type);
+		}
+	}
+
+	for (int z = 0; z < UpgradeMax; ++z) {
+		if (this->ChangeUpgrades[z] == 'A' || this->ChangeUpgrades[z] == 'F' || this->ChangeUpgrades[z] == 'R') {
+			this->changed_upgrade_ids.push_back(z);
+		}
+	}
+
+	this->indexed_unit_type_count = unit_type::get_all().size();
+}
+
+void upgrade_modifier::check_indexes() const
+{
+	//rebuild the indexes if unit types were defined after they were built
+	if (this->indexed_unit_type_count != unit_type::get_all().size()) {
+		this->build_indexes();
+	}
+}
+
 int upgrade_modifier::GetUnitStock(unit_type *unit_type) const
 {
 	auto find_iterator = this->UnitStock.find(unit_type);
@@ -30,10 +30,33 @@
 #include "util/container_util.h"
 #include "util/point_util.h"
 #include "util/size_util.h"
+#include "util/thread_pool.h"
 #include "xbrz.h"
 
 namespace wyrmgus::image {
 
+//the minimum number of source rows in a slice scaled by a single task, as xBRZ is slightly less efficient on the first row of each slice
+static constexpr int min_scale_slice_height = 16;
+
+static int get_scale_slice_count(const int height, const size_t task_count)
+{
+	return std::max(1, std::min(static_cast<int>(task_count), height / min_scale_slice_height));
+}
+
+//scale a slice of rows of an image with xBRZ; slices with different rows can be scaled concurrently
+static void scale_slice(const int scale_factor, const uint32_t *src_data, uint32_t *dst_data, const int width, const int height, const int slice_count, const int slice_index)
+{
+	const int slice_height = (height + slice_count - 1) / slice_count;
+	const int y_first = slice_index * slice_height;
+	const int y_last = std::min(height, y_first + slice_height);
+
+	if (y_first >= y_last) {
+		return;
+	}
+
+	xbrz::scale(scale_factor, src_data, dst_data, width, height, xbrz::ScalerCfg(), y_first, y_last);
+}
+
 QImage scale(const QImage &src_image, const int scale_factor)
 {
 	if (src_image.format() != QImage::Format_RGBA8888) {
@@ -43,9 +66,14 @@ QImage scale(const QImage &src_image, const int scale_factor)
 
 	QImage result_image(src_image.size() * scale_factor, QImage::Format_RGBA8888);
 
-	const unsigned char *src_data = src_image.constBits();
-	unsigned char *dst_data = result_image.bits();
-	xbrz::scale(scale_factor, reinterpret_cast<const uint32_t *>(src_data), reinterpret_cast<uint32_t *>(dst_data), src_image.width(), src_image.height());
+	const uint32_t *src_data = reinterpret_cast<const uint32_t *>(src_image.constBits());
+	uint32_t *dst_data = reinterpret_cast<uint32_t *>(result_image.bits());
+
+	const int slice_count = image::get_scale_slice_count(src_image.height(), thread_pool::get()->get_thread_count());
+
+	thread_pool::get()->parallel_for(slice_count, [&](const size_t slice_index) {
+		image::scale_slice(scale_factor, src_data, dst_data, src_image.width(), src_image.height(), slice_count, static_cast<int>(slice_index));
+	});
 
 	return result_image;
 }
@@ -64,7 +92,7 @@ QImage scale(const QImage &src_image, const int scale_factor, const QSize &old_f
 	//scale an image with xBRZ
 	const QSize new_frame_size = old_frame_size * scale_factor;
 
-	const int bpp = src_image.depth() / 8;
+	static constexpr int bpp = 4;
 	const QSize result_size = src_image.size() * scale_factor;
 	QImage result_image(result_size, QImage::Format_RGBA8888);
 
@@ -72,33 +100,53 @@ QImage scale(const QImage &src_image, const int scale_factor, const QSize &old_f
 		throw std::runtime_error("Failed to allocate image to be scaled.");
 	}
 
+	const unsigned char *src_data = src_image.constBits();
 	unsigned char *dst_data = result_image.bits();
+	const size_t src_bytes_per_line = static_cast<size_t>(src_image.bytesPerLine());
+	const size_t dst_bytes_per_line = static_cast<size_t>(result_image.bytesPerLine());
 
-	//if a simple scale factor is being used for the resizing, then use xBRZ for the rescaling
 	const int horizontal_frame_count = src_image.width() / old_frame_size.width();
 	const int vertical_frame_count = src_image.height() / old_frame_size.height();
+	const int frame_count = horizontal_frame_count * vertical_frame_count;
+	const size_t old_frame_pixel_count = static_cast<size_t>(old_frame_size.width()) * old_frame_size.height();
+	const size_t new_frame_pixel_count = static_cast<size_t>(new_frame_size.width()) * new_frame_size.height();
+
+	//xBRZ needs each frame to be contiguous in memory, so the frames are copied row by row into a buffer, scaled into another buffer and then copied row by row into the result
+	std::vector<uint32_t> src_frame_data(old_frame_pixel_count * frame_count);
+	std::vector<uint32_t> dst_frame_data(new_frame_pixel_count * frame_count);
+
+	thread_pool::get()->parallel_for(frame_count, [&](const size_t frame_index) {
+		const int frame_x = static_cast<int>(frame_index) % horizontal_frame_count;
+		const int frame_y = static_cast<int>(frame_index) / horizontal_frame_count;
+		uint32_t *frame_data = &src_frame_data[frame_index * old_frame_pixel_count];
+
+		for (int y = 0; y < old_frame_size.height(); ++y) {
+			const unsigned char *src_line = src_data + (frame_y * old_frame_size.height() + y) * src_bytes_per_line + frame_x * old_frame_size.width() * bpp;
+			memcpy(frame_data + y * old_frame_size.width(), src_line, old_frame_size.width() * bpp);
+		}
+	});
 
-	//scale each frame individually
-	for (int frame_x = 0; frame_x < horizontal_frame_count; ++frame_x) {
-		for (int frame_y = 0; frame_y < vertical_frame_count; ++frame_y) {
-			const QImage src_frame_image = src_image.copy(frame_x * old_frame_size.width(), frame_y * old_frame_size.height(), old_frame_size.width(), old_frame_size.height());
-			QImage result_frame_image = image::scale(src_frame_image, scale_factor);
-
-			const unsigned char *frame_data = result_frame_image.constBits();
-
-			for (int x = 0; x < new_frame_size.width(); ++x) {
-				for (int y = 0; y < new_frame_size.height(); ++y) {
-					const int frame_pixel_index = y * new_frame_size.width() + x;
-					const int pixel_x = frame_x * new_frame_size.width() + x;
-					const int pixel_y = frame_y * new_frame_size.height() + y;
-					const int pixel_index = pixel_y * result_image.width() + pixel_x;
-					for (int i = 0; i < bpp; ++i) {
-						dst_data[pixel_index * bpp + i] = frame_data[frame_pixel_index * bpp + i];
-					}
-				}
-			}
+	//if there are fewer frames than threads, then split the frames into slices of rows as well
+	const size_t thread_count = thread_pool::get()->get_thread_count();
+	const int slices_per_frame = image::get_scale_slice_count(old_frame_size.height(), (thread_count + frame_count - 1) / frame_count);
+
+	thread_pool::get()->parallel_for(static_cast<size_t>(frame_count) * slices_per_frame, [&](const size_t task_index) {
+		const size_t frame_index = task_index / slices_per_frame;
+		const int slice_index = static_cast<int>(task_index % slices_per_frame);
+
+		image::scale_slice(scale_factor, &src_frame_data[frame_index * old_frame_pixel_count], &dst_frame_data[frame_index * new_frame_pixel_count], old_frame_size.width(), old_frame_size.height(), slices_per_frame, slice_index);
+	});
+
+	thread_pool::get()->parallel_for(frame_count, [&](const size_t frame_index) {
+		const int frame_x = static_cast<int>(frame_index) % horizontal_frame_count;
+		const int frame_y = static_cast<int>(frame_index) / horizontal_frame_count;
+		const uint32_t *frame_data = &dst_frame_data[frame_index * new_frame_pixel_count];
+
+		for (int y = 0; y < new_frame_size.height(); ++y) {
+			unsigned char *dst_line = dst_data + (frame_y * new_frame_size.height() + y) * dst_bytes_per_line + frame_x * new_frame_size.width() * bpp;
+			memcpy(dst_line, frame_data + y * new_frame_size.width(), new_frame_size.width() * bpp);
 		}
-	}
+	});
 
 	return result_image;
 }
@@ -0,0 +1,68 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "stratagus.h"
+
+#include "util/interned_string.h"
+
+namespace wyrmgus {
+
+//the strings are interned from the threads parsing the database as well
+static std::mutex interned_string_mutex;
+
+interned_string::interned_string(const std::string_view &str)
+{
+	const size_t hash = string_hash_map<std::unique_ptr<const data>>::hash_key(str);
+
+	std::lock_guard<std::mutex> lock(interned_string_mutex);
+
+	std::unique_ptr<const data> &string_data = interned_string::get_pool()[str];
+	if (string_data == nullptr) {
+		string_data = std::make_unique<const data>(str, hash);
+	}
+
+	this->string_data = string_data.get();
+}
+
+//the pool of interned strings; they are never freed, so that interned strings remain valid until the program exits
+string_hash_map<std::unique_ptr<const interned_string::data>> &interned_string::get_pool()
+{
+	static string_hash_map<std::unique_ptr<const data>> pool;
+	return pool;
+}
+
+const interned_string::data *interned_string::get_empty_data()
+{
+	static const interned_string empty_string = interned_string(std::string_view());
+	return empty_string.string_data;
+}
+
+}
@@ -0,0 +1,96 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "util/string_hash_map.h"
+
+namespace wyrmgus {
+
+//a string stored only once for all its occurrences, together with its hash; copies are cheap, and comparing two interned strings is a pointer comparison
+class interned_string final
+{
+private:
+	struct data final
+	{
+		explicit data(const std::string_view &str, const size_t hash) : str(str), hash(hash)
+		{
+		}
+
+		const std::string str;
+		const size_t hash = 0;
+	};
+
+public:
+	interned_string() : string_data(interned_string::get_empty_data())
+	{
+	}
+
+	explicit interned_string(const std::string_view &str);
+
+	const std::string &str() const
+	{
+		return this->string_data->str;
+	}
+
+	size_t get_hash() const
+	{
+		return this->string_data->hash;
+	}
+
+	bool empty() const
+	{
+		return this->string_data->str.empty();
+	}
+
+	bool operator ==(const interned_string &other) const
+	{
+		return this->string_data == other.string_data;
+	}
+
+	bool operator !=(const interned_string &other) const
+	{
+		return this->string_data != other.string_data;
+	}
+
+	bool operator <(const interned_string &other) const
+	{
+		return this->str() < other.str();
+	}
+
+private:
+	static string_hash_map<std::unique_ptr<const data>> &get_pool();
+	static const data *get_empty_data();
+
+	const data *string_data = nullptr;
+};
+
+}
@@ -0,0 +1,217 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+namespace wyrmgus {
+
+//a hash table with string keys, using open addressing with linear probing; lookups can be done with string views or with precomputed hashes, so that no temporary strings need to be created
+template <typename T>
+class string_hash_map final
+{
+private:
+	enum class slot_state : uint8_t {
+		empty,
+		occupied,
+		deleted
+	};
+
+	struct slot final
+	{
+		std::string key;
+		size_t hash = 0;
+		T value = T();
+		slot_state state = slot_state::empty;
+	};
+
+public:
+	static size_t hash_key(const std::string_view &key)
+	{
+		return std::hash<std::string_view>()(key);
+	}
+
+	size_t size() const
+	{
+		return this->count;
+	}
+
+	bool empty() const
+	{
+		return this->count == 0;
+	}
+
+	T *find(const std::string_view &key, const size_t hash)
+	{
+		const size_t index = this->find_index(key, hash);
+		if (index == string_hash_map::npos) {
+			return nullptr;
+		}
+
+		return &this->slots[index].value;
+	}
+
+	const T *find(const std::string_view &key, const size_t hash) const
+	{
+		const size_t index = this->find_index(key, hash);
+		if (index == string_hash_map::npos) {
+			return nullptr;
+		}
+
+		return &this->slots[index].value;
+	}
+
+	T *find(const std::string_view &key)
+	{
+		return this->find(key, string_hash_map::hash_key(key));
+	}
+
+	const T *find(const std::string_view &key) const
+	{
+		return this->find(key, string_hash_map::hash_key(key));
+	}
+
+	bool contains(const std::string_view &key) const
+	{
+		return this->find(key) != nullptr;
+	}
+
+	//get the value for the key, inserting a default-constructed one if the key isn't present
+	T &operator [](const std::string_view &key)
+	{
+		const size_t hash = string_hash_map::hash_key(key);
+
+		T *value = this->find(key, hash);
+		if (value != nullptr) {
+			return *value;
+		}
+
+		if ((this->count + this->deleted_count + 1) * 4 > this->slots.size() * 3) {
+			this->rehash(std::max<size_t>(16, this->count * 4 >= this->slots.size() ? this->slots.size() * 2 : this->slots.size()));
+		}
+
+		const size_t mask = this->slots.size() - 1;
+		size_t index = hash & mask;
+		while (this->slots[index].state == slot_state::occupied) {
+			index = (index + 1) & mask;
+		}
+
+		slot &slot = this->slots[index];
+		if (slot.state == slot_state::deleted) {
+			--this->deleted_count;
+		}
+
+		slot.key = key;
+		slot.hash = hash;
+		slot.value = T();
+		slot.state = slot_state::occupied;
+		++this->count;
+
+		return slot.value;
+	}
+
+	bool erase(const std::string_view &key)
+	{
+		const size_t index = this->find_index(key, string_hash_map::hash_key(key));
+		if (index == string_hash_map::npos) {
+			return false;
+		}
+
+		//leave a tombstone, so that the probe sequences going through the slot remain intact
+		slot &slot = this->slots[index];
+		slot.key.clear();
+		slot.value = T();
+		slot.state = slot_state::deleted;
+		--this->count;
+		++this->deleted_count;
+
+		return true;
+	}
+
+	void clear()
+	{
+		this->slots.clear();
+		this->count = 0;
+		this->deleted_count = 0;
+	}
+
+private:
+	static constexpr size_t npos = static_cast<size_t>(-1);
+
+	size_t find_index(const std::string_view &key, const size_t hash) const
+	{
+		if (this->slots.empty()) {
+			return string_hash_map::npos;
+		}
+
+		const size_t mask = this->slots.size() - 1;
+		size_t index = hash & mask;
+
+		//the table is never full, so there is always an empty slot to end the probe sequence
+		while (this->slots[index].state != slot_state::empty) {
+			const slot &slot = this->slots[index];
+			if (slot.state == slot_state::occupied && slot.hash == hash && slot.key == key) {
+				return index;
+			}
+
+			index = (index + 1) & mask;
+		}
+
+		return string_hash_map::npos;
+	}
+
+	//rebuild the table with the given capacity, which must be a power of two, dropping the tombstones
+	void rehash(const size_t capacity)
+	{
+		std::vector<slot> old_slots = std::move(this->slots);
+		this->slots = std::vector<slot>(capacity);
+		this->deleted_count = 0;
+
+		const size_t mask = capacity - 1;
+		for (slot &old_slot : old_slots) {
+			if (old_slot.state != slot_state::occupied) {
+				continue;
+			}
+
+			size_t index = old_slot.hash & mask;
+			while (this->slots[index].state == slot_state::occupied) {
+				index = (index + 1) & mask;
+			}
+
+			this->slots[index] = std::move(old_slot);
+		}
+	}
+
+	std::vector<slot> slots; //the size is always zero or a power of two
+	size_t count = 0;
+	size_t deleted_count = 0;
+};
+
+}
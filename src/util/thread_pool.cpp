@@ -0,0 +1,133 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2019-2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "stratagus.h"
+
+#include "util/thread_pool.h"
+
+#include "util/exception_util.h"
+
+namespace wyrmgus {
+
+thread_pool::thread_pool()
+{
+	//leave one core for the calling thread
+	const unsigned int hardware_thread_count = std::thread::hardware_concurrency();
+	const unsigned int worker_count = hardware_thread_count > 1 ? hardware_thread_count - 1 : 0;
+
+	for (unsigned int i = 0; i < worker_count; ++i) {
+		this->workers.emplace_back([this]() {
+			this->run_worker();
+		});
+	}
+}
+
+thread_pool::~thread_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+
+	this->task_condition.notify_all();
+
+	for (std::thread &worker : this->workers) {
+		worker.join();
+	}
+}
+
+void thread_pool::post(std::function<void()> &&task)
+{
+	if (this->workers.empty()) {
+		task();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->tasks.push(std::move(task));
+	}
+
+	this->task_condition.notify_one();
+}
+
+void thread_pool::process_batch(batch &batch)
+{
+	while (true) {
+		const size_t index = batch.next_index++;
+		if (index >= batch.count) {
+			return;
+		}
+
+		try {
+			batch.function(index);
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(batch.mutex);
+			if (!batch.exception) {
+				batch.exception = std::current_exception();
+			}
+		}
+
+		if (++batch.completed_count == batch.count) {
+			std::lock_guard<std::mutex> lock(batch.mutex);
+			batch.completed_condition.notify_all();
+		}
+	}
+}
+
+void thread_pool::run_worker()
+{
+	while (true) {
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->task_condition.wait(lock, [this]() {
+				return this->stopping || !this->tasks.empty();
+			});
+
+			if (this->stopping && this->tasks.empty()) {
+				return;
+			}
+
+			task = std::move(this->tasks.front());
+			this->tasks.pop();
+		}
+
+		try {
+			task();
+		} catch (const std::exception &exception) {
+			exception::report(exception);
+		}
+	}
+}
+
+}
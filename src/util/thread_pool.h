@@ -0,0 +1,124 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2019-2020 by Andrettin
+//
+//      Permission is hereby granted, free of charge, to any person obtaining a
+//      copy of this software and associated documentation files (the
+//      "Software"), to deal in the Software without restriction, including
+//      without limitation the rights to use, copy, modify, merge, publish,
+//      distribute, sublicense, and/or sell copies of the Software, and to
+//      permit persons to whom the Software is furnished to do so, subject to
+//      the following conditions:
+//
+//      The above copyright notice and this permission notice shall be included
+//      in all copies or substantial portions of the Software.
+//
+//      THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//      OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//      MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//      IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//      CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//      TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//      SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "util/singleton.h"
+
+#include <atomic>
+#include <condition_variable>
+
+namespace wyrmgus {
+
+//a pool of worker threads, used to spread independent work items over all cores
+class thread_pool final : public singleton<thread_pool>
+{
+private:
+	//the shared state of a parallel_for call; it is kept alive by the tasks referencing it, so that tasks which start after the call has finished can still safely find out that there is nothing left for them to do
+	struct batch final
+	{
+		explicit batch(const size_t count, std::function<void(size_t)> &&function)
+			: count(count), function(std::move(function))
+		{
+		}
+
+		const size_t count = 0;
+		const std::function<void(size_t)> function;
+		std::atomic<size_t> next_index = 0;
+		std::atomic<size_t> completed_count = 0;
+		std::mutex mutex;
+		std::condition_variable completed_condition;
+		std::exception_ptr exception;
+	};
+
+public:
+	thread_pool();
+	~thread_pool();
+
+	size_t get_thread_count() const
+	{
+		//the calling thread counts as well, as it takes part in parallel_for calls
+		return this->workers.size() + 1;
+	}
+
+	//run the function for each index in [0, count), spreading the calls over the worker threads; the calling thread takes part in the work, and the call returns only after all indexes have been processed
+	template <typename function_type>
+	void parallel_for(const size_t count, const function_type &function)
+	{
+		if (count == 0) {
+			return;
+		}
+
+		if (count == 1 || this->workers.empty()) {
+			for (size_t i = 0; i < count; ++i) {
+				function(i);
+			}
+			return;
+		}
+
+		const std::shared_ptr<batch> batch = std::make_shared<thread_pool::batch>(count, function);
+
+		const size_t helper_count = std::min(this->workers.size(), count - 1);
+		for (size_t i = 0; i < helper_count; ++i) {
+			this->post([batch]() {
+				thread_pool::process_batch(*batch);
+			});
+		}
+
+		thread_pool::process_batch(*batch);
+
+		std::unique_lock<std::mutex> lock(batch->mutex);
+		batch->completed_condition.wait(lock, [&batch]() {
+			return batch->completed_count == batch->count;
+		});
+
+		if (batch->exception) {
+			std::rethrow_exception(batch->exception);
+		}
+	}
+
+	//run a task asynchronously on one of the worker threads
+	void post(std::function<void()> &&task);
+
+private:
+	static void process_batch(batch &batch);
+
+	void run_worker();
+
+private:
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable task_condition;
+	bool stopping = false;
+};
+
+}
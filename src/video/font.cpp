@@ -359,6 +359,21 @@ unsigned int font::DrawChar(CGraphic &g, int utf8, int x, int y) const
 	return w + 1;
 }
 
+/**
+**  Get the width of a character, including its spacing, as drawn by DrawChar.
+*/
+unsigned int font::get_char_width(const int utf8) const
+{
+	int c = utf8 - 32;
+	const int ipr = this->G->GraphicWidth / this->G->Width;
+
+	if (c < 0 || ipr * this->G->GraphicHeight / this->G->Height <= c) {
+		c = 0;
+	}
+
+	return this->char_width[c] + 1;
+}
+
 CGraphic *font::get_font_color_graphic(const wyrmgus::font_color *font_color)
 {
 	if (!this->font_color_graphics.contains(font_color)) {
@@ -378,7 +393,7 @@ CGraphic *font::get_font_color_graphic(const wyrmgus::font_color *font_color)
 }
 
 /**
-**  Draw text with font at x,y clipped/unclipped.
+**  Parse text, passing each of its characters to draw_char.
 **
 **  ~    is special prefix.
 **  ~~   is the ~ character self.
@@ -386,17 +401,16 @@ CGraphic *font::get_font_color_graphic(const wyrmgus::font_color *font_color)
 **  ~<   start reverse.
 **  ~>   switch back to last used color.
 **
-**  @param x     X screen position
-**  @param y     Y screen position
-**  @param font  Font number
-**  @param text  Text to be displayed.
-**  @param clip  Flag if TRUE clip, otherwise not.
+**  @param text          Text to be parsed.
+**  @param fc            Font color at the start of the text.
+**  @param prefix_width  If not null, set to the width of the text before "~|".
+**  @param draw_char     Called with the font color, the character and its offset, returns the width drawn.
 **
-**  @return      The length of the printed text.
+**  @return      The length of the parsed text.
 */
-template <const bool CLIP>
-int CLabel::DoDrawText(int x, int y,
-					   const char *const text, const size_t len, const wyrmgus::font_color *fc) const
+template <typename DRAW_CHAR>
+int CLabel::ParseText(const char *const text, const size_t len, const wyrmgus::font_color *fc,
+					  int *prefix_width, const DRAW_CHAR &draw_char) const
 {
 	int widths = 0;
 	int utf8;
@@ -405,10 +419,6 @@ int CLabel::DoDrawText(int x, int y,
 	size_t pos = 0;
 	const wyrmgus::font_color *backup = fc;
 	bool isColor = false;
-	//Wyrmgus start
-//	CGraphic *g = font->get_font_color_graphic(FontColor);
-	CGraphic *g = this->font->get_font_color_graphic(fc);
-	//Wyrmgus end
 
 	while (GetUTF8(text, len, pos, utf8)) {
 		tab = false;
@@ -423,13 +433,13 @@ int CLabel::DoDrawText(int x, int y,
 					++pos;
 					break;
 				case '|':
+					if (prefix_width != nullptr) {
+						*prefix_width = widths;
+					}
 					++pos;
 					continue;
 				case '!':
-					if (fc != reverse) {
-						fc = reverse;
-						g = font->get_font_color_graphic(fc);
-					}
+					fc = reverse;
 					++pos;
 					continue;
 				case '<':
@@ -437,7 +447,6 @@ int CLabel::DoDrawText(int x, int y,
 					if (fc != reverse) {
 						isColor = true;
 						fc = reverse;
-						g = font->get_font_color_graphic(fc);
 					}
 					++pos;
 					continue;
@@ -445,7 +454,6 @@ int CLabel::DoDrawText(int x, int y,
 					if (fc != LastTextColor) {
 						std::swap(fc, LastTextColor);
 						isColor = false;
-						g = font->get_font_color_graphic(fc);
 					}
 					++pos;
 					continue;
@@ -468,7 +476,6 @@ int CLabel::DoDrawText(int x, int y,
 					if (fc_tmp) {
 						isColor = true;
 						fc = fc_tmp;
-						g = font->get_font_color_graphic(fc);
 					}
 					continue;
 				}
@@ -476,20 +483,92 @@ int CLabel::DoDrawText(int x, int y,
 		}
 		if (tab) {
 			for (int tabs = 0; tabs < tabSize; ++tabs) {
-				widths += font->DrawChar<CLIP>(*g, ' ', x + widths, y);
+				widths += draw_char(fc, ' ', widths);
 			}
 		} else {
-			widths += font->DrawChar<CLIP>(*g, utf8, x + widths, y);
+			widths += draw_char(fc, utf8, widths);
 		}
 
 		if (isColor == false && fc != backup) {
 			fc = backup;
-			g = font->get_font_color_graphic(fc);
 		}
 	}
 	return widths;
 }
 
+/**
+**  Draw text with font at x,y clipped/unclipped.
+**
+**  @param x     X screen position
+**  @param y     Y screen position
+**  @param text  Text to be displayed.
+**  @param fc    Font color at the start of the text.
+**
+**  @return      The length of the printed text.
+*/
+template <const bool CLIP>
+int CLabel::DoDrawText(int x, int y,
+					   const char *const text, const size_t len, const wyrmgus::font_color *fc) const
+{
+	//Wyrmgus start
+//	CGraphic *g = font->get_font_color_graphic(FontColor);
+	CGraphic *g = this->font->get_font_color_graphic(fc);
+	//Wyrmgus end
+	const wyrmgus::font_color *g_color = fc;
+
+	return this->ParseText(text, len, fc, nullptr, [&](const wyrmgus::font_color *char_color, const int utf8, const int offset) {
+		if (char_color != g_color) {
+			g_color = char_color;
+			g = this->font->get_font_color_graphic(g_color);
+		}
+
+		return static_cast<int>(this->font->DrawChar<CLIP>(*g, utf8, x + offset, y));
+	});
+}
+
+/**
+**  Lay text out, so that it can be drawn repeatedly without being parsed again.
+**
+**  @param text    Text to be laid out.
+**  @param layout  Set to the glyphs of the text.
+*/
+void CLabel::Layout(const std::string &text, CTextLayout &layout) const
+{
+	layout.Glyphs.clear();
+	layout.PrefixWidth = -1;
+
+	layout.Width = this->ParseText(text.c_str(), text.size(), normal, &layout.PrefixWidth, [&](const wyrmgus::font_color *char_color, const int utf8, const int offset) {
+		layout.Glyphs.push_back({ offset, utf8, char_color });
+		return static_cast<int>(this->font->get_char_width(utf8));
+	});
+
+	layout.LastTextColor = LastTextColor;
+}
+
+/**
+**  Draw text laid out by Layout, unclipped.
+**
+**  @return  The length of the printed text.
+*/
+int CLabel::DrawLayout(int x, int y, const CTextLayout &layout) const
+{
+	const wyrmgus::font_color *g_color = nullptr;
+	CGraphic *g = nullptr;
+
+	for (const CTextLayout::Glyph &glyph : layout.Glyphs) {
+		if (glyph.Color != g_color) {
+			g_color = glyph.Color;
+			g = this->font->get_font_color_graphic(g_color);
+		}
+
+		this->font->DrawChar<false>(*g, glyph.UTF8, x + glyph.X, y);
+	}
+
+	LastTextColor = layout.LastTextColor;
+
+	return layout.Width;
+}
+
 CLabel::CLabel(wyrmgus::font *f, const wyrmgus::font_color *nc, const wyrmgus::font_color *rc) : font(f)
 {
 	if (!f->is_loaded()) {
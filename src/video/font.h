@@ -85,6 +85,7 @@ public:
 
 	template<bool CLIP>
 	unsigned int DrawChar(CGraphic &g, int utf8, int x, int y) const;
+	unsigned int get_char_width(const int utf8) const;
 
 private:
 	void make_font_color_texture(const wyrmgus::font_color *fc);
@@ -113,6 +114,22 @@ extern void FreeOpenGLFonts();
 extern void ReloadFonts();
 #endif
 
+/// Text laid out by a label, which can be drawn again without parsing its characters and format codes
+struct CTextLayout
+{
+	struct Glyph
+	{
+		int X;  /// Offset from the start of the text
+		int UTF8;
+		const wyrmgus::font_color *Color;
+	};
+
+	std::vector<Glyph> Glyphs;
+	int Width = 0;
+	int PrefixWidth = -1; /// Width of the text before "~|", or -1 if the text has no "~|"
+	const wyrmgus::font_color *LastTextColor = nullptr; /// Last text color after the text has been drawn
+};
+
 class CLabel
 {
 public:
@@ -150,7 +167,13 @@ public:
 
 	int DrawCentered(int x, int y, const std::string &text) const;
 	int DrawReverseCentered(int x, int y, const std::string &text) const;
+	/// Lay text out once, to draw it repeatedly with DrawLayout
+	void Layout(const std::string &text, CTextLayout &layout) const;
+	int DrawLayout(int x, int y, const CTextLayout &layout) const;
 private:
+	template <typename DRAW_CHAR>
+	int ParseText(const char *const text, const size_t len, const wyrmgus::font_color *fc,
+				  int *prefix_width, const DRAW_CHAR &draw_char) const;
 	template <const bool CLIP>
 	int DoDrawText(int x, int y, const char *const text,
 				   const size_t len, const wyrmgus::font_color *fc) const;
@@ -30,6 +30,7 @@
 
 #include "stratagus.h"
 
+#include "database/database.h"
 #include "database/defines.h"
 //Wyrmgus start
 #include "grand_strategy.h"
@@ -48,6 +49,7 @@
 //Wyrmgus start
 #include "unit/unit.h" //for using CPreference
 //Wyrmgus end
+#include "util/hash_util.h"
 #include "util/image_util.h"
 #include "util/point_util.h"
 #include "video/video.h"
@@ -1043,6 +1045,172 @@ void MakeTextures2(const QImage &image, GLuint texture, const int ow, const int
 	}
 }
 
+static constexpr uintmax_t ScaledImageCacheMaxSize = 256 * 1024 * 1024; /// Size above which the least recently used scaled image cache files are removed
+static std::optional<uintmax_t> ScaledImageCacheSize; /// Total size of the scaled image cache files, if it has been calculated
+
+/**
+**	@brief	Keep the scaled image cache within its maximum size, removing its least recently used files if needed
+**
+**	The cache folder is only gone through the first time, and then whenever the size of the files added to it would take it over the maximum size.
+**
+**	@param	cache_path	The path of the scaled image cache
+**	@param	added_size	The size of the file which has been added to the cache
+*/
+static void TrimScaledImageCache(const std::filesystem::path &cache_path, const uintmax_t added_size)
+{
+	if (ScaledImageCacheSize.has_value()) {
+		ScaledImageCacheSize = ScaledImageCacheSize.value() + added_size;
+
+		if (ScaledImageCacheSize.value() <= ScaledImageCacheMaxSize) {
+			return;
+		}
+	}
+
+	std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> cache_files;
+	uintmax_t cache_size = 0;
+
+	std::error_code error_code;
+	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(cache_path, error_code)) {
+		if (!entry.is_regular_file(error_code)) {
+			continue;
+		}
+
+		cache_size += entry.file_size(error_code);
+		cache_files.emplace_back(entry.last_write_time(error_code), entry.path());
+	}
+
+	if (cache_size > ScaledImageCacheMaxSize) {
+		//remove down to three quarters of the maximum size, so that the folder needn't be gone through again soon
+		std::sort(cache_files.begin(), cache_files.end());
+
+		for (const auto &[last_write_time, filepath] : cache_files) {
+			if (cache_size <= ScaledImageCacheMaxSize / 4 * 3) {
+				break;
+			}
+
+			const uintmax_t file_size = std::filesystem::file_size(filepath, error_code);
+			if (!error_code && std::filesystem::remove(filepath, error_code)) {
+				cache_size -= file_size;
+			}
+		}
+	}
+
+	ScaledImageCacheSize = cache_size;
+}
+
+/**
+**	@brief	Scale an image with xBRZ, reusing the result of a previous scaling from the scaled image cache if possible
+**
+**	The cache is keyed by a hash of the source image's pixels, the scale factor and the color conversion applied before scaling, if any. The cache files are compressed, and are removed on a least recently used basis when the cache grows too large.
+**
+**	@param	image			The image to be scaled, in the RGBA8888 format
+**	@param	source_image	The image as it was loaded from its file, before color conversion, in the RGBA8888 format
+**	@param	variant			Identifies the color conversion applied to the image, or is empty if it is the source image
+**	@param	scale_factor	The scale factor
+**	@param	frame_size		The size of the image's frames
+**
+**	@return	The scaled image
+*/
+static QImage ScaleImageWithCache(const QImage &image, const QImage &source_image, const std::string &variant, const int scale_factor, const QSize &frame_size)
+{
+	if (image.format() != QImage::Format_RGBA8888) {
+		return ScaleImageWithCache(image.convertToFormat(QImage::Format_RGBA8888), source_image, variant, scale_factor, frame_size);
+	}
+
+	if (source_image.format() != QImage::Format_RGBA8888) {
+		//hash the colors of indexed images rather than their indexes, so that images differing only in their color tables get different keys
+		return ScaleImageWithCache(image, source_image.convertToFormat(QImage::Format_RGBA8888), variant, scale_factor, frame_size);
+	}
+
+	const int header[5] = { source_image.width(), source_image.height(), frame_size.width(), frame_size.height(), scale_factor };
+	uint64_t hash = wyrmgus::hash::fnv1a(header, sizeof(header));
+	const size_t source_line_size = static_cast<size_t>(source_image.width()) * 4;
+	for (int y = 0; y < source_image.height(); ++y) {
+		hash = wyrmgus::hash::fnv1a(source_image.constScanLine(y), source_line_size, hash);
+	}
+	hash = wyrmgus::hash::fnv1a(variant.data(), variant.size(), hash);
+
+	char filename[64];
+	snprintf(filename, sizeof(filename), "%016llx_%dx.rgba.z", static_cast<unsigned long long>(hash), scale_factor);
+
+	std::filesystem::path cache_path;
+	try {
+		cache_path = wyrmgus::database::get_cache_path() / "scaled_images";
+	} catch (const std::exception &exception) {
+		fprintf(stderr, "Failed to get the scaled image cache path: %s\n", exception.what());
+		return wyrmgus::image::scale(image, scale_factor, frame_size);
+	}
+
+	const std::filesystem::path cache_filepath = cache_path / filename;
+	const QSize result_size = image.size() * scale_factor;
+	const size_t result_line_size = static_cast<size_t>(result_size.width()) * 4;
+	const size_t result_data_size = result_line_size * result_size.height();
+
+	if (std::filesystem::exists(cache_filepath)) {
+		std::ifstream ifstream(cache_filepath, std::ios::binary);
+		int cached_size[2] = { 0, 0 };
+		ifstream.read(reinterpret_cast<char *>(cached_size), sizeof(cached_size));
+
+		if (ifstream && cached_size[0] == result_size.width() && cached_size[1] == result_size.height()) {
+			const std::string compressed_data((std::istreambuf_iterator<char>(ifstream)), std::istreambuf_iterator<char>());
+			const QByteArray data = qUncompress(reinterpret_cast<const uchar *>(compressed_data.data()), static_cast<int>(compressed_data.size()));
+
+			if (static_cast<size_t>(data.size()) == result_data_size) {
+				QImage result_image(result_size, QImage::Format_RGBA8888);
+
+				for (int y = 0; y < result_image.height(); ++y) {
+					memcpy(result_image.scanLine(y), data.constData() + result_line_size * y, result_line_size);
+				}
+
+				//mark the file as recently used
+				std::error_code error_code;
+				std::filesystem::last_write_time(cache_filepath, std::filesystem::file_time_type::clock::now(), error_code);
+
+				return result_image;
+			}
+		}
+
+		fprintf(stderr, "Invalid scaled image cache file: \"%s\".\n", cache_filepath.string().c_str());
+	}
+
+	QImage result_image = wyrmgus::image::scale(image, scale_factor, frame_size);
+
+	try {
+		if (!std::filesystem::exists(cache_path)) {
+			std::filesystem::create_directories(cache_path);
+		}
+
+		QByteArray data(static_cast<int>(result_data_size), Qt::Uninitialized);
+		for (int y = 0; y < result_image.height(); ++y) {
+			memcpy(data.data() + result_line_size * y, result_image.constScanLine(y), result_line_size);
+		}
+		const QByteArray compressed_data = qCompress(data);
+
+		//write to a temporary file first, so that an interrupted write cannot leave a truncated cache file behind
+		std::filesystem::path temp_filepath = cache_filepath;
+		temp_filepath += ".tmp";
+
+		{
+			std::ofstream ofstream(temp_filepath, std::ios::binary | std::ios::trunc);
+			const int result_size_values[2] = { result_size.width(), result_size.height() };
+			ofstream.write(reinterpret_cast<const char *>(result_size_values), sizeof(result_size_values));
+			ofstream.write(compressed_data.constData(), compressed_data.size());
+
+			if (!ofstream) {
+				throw std::runtime_error("Failed to write file \"" + temp_filepath.string() + "\".");
+			}
+		}
+
+		std::filesystem::rename(temp_filepath, cache_filepath);
+
+		TrimScaledImageCache(cache_path, sizeof(int) * 2 + static_cast<uintmax_t>(compressed_data.size()));
+	} catch (const std::exception &exception) {
+		fprintf(stderr, "Failed to save the scaled image cache file: %s\n", exception.what());
+	}
+
+	return result_image;
+}
+
 static void MakeTextures(CGraphic *g, const bool grayscale, const wyrmgus::player_color *player_color, const wyrmgus::time_of_day *time_of_day)
 {
 	const int tw = (g->get_width() - 1) / GLMaxTextureSize + 1;
@@ -1098,11 +1266,17 @@ static void MakeTextures(CGraphic *g, const bool grayscale, const wyrmgus::playe
 		image = image.convertToFormat(QImage::Format_RGBA8888);
 	}
 
+	//the image before color conversion, which identifies the scaled image in the cache together with the conversion
+	const QImage source_image = image;
+	std::string scaled_image_variant;
+
 	if (grayscale) {
 		if (Preference.SepiaForGrayscale) {
 			ApplySepiaScale(image);
+			scaled_image_variant = "sepia";
 		} else {
 			ApplyGrayScale(image);
+			scaled_image_variant = "grayscale";
 		}
 	} else if (player_color != nullptr && g->has_player_color()) {
 		const int bpp = image.depth() / 8;
@@ -1130,6 +1304,9 @@ static void MakeTextures(CGraphic *g, const bool grayscale, const wyrmgus::playe
 				}
 			}
 		}
+
+		//player colors have to be converted before scaling, as scaling blends them with the colors around them
+		scaled_image_variant = conversible_player_color->get_identifier() + "_" + player_color->get_identifier();
 	}
 
 	if (image.size() != g->get_size()) {
@@ -1137,7 +1314,7 @@ static void MakeTextures(CGraphic *g, const bool grayscale, const wyrmgus::playe
 		if (g->get_width() > image.width() && g->get_height() > image.height() && (g->get_width() % image.width()) == 0 && (g->get_height() % image.height()) == 0 && (g->get_width() / image.width()) == (g->get_height() / image.height())) {
 			//if a simple scale factor is being used for the resizing, then use xBRZ for the rescaling
 			const int scale_factor = g->get_width() / image.width();
-			image = wyrmgus::image::scale(image, scale_factor, g->get_original_frame_size());
+			image = ScaleImageWithCache(image, source_image, scaled_image_variant, scale_factor, g->get_original_frame_size());
 		} else {
 			image = image.scaled(g->get_size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
 			if (image.format() != QImage::Format_RGBA8888) {